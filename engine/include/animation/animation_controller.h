@@ -5,6 +5,7 @@
 namespace d2portable::sprites {
     class DC6Sprite;
     struct DC6Frame;
+    struct DC6FrameView;
 }
 
 namespace d2::animation {
@@ -111,9 +112,16 @@ public:
     /**
      * Get the current sprite frame for rendering
      * @return Pointer to the current DC6Frame
+     * @deprecated Always returns nullptr; use getCurrentFrameView()
      */
     const d2portable::sprites::DC6Frame* getCurrentSpriteFrame() const;
     
+    /**
+     * Get the current direction and frame of the sprite for rendering
+     * @return View of the frame's pixels, no copy is made
+     */
+    d2portable::sprites::DC6FrameView getCurrentFrameView() const;
+    
     /**
      * Get the total number of frames in the current direction
      */
@@ -0,0 +1,124 @@
+#ifndef D2PORTABLE_ASSET_BUNDLE_H
+#define D2PORTABLE_ASSET_BUNDLE_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "sprites/dc6_parser.h"
+
+namespace d2portable {
+namespace core {
+
+/**
+ * Current version of the .d2pak bundle format
+ */
+constexpr uint32_t kAssetBundleVersion = 1;
+
+/**
+ * Writes a .d2pak bundle of pre-decoded sprites
+ *
+ * Layout (little endian, every section 16-byte aligned):
+ *   header | entry table sorted by path hash | frame table | path pool | pixel blobs
+ * Each frame's palette-indexed pixels are stored decoded, so loading a
+ * bundled sprite needs no DC6 parsing or RLE decoding.
+ */
+class AssetBundleWriter {
+public:
+    AssetBundleWriter();
+    ~AssetBundleWriter();
+
+    AssetBundleWriter(const AssetBundleWriter&) = delete;
+    AssetBundleWriter& operator=(const AssetBundleWriter&) = delete;
+
+    /**
+     * Add a sprite to the bundle
+     * @param relative_path Asset path the sprite is looked up by (case and
+     *                      separator insensitive)
+     * @param sprite Decoded sprite; kept alive until write()
+     * @return false if the path was already added
+     */
+    bool addSprite(const std::string& relative_path, std::shared_ptr<sprites::DC6Sprite> sprite);
+
+    /**
+     * Get the number of sprites added so far
+     */
+    size_t getSpriteCount() const;
+
+    /**
+     * Write the bundle to disk
+     * @param output_path Destination file
+     * @return true if successful, false otherwise
+     */
+    bool write(const std::string& output_path);
+
+    /**
+     * Get the last error message
+     */
+    std::string getLastError() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * Read-only view of a .d2pak bundle
+ *
+ * The bundle is memory mapped; sprites returned by loadSprite() read their
+ * pixels straight from the mapping and keep it alive on their own, so they
+ * may outlive the AssetBundle. Lookups are safe from several threads.
+ */
+class AssetBundle {
+public:
+    AssetBundle();
+    ~AssetBundle();
+
+    AssetBundle(const AssetBundle&) = delete;
+    AssetBundle& operator=(const AssetBundle&) = delete;
+
+    /**
+     * Map a bundle and validate its header and tables
+     * @param bundle_path Path to the .d2pak file
+     * @return true if successful, false otherwise
+     */
+    bool open(const std::string& bundle_path);
+
+    /**
+     * Check if a bundle is open
+     */
+    bool isOpen() const;
+
+    /**
+     * Check if the bundle contains a sprite
+     * @param relative_path Asset path (case and separator insensitive)
+     */
+    bool contains(const std::string& relative_path) const;
+
+    /**
+     * Get a sprite backed by the bundle mapping
+     * @param relative_path Asset path (case and separator insensitive)
+     * @return Sprite, or nullptr if the bundle does not contain it
+     */
+    std::shared_ptr<sprites::DC6Sprite> loadSprite(const std::string& relative_path) const;
+
+    /**
+     * Get the number of sprites in the bundle
+     */
+    size_t getSpriteCount() const;
+
+    /**
+     * Get the last error message
+     */
+    std::string getLastError() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace core
+} // namespace d2portable
+
+#endif // D2PORTABLE_ASSET_BUNDLE_H
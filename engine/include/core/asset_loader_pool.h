@@ -0,0 +1,92 @@
+#ifndef D2PORTABLE_ASSET_LOADER_POOL_H
+#define D2PORTABLE_ASSET_LOADER_POOL_H
+
+#include <string>
+#include <memory>
+#include <future>
+#include <functional>
+#include <cstddef>
+#include "sprites/dc6_parser.h"
+
+namespace d2portable {
+namespace core {
+
+/**
+ * Scheduling priority for asynchronous asset loads
+ */
+enum class LoadPriority {
+    VISIBLE,   // Needed for the current frame
+    NEARBY,    // Likely to come on screen soon
+    PREFETCH   // Speculative, first to be cancelled
+};
+
+/**
+ * Fixed-size worker pool for asynchronous sprite loads
+ *
+ * Requests are served highest priority first (FIFO within a priority).
+ * Concurrent requests for the same path share a single load, and a
+ * repeated request can raise the priority of a queued load. Loads that
+ * have not started yet can be cancelled; their futures resolve to nullptr.
+ */
+class AssetLoaderPool {
+public:
+    using SpritePtr = std::shared_ptr<sprites::DC6Sprite>;
+    using LoadFunction = std::function<SpritePtr(const std::string&)>;
+
+    /**
+     * Create the pool and start its workers
+     * @param load_function Performs the actual (synchronous) load
+     * @param worker_count Number of workers, or 0 for a default that leaves
+     *                     a core free for the game thread
+     */
+    explicit AssetLoaderPool(LoadFunction load_function, size_t worker_count = 0);
+
+    /**
+     * Stop the workers; queued loads resolve to nullptr
+     */
+    ~AssetLoaderPool();
+
+    AssetLoaderPool(const AssetLoaderPool&) = delete;
+    AssetLoaderPool& operator=(const AssetLoaderPool&) = delete;
+
+    /**
+     * Queue a load, or join an already queued or running load of the same path
+     * @param path Asset path passed to the load function
+     * @param priority Scheduling priority
+     * @return Future that will contain the loaded sprite
+     */
+    std::future<SpritePtr> submit(const std::string& path, LoadPriority priority = LoadPriority::VISIBLE);
+
+    /**
+     * Cancel a queued load
+     * @param path Asset path of the load
+     * @return true if the load was still queued and has been cancelled
+     */
+    bool cancel(const std::string& path);
+
+    /**
+     * Cancel every queued load at or below the given priority
+     * @param priority Highest priority to cancel (PREFETCH cancels only prefetches)
+     * @return Number of cancelled loads
+     */
+    size_t cancelAll(LoadPriority priority = LoadPriority::VISIBLE);
+
+    /**
+     * Get the number of loads waiting for a worker
+     */
+    size_t getQueuedCount() const;
+
+    /**
+     * Get the number of worker threads
+     */
+    size_t getWorkerCount() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace core
+} // namespace d2portable
+
+#endif // D2PORTABLE_ASSET_LOADER_POOL_H
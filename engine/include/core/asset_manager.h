@@ -8,6 +8,7 @@
 #include <future>
 #include <chrono>
 #include "sprites/dc6_parser.h"
+#include "core/asset_loader_pool.h"
 
 // Forward declaration
 namespace d2 {
@@ -71,6 +72,21 @@ public:
      */
     bool initializeWithMPQs(const std::string& mpq_directory, const std::string& fallback_path = "");
     
+    /**
+     * Mount a pre-decoded .d2pak sprite bundle
+     * 
+     * Bundled sprites are served from a read-only mapping before any archive
+     * or directory is searched. Mount bundles before loading starts.
+     * @param bundle_path Path to the bundle written by AssetBundleWriter
+     * @return true if the bundle was mapped and validated
+     */
+    bool mountBundle(const std::string& bundle_path);
+    
+    /**
+     * Get the number of mounted bundles
+     */
+    size_t getMountedBundleCount() const;
+    
     /**
      * Check if the asset manager is initialized
      * @return true if initialized, false otherwise
@@ -92,11 +108,29 @@ public:
     std::shared_ptr<sprites::DC6Sprite> loadSprite(const std::string& relative_path);
     
     /**
-     * Load a DC6 sprite asynchronously
+     * Load a DC6 sprite asynchronously on the shared loader pool
+     * 
+     * Requests for a sprite that is already queued or loading share that load.
      * @param relative_path Relative path to DC6 file
-     * @return Future that will contain the loaded sprite
+     * @param priority Scheduling priority of the load
+     * @return Future that will contain the loaded sprite (nullptr if cancelled)
+     */
+    std::future<std::shared_ptr<sprites::DC6Sprite>> loadSpriteAsync(const std::string& relative_path,
+                                                                     LoadPriority priority = LoadPriority::VISIBLE);
+    
+    /**
+     * Cancel an asynchronous sprite load that has not started yet
+     * @param relative_path Relative path passed to loadSpriteAsync
+     * @return true if the load was cancelled
      */
-    std::future<std::shared_ptr<sprites::DC6Sprite>> loadSpriteAsync(const std::string& relative_path);
+    bool cancelAsyncLoad(const std::string& relative_path);
+    
+    /**
+     * Cancel all queued asynchronous loads at or below a priority
+     * @param priority Highest priority to cancel (e.g. PREFETCH when the player leaves an area)
+     * @return Number of cancelled loads
+     */
+    size_t cancelAsyncLoads(LoadPriority priority);
     
     /**
      * Load raw file data synchronously
@@ -105,6 +139,21 @@ public:
      */
     std::vector<uint8_t> loadFileData(const std::string& relative_path);
     
+    /**
+     * Load raw file data into a reusable buffer
+     * @param relative_path Relative path to file
+     * @param data Buffer that receives the file; its capacity is reused
+     * @return true if the file was loaded
+     */
+    bool loadFileData(const std::string& relative_path, std::vector<uint8_t>& data);
+    
+    /**
+     * Get the uncompressed size of an archived file without opening it
+     * @param relative_path Relative path to file
+     * @return Size in bytes, or 0 if the file is not in the archive index
+     */
+    size_t getFileSize(const std::string& relative_path) const;
+    
     /**
      * Get asset information
      * @param relative_path Relative path to asset
@@ -124,6 +173,13 @@ public:
      */
     size_t getCacheMemoryUsage() const;
     
+    /**
+     * Get the number of times a cache lookup had to wait for another
+     * thread holding the same cache shard
+     * @return Contended lock acquisitions since construction
+     */
+    uint64_t getCacheLockContentionCount() const;
+    
     /**
      * Clear all cached assets
      */
@@ -135,6 +191,35 @@ public:
      */
     void setMaxCacheSize(size_t max_bytes);
     
+    /**
+     * Set the budget for decoded sprite pixels (0 = unlimited)
+     * 
+     * Sprites decode their frames on demand and charge the bytes to the
+     * direction they belong to. Over budget, the least recently drawn
+     * directions of any sprite are dropped first, so a character keeps the
+     * directions on screen while its other directions are released. The
+     * cache size limit above only covers the encoded files.
+     * @param max_bytes Maximum decoded bytes (default kDefaultResidencyBudget)
+     */
+    void setSpriteResidencyBudget(size_t max_bytes);
+    
+    /**
+     * Get the budget for decoded sprite pixels
+     * @return Budget in bytes (0 = unlimited)
+     */
+    size_t getSpriteResidencyBudget() const;
+    
+    /**
+     * Get the decoded pixel bytes of all loaded sprites
+     * @return Resident bytes; reported to the memory monitor as "sprite_pixels"
+     */
+    size_t getSpriteResidentBytes() const;
+    
+    /**
+     * Get the number of sprite directions holding decoded pixels
+     */
+    size_t getSpriteResidentDirectionCount() const;
+    
     /**
      * Get the last error message
      * @return Error message string
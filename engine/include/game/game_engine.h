@@ -18,6 +18,7 @@ class Renderer;
 class WorldRenderer;
 class Camera;
 class SpriteRenderer;
+class TextureManager;
 }
 namespace game {
 class GameState;
@@ -137,6 +138,7 @@ private:
     std::unique_ptr<d2::rendering::Renderer> renderer_;
     std::unique_ptr<d2::rendering::WorldRenderer> worldRenderer_;
     std::unique_ptr<d2::rendering::Camera> camera_;
+    std::unique_ptr<d2::rendering::TextureManager> textureManager_;
     std::unique_ptr<d2::rendering::SpriteRenderer> spriteRenderer_;
     std::unique_ptr<d2::game::GameState> gameState_;
     std::unique_ptr<d2::input::InputManager> inputManager_;
@@ -11,6 +11,7 @@ namespace d2portable::core {
 
 namespace d2::utils {
     class DataTableParser;
+    class DataTable;
 }
 
 namespace d2::game {
@@ -28,6 +29,8 @@ public:
     
     /**
      * Load item data from asset manager using data table parser
+     *
+     * Rows with an empty name are skipped.
      * @param assetManager The asset manager to load files from
      * @param parser The data table parser to parse the files
      * @return true if loading successful, false otherwise
@@ -74,6 +77,18 @@ private:
     bool loadMiscData(std::shared_ptr<d2portable::core::AssetManager> assetManager,
                      d2::utils::DataTableParser* parser);
     
+    /**
+     * Load a data table from data/excel, or from data/ when it is not there
+     *
+     * The precompiled .d2tbl next to the text is used when it matches the
+     * text; AssetExtractor::compileDataTables writes it there.
+     * @param fileName Table file name, e.g. "armor.txt"
+     */
+    bool loadTable(std::shared_ptr<d2portable::core::AssetManager> assetManager,
+                   d2::utils::DataTableParser* parser,
+                   const std::string& fileName,
+                   d2::utils::DataTable& table);
+    
     std::unordered_map<std::string, Item> items_;
     Item defaultItem_; // Returned when item not found
 };
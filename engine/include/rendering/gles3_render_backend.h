@@ -27,6 +27,8 @@ public:
                     GLenum format, GLenum type, const void* pixels) override;
     void texParameteri(GLenum target, GLenum pname, GLint param) override;
     void deleteTextures(GLsizei n, const GLuint* textures) override;
+    void activeTexture(GLenum texture) override;
+    void pixelStorei(GLenum pname, GLint param) override;
 
     GLuint createShader(GLenum shaderType) override;
     void shaderSource(GLuint shader, GLsizei count, const char* const* string, const GLint* length) override;
@@ -21,6 +21,15 @@ struct DrawElementsCall {
     uintptr_t indices;
 };
 
+struct TexImage2DCall {
+    uint32_t texture;
+    int internalformat;
+    int width;
+    int height;
+    uint32_t format;
+    size_t bytes;
+};
+
 class MockRenderBackend : public IRenderBackend {
 public:
     MockRenderBackend();
@@ -45,6 +54,8 @@ public:
                     GLenum format, GLenum type, const void* pixels) override;
     void texParameteri(GLenum target, GLenum pname, GLint param) override;
     void deleteTextures(GLsizei n, const GLuint* textures) override;
+    void activeTexture(GLenum texture) override;
+    void pixelStorei(GLenum pname, GLint param) override;
 
     // Shader operations
     GLuint createShader(GLenum shaderType) override;
@@ -89,6 +100,16 @@ public:
     const std::vector<DrawArraysCall>& getDrawArraysCalls() const;
     const std::vector<DrawElementsCall>& getDrawElementsCalls() const;
 
+    // Texture upload inspection
+    void resetTextureUploadTracking();
+    const std::vector<TexImage2DCall>& getTexImage2DCalls() const;
+    size_t getTextureBytesUploaded() const;
+    GLuint getBoundTexture(GLenum unit) const;
+    GLint getUnpackAlignment() const;
+
+    // Buffer upload inspection: bytes passed to the most recent bufferSubData
+    const std::vector<uint8_t>& getLastBufferSubData() const;
+
 private:
     // RNG for buffer/VAO/shader IDs
     std::mt19937 gen_;
@@ -103,10 +124,18 @@ private:
     // VBO state
     std::unordered_map<uint32_t, size_t> vboSizes_;
     uint32_t currentlyBoundBuffer_ = 0;
+    std::vector<uint8_t> lastBufferSubData_;
     static constexpr size_t MAX_VBO_SIZE = 100 * 1024 * 1024;
 
     // Texture state
     uint32_t nextTextureId_ = 1;
+    GLenum activeTextureUnit_ = GL_TEXTURE0_VALUE;
+    std::unordered_map<GLenum, GLuint> boundTextures_;
+    GLint unpackAlignment_ = 4;
+
+    // Texture upload tracking
+    std::vector<TexImage2DCall> texImage2DCalls_;
+    size_t textureBytesUploaded_ = 0;
 
     // Draw command tracking
     std::vector<DrawArraysCall> drawArraysCalls_;
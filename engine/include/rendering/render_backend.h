@@ -35,6 +35,9 @@ constexpr GLenum GL_STATIC_DRAW_VALUE = 0x88E4;
 
 constexpr GLenum GL_TEXTURE_2D_VALUE = 0x0DE1;
 constexpr GLenum GL_RGBA_VALUE = 0x1908;
+constexpr GLenum GL_RGBA8_VALUE = 0x8058;
+constexpr GLenum GL_RED_VALUE = 0x1903;
+constexpr GLenum GL_R8_VALUE = 0x8229;
 constexpr GLenum GL_UNSIGNED_BYTE_VALUE = 0x1401;
 constexpr GLenum GL_TEXTURE_MIN_FILTER_VALUE = 0x2801;
 constexpr GLenum GL_TEXTURE_MAG_FILTER_VALUE = 0x2800;
@@ -44,6 +47,8 @@ constexpr GLenum GL_LINEAR_VALUE = 0x2601;
 constexpr GLenum GL_NEAREST_VALUE = 0x2600;
 constexpr GLenum GL_CLAMP_TO_EDGE_VALUE = 0x812F;
 constexpr GLenum GL_REPEAT_VALUE = 0x2901;
+constexpr GLenum GL_TEXTURE0_VALUE = 0x84C0;
+constexpr GLenum GL_UNPACK_ALIGNMENT_VALUE = 0x0CF5;
 
 constexpr GLenum GL_TRIANGLES_VALUE = 0x0004;
 constexpr GLenum GL_FLOAT_VALUE = 0x1406;
@@ -78,6 +83,8 @@ public:
                             GLenum format, GLenum type, const void* pixels) = 0;
     virtual void texParameteri(GLenum target, GLenum pname, GLint param) = 0;
     virtual void deleteTextures(GLsizei n, const GLuint* textures) = 0;
+    virtual void activeTexture(GLenum texture) = 0;
+    virtual void pixelStorei(GLenum pname, GLint param) = 0;
 
     // Shader operations
     virtual GLuint createShader(GLenum shaderType) = 0;
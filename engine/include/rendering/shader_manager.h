@@ -12,6 +12,12 @@ enum class ShaderType {
     FRAGMENT
 };
 
+// Fragment shader variants for sprite rendering
+enum class SpriteShaderVariant {
+    RGBA,      // Samples an RGBA sprite texture
+    PALETTED   // Looks R8 palette indices up in a 256x1 palette texture
+};
+
 class ShaderManager {
 public:
     ShaderManager() = default;
@@ -29,6 +35,17 @@ public:
     int getUniformLocation(uint32_t program_id, const std::string& name) const;
     bool setUniformMatrix4fv(uint32_t program_id, const std::string& name, const float* value);
     bool setUniform4f(uint32_t program_id, const std::string& name, float v0, float v1, float v2, float v3);
+    bool setUniform1i(uint32_t program_id, const std::string& name, int value);
+    
+    // Sprite shaders; the paletted variant samples u_texture on SPRITE_TEXTURE_UNIT
+    // and u_palette on PALETTE_TEXTURE_UNIT, and multiplies the color by u_tint
+    static constexpr uint32_t SPRITE_TEXTURE_UNIT = 0;
+    static constexpr uint32_t PALETTE_TEXTURE_UNIT = 1;
+    static std::string getSpriteVertexShaderSource();
+    static std::string getSpriteFragmentShaderSource(SpriteShaderVariant variant);
+    
+    // Compiles and links the variant on first use; returns 0 on failure
+    uint32_t getSpriteProgram(SpriteShaderVariant variant);
 
 private:
     struct ProgramInfo {
@@ -40,6 +57,7 @@ private:
     std::unordered_set<uint32_t> valid_shaders_;
     std::unordered_set<uint32_t> valid_programs_;
     std::unordered_map<uint32_t, ProgramInfo> program_info_;
+    std::unordered_map<int, uint32_t> sprite_programs_;
 };
 
 } // namespace d2::rendering
\ No newline at end of file
@@ -29,8 +29,18 @@ public:
 
     bool initialize(const Renderer& renderer, const TextureManager& texture_manager);
     virtual void beginFrame();
+    
+    // position and size describe the whole frame; textures trimmed by the
+    // TextureManager passed to initialize() are drawn as the smaller quad
+    // covering just their visible bounds
     virtual void drawSprite(uint32_t texture_id, const glm::vec2& position, const glm::vec2& size);
     virtual void drawSpriteFromAtlas(const std::string& spriteName, const glm::vec2& position, const glm::vec2& size);
+    
+    // Paletted sprites: an indexed texture drawn through a palette texture
+    // (see TextureManager::createIndexedTexture and createPaletteTexture)
+    virtual void drawPalettedSprite(uint32_t texture_id, uint32_t palette_texture_id,
+                                    const glm::vec2& position, const glm::vec2& size);
+    void setPaletteTint(float r, float g, float b, float a);
     virtual void endFrame();
     
     // Batch rendering for performance optimization
@@ -66,6 +76,7 @@ public:
     
     // Shader management
     uint32_t getShaderProgram() const;
+    uint32_t getPalettedShaderProgram() const;
     bool isShaderProgramActive() const;
     
     // OpenGL resource access (for testing)
@@ -73,7 +84,10 @@ public:
     uint32_t getVertexBufferId() const;
 
 private:
+    void trimQuad(uint32_t texture_id, glm::vec2& position, glm::vec2& size) const;
+    
     bool initialized_ = false;
+    const TextureManager* texture_manager_ = nullptr;
     uint32_t draw_call_count_ = 0;
     uint32_t sprite_count_ = 0;
     std::unordered_set<uint32_t> textures_used_;
@@ -85,7 +99,9 @@ private:
     // Shader management
     std::unique_ptr<ShaderManager> shader_manager_;
     uint32_t shader_program_ = 0;
+    uint32_t paletted_shader_program_ = 0;
     bool shader_program_active_ = false;
+    float palette_tint_[4] = {1.0f, 1.0f, 1.0f, 1.0f};
     
     // OpenGL resources
     std::unique_ptr<VertexBuffer> vertex_buffer_;
@@ -94,9 +110,11 @@ private:
     // Sprite batching
     struct SpriteBatch {
         uint32_t texture_id;
+        uint32_t palette_texture_id = 0;
         std::vector<SpriteVertex> vertices;
     };
     std::unordered_map<uint32_t, SpriteBatch> sprite_batches_;
+    std::unordered_map<uint64_t, SpriteBatch> paletted_batches_;
     
     // Texture Atlas support
     std::vector<d2::TextureAtlas> atlases_;
@@ -12,10 +12,26 @@ enum class TextureWrapMode {
     REPEAT
 };
 
+enum class TextureFormat {
+    RGBA,     // 4 bytes per pixel, linear filtering
+    INDEXED,  // R8 palette indices, nearest filtering
+    PALETTE   // 256x1 RGBA palette for indexed textures
+};
+
+// Where a trimmed texture sits inside the frame it was cut from
+struct TextureTrim {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t source_width = 0;
+    uint32_t source_height = 0;
+};
+
 struct TextureInfo {
     uint32_t width;
     uint32_t height;
     uint32_t gl_texture_id;
+    TextureFormat format = TextureFormat::RGBA;
+    TextureTrim trim;
 };
 
 class Renderer;
@@ -36,11 +52,33 @@ public:
     uint32_t createTexture(const uint8_t* rgba_data, uint32_t width, uint32_t height);
     uint32_t getTextureWidth(uint32_t texture_id) const;
     uint32_t getTextureHeight(uint32_t texture_id) const;
+    TextureFormat getTextureFormat(uint32_t texture_id) const;
+    
+    // Paletted textures: frames are uploaded once as one-byte palette
+    // indices and drawn with SpriteShaderVariant::PALETTED, so a palette
+    // variant costs a 1 KB palette texture instead of a re-upload per frame
+    uint32_t uploadSpriteIndexed(std::shared_ptr<sprites::DC6Sprite> sprite, uint32_t direction, uint32_t frame);
+    uint32_t createIndexedTexture(const uint8_t* indices, uint32_t width, uint32_t height);
+    uint32_t createPaletteTexture(const std::vector<uint32_t>& palette);
+    bool updatePaletteTexture(uint32_t texture_id, const std::vector<uint32_t>& palette);
+    
+    // Border trimming: sprite uploads keep only the frame's visible
+    // bounds (palette index 0 is transparent). getTextureTrim() reports
+    // where the texture sits in the frame, and SpriteRenderer uses it to
+    // shrink the quad, so callers keep drawing with the frame's full size.
+    void setBorderTrimming(bool enabled);
+    bool isBorderTrimmingEnabled() const;
+    TextureTrim getTextureTrim(uint32_t texture_id) const;
     
     // Texture wrapping modes
     void setTextureWrapMode(uint32_t texture_id, TextureWrapMode wrap_mode);
 
 private:
+    uint32_t uploadTexture(const uint8_t* pixels, uint32_t width, uint32_t height, TextureFormat format);
+    uint32_t uploadFrame(const sprites::DC6FrameView& frame, const uint8_t* pixels, TextureFormat format);
+    bool uploadPalette(uint32_t gl_texture_id, const std::vector<uint32_t>& palette);
+
+    bool trim_borders_ = true;
     uint32_t next_texture_id_ = 1;
     std::unordered_map<uint32_t, TextureInfo> textures_;
 };
@@ -5,10 +5,13 @@
 #include <memory>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 namespace d2portable {
 namespace sprites {
 
+class SpriteResidency;
+
 /**
  * Frame information for a DC6 sprite
  */
@@ -20,6 +23,25 @@ struct DC6Frame {
     std::vector<uint8_t> pixelData;
 };
 
+/**
+ * Read-only view of a frame's metadata and palette-indexed pixels
+ *
+ * The pixels are not copied. They stay valid while the sprite is alive;
+ * sprites that can drop a frame's pixels set owner so the view keeps them
+ * alive on its own.
+ */
+struct DC6FrameView {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int32_t offsetX = 0;
+    int32_t offsetY = 0;
+    const uint8_t* pixels = nullptr;
+    size_t pixelCount = 0;
+    std::shared_ptr<const void> owner;
+
+    bool empty() const { return pixelCount == 0; }
+};
+
 /**
  * DC6 Sprite class representing a loaded sprite
  */
@@ -39,12 +61,25 @@ public:
     
     /**
      * Get a specific frame
+     *
+     * Copies the frame's pixels; prefer getFrameView() on hot paths.
      * @param direction Direction index
      * @param frame Frame index
      * @return Frame information
      */
     virtual DC6Frame getFrame(uint32_t direction, uint32_t frame) const = 0;
     
+    /**
+     * Get a specific frame without copying its pixels
+     *
+     * The default implementation wraps a getFrame() copy, so sprites only
+     * need to override it when they can hand out their own storage.
+     * @param direction Direction index
+     * @param frame Frame index
+     * @return Frame view; empty for an invalid direction or frame
+     */
+    virtual DC6FrameView getFrameView(uint32_t direction, uint32_t frame) const;
+    
     /**
      * Get frame as RGBA image data
      * @param direction Direction index
@@ -62,10 +97,38 @@ public:
      */
     virtual std::vector<uint8_t> getFrameImageWithPalette(uint32_t direction, uint32_t frame, 
                                                           const std::vector<uint32_t>& palette) const = 0;
+    
+    /**
+     * Convert a frame to RGBA into a caller-provided buffer
+     * @param direction Direction index
+     * @param frame Frame index
+     * @param palette 256-color palette (RGBA format, 32-bit per color)
+     * @param rgba Destination buffer
+     * @param capacity Size of the destination in bytes
+     * @return Number of pixels written; 0 if the frame is empty or does not fit
+     */
+    size_t expandFrame(uint32_t direction, uint32_t frame, const uint32_t* palette,
+                       uint8_t* rgba, size_t capacity) const;
+    
+    /**
+     * Get the size of the encoded data the sprite keeps to decode frames from
+     * @return Bytes held besides decoded frames; 0 if the sprite keeps none
+     */
+    virtual size_t getEncodedSize() const { return 0; }
 };
 
+/**
+ * Default number of bytes of decoded frames a parsed sprite keeps cached
+ */
+constexpr size_t kDefaultFrameCacheBudget = 1024 * 1024;
+
 /**
  * DC6 file parser for Diablo II sprites
+ *
+ * Parsing only validates the header and locates the frames. A frame is
+ * RLE-decoded the first time it is requested and kept in a per-sprite
+ * cache bounded by the frame cache budget, or charged to a shared
+ * SpriteResidency when one is set.
  */
 class DC6Parser {
 public:
@@ -83,11 +146,43 @@ public:
      */
     std::unique_ptr<DC6Sprite> parseData(const std::vector<uint8_t>& data);
     
+    /**
+     * Parse DC6 data from memory, taking ownership of the buffer
+     * @param data DC6 file data; the sprite decodes frames from it
+     * @return Parsed sprite object, or nullptr on failure
+     */
+    std::unique_ptr<DC6Sprite> parseData(std::vector<uint8_t>&& data);
+    
+    /**
+     * Set the decoded frame cache budget for sprites parsed afterwards
+     * @param bytes Decoded pixel bytes each sprite may keep; the most
+     *              recently used frame is always kept
+     */
+    void setFrameCacheBudget(size_t bytes);
+    
+    /**
+     * Get the decoded frame cache budget
+     */
+    size_t getFrameCacheBudget() const;
+    
+    /**
+     * Share a residency budget between sprites parsed afterwards
+     *
+     * Their decoded frames are charged to the residency per direction
+     * instead of being bounded by the frame cache budget.
+     * @param residency Residency to charge, or nullptr for per-sprite budgets
+     */
+    void setResidency(std::shared_ptr<SpriteResidency> residency);
+    
     /**
      * Get the default Diablo II palette
      * @return 256-color palette (RGBA format, 32-bit per color)
      */
     std::vector<uint32_t> getDefaultPalette() const;
+    
+private:
+    size_t frame_cache_budget = kDefaultFrameCacheBudget;
+    std::shared_ptr<SpriteResidency> residency;
 };
 
 } // namespace sprites
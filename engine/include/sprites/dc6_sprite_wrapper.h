@@ -8,6 +8,7 @@ namespace sprites {
 // Type alias to use d2portable::sprites::DC6Sprite in d2::sprites namespace
 using DC6Sprite = ::d2portable::sprites::DC6Sprite;
 using DC6Frame = ::d2portable::sprites::DC6Frame;
+using DC6FrameView = ::d2portable::sprites::DC6FrameView;
 using DC6Parser = ::d2portable::sprites::DC6Parser;
 
 } // namespace sprites
@@ -0,0 +1,86 @@
+#ifndef D2PORTABLE_DCC_PARSER_H
+#define D2PORTABLE_DCC_PARSER_H
+
+#include "sprites/dc6_parser.h"
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace d2portable {
+namespace sprites {
+
+/**
+ * Default number of bytes of decoded directions a parsed DCC sprite keeps
+ */
+constexpr size_t kDefaultDirectionCacheBudget = 4 * 1024 * 1024;
+
+/**
+ * DCC file parser for Diablo II animations (characters, monsters, objects)
+ *
+ * DCC sprites share the DC6Sprite interface. Parsing only validates the
+ * header and locates the directions. Every frame of a direction is coded
+ * against the previous one, so a direction is decoded as a whole the
+ * first time one of its frames is requested, and the decoded directions
+ * are kept in a per-sprite cache bounded by the direction cache budget,
+ * or charged to a shared SpriteResidency when one is set.
+ * Decoding reuses one scratch arena per sprite for the pixel buffer cells
+ * and the direction canvas.
+ *
+ * Frames are cropped to their own bounding box; offsetX is the left edge
+ * and offsetY the bottom row, as for DC6 frames.
+ */
+class DCCParser {
+public:
+    /**
+     * Parse a DCC file from disk
+     * @param filepath Path to the DCC file
+     * @return Parsed sprite object, or nullptr on failure
+     */
+    std::unique_ptr<DC6Sprite> parseFile(const std::string& filepath);
+
+    /**
+     * Parse DCC data from memory
+     * @param data DCC file data
+     * @return Parsed sprite object, or nullptr on failure
+     */
+    std::unique_ptr<DC6Sprite> parseData(const std::vector<uint8_t>& data);
+
+    /**
+     * Parse DCC data from memory, taking ownership of the buffer
+     * @param data DCC file data; the sprite decodes directions from it
+     * @return Parsed sprite object, or nullptr on failure
+     */
+    std::unique_ptr<DC6Sprite> parseData(std::vector<uint8_t>&& data);
+
+    /**
+     * Set the decoded direction cache budget for sprites parsed afterwards
+     * @param bytes Decoded pixel bytes each sprite may keep; the most
+     *              recently used direction is always kept
+     */
+    void setDirectionCacheBudget(size_t bytes);
+
+    /**
+     * Get the decoded direction cache budget
+     */
+    size_t getDirectionCacheBudget() const;
+
+    /**
+     * Share a residency budget between sprites parsed afterwards
+     *
+     * Their decoded directions are charged to the residency instead of
+     * being bounded by the direction cache budget.
+     * @param residency Residency to charge, or nullptr for per-sprite budgets
+     */
+    void setResidency(std::shared_ptr<SpriteResidency> residency);
+
+private:
+    size_t direction_cache_budget = kDefaultDirectionCacheBudget;
+    std::shared_ptr<SpriteResidency> residency;
+};
+
+} // namespace sprites
+} // namespace d2portable
+
+#endif // D2PORTABLE_DCC_PARSER_H
@@ -0,0 +1,49 @@
+#ifndef D2PORTABLE_FRAME_TRIM_H
+#define D2PORTABLE_FRAME_TRIM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace d2portable {
+namespace sprites {
+
+/**
+ * Rectangle inside a frame, in pixels from the frame's top-left corner
+ */
+struct FrameRect {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bool empty() const { return width == 0 || height == 0; }
+};
+
+/**
+ * Find the tight bounds of a frame's visible pixels
+ *
+ * Palette index 0 is transparent in every Diablo II palette, so every
+ * other index counts as visible.
+ * @param indices Palette indices, top row first
+ * @param width Frame width
+ * @param height Frame height
+ * @return Smallest rectangle holding every visible pixel; empty if the
+ *         frame is fully transparent
+ */
+FrameRect findOpaqueBounds(const uint8_t* indices, uint32_t width, uint32_t height);
+
+/**
+ * Copy a rectangle out of a tightly packed image
+ * @param pixels Source image, top row first
+ * @param width Source width in pixels
+ * @param bytes_per_pixel Size of one pixel
+ * @param rect Rectangle to copy; must lie inside the source
+ * @param out Destination of rect.width * rect.height * bytes_per_pixel bytes
+ */
+void copyFrameRect(const uint8_t* pixels, uint32_t width, size_t bytes_per_pixel,
+                   const FrameRect& rect, uint8_t* out);
+
+} // namespace sprites
+} // namespace d2portable
+
+#endif // D2PORTABLE_FRAME_TRIM_H
@@ -0,0 +1,44 @@
+#ifndef D2PORTABLE_PALETTE_EXPAND_H
+#define D2PORTABLE_PALETTE_EXPAND_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace d2portable {
+namespace sprites {
+
+/**
+ * Expand palette indices to RGBA pixels
+ *
+ * Uses the widest kernel the CPU supports (AVX2 gathers or SSE2 stores on
+ * x86, table lookups on NEON) and the scalar loop otherwise. Every kernel
+ * produces the same bytes.
+ * @param indices Palette indices, one byte per pixel
+ * @param count Number of pixels
+ * @param palette 256 colors, each stored as R | G << 8 | B << 16 | A << 24
+ * @param rgba Destination of at least count * 4 bytes; may not overlap indices
+ */
+void expandPalette(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgba);
+
+/**
+ * Expand palette indices to RGBA pixels one pixel at a time
+ *
+ * Reference for the vector kernels; same parameters as expandPalette().
+ */
+void expandPaletteScalar(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgba);
+
+/**
+ * Get the name of the kernel expandPalette() uses on this machine
+ * @return "avx2", "sse2", "neon" or "scalar"
+ */
+const char* getPaletteExpandKernel();
+
+/**
+ * Get the palette that expands an index to an opaque gray of that value
+ */
+const uint32_t* getGrayscalePalette();
+
+} // namespace sprites
+} // namespace d2portable
+
+#endif // D2PORTABLE_PALETTE_EXPAND_H
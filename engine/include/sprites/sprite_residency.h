@@ -0,0 +1,135 @@
+#ifndef D2PORTABLE_SPRITE_RESIDENCY_H
+#define D2PORTABLE_SPRITE_RESIDENCY_H
+
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace d2portable {
+namespace sprites {
+
+/**
+ * Default number of bytes of decoded sprite directions a residency keeps
+ */
+constexpr size_t kDefaultResidencyBudget = 256 * 1024 * 1024;
+
+/**
+ * A sprite whose decoded directions can be dropped and decoded again later
+ *
+ * Sprites never call into their SpriteResidency while holding their own
+ * locks, which lets the residency evict from any sprite.
+ */
+class ResidentSprite {
+public:
+    virtual ~ResidentSprite() = default;
+
+    /**
+     * Get the use stamp of a direction's latest frame access
+     * @param direction Direction index
+     * @return Stamp from SpriteResidency::touch(); must not block
+     */
+    virtual uint64_t getDirectionLastUse(uint32_t direction) const = 0;
+
+    /**
+     * Drop the decoded pixels of a direction
+     * @param direction Direction index
+     * @return Number of decoded bytes released
+     */
+    virtual size_t evictDirection(uint32_t direction) const = 0;
+};
+
+/**
+ * Shared budget for the decoded pixels of many sprites
+ *
+ * Sprites charge the bytes they decode to the direction the pixels belong
+ * to. When the total exceeds the budget, the least recently used
+ * directions are evicted across all sprites until it fits again; the most
+ * recently used direction is always kept. Directions drawn every frame
+ * stay resident while cold directions of the same sprite are dropped.
+ */
+class SpriteResidency {
+public:
+    /**
+     * @param budget_bytes Decoded bytes to keep (0 = unlimited)
+     */
+    explicit SpriteResidency(size_t budget_bytes = kDefaultResidencyBudget);
+    ~SpriteResidency();
+
+    SpriteResidency(const SpriteResidency&) = delete;
+    SpriteResidency& operator=(const SpriteResidency&) = delete;
+
+    /**
+     * Set the budget, evicting directions if it is already exceeded
+     * @param budget_bytes Decoded bytes to keep (0 = unlimited)
+     */
+    void setBudget(size_t budget_bytes);
+
+    /**
+     * Get the budget in bytes
+     */
+    size_t getBudget() const;
+
+    /**
+     * Get the decoded bytes currently charged
+     */
+    size_t getResidentBytes() const;
+
+    /**
+     * Get the number of directions holding decoded pixels
+     */
+    size_t getResidentDirectionCount() const;
+
+    /**
+     * Get the number of directions evicted since construction
+     */
+    uint64_t getEvictionCount() const;
+
+    /**
+     * Set a function told about every change of the resident bytes
+     *
+     * Called with the residency's lock held, so it must not call back
+     * into the residency.
+     * @param callback Receives the bytes added (positive) or released (negative)
+     */
+    void setUsageCallback(std::function<void(int64_t)> callback);
+
+    /**
+     * Get a new use stamp for a direction that was just accessed
+     */
+    uint64_t touch();
+
+    /**
+     * Charge newly decoded bytes to a direction and enforce the budget
+     * @param sprite Sprite that decoded them
+     * @param direction Direction index
+     * @param bytes Decoded bytes added
+     */
+    void charge(const ResidentSprite* sprite, uint32_t direction, size_t bytes);
+
+    /**
+     * Release bytes a sprite dropped by itself
+     * @param sprite Sprite that dropped them
+     * @param direction Direction index
+     * @param bytes Decoded bytes released
+     */
+    void release(const ResidentSprite* sprite, uint32_t direction, size_t bytes);
+
+    /**
+     * Release everything charged to a sprite
+     *
+     * Sprites call this first thing in their destructor. It waits for an
+     * eviction in progress, so the residency never calls a dead sprite.
+     * @param sprite Sprite being destroyed
+     */
+    void forget(const ResidentSprite* sprite);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace sprites
+} // namespace d2portable
+
+#endif // D2PORTABLE_SPRITE_RESIDENCY_H
@@ -63,12 +63,77 @@ public:
         extractionMonitor = monitor;
     }
     
+    /**
+     * Set the number of workers decompressing files during extraction
+     *
+     * Each worker opens its own handle on every archive it reads from.
+     * The extracted files are the same for any count.
+     * @param threads Worker count; 0 uses every hardware thread
+     */
+    void setThreadCount(int threads) { threadCount = threads; }
+    
+    /**
+     * Enable/disable baking sprite atlases after extraction
+     * @param enable true to run bakeSpriteAtlases() at the end of extractFromD2()
+     */
+    void setAtlasBaking(bool enable) { atlasBaking = enable; }
+    
+    /**
+     * Set the maximum size of baked atlas pages
+     * @param size Page width and height in pixels
+     */
+    void setAtlasPageSize(int size) { atlasPageSize = size; }
+    
+    /**
+     * Pack extracted sprite sets that are drawn together into atlas pages
+     *
+     * Every frame of the DC6 files under sprites/ui and sprites/items is
+     * decoded, trimmed and packed into outputPath/atlases/<set>.atlas and
+     * <set>_<page>.png, so a screen binds one set of pages instead of a
+     * texture per sprite. Frames are looked up in the .atlas map with
+     * TextureAtlas::frameName(). Colors come from the Act 1 palette,
+     * data/palette/act1/pal.dat, when it was extracted. Sets are baked one
+     * page at a time.
+     * @param outputPath Path extracted assets were saved to
+     * @return true unless a set failed to pack or save
+     */
+    bool bakeSpriteAtlases(const std::string& outputPath);
+    
+    /**
+     * Get the number of atlas sets baked
+     * @return Number of sets written by the last bakeSpriteAtlases() call
+     */
+    size_t getBakedAtlasCount() const { return bakedAtlasCount; }
+    
+    /**
+     * Precompile extracted Excel tables into their binary form
+     *
+     * Every .txt under data/excel is parsed once and written next to it as
+     * a .d2tbl file (see DataTableParser::writeBinary), so the game loads
+     * tables without parsing text. Tables whose .d2tbl was already built
+     * from the same text are skipped.
+     * @param outputPath Path extracted assets were saved to
+     * @return true unless a table failed to write
+     */
+    bool compileDataTables(const std::string& outputPath);
+    
+    /**
+     * Get the number of data tables compiled
+     * @return Number of .d2tbl files written by the last compileDataTables() call
+     */
+    size_t getCompiledDataTableCount() const { return compiledTableCount; }
+    
 private:
     size_t extractedCount = 0;
     size_t extractedAudioCount = 0;
     size_t extractedDataCount = 0;
     std::function<void(float, const std::string&)> progressCallback;
     ExtractionMonitor* extractionMonitor = nullptr;
+    int threadCount = 0;    // Default to one worker per core
+    bool atlasBaking = true;
+    int atlasPageSize = 2048;
+    size_t bakedAtlasCount = 0;
+    size_t compiledTableCount = 0;
     
     // Helper methods
     bool validateD2Path(const std::filesystem::path& path) const;
@@ -3,6 +3,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <cstdint>
 
 namespace d2 {
 
@@ -24,6 +25,7 @@ public:
         std::string checksum; // SHA-256 or similar checksum
         std::string type;     // Asset type (sprite, sound, data, etc.)
         int version;          // Version number for updates
+        int64_t modifiedTime = 0; // Last write time when the checksum was taken, 0 if unknown
     };
     
     AssetManifest() = default;
@@ -34,8 +36,12 @@ public:
      * @param path Relative path to the asset
      * @param size Size of the asset in bytes
      * @param checksum Checksum of the asset for validation
+     * @param modifiedTime Last write time of the file the checksum was taken
+     *        from, so unchanged files can be recognised without hashing
+     *        (0 = unknown, always hash)
      */
-    void addAsset(const std::string& path, size_t size, const std::string& checksum);
+    void addAsset(const std::string& path, size_t size, const std::string& checksum,
+                  int64_t modifiedTime = 0);
     
     /**
      * Save the manifest to a JSON file
@@ -73,6 +79,12 @@ public:
      */
     const AssetInfo* getAssetInfo(const std::string& path) const;
     
+    /**
+     * Get the paths of all assets
+     * @return Asset paths, in no particular order
+     */
+    std::vector<std::string> getAssetPaths() const;
+    
     /**
      * Get all assets of a specific type
      * @param type Asset type to filter by (e.g., "sprite", "sound")
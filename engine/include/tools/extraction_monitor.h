@@ -36,7 +36,8 @@ enum class ErrorType {
     INSUFFICIENT_SPACE,
     PERMISSION_DENIED,
     UNSUPPORTED_FORMAT,
-    NETWORK_ERROR
+    NETWORK_ERROR,
+    IO_ERROR
 };
 
 /**
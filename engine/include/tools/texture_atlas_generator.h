@@ -4,6 +4,8 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <cstdint>
+#include <cstddef>
 
 namespace d2 {
 
@@ -16,6 +18,14 @@ public:
         int page;           // Which texture page this sprite is on
         int x, y;          // Position within the page
         int width, height; // Dimensions of the sprite
+        
+        // Where the packed pixels sit in the original frame; DC6 frames are
+        // packed without their transparent borders
+        int sourceWidth = 0, sourceHeight = 0;
+        int trimX = 0, trimY = 0;
+        
+        // DC6 frame offsets, for placing the frame relative to its anchor
+        int offsetX = 0, offsetY = 0;
     };
     
     TextureAtlas() = default;
@@ -52,11 +62,65 @@ public:
         return (it != spriteMap.end()) ? &it->second : nullptr;
     }
     
+    /**
+     * Get the number of sprites in the atlas
+     * @return Number of sprite entries, one per packed frame
+     */
+    size_t getSpriteCount() const { return spriteMap.size(); }
+    
+    /**
+     * Get the dimensions of a texture page
+     * @param page Page index
+     * @return Page width or height in pixels, 0 for an invalid page
+     */
+    int getPageWidth(int page) const { return validPage(page) ? pages[page].width : 0; }
+    int getPageHeight(int page) const { return validPage(page) ? pages[page].height : 0; }
+    
+    /**
+     * Get the RGBA pixels of a texture page
+     * @param page Page index
+     * @return Page pixels, or nullptr if the page was loaded from a map file
+     */
+    const std::vector<uint8_t>* getPagePixels(int page) const {
+        return validPage(page) ? pages[page].pixels.get() : nullptr;
+    }
+    
+    /**
+     * Load an atlas map written by TextureAtlasGenerator::saveAtlas
+     *
+     * Only the map is read; the page images stay on disk.
+     * @param mapPath Path to the .atlas map file
+     * @return true if the map was loaded
+     */
+    bool loadFromFile(const std::string& mapPath);
+    
+    /**
+     * Get the atlas name of a sprite frame
+     *
+     * The first frame of the first direction uses the file name itself, so
+     * single-frame sprites are looked up by file name.
+     * @param spriteName File name of the sprite
+     * @param direction Direction index
+     * @param frame Frame index within the direction
+     * @return Name of the frame's atlas entry
+     */
+    static std::string frameName(const std::string& spriteName, int direction, int frame);
+    
 private:
     friend class TextureAtlasGenerator;
     
+    struct Page {
+        int width = 0;
+        int height = 0;
+        // Shared so copies of the atlas do not copy the pixels
+        std::shared_ptr<const std::vector<uint8_t>> pixels;
+    };
+    
+    bool validPage(int page) const { return page >= 0 && page < static_cast<int>(pages.size()); }
+    
     bool valid = false;
     int pageCount = 0;
+    std::vector<Page> pages;
     std::unordered_map<std::string, SpriteInfo> spriteMap;
 };
 
@@ -65,6 +129,11 @@ private:
  * 
  * This tool packs multiple sprites into texture atlas pages to reduce
  * draw calls and improve rendering performance on mobile devices.
+ * 
+ * Sprite sizes come from the files themselves: PNG headers, or every
+ * frame of a DC6 file trimmed to its visible bounds. Sprites are packed
+ * with several MaxRects and skyline heuristics in parallel, and the
+ * trial that needs the fewest pages and the least page area wins.
  */
 class TextureAtlasGenerator {
 public:
@@ -83,12 +152,32 @@ public:
     
     /**
      * Save the generated atlas to disk
+     *
+     * Writes the binary map to outputPath + ".atlas" and each page to
+     * outputPath + "_<page>.png".
      * @param atlas The atlas to save
      * @param outputPath Base path for output files (pages will be numbered)
      * @return true if save succeeded
      */
     bool saveAtlas(const TextureAtlas& atlas, const std::string& outputPath);
     
+    /**
+     * Generate an atlas and save it one page at a time
+     *
+     * Writes the same files as generateAtlas followed by saveAtlas, but
+     * holds only the page being drawn: sprites are measured first, and a
+     * frame is decoded only while its page is composed.
+     * @param sprites List of sprite file paths
+     * @param maxWidth Maximum width of each atlas page
+     * @param maxHeight Maximum height of each atlas page
+     * @param outputPath Base path for output files, as for saveAtlas
+     * @param atlas Receives the atlas map; its pages hold no pixels, and it
+     *        is invalid if no sprite could be packed
+     * @return false if a file could not be written
+     */
+    bool bakeAtlas(const std::vector<std::string>& sprites, int maxWidth, int maxHeight,
+                   const std::string& outputPath, TextureAtlas& atlas);
+    
     /**
      * Set padding between sprites in the atlas
      * @param padding Padding in pixels
@@ -101,12 +190,25 @@ public:
      */
     void setPowerOfTwo(bool enable) { powerOfTwo = enable; }
     
+    /**
+     * Set the palette DC6 sprites are expanded with
+     * @param palette 256 colors, each stored as R | G << 8 | B << 16 | A << 24
+     */
+    void setPalette(const std::vector<uint32_t>& palette);
+    
+    /**
+     * Set the number of threads used to load sprites and run packing trials
+     * @param threads Thread count; 0 uses every hardware thread
+     */
+    void setThreadCount(int threads) { threadCount = threads; }
+    
 private:
     struct Impl;
     std::unique_ptr<Impl> pImpl;
     
     int padding = 2;        // Default 2 pixel padding between sprites
     bool powerOfTwo = true; // Default to power-of-two textures for compatibility
+    int threadCount = 0;    // Default to one thread per core
 };
 
 } // namespace d2
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace d2::utils {
+
+/**
+ * Fast non-cryptographic content hashing (XXH64)
+ *
+ * Used to tell whether extracted assets and archives changed. Files are
+ * hashed through a read-only mapping, and batches of files are spread
+ * across threads.
+ */
+class ContentHash {
+public:
+    /**
+     * Hash a memory buffer
+     * @param data The bytes to hash (may be nullptr when size is 0)
+     * @param size Number of bytes
+     * @param seed Hash seed
+     * @return The XXH64 hash of the bytes
+     */
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 0);
+
+    /**
+     * Hash a file's contents
+     * @param path Path to the file
+     * @param result Receives the hash
+     * @return true if successful, false if the file could not be read
+     */
+    static bool hashFile(const std::string& path, uint64_t& result);
+
+    /**
+     * Hash several files in parallel
+     * @param paths Paths to the files
+     * @param threads Number of worker threads (0 = every hardware thread)
+     * @return The formatted hash of each file, in the order of paths; empty
+     *         for files that could not be read
+     */
+    static std::vector<std::string> hashFiles(const std::vector<std::string>& paths, int threads = 0);
+
+    /**
+     * Format a hash as 16 lowercase hex digits
+     */
+    static std::string toHex(uint64_t hash);
+};
+
+} // namespace d2::utils
@@ -1,18 +1,26 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <cstdint>
+#include <cstddef>
 
 namespace d2::utils {
 
 // Forward declaration
 class DataTable;
 
+/**
+ * Current version of the precompiled (.d2tbl) data table format
+ */
+constexpr uint32_t kDataTableBinaryVersion = 1;
+
 /**
  * Parser for Diablo II's tab-delimited data tables (Excel files)
- * 
+ *
  * Diablo II uses tab-delimited text files for game data like items,
  * monsters, skills, etc. This parser converts these files into
  * easily queryable data structures.
@@ -29,20 +37,126 @@ public:
      */
     DataTable parseExcel(const std::string& data);
     
+    /**
+     * Parse a tab-delimited data table from a memory buffer
+     * @param data The raw text data to parse; not kept after parsing
+     * @param size Size of the data in bytes
+     * @return A DataTable object containing the parsed data
+     */
+    DataTable parseExcel(const char* data, size_t size);
+
     /**
      * Parse a data table from a file
+     *
+     * A precompiled copy next to the file (see getBinaryPath) is loaded
+     * instead when it was built from the same text.
      * @param filename Path to the file to parse
      * @return A DataTable object containing the parsed data
      */
     DataTable parseExcelFile(const std::string& filename);
+
+    /**
+     * Write a table in the precompiled binary form
+     *
+     * Layout (little endian, every section 16-byte aligned):
+     *   header | column schema | column names | string pool offsets |
+     *   string pool | numeric text ids | typed column blobs
+     * Loading copies the blobs back without parsing any text.
+     * @param table The parsed table
+     * @param sourceHash hashSource() of the text the table was parsed from
+     * @param filename Destination file
+     * @return true if successful, false otherwise
+     */
+    bool writeBinary(const DataTable& table, uint64_t sourceHash, const std::string& filename);
+
+    /**
+     * Load a precompiled table from a memory buffer
+     * @param data The binary data
+     * @param size Size of the data in bytes
+     * @param table Receives the table
+     * @param sourceHash Expected hash of the source text (0 = do not check)
+     * @return false if the data is not a valid table of this version or was
+     *         built from other text
+     */
+    bool loadBinary(const uint8_t* data, size_t size, DataTable& table, uint64_t sourceHash = 0);
+
+    /**
+     * Load a precompiled table from a file with a single mapping
+     * @param filename Path to the .d2tbl file
+     * @param table Receives the table
+     * @param sourceHash Expected hash of the source text (0 = do not check)
+     * @return true if successful, false otherwise
+     */
+    bool loadBinaryFile(const std::string& filename, DataTable& table, uint64_t sourceHash = 0);
+
+    /**
+     * Hash of a table's source text, stored in its precompiled form
+     */
+    static uint64_t hashSource(const char* data, size_t size);
+
+    /**
+     * Get the path of the precompiled copy of a text table
+     * @param textPath Path to the .txt file
+     * @return The same path with a .d2tbl extension
+     */
+    static std::string getBinaryPath(const std::string& textPath);
 };
 
 /**
  * Represents a parsed data table
+ *
+ * Values are stored column by column. Cell text is interned in a string
+ * pool shared by the whole table, and columns whose cells are all numbers
+ * keep the parsed values, so typed reads do not parse text. getString
+ * always returns a cell's exact text. Resolve
+ * a column name once with getColumn() and read cells through the handle.
+ *
+ * The Row interface copies a row into a map and is kept for callers that
+ * read a handful of values.
  */
 class DataTable {
 public:
     using Row = std::unordered_map<std::string, std::string>;
+
+    /**
+     * Storage type of a column, chosen from its values at parse time
+     */
+    enum class ColumnType {
+        INT,    // Every non-empty cell is an integer
+        FLOAT,  // Every non-empty cell is a number, some with fractions
+        STRING
+    };
+
+    /**
+     * A column resolved by name; invalid if the name was not found
+     */
+    struct Column {
+        static constexpr size_t kInvalidIndex = static_cast<size_t>(-1);
+        size_t index = kInvalidIndex;
+
+        bool isValid() const { return index != kInvalidIndex; }
+    };
+
+    /**
+     * Returned by findRowIndex when no row matches
+     */
+    static constexpr size_t kNoRow = static_cast<size_t>(-1);
+
+    /**
+     * Indices of the rows matching a lookup, in ascending order
+     *
+     * Points into the column's index, so it stays valid while the table does.
+     */
+    struct RowRange {
+        const uint32_t* first = nullptr;
+        const uint32_t* last = nullptr;
+
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+        size_t operator[](size_t i) const { return first[i]; }
+    };
     
     DataTable() = default;
     ~DataTable() = default;
@@ -50,7 +164,12 @@ public:
     /**
      * Get the number of rows in the table
      */
-    size_t getRowCount() const { return rows_.size(); }
+    size_t getRowCount() const { return rowCount_; }
+
+    /**
+     * Get the number of columns in the table
+     */
+    size_t getColumnCount() const { return columns_.size(); }
     
     /**
      * Check if a column exists
@@ -58,7 +177,76 @@ public:
     bool hasColumn(const std::string& columnName) const;
     
     /**
-     * Find a row by column value
+     * Resolve a column name
+     * @param columnName The column name; the first column of that name is used
+     * @return Column handle, invalid if the table has no such column
+     */
+    Column getColumn(const std::string& columnName) const;
+
+    /**
+     * Get the name of a column
+     */
+    const std::string& getColumnName(Column column) const { return columns_[column.index].name; }
+
+    /**
+     * Get the storage type of a column
+     */
+    ColumnType getColumnType(Column column) const { return columns_[column.index].type; }
+
+    /**
+     * Get a cell as an integer
+     * @return The value, or 0 if the column is invalid or the cell is not a number
+     */
+    int getInt(size_t row, Column column) const;
+
+    /**
+     * Get a cell as a float
+     * @return The value, or 0.0f if the column is invalid or the cell is not a number
+     */
+    float getFloat(size_t row, Column column) const;
+
+    /**
+     * Get a cell's text
+     * @return The text, valid while the table is alive; empty if the column is invalid
+     */
+    std::string_view getString(size_t row, Column column) const;
+
+    /**
+     * Find the first row whose cell in a column has the given text
+     *
+     * The first lookup on a column builds a hash index of it; later
+     * lookups take constant time.
+     * @return Row index, or kNoRow if no row matches
+     */
+    size_t findRowIndex(Column column, std::string_view value) const;
+
+    /**
+     * Find every row whose cell in a column has the given text
+     * @return Matching row indices, empty if none match
+     */
+    RowRange findRows(Column column, std::string_view value) const;
+
+    /**
+     * Check whether every cell of a column has a different text
+     * @return True if lookups on the column match at most one row
+     */
+    bool isUniqueColumn(Column column) const;
+
+    /**
+     * Build a column's lookup index now instead of on its first lookup
+     *
+     * Useful for columns looked up from several threads or in frame time.
+     */
+    void buildIndex(Column column) const;
+
+    /**
+     * Get the approximate heap memory held by the table
+     * @return Bytes used by columns, the string pool and built indexes
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Find a row by column value, through the column's index
      * @param columnName The column to search in
      * @param value The value to search for
      * @return The first matching row, or empty row if not found
@@ -66,14 +254,14 @@ public:
     Row findRow(const std::string& columnName, const std::string& value) const;
     
     /**
-     * Get all rows
+     * Get all rows, copied into maps
      */
-    const std::vector<Row>& getAllRows() const { return rows_; }
+    std::vector<Row> getAllRows() const;
     
     /**
-     * Get a row by index
+     * Get a row by index, copied into a map
      */
-    const Row& getRow(size_t index) const { return rows_[index]; }
+    Row getRow(size_t index) const;
     
     /**
      * Get an integer value from a row
@@ -95,8 +283,40 @@ public:
     friend class DataTableParser;
     
 private:
-    std::vector<std::string> columns_;
-    std::vector<Row> rows_;
+    struct ColumnData {
+        std::string name;
+        ColumnType type = ColumnType::STRING;
+        std::vector<uint32_t> strings;  // String pool id of every cell; empty for
+                                        // numeric columns whose text follows from the values
+        std::vector<int32_t> ints;      // INT columns only
+        std::vector<float> floats;      // FLOAT columns only
+        std::vector<bool> blanks;       // Blank cells, when strings was dropped
+    };
+
+    std::string_view pooledString(uint32_t id) const {
+        return std::string_view(pool_.data() + poolOffsets_[id], poolOffsets_[id + 1] - poolOffsets_[id]);
+    }
+
+    struct ColumnIndex;
+    struct IndexCache;
+
+    std::string_view cellString(const ColumnData& data, size_t row) const;
+    const ColumnIndex* columnIndex(Column column) const;
+
+    std::vector<ColumnData> columns_;
+    size_t rowCount_ = 0;
+
+    // Interned cell text: string id i spans [poolOffsets_[i], poolOffsets_[i + 1])
+    std::string pool_;
+    std::vector<uint32_t> poolOffsets_;
+
+    // Pool id of the text of each numeric value, for columns without string ids
+    std::unordered_map<int32_t, uint32_t> intText_;
+    std::unordered_map<uint32_t, uint32_t> floatText_;  // Keyed by the float's bits
+
+    // Lookup indexes, built per column on first use. Tables never change
+    // after parsing, so copies share them.
+    std::shared_ptr<IndexCache> indexes_;
 };
 
-} // namespace d2::utils
\ No newline at end of file
+} // namespace d2::utils
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace d2portable {
+namespace utils {
+
+/**
+ * Read-only memory mapping of a whole file
+ * 
+ * The mapped bytes stay valid until close() or destruction. Moving
+ * transfers ownership of the mapping.
+ */
+class MemoryMappedFile {
+public:
+    MemoryMappedFile() = default;
+    ~MemoryMappedFile();
+
+    // Disable copy operations
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    // Enable move operations
+    MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+    MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+    /**
+     * Maps a file read-only, replacing any current mapping
+     * @param filepath Path to the file
+     * @return true if successful, false otherwise (empty files cannot be mapped)
+     */
+    bool open(const std::string& filepath);
+
+    /**
+     * Unmaps the file
+     */
+    void close();
+
+    /**
+     * Checks if a file is currently mapped
+     */
+    bool isOpen() const { return data_ != nullptr; }
+
+    /**
+     * Gets the start of the mapping, or nullptr if nothing is mapped
+     */
+    const uint8_t* data() const { return data_; }
+
+    /**
+     * Gets the size of the mapping in bytes
+     */
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+} // namespace utils
+} // namespace d2portable
@@ -93,6 +93,17 @@ uint32_t getBinaryModeLength(PKWAREWork& work);
  */
 uint32_t getASCIIModeLength(PKWAREWork& work, const HuffmanTable& litcode, bool& is_literal);
 
+/**
+ * @brief Bit-at-a-time decoder PKWAREExplode is validated against
+ * @param compressed_data Input compressed data
+ * @param output Output buffer for decompressed data
+ * @param expected_size Expected size of decompressed data
+ * @return true if decompression produced any output
+ */
+bool explodeReference(const std::vector<uint8_t>& compressed_data,
+                      std::vector<uint8_t>& output,
+                      size_t expected_size);
+
 } // namespace pkware_internal
 } // namespace utils
 } // namespace d2portable
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <vector>
 #include <memory>
 #include <optional>
+#include <cstdint>
+#include <cstddef>
 
 namespace d2portable {
 namespace utils {
@@ -18,11 +20,32 @@ struct StormMPQFileInfo {
     uint32_t flags;
 };
 
+/**
+ * How archive contents are read
+ */
+enum class MPQAccessMode {
+    BUFFERED,       // StormLib buffered file I/O
+    MEMORY_MAPPED   // Sectors are read straight from a read-only mapping of the archive
+};
+
+/**
+ * Zero-copy view of a file stored uncompressed in a memory-mapped archive.
+ * Valid until the archive is closed.
+ */
+struct MPQFileView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
 /**
  * StormLib-based MPQ archive loader
  * 
  * This class provides a wrapper around StormLib for loading and extracting
  * files from MPQ archives, specifically for Diablo II game assets.
+ *
+ * Once open, the query and extraction methods may be called from several
+ * threads at once: each call borrows its own StormLib archive handle from an
+ * internal pool. open(), close() and moves must not race with other calls.
  */
 class StormLibMPQLoader {
 public:
@@ -40,9 +63,11 @@ public:
     /**
      * Opens an MPQ archive
      * @param filepath Path to the MPQ file
+     * @param mode MEMORY_MAPPED serves unencrypted files from a mapping of the
+     *             archive and falls back to buffered reads for everything else
      * @return true if successful, false otherwise
      */
-    bool open(const std::string& filepath);
+    bool open(const std::string& filepath, MPQAccessMode mode = MPQAccessMode::BUFFERED);
 
     /**
      * Closes the current MPQ archive
@@ -55,6 +80,12 @@ public:
      */
     bool isOpen() const;
 
+    /**
+     * Checks if the open archive is served from a memory mapping
+     * @return true if memory mapped, false otherwise
+     */
+    bool isMemoryMapped() const;
+
     /**
      * Lists all files in the MPQ archive
      * @return Vector of file information structures
@@ -76,6 +107,25 @@ public:
      */
     bool extractFile(const std::string& filename, std::vector<uint8_t>& output);
 
+    /**
+     * Extracts a file into a caller-provided buffer without allocating
+     * @param filename Name of the file to extract
+     * @param buffer Destination buffer
+     * @param capacity Size of the destination buffer in bytes
+     * @param bytesWritten Receives the file size; when the buffer is too
+     *                     small this is the capacity required
+     * @return true if extraction successful, false otherwise
+     */
+    bool extractFile(const std::string& filename, uint8_t* buffer, size_t capacity, size_t& bytesWritten);
+
+    /**
+     * Gets a zero-copy view of a file stored without compression or encryption
+     * @param filename Name of the file
+     * @param view Receives the file's bytes inside the archive mapping
+     * @return true if the archive is memory mapped and the file is stored raw
+     */
+    bool getFileView(const std::string& filename, MPQFileView& view) const;
+
     /**
      * Gets information about a specific file
      * @param filename Name of the file
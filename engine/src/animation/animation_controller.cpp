@@ -1,6 +1,7 @@
 #include "animation/animation_controller.h"
 #include "sprites/dc6_parser.h"
 #include <algorithm>
+#include <stdexcept>
 
 namespace d2::animation {
 
@@ -86,6 +87,14 @@ const d2portable::sprites::DC6Frame* AnimationController::getCurrentSpriteFrame(
     return nullptr;
 }
 
+d2portable::sprites::DC6FrameView AnimationController::getCurrentFrameView() const {
+    if (!sprite_) {
+        return d2portable::sprites::DC6FrameView{};
+    }
+    return sprite_->getFrameView(static_cast<uint32_t>(currentDirection_),
+                                 static_cast<uint32_t>(currentFrame_));
+}
+
 int AnimationController::getTotalFrames() const {
     if (!sprite_) {
         return 0;
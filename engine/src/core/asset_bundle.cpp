@@ -0,0 +1,456 @@
+#include "core/asset_bundle.h"
+#include "utils/memory_mapped_file.h"
+#include "sprites/palette_expand.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+namespace d2portable {
+namespace core {
+
+namespace {
+
+constexpr char kBundleMagic[4] = {'D', '2', 'P', 'K'};
+constexpr uint64_t kSectionAlignment = 16;
+
+// On-disk structures. Offsets are absolute file offsets.
+struct BundleHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t frame_count;
+    uint64_t entry_table_offset;
+    uint64_t frame_table_offset;
+    uint64_t path_pool_offset;
+    uint64_t file_size;
+};
+static_assert(sizeof(BundleHeader) == 48, "BundleHeader layout changed");
+
+// Sorted by (path_hash, path) so lookups are a binary search
+struct BundleEntry {
+    uint64_t path_hash;
+    uint32_t path_offset;   // Relative to the path pool
+    uint32_t path_length;
+    uint32_t first_frame;   // Index into the frame table
+    uint32_t directions;
+    uint32_t frames_per_direction;
+    uint32_t reserved;
+};
+static_assert(sizeof(BundleEntry) == 32, "BundleEntry layout changed");
+
+// Frames of a sprite are stored direction-major, like DC6
+struct BundleFrame {
+    uint32_t width;
+    uint32_t height;
+    int32_t offset_x;
+    int32_t offset_y;
+    uint64_t pixel_offset;  // width * height palette indices
+};
+static_assert(sizeof(BundleFrame) == 24, "BundleFrame layout changed");
+
+// Asset paths are matched the way MPQ names are: case-insensitive, backslash separated
+std::string normalizePath(const std::string& path) {
+    std::string normalized = path;
+    for (char& c : normalized) {
+        c = (c == '/') ? '\\' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return normalized;
+}
+
+// FNV-1a
+uint64_t hashPath(const std::string& normalized) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : normalized) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+// Sprite whose frames live in a mapped bundle
+class BundleSprite : public sprites::DC6Sprite {
+public:
+    BundleSprite(std::shared_ptr<const utils::MemoryMappedFile> mapping, const BundleFrame* frames,
+                 uint32_t directions, uint32_t frames_per_direction)
+        : mapping(std::move(mapping)), frames(frames),
+          directions(directions), frames_per_direction(frames_per_direction) {}
+
+    uint32_t getDirectionCount() const override {
+        return directions;
+    }
+
+    uint32_t getFramesPerDirection() const override {
+        return frames_per_direction;
+    }
+
+    sprites::DC6Frame getFrame(uint32_t direction, uint32_t frame) const override {
+        const BundleFrame* bundle_frame = find(direction, frame);
+        if (!bundle_frame) {
+            return sprites::DC6Frame{};
+        }
+
+        sprites::DC6Frame dc6_frame;
+        dc6_frame.width = bundle_frame->width;
+        dc6_frame.height = bundle_frame->height;
+        dc6_frame.offsetX = bundle_frame->offset_x;
+        dc6_frame.offsetY = bundle_frame->offset_y;
+        const uint8_t* pixels = pixelsOf(*bundle_frame);
+        dc6_frame.pixelData.assign(pixels, pixels + pixelCount(*bundle_frame));
+        return dc6_frame;
+    }
+
+    // Points straight into the mapping, which the view keeps alive
+    sprites::DC6FrameView getFrameView(uint32_t direction, uint32_t frame) const override {
+        sprites::DC6FrameView view;
+        const BundleFrame* bundle_frame = find(direction, frame);
+        if (!bundle_frame) {
+            return view;
+        }
+
+        view.width = bundle_frame->width;
+        view.height = bundle_frame->height;
+        view.offsetX = bundle_frame->offset_x;
+        view.offsetY = bundle_frame->offset_y;
+        view.pixels = pixelsOf(*bundle_frame);
+        view.pixelCount = pixelCount(*bundle_frame);
+        view.owner = mapping;
+        return view;
+    }
+
+    std::vector<uint8_t> getFrameImage(uint32_t direction, uint32_t frame) const override {
+        // Grayscale, matching DC6Sprite without a palette
+        return expandToRGBA(direction, frame, sprites::getGrayscalePalette());
+    }
+
+    std::vector<uint8_t> getFrameImageWithPalette(uint32_t direction, uint32_t frame,
+                                                  const std::vector<uint32_t>& palette) const override {
+        if (palette.size() != 256) {
+            return getFrameImage(direction, frame);
+        }
+        return expandToRGBA(direction, frame, palette.data());
+    }
+
+private:
+    // Empty frames are reported as missing, like an unset DC6 frame
+    const BundleFrame* find(uint32_t direction, uint32_t frame) const {
+        if (direction >= directions || frame >= frames_per_direction) {
+            return nullptr;
+        }
+        const BundleFrame* bundle_frame = &frames[direction * frames_per_direction + frame];
+        return pixelCount(*bundle_frame) > 0 ? bundle_frame : nullptr;
+    }
+
+    std::vector<uint8_t> expandToRGBA(uint32_t direction, uint32_t frame, const uint32_t* palette) const {
+        std::vector<uint8_t> rgba_data;
+        const BundleFrame* bundle_frame = find(direction, frame);
+        if (!bundle_frame) {
+            return rgba_data;
+        }
+
+        rgba_data.resize(pixelCount(*bundle_frame) * 4);
+        sprites::expandPalette(pixelsOf(*bundle_frame), pixelCount(*bundle_frame), palette, rgba_data.data());
+        return rgba_data;
+    }
+
+    static size_t pixelCount(const BundleFrame& frame) {
+        return static_cast<size_t>(frame.width) * frame.height;
+    }
+
+    const uint8_t* pixelsOf(const BundleFrame& frame) const {
+        return mapping->data() + frame.pixel_offset;
+    }
+
+    std::shared_ptr<const utils::MemoryMappedFile> mapping;
+    const BundleFrame* frames;
+    uint32_t directions;
+    uint32_t frames_per_direction;
+};
+
+} // namespace
+
+// AssetBundleWriter
+
+class AssetBundleWriter::Impl {
+public:
+    struct PendingSprite {
+        std::string path;
+        uint64_t hash;
+        std::shared_ptr<sprites::DC6Sprite> sprite;
+    };
+
+    std::vector<PendingSprite> sprites;
+    std::unordered_set<std::string> paths;
+    std::string last_error;
+};
+
+AssetBundleWriter::AssetBundleWriter() : pImpl(std::make_unique<Impl>()) {}
+
+AssetBundleWriter::~AssetBundleWriter() = default;
+
+bool AssetBundleWriter::addSprite(const std::string& relative_path, std::shared_ptr<sprites::DC6Sprite> sprite) {
+    if (!sprite) {
+        pImpl->last_error = "Null sprite: " + relative_path;
+        return false;
+    }
+
+    std::string path = normalizePath(relative_path);
+    if (!pImpl->paths.insert(path).second) {
+        pImpl->last_error = "Duplicate sprite path: " + relative_path;
+        return false;
+    }
+
+    uint64_t hash = hashPath(path);
+    pImpl->sprites.push_back({std::move(path), hash, std::move(sprite)});
+    return true;
+}
+
+size_t AssetBundleWriter::getSpriteCount() const {
+    return pImpl->sprites.size();
+}
+
+bool AssetBundleWriter::write(const std::string& output_path) {
+    auto& sprites = pImpl->sprites;
+    std::sort(sprites.begin(), sprites.end(), [](const Impl::PendingSprite& a, const Impl::PendingSprite& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.path < b.path;
+    });
+
+    // Lay out the tables, then place each frame's pixels after them
+    std::vector<BundleEntry> entries;
+    std::vector<BundleFrame> frames;
+    std::string path_pool;
+    entries.reserve(sprites.size());
+
+    for (const auto& pending : sprites) {
+        BundleEntry entry{};
+        entry.path_hash = pending.hash;
+        entry.path_offset = static_cast<uint32_t>(path_pool.size());
+        entry.path_length = static_cast<uint32_t>(pending.path.size());
+        entry.first_frame = static_cast<uint32_t>(frames.size());
+        entry.directions = pending.sprite->getDirectionCount();
+        entry.frames_per_direction = pending.sprite->getFramesPerDirection();
+        path_pool += pending.path;
+
+        for (uint32_t dir = 0; dir < entry.directions; dir++) {
+            for (uint32_t frame = 0; frame < entry.frames_per_direction; frame++) {
+                auto dc6_frame = pending.sprite->getFrameView(dir, frame);
+                BundleFrame bundle_frame{};
+                // A frame without pixels is stored empty
+                if (!dc6_frame.empty()) {
+                    bundle_frame.width = dc6_frame.width;
+                    bundle_frame.height = dc6_frame.height;
+                }
+                bundle_frame.offset_x = dc6_frame.offsetX;
+                bundle_frame.offset_y = dc6_frame.offsetY;
+                frames.push_back(bundle_frame);
+            }
+        }
+        entries.push_back(entry);
+    }
+
+    BundleHeader header{};
+    std::memcpy(header.magic, kBundleMagic, sizeof(kBundleMagic));
+    header.version = kAssetBundleVersion;
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    header.frame_count = static_cast<uint32_t>(frames.size());
+    header.entry_table_offset = alignUp(sizeof(BundleHeader));
+    header.frame_table_offset = alignUp(header.entry_table_offset + entries.size() * sizeof(BundleEntry));
+    header.path_pool_offset = alignUp(header.frame_table_offset + frames.size() * sizeof(BundleFrame));
+
+    uint64_t pixel_end = alignUp(header.path_pool_offset + path_pool.size());
+    for (auto& frame : frames) {
+        frame.pixel_offset = pixel_end;
+        pixel_end = alignUp(pixel_end + static_cast<uint64_t>(frame.width) * frame.height);
+    }
+    header.file_size = pixel_end;
+
+    std::ofstream out(output_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        pImpl->last_error = "Failed to create bundle: " + output_path;
+        return false;
+    }
+
+    uint64_t position = 0;
+    auto writeBytes = [&](const void* data, size_t size) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position += size;
+    };
+    auto padTo = [&](uint64_t offset) {
+        static const char zeros[kSectionAlignment] = {};
+        while (position < offset) {
+            writeBytes(zeros, static_cast<size_t>(std::min<uint64_t>(offset - position, sizeof(zeros))));
+        }
+    };
+
+    writeBytes(&header, sizeof(header));
+    padTo(header.entry_table_offset);
+    writeBytes(entries.data(), entries.size() * sizeof(BundleEntry));
+    padTo(header.frame_table_offset);
+    writeBytes(frames.data(), frames.size() * sizeof(BundleFrame));
+    padTo(header.path_pool_offset);
+    writeBytes(path_pool.data(), path_pool.size());
+
+    size_t frame_index = 0;
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const auto& sprite = sprites[i].sprite;
+        for (uint32_t dir = 0; dir < entries[i].directions; dir++) {
+            for (uint32_t frame = 0; frame < entries[i].frames_per_direction; frame++) {
+                const BundleFrame& bundle_frame = frames[frame_index++];
+                size_t count = static_cast<size_t>(bundle_frame.width) * bundle_frame.height;
+                if (count == 0) {
+                    continue;
+                }
+
+                // DC6 decoding pads short frames; keep the blob exactly width * height
+                auto pixels = sprite->getFrameView(dir, frame);
+                size_t stored = std::min(count, pixels.pixelCount);
+                padTo(bundle_frame.pixel_offset);
+                writeBytes(pixels.pixels, stored);
+                padTo(bundle_frame.pixel_offset + count);
+            }
+        }
+    }
+    padTo(header.file_size);
+
+    if (!out.good()) {
+        pImpl->last_error = "Failed to write bundle: " + output_path;
+        return false;
+    }
+    return true;
+}
+
+std::string AssetBundleWriter::getLastError() const {
+    return pImpl->last_error;
+}
+
+// AssetBundle
+
+class AssetBundle::Impl {
+public:
+    std::shared_ptr<utils::MemoryMappedFile> mapping;
+    const BundleHeader* header = nullptr;
+    const BundleEntry* entries = nullptr;
+    const BundleFrame* frames = nullptr;
+    const char* path_pool = nullptr;
+    uint64_t path_pool_size = 0;
+    std::string last_error;
+
+    bool fail(const std::string& message) {
+        last_error = message;
+        mapping.reset();
+        header = nullptr;
+        return false;
+    }
+
+    const BundleEntry* find(const std::string& relative_path) const {
+        if (!header) {
+            return nullptr;
+        }
+
+        std::string path = normalizePath(relative_path);
+        uint64_t hash = hashPath(path);
+        const BundleEntry* end = entries + header->entry_count;
+        const BundleEntry* it = std::lower_bound(entries, end, hash,
+            [](const BundleEntry& entry, uint64_t value) { return entry.path_hash < value; });
+
+        for (; it != end && it->path_hash == hash; ++it) {
+            if (static_cast<uint64_t>(it->path_offset) + it->path_length <= path_pool_size &&
+                path.compare(0, std::string::npos, path_pool + it->path_offset, it->path_length) == 0) {
+                return it;
+            }
+        }
+        return nullptr;
+    }
+};
+
+AssetBundle::AssetBundle() : pImpl(std::make_unique<Impl>()) {}
+
+AssetBundle::~AssetBundle() = default;
+
+bool AssetBundle::open(const std::string& bundle_path) {
+    pImpl->mapping = std::make_shared<utils::MemoryMappedFile>();
+    pImpl->header = nullptr;
+    if (!pImpl->mapping->open(bundle_path)) {
+        return pImpl->fail("Failed to map bundle: " + bundle_path);
+    }
+
+    const uint8_t* base = pImpl->mapping->data();
+    uint64_t size = pImpl->mapping->size();
+    if (size < sizeof(BundleHeader)) {
+        return pImpl->fail("Bundle too small: " + bundle_path);
+    }
+
+    const auto* header = reinterpret_cast<const BundleHeader*>(base);
+    if (std::memcmp(header->magic, kBundleMagic, sizeof(kBundleMagic)) != 0) {
+        return pImpl->fail("Not a d2pak bundle: " + bundle_path);
+    }
+    if (header->version != kAssetBundleVersion) {
+        return pImpl->fail("Unsupported bundle version " + std::to_string(header->version) + ": " + bundle_path);
+    }
+    if (header->file_size != size) {
+        return pImpl->fail("Truncated bundle: " + bundle_path);
+    }
+
+    // Tables must be aligned and inside the file before they are dereferenced
+    uint64_t entry_end = header->entry_table_offset + static_cast<uint64_t>(header->entry_count) * sizeof(BundleEntry);
+    uint64_t frame_end = header->frame_table_offset + static_cast<uint64_t>(header->frame_count) * sizeof(BundleFrame);
+    if (header->entry_table_offset % kSectionAlignment || header->frame_table_offset % kSectionAlignment ||
+        entry_end > size || frame_end > size || header->path_pool_offset > size) {
+        return pImpl->fail("Corrupt bundle tables: " + bundle_path);
+    }
+
+    pImpl->header = header;
+    pImpl->entries = reinterpret_cast<const BundleEntry*>(base + header->entry_table_offset);
+    pImpl->frames = reinterpret_cast<const BundleFrame*>(base + header->frame_table_offset);
+    pImpl->path_pool = reinterpret_cast<const char*>(base + header->path_pool_offset);
+    pImpl->path_pool_size = size - header->path_pool_offset;
+    pImpl->last_error.clear();
+    return true;
+}
+
+bool AssetBundle::isOpen() const {
+    return pImpl->header != nullptr;
+}
+
+bool AssetBundle::contains(const std::string& relative_path) const {
+    return pImpl->find(relative_path) != nullptr;
+}
+
+std::shared_ptr<sprites::DC6Sprite> AssetBundle::loadSprite(const std::string& relative_path) const {
+    const BundleEntry* entry = pImpl->find(relative_path);
+    if (!entry) {
+        return nullptr;
+    }
+
+    // Frame data is only validated for the sprites actually used
+    uint64_t frame_count = static_cast<uint64_t>(entry->directions) * entry->frames_per_direction;
+    if (entry->first_frame + frame_count > pImpl->header->frame_count) {
+        return nullptr;
+    }
+    const BundleFrame* frames = pImpl->frames + entry->first_frame;
+    for (uint64_t i = 0; i < frame_count; i++) {
+        uint64_t pixels = static_cast<uint64_t>(frames[i].width) * frames[i].height;
+        if (frames[i].pixel_offset > pImpl->mapping->size() ||
+            pixels > pImpl->mapping->size() - frames[i].pixel_offset) {
+            return nullptr;
+        }
+    }
+
+    return std::make_shared<BundleSprite>(pImpl->mapping, frames, entry->directions, entry->frames_per_direction);
+}
+
+size_t AssetBundle::getSpriteCount() const {
+    return pImpl->header ? pImpl->header->entry_count : 0;
+}
+
+std::string AssetBundle::getLastError() const {
+    return pImpl->last_error;
+}
+
+} // namespace core
+} // namespace d2portable
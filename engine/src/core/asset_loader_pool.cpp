@@ -0,0 +1,209 @@
+#include "core/asset_loader_pool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace d2portable {
+namespace core {
+
+namespace {
+
+// Pending or running load shared by every caller that asked for the path
+struct LoadJob {
+    LoadPriority priority;
+    uint64_t sequence;
+    bool running = false;
+    std::vector<std::promise<AssetLoaderPool::SpritePtr>> waiters;
+};
+
+// Queue order: priority first, then submission order
+using QueueKey = std::tuple<int, uint64_t, std::string>;
+
+size_t defaultWorkerCount() {
+    size_t cores = std::thread::hardware_concurrency();
+    // Leave one core for the game thread; cap so loads cannot swamp a phone
+    return std::clamp<size_t>(cores > 1 ? cores - 1 : 1, 1, 4);
+}
+
+} // namespace
+
+class AssetLoaderPool::Impl {
+public:
+    LoadFunction load_function;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_available;
+    std::unordered_map<std::string, LoadJob> jobs;
+    std::set<QueueKey> queue;
+    uint64_t next_sequence = 0;
+    bool stopping = false;
+
+    static QueueKey queueKey(const std::string& path, const LoadJob& job) {
+        return QueueKey(static_cast<int>(job.priority), job.sequence, path);
+    }
+
+    static void resolve(std::vector<std::promise<SpritePtr>>& waiters, const SpritePtr& sprite) {
+        for (auto& waiter : waiters) {
+            waiter.set_value(sprite);
+        }
+    }
+
+    void workerLoop() {
+        while (true) {
+            std::string path;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_available.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (stopping) {
+                    return;
+                }
+                path = std::get<2>(*queue.begin());
+                queue.erase(queue.begin());
+                jobs[path].running = true;
+            }
+
+            SpritePtr sprite;
+            std::exception_ptr error;
+            try {
+                sprite = load_function(path);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::vector<std::promise<SpritePtr>> waiters;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = jobs.find(path);
+                waiters = std::move(it->second.waiters);
+                jobs.erase(it);
+            }
+
+            if (error) {
+                for (auto& waiter : waiters) {
+                    waiter.set_exception(error);
+                }
+            } else {
+                resolve(waiters, sprite);
+            }
+        }
+    }
+};
+
+AssetLoaderPool::AssetLoaderPool(LoadFunction load_function, size_t worker_count)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->load_function = std::move(load_function);
+
+    if (worker_count == 0) {
+        worker_count = defaultWorkerCount();
+    }
+    for (size_t i = 0; i < worker_count; i++) {
+        pImpl->workers.emplace_back([this]() { pImpl->workerLoop(); });
+    }
+}
+
+AssetLoaderPool::~AssetLoaderPool() {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        pImpl->stopping = true;
+    }
+    pImpl->work_available.notify_all();
+
+    for (auto& worker : pImpl->workers) {
+        worker.join();
+    }
+
+    // Anything still queued never ran
+    for (auto& pair : pImpl->jobs) {
+        Impl::resolve(pair.second.waiters, nullptr);
+    }
+}
+
+std::future<AssetLoaderPool::SpritePtr> AssetLoaderPool::submit(const std::string& path, LoadPriority priority) {
+    std::promise<SpritePtr> promise;
+    auto future = promise.get_future();
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+
+    auto it = pImpl->jobs.find(path);
+    if (it != pImpl->jobs.end()) {
+        LoadJob& job = it->second;
+        job.waiters.push_back(std::move(promise));
+
+        // Promote a queued load if the new caller needs it sooner
+        if (!job.running && priority < job.priority) {
+            pImpl->queue.erase(Impl::queueKey(path, job));
+            job.priority = priority;
+            pImpl->queue.insert(Impl::queueKey(path, job));
+        }
+        return future;
+    }
+
+    LoadJob job;
+    job.priority = priority;
+    job.sequence = pImpl->next_sequence++;
+    job.waiters.push_back(std::move(promise));
+    pImpl->queue.insert(Impl::queueKey(path, job));
+    pImpl->jobs.emplace(path, std::move(job));
+
+    pImpl->work_available.notify_one();
+    return future;
+}
+
+bool AssetLoaderPool::cancel(const std::string& path) {
+    std::vector<std::promise<SpritePtr>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        auto it = pImpl->jobs.find(path);
+        if (it == pImpl->jobs.end() || it->second.running) {
+            return false;
+        }
+        pImpl->queue.erase(Impl::queueKey(path, it->second));
+        waiters = std::move(it->second.waiters);
+        pImpl->jobs.erase(it);
+    }
+
+    Impl::resolve(waiters, nullptr);
+    return true;
+}
+
+size_t AssetLoaderPool::cancelAll(LoadPriority priority) {
+    std::vector<std::promise<SpritePtr>> waiters;
+    size_t cancelled = 0;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        // Lower priorities sort last, so cancel from the back of the queue
+        while (!pImpl->queue.empty()) {
+            auto last = std::prev(pImpl->queue.end());
+            if (std::get<0>(*last) < static_cast<int>(priority)) {
+                break;
+            }
+            auto job = pImpl->jobs.find(std::get<2>(*last));
+            std::move(job->second.waiters.begin(), job->second.waiters.end(), std::back_inserter(waiters));
+            pImpl->jobs.erase(job);
+            pImpl->queue.erase(last);
+            cancelled++;
+        }
+    }
+
+    Impl::resolve(waiters, nullptr);
+    return cancelled;
+}
+
+size_t AssetLoaderPool::getQueuedCount() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->queue.size();
+}
+
+size_t AssetLoaderPool::getWorkerCount() const {
+    return pImpl->workers.size();
+}
+
+} // namespace core
+} // namespace d2portable
@@ -1,18 +1,29 @@
 #include "core/asset_manager.h"
+#include "core/asset_bundle.h"
 #include "utils/stormlib_mpq_loader.h"
 #include "utils/file_utils.h"
 #include "sprites/dc6_parser.h"
+#include "sprites/dcc_parser.h"
+#include "sprites/sprite_residency.h"
 #include "performance/memory_monitor.h"
 #include <filesystem>
 #include <unordered_map>
+#include <list>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <array>
+#include <limits>
 #include <fstream>
 #include <algorithm>
+#include <cctype>
 
 namespace d2portable {
 namespace core {
 
+struct CacheEntry;
+using CacheNode = std::pair<const std::string, CacheEntry>;
+
 // Asset cache entry
 struct CacheEntry {
     std::shared_ptr<sprites::DC6Sprite> sprite;
@@ -20,108 +31,383 @@ struct CacheEntry {
     size_t memory_size;
     std::chrono::time_point<std::chrono::steady_clock> last_accessed;
     AssetStatus status;
+    // Global access sequence number, used to compare recency across shards
+    uint64_t last_use = 0;
+    // Position in the owning shard's lru_list
+    std::list<CacheNode*>::iterator lru_position;
+};
+
+// Number of independently locked cache partitions
+constexpr size_t kCacheShardCount = 16;
+
+// Heap cost charged for a sprite whose pixels live in a mapped bundle
+constexpr size_t kMappedSpriteMemorySize = 1024;
+
+// Bookkeeping charged for a parsed sprite on top of its encoded file bytes
+constexpr size_t kSpriteBaseMemorySize = 1024;
+
+// MemoryMonitor identifier for decoded sprite directions
+const char* const kDecodedSpritesIdentifier = "sprite_pixels";
+
+// One lock stripe of the asset cache. Map nodes are stable, so the LRU
+// list (most recently used at the front) can point at them directly.
+struct CacheShard {
+    std::mutex mutex;
+    std::unordered_map<std::string, CacheEntry> entries;
+    std::list<CacheNode*> lru_list;
 };
 
 // Private implementation class
 class AssetManager::Impl {
 public:
-    Impl() : initialized(false), max_cache_size(0), use_mpq(false) {}
+    Impl() : initialized(false), max_cache_size(0), use_mpq(false),
+             residency(std::make_shared<sprites::SpriteResidency>()) {
+        residency->setUsageCallback([this](int64_t delta) { reportResidencyChange(delta); });
+    }
     
     bool initialized;
     std::string data_path;
     std::string last_error;
-    size_t max_cache_size;
+    mutable std::mutex error_mutex;
+    std::atomic<size_t> max_cache_size;
     bool use_mpq;
     
     // MPQ support
     std::vector<std::unique_ptr<utils::StormLibMPQLoader>> mpq_loaders;
     std::string fallback_path;
     
-    // Cache management
-    std::unordered_map<std::string, CacheEntry> cache;
-    mutable std::mutex cache_mutex;
+    // Cross-archive file index: normalized path -> owning archive and size.
+    // Built once at initialization; the highest priority archive wins.
+    struct IndexedFile {
+        size_t loader;
+        uint32_t size;
+    };
+    std::unordered_map<std::string, IndexedFile> file_index;
+    // Archives without a usable (listfile) that still have to be probed
+    std::vector<size_t> unindexed_loaders;
+    
+    // Pre-decoded .d2pak bundles, searched before any archive
+    std::vector<std::unique_ptr<AssetBundle>> bundles;
+    
+    // Cache management. Loads run outside the shard locks, so a cache hit
+    // never waits for another thread's decompression.
+    std::array<CacheShard, kCacheShardCount> cache_shards;
+    std::atomic<size_t> current_cache_size{0};
+    std::atomic<uint64_t> access_clock{0};
+    std::atomic<uint64_t> lock_contentions{0};
     
     // Memory monitoring
     d2::MemoryMonitor* memory_monitor = nullptr;
+    std::mutex monitor_mutex;
+    
+    // Decoded pixels of every parsed sprite share this budget. Sprites may
+    // outlive the manager, so they hold it too.
+    std::shared_ptr<sprites::SpriteResidency> residency;
+    
+    // Workers for loadSpriteAsync, started on first use. The pool is
+    // published through started_pool once built, so cancellation from
+    // other threads never reads loader_pool while call_once writes it.
+    std::unique_ptr<AssetLoaderPool> loader_pool;
+    std::once_flag loader_pool_once;
+    std::atomic<AssetLoaderPool*> started_pool{nullptr};
+    
+    void setLastError(const std::string& error) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        last_error = error;
+    }
+    
+    void reportAllocation(const std::string& path, size_t size) {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        if (memory_monitor) {
+            memory_monitor->recordAllocation("sprite:" + path, size);
+        }
+    }
+    
+    void reportDeallocation(const std::string& path, size_t size) {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        if (memory_monitor) {
+            memory_monitor->recordDeallocation("sprite:" + path, size);
+        }
+    }
+    
+    void reportResidencyChange(int64_t delta) {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        if (!memory_monitor) {
+            return;
+        }
+        if (delta > 0) {
+            memory_monitor->recordAllocation(kDecodedSpritesIdentifier, static_cast<size_t>(delta));
+        } else {
+            memory_monitor->recordDeallocation(kDecodedSpritesIdentifier, static_cast<size_t>(-delta));
+        }
+    }
+    
+    CacheShard& shardFor(const std::string& path) {
+        return cache_shards[std::hash<std::string>{}(path) % kCacheShardCount];
+    }
+    
+    // Lock a shard, counting acquisitions that had to wait for another thread
+    std::unique_lock<std::mutex> lockShard(CacheShard& shard) {
+        std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            lock_contentions.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+        }
+        return lock;
+    }
     
     // Utility methods
     std::string resolveFilePath(const std::string& relative_path) const {
         return (std::filesystem::path(data_path) / relative_path).string();
     }
     
-    void updateLastAccessed(const std::string& path) {
-        auto it = cache.find(path);
-        if (it != cache.end()) {
-            it->second.last_accessed = std::chrono::steady_clock::now();
-        }
+    // The caller must hold the shard's lock for all entry helpers below
+    void touchEntry(CacheShard& shard, CacheEntry& entry) {
+        entry.last_accessed = std::chrono::steady_clock::now();
+        entry.last_use = access_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+        shard.lru_list.splice(shard.lru_list.begin(), shard.lru_list, entry.lru_position);
     }
     
-    void enforceCacheLimit() {
-        if (max_cache_size == 0) return; // No limit
+    void eraseEntry(CacheShard& shard, std::unordered_map<std::string, CacheEntry>::iterator it) {
+        current_cache_size -= it->second.memory_size;
+        
+        // Report deallocation to memory monitor if set
+        if (it->second.sprite) {
+            reportDeallocation(it->first, it->second.memory_size);
+        }
         
-        size_t current_size = 0;
-        for (const auto& pair : cache) {
-            current_size += pair.second.memory_size;
+        shard.lru_list.erase(it->second.lru_position);
+        shard.entries.erase(it);
+    }
+    
+    void storeEntry(CacheShard& shard, const std::string& path, CacheEntry entry) {
+        auto existing = shard.entries.find(path);
+        if (existing != shard.entries.end()) {
+            eraseEntry(shard, existing);
         }
         
-        // If over limit, remove oldest entries
-        while (current_size > max_cache_size && !cache.empty()) {
-            auto oldest = cache.begin();
-            auto oldest_time = oldest->second.last_accessed;
+        current_cache_size += entry.memory_size;
+        entry.last_use = access_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto it = shard.entries.emplace(path, std::move(entry)).first;
+        shard.lru_list.push_front(&*it);
+        it->second.lru_position = shard.lru_list.begin();
+    }
+    
+    // Must be called without any shard lock held
+    void enforceCacheLimit() {
+        while (true) {
+            size_t limit = max_cache_size.load();
+            if (limit == 0 || current_cache_size.load() <= limit) {
+                return;
+            }
             
-            for (auto it = cache.begin(); it != cache.end(); ++it) {
-                if (it->second.last_accessed < oldest_time) {
-                    oldest = it;
-                    oldest_time = it->second.last_accessed;
+            // Evict the globally least recently used entry: the oldest
+            // of the per-shard LRU tails
+            CacheShard* victim = nullptr;
+            std::string victim_path;
+            uint64_t oldest_use = std::numeric_limits<uint64_t>::max();
+            for (auto& shard : cache_shards) {
+                auto lock = lockShard(shard);
+                if (!shard.lru_list.empty() && shard.lru_list.back()->second.last_use < oldest_use) {
+                    oldest_use = shard.lru_list.back()->second.last_use;
+                    victim = &shard;
+                    victim_path = shard.lru_list.back()->first;
                 }
             }
-            
-            current_size -= oldest->second.memory_size;
-            
-            // Report deallocation to memory monitor if set
-            if (memory_monitor && oldest->second.sprite) {
-                memory_monitor->recordDeallocation("sprite:" + oldest->first, oldest->second.memory_size);
+            if (!victim) {
+                return;
             }
             
-            cache.erase(oldest);
+            // The shard was unlocked since the scan: only evict the entry if
+            // it is still there and nobody used or replaced it meanwhile,
+            // otherwise scan again
+            auto lock = lockShard(*victim);
+            auto it = victim->entries.find(victim_path);
+            if (it != victim->entries.end() && it->second.last_use == oldest_use) {
+                eraseEntry(*victim, it);
+            }
         }
     }
     
+    void cacheRawData(const std::string& path, const std::vector<uint8_t>& data) {
+        CacheEntry entry;
+        entry.raw_data = data;
+        entry.memory_size = data.size();
+        entry.last_accessed = std::chrono::steady_clock::now();
+        entry.status = AssetStatus::LOADED;
+        {
+            CacheShard& shard = shardFor(path);
+            auto lock = lockShard(shard);
+            storeEntry(shard, path, std::move(entry));
+        }
+        enforceCacheLimit();
+    }
+    
+    bool lookupRawData(const std::string& path, std::vector<uint8_t>& data) {
+        CacheShard& shard = shardFor(path);
+        auto lock = lockShard(shard);
+        auto it = shard.entries.find(path);
+        if (it == shard.entries.end() || it->second.raw_data.empty()) {
+            return false;
+        }
+        touchEntry(shard, it->second);
+        data = it->second.raw_data;
+        return true;
+    }
+    
+    // MPQ names are case-insensitive and use backslash separators
+    static std::string normalizeArchivePath(const std::string& path) {
+        std::string normalized = path;
+        for (char& c : normalized) {
+            c = (c == '/') ? '\\' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return normalized;
+    }
+    
+    // Diablo II archive precedence: patches override the expansion,
+    // which overrides the classic archives.
+    static int archivePriority(const std::filesystem::path& mpq_path) {
+        std::string name = mpq_path.filename().string();
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name.rfind("patch", 0) == 0) return 2;
+        if (name.rfind("d2exp", 0) == 0 || name.rfind("d2x", 0) == 0) return 1;
+        return 0;
+    }
+    
+    void buildFileIndex() {
+        file_index.clear();
+        unindexed_loaders.clear();
+        
+        // mpq_loaders is ordered by priority, so the first archive that
+        // lists a path owns it
+        for (size_t i = 0; i < mpq_loaders.size(); i++) {
+            auto files = mpq_loaders[i]->listFiles();
+            if (files.empty()) {
+                unindexed_loaders.push_back(i);
+                continue;
+            }
+            file_index.reserve(file_index.size() + files.size());
+            for (const auto& info : files) {
+                file_index.emplace(normalizeArchivePath(info.filename), IndexedFile{i, info.uncompressed_size});
+            }
+        }
+    }
+    
+    bool archivesContain(const std::string& relative_path) {
+        std::string mpq_path = normalizeArchivePath(relative_path);
+        if (file_index.count(mpq_path)) {
+            return true;
+        }
+        for (size_t i : unindexed_loaders) {
+            if (mpq_loaders[i]->hasFile(mpq_path)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool extractFromArchives(const std::string& relative_path, std::vector<uint8_t>& data) {
+        std::string mpq_path = normalizeArchivePath(relative_path);
+        
+        auto it = file_index.find(mpq_path);
+        size_t indexed = (it != file_index.end()) ? it->second.loader : mpq_loaders.size();
+        
+        // Loaders serve concurrent reads, so workers extract in parallel.
+        // Unlisted archives are only probed when they outrank the index hit
+        for (size_t i : unindexed_loaders) {
+            if (i > indexed) {
+                break;
+            }
+            if (mpq_loaders[i]->extractFile(mpq_path, data)) {
+                return true;
+            }
+        }
+        if (indexed >= mpq_loaders.size()) {
+            return false;
+        }
+        if (mpq_loaders[indexed]->extractFile(mpq_path, data)) {
+            return true;
+        }
+
+        // The owning archive failed to extract (damaged block, read error);
+        // lower-priority archives may still hold a good copy
+        for (size_t i = indexed + 1; i < mpq_loaders.size(); i++) {
+            if (mpq_loaders[i]->extractFile(mpq_path, data)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
     // Helper methods for loadSprite refactoring
-    std::shared_ptr<sprites::DC6Sprite> checkSpriteCache(const std::string& relative_path) {
-        auto cache_it = cache.find(relative_path);
-        if (cache_it != cache.end() && cache_it->second.sprite) {
-            updateLastAccessed(relative_path);
+    std::shared_ptr<sprites::DC6Sprite> checkSpriteCache(CacheShard& shard, const std::string& relative_path) {
+        auto cache_it = shard.entries.find(relative_path);
+        if (cache_it != shard.entries.end() && cache_it->second.sprite) {
+            touchEntry(shard, cache_it->second);
             return cache_it->second.sprite;
         }
         return nullptr;
     }
     
+    // DCC animations share the sprite interface but have their own decoder
+    static bool isDCCPath(const std::string& path) {
+        std::string ext = std::filesystem::path(path).extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return ext == ".dcc";
+    }
+    
+    std::unique_ptr<sprites::DC6Sprite> parseSpriteFile(const std::string& path) const {
+        if (isDCCPath(path)) {
+            sprites::DCCParser parser;
+            parser.setResidency(residency);
+            return parser.parseFile(path);
+        }
+        sprites::DC6Parser parser;
+        parser.setResidency(residency);
+        return parser.parseFile(path);
+    }
+    
     std::unique_ptr<sprites::DC6Sprite> loadSpriteFromMPQ(const std::string& relative_path) {
         if (!use_mpq) {
             return nullptr;
         }
         
-        // Convert forward slashes to backslashes for MPQ compatibility
-        std::string mpq_path = relative_path;
-        std::replace(mpq_path.begin(), mpq_path.end(), '/', '\\');
+        // The sprite decodes its frames from the file bytes on demand, so
+        // hand the extracted buffer over rather than copying it
+        std::vector<uint8_t> data;
+        if (!extractFromArchives(relative_path, data)) {
+            return nullptr;
+        }
         
+        if (isDCCPath(relative_path)) {
+            sprites::DCCParser parser;
+            parser.setResidency(residency);
+            return parser.parseData(std::move(data));
+        }
         sprites::DC6Parser parser;
-        
-        // Try each MPQ loader
-        for (const auto& loader : mpq_loaders) {
-            std::vector<uint8_t> data;
-            if (loader->extractFile(mpq_path, data)) {
-                auto sprite = parser.parseData(data);
-                if (sprite) {
-                    return sprite;
-                }
+        parser.setResidency(residency);
+        return parser.parseData(std::move(data));
+    }
+    
+    std::shared_ptr<sprites::DC6Sprite> loadSpriteFromBundles(const std::string& relative_path) {
+        for (const auto& bundle : bundles) {
+            auto sprite = bundle->loadSprite(relative_path);
+            if (sprite) {
+                return sprite;
             }
         }
-        
         return nullptr;
     }
     
+    bool bundlesContain(const std::string& relative_path) const {
+        for (const auto& bundle : bundles) {
+            if (bundle->contains(relative_path)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
     std::unique_ptr<sprites::DC6Sprite> loadSpriteFromFallback(const std::string& relative_path) {
         if (fallback_path.empty()) {
             return nullptr;
@@ -129,8 +415,7 @@ public:
         
         std::string fallback_file = (std::filesystem::path(fallback_path) / relative_path).string();
         if (d2::utils::FileUtils::validateFileExists(fallback_file)) {
-            sprites::DC6Parser parser;
-            return parser.parseFile(fallback_file);
+            return parseSpriteFile(fallback_file);
         }
         
         return nullptr;
@@ -139,67 +424,72 @@ public:
     std::unique_ptr<sprites::DC6Sprite> loadSpriteFromFilesystem(const std::string& relative_path) {
         std::string full_path = resolveFilePath(relative_path);
         if (d2::utils::FileUtils::validateFileExists(full_path)) {
-            sprites::DC6Parser parser;
-            return parser.parseFile(full_path);
+            return parseSpriteFile(full_path);
         }
         
         return nullptr;
     }
     
-    size_t calculateSpriteMemorySize(const std::shared_ptr<sprites::DC6Sprite>& sprite) {
-        size_t memory_size = 1024; // Base overhead
-        
-        try {
-            uint32_t dirs = sprite->getDirectionCount();
-            uint32_t frames = sprite->getFramesPerDirection();
-            if (dirs > 0 && frames > 0) {
-                auto dc6_frame = sprite->getFrame(0, 0);
-                size_t frame_size = dc6_frame.width * dc6_frame.height * 4; // RGBA
-                memory_size += frame_size * dirs * frames;
-            }
-        } catch (...) {
-            // If there's any issue calculating size, just use base overhead
-            memory_size = 1024;
-        }
-        
-        return memory_size;
+    // Decoded pixels are charged to the residency as they are decoded, so
+    // the cache entry only covers what the sprite holds up front
+    static size_t spriteMemorySize(const sprites::DC6Sprite& sprite) {
+        return kSpriteBaseMemorySize + sprite.getEncodedSize();
     }
     
-    void cacheSpriteResult(const std::string& relative_path, const std::shared_ptr<sprites::DC6Sprite>& sprite) {
+    // Returns the cached sprite, which may be one another thread stored
+    // while this one was loading
+    std::shared_ptr<sprites::DC6Sprite> cacheSpriteResult(const std::string& relative_path,
+                                                          const std::shared_ptr<sprites::DC6Sprite>& sprite,
+                                                          size_t memory_size) {
         CacheEntry entry;
         entry.sprite = sprite;
         entry.status = AssetStatus::LOADED;
         entry.last_accessed = std::chrono::steady_clock::now();
-        entry.memory_size = calculateSpriteMemorySize(sprite);
-        
-        cache[relative_path] = entry;
-        enforceCacheLimit();
+        entry.memory_size = memory_size;
         
-        // Report memory usage to memory monitor if set
-        if (memory_monitor) {
-            memory_monitor->recordAllocation("sprite:" + relative_path, entry.memory_size);
+        {
+            CacheShard& shard = shardFor(relative_path);
+            auto lock = lockShard(shard);
+            auto existing = checkSpriteCache(shard, relative_path);
+            if (existing) {
+                return existing;
+            }
+            storeEntry(shard, relative_path, std::move(entry));
+            
+            // Report memory usage to memory monitor if set
+            reportAllocation(relative_path, memory_size);
         }
+        
+        enforceCacheLimit();
+        return sprite;
     }
 };
 
 AssetManager::AssetManager() : pImpl(std::make_unique<Impl>()) {}
 
-AssetManager::~AssetManager() = default;
+AssetManager::~AssetManager() {
+    // Loader workers call back into this object, so stop them first
+    pImpl->started_pool.store(nullptr, std::memory_order_release);
+    pImpl->loader_pool.reset();
+    
+    // Sprites handed out may keep the residency alive past this object
+    pImpl->residency->setUsageCallback(nullptr);
+}
 
 bool AssetManager::initialize(const std::string& data_path) {
     if (!std::filesystem::exists(data_path)) {
-        pImpl->last_error = "Data path does not exist: " + data_path;
+        pImpl->setLastError("Data path does not exist: " + data_path);
         return false;
     }
     
     if (!std::filesystem::is_directory(data_path)) {
-        pImpl->last_error = "Data path is not a directory: " + data_path;
+        pImpl->setLastError("Data path is not a directory: " + data_path);
         return false;
     }
     
     pImpl->data_path = data_path;
     pImpl->initialized = true;
-    pImpl->last_error.clear();
+    pImpl->setLastError("");
     
     return true;
 }
@@ -210,82 +500,111 @@ bool AssetManager::isInitialized() const {
 
 bool AssetManager::initializeWithMPQ(const std::string& mpq_path, const std::string& fallback_path) {
     if (!d2::utils::FileUtils::validateFileExists(mpq_path)) {
-        pImpl->last_error = "MPQ file does not exist: " + mpq_path;
+        pImpl->setLastError("MPQ file does not exist: " + mpq_path);
         return false;
     }
     
     auto loader = std::make_unique<utils::StormLibMPQLoader>();
     if (!loader->open(mpq_path)) {
-        pImpl->last_error = "Failed to open MPQ: " + loader->getLastError();
+        pImpl->setLastError("Failed to open MPQ: " + loader->getLastError());
         return false;
     }
     
     pImpl->mpq_loaders.clear();
     pImpl->mpq_loaders.push_back(std::move(loader));
+    pImpl->buildFileIndex();
     pImpl->use_mpq = true;
     pImpl->fallback_path = fallback_path;
     pImpl->initialized = true;
-    pImpl->last_error.clear();
+    pImpl->setLastError("");
     
     return true;
 }
 
 bool AssetManager::initializeWithMPQs(const std::string& mpq_directory, const std::string& fallback_path) {
     if (!std::filesystem::exists(mpq_directory)) {
-        pImpl->last_error = "MPQ directory does not exist: " + mpq_directory;
+        pImpl->setLastError("MPQ directory does not exist: " + mpq_directory);
         return false;
     }
     
     if (!std::filesystem::is_directory(mpq_directory)) {
-        pImpl->last_error = "Path is not a directory: " + mpq_directory;
+        pImpl->setLastError("Path is not a directory: " + mpq_directory);
         return false;
     }
     
     pImpl->mpq_loaders.clear();
     
-    // Find and open all MPQ files in the directory
+    // Find all MPQ files in the directory
+    std::vector<std::filesystem::path> mpq_files;
     for (const auto& entry : std::filesystem::directory_iterator(mpq_directory)) {
         if (entry.is_regular_file()) {
             std::string ext = entry.path().extension().string();
             std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
             if (ext == ".mpq") {
-                auto loader = std::make_unique<utils::StormLibMPQLoader>();
-                if (loader->open(entry.path().string())) {
-                    pImpl->mpq_loaders.push_back(std::move(loader));
-                }
+                mpq_files.push_back(entry.path());
             }
         }
     }
     
+    // Open highest priority archives first (patch > expansion > classic);
+    // directory order is unspecified, so break ties by name
+    std::sort(mpq_files.begin(), mpq_files.end(),
+              [](const std::filesystem::path& a, const std::filesystem::path& b) {
+                  int pa = Impl::archivePriority(a);
+                  int pb = Impl::archivePriority(b);
+                  return pa != pb ? pa > pb : a.filename() < b.filename();
+              });
+    
+    for (const auto& mpq_file : mpq_files) {
+        auto loader = std::make_unique<utils::StormLibMPQLoader>();
+        if (loader->open(mpq_file.string())) {
+            pImpl->mpq_loaders.push_back(std::move(loader));
+        }
+    }
+    
     if (pImpl->mpq_loaders.empty()) {
-        pImpl->last_error = "No valid MPQ files found in directory: " + mpq_directory;
+        pImpl->setLastError("No valid MPQ files found in directory: " + mpq_directory);
         return false;
     }
     
+    pImpl->buildFileIndex();
+    
     pImpl->use_mpq = true;
     pImpl->fallback_path = fallback_path;
     pImpl->initialized = true;
-    pImpl->last_error.clear();
+    pImpl->setLastError("");
+    
+    return true;
+}
+
+bool AssetManager::mountBundle(const std::string& bundle_path) {
+    auto bundle = std::make_unique<AssetBundle>();
+    if (!bundle->open(bundle_path)) {
+        pImpl->setLastError(bundle->getLastError());
+        return false;
+    }
     
+    pImpl->bundles.push_back(std::move(bundle));
     return true;
 }
 
+size_t AssetManager::getMountedBundleCount() const {
+    return pImpl->bundles.size();
+}
+
 bool AssetManager::hasFile(const std::string& relative_path) const {
     if (!pImpl->initialized) {
         return false;
     }
     
+    if (pImpl->bundlesContain(relative_path)) {
+        return true;
+    }
+    
     // If using MPQ archives, check them first
     if (pImpl->use_mpq) {
-        // Convert forward slashes to backslashes for MPQ compatibility
-        std::string mpq_path = relative_path;
-        std::replace(mpq_path.begin(), mpq_path.end(), '/', '\\');
-        
-        // Check each loaded MPQ
-        for (const auto& loader : pImpl->mpq_loaders) {
-            if (loader->hasFile(mpq_path)) {
-                return true;
-            }
+        if (pImpl->archivesContain(relative_path)) {
+            return true;
         }
         
         // Check fallback path if set
@@ -306,16 +625,25 @@ bool AssetManager::hasFile(const std::string& relative_path) const {
 
 std::shared_ptr<sprites::DC6Sprite> AssetManager::loadSprite(const std::string& relative_path) {
     if (!pImpl->initialized) {
-        pImpl->last_error = "Asset manager not initialized";
+        pImpl->setLastError("Asset manager not initialized");
         return nullptr;
     }
     
-    std::lock_guard<std::mutex> lock(pImpl->cache_mutex);
-    
     // Check cache first
-    auto cached_sprite = pImpl->checkSpriteCache(relative_path);
-    if (cached_sprite) {
-        return cached_sprite;
+    {
+        CacheShard& shard = pImpl->shardFor(relative_path);
+        auto lock = pImpl->lockShard(shard);
+        auto cached_sprite = pImpl->checkSpriteCache(shard, relative_path);
+        if (cached_sprite) {
+            return cached_sprite;
+        }
+    }
+    
+    // Bundled sprites are already decoded and live in a file mapping, so
+    // they only cost their bookkeeping
+    auto bundled_sprite = pImpl->loadSpriteFromBundles(relative_path);
+    if (bundled_sprite) {
+        return pImpl->cacheSpriteResult(relative_path, bundled_sprite, kMappedSpriteMemorySize);
     }
     
     // Try loading from various sources
@@ -335,60 +663,72 @@ std::shared_ptr<sprites::DC6Sprite> AssetManager::loadSprite(const std::string&
     }
     
     if (!sprite) {
-        pImpl->last_error = "Failed to load sprite: " + relative_path;
+        pImpl->setLastError("Failed to load sprite: " + relative_path);
         return nullptr;
     }
     
     // Convert unique_ptr to shared_ptr and cache the result
     std::shared_ptr<sprites::DC6Sprite> shared_sprite = std::move(sprite);
-    pImpl->cacheSpriteResult(relative_path, shared_sprite);
-    
-    return shared_sprite;
+    return pImpl->cacheSpriteResult(relative_path, shared_sprite, Impl::spriteMemorySize(*shared_sprite));
 }
 
-std::future<std::shared_ptr<sprites::DC6Sprite>> AssetManager::loadSpriteAsync(const std::string& relative_path) {
-    return std::async(std::launch::async, [this, relative_path]() {
-        return loadSprite(relative_path);
+std::future<std::shared_ptr<sprites::DC6Sprite>> AssetManager::loadSpriteAsync(const std::string& relative_path,
+                                                                               LoadPriority priority) {
+    // Cache hits do not need a worker
+    {
+        CacheShard& shard = pImpl->shardFor(relative_path);
+        auto lock = pImpl->lockShard(shard);
+        auto cached_sprite = pImpl->checkSpriteCache(shard, relative_path);
+        if (cached_sprite) {
+            std::promise<std::shared_ptr<sprites::DC6Sprite>> ready;
+            ready.set_value(cached_sprite);
+            return ready.get_future();
+        }
+    }
+    
+    std::call_once(pImpl->loader_pool_once, [this]() {
+        pImpl->loader_pool = std::make_unique<AssetLoaderPool>([this](const std::string& path) {
+            return loadSprite(path);
+        });
+        pImpl->started_pool.store(pImpl->loader_pool.get(), std::memory_order_release);
     });
+    return pImpl->loader_pool->submit(relative_path, priority);
+}
+
+bool AssetManager::cancelAsyncLoad(const std::string& relative_path) {
+    AssetLoaderPool* pool = pImpl->started_pool.load(std::memory_order_acquire);
+    return pool && pool->cancel(relative_path);
+}
+
+size_t AssetManager::cancelAsyncLoads(LoadPriority priority) {
+    AssetLoaderPool* pool = pImpl->started_pool.load(std::memory_order_acquire);
+    return pool ? pool->cancelAll(priority) : 0;
 }
 
 std::vector<uint8_t> AssetManager::loadFileData(const std::string& relative_path) {
-    if (!pImpl->initialized) {
-        pImpl->last_error = "Asset manager not initialized";
+    std::vector<uint8_t> data;
+    if (!loadFileData(relative_path, data)) {
         return {};
     }
-    
-    std::lock_guard<std::mutex> lock(pImpl->cache_mutex);
+    return data;
+}
+
+bool AssetManager::loadFileData(const std::string& relative_path, std::vector<uint8_t>& data) {
+    if (!pImpl->initialized) {
+        pImpl->setLastError("Asset manager not initialized");
+        return false;
+    }
     
     // Check cache first
-    auto cache_it = pImpl->cache.find(relative_path);
-    if (cache_it != pImpl->cache.end() && !cache_it->second.raw_data.empty()) {
-        pImpl->updateLastAccessed(relative_path);
-        return cache_it->second.raw_data;
+    if (pImpl->lookupRawData(relative_path, data)) {
+        return true;
     }
     
-    std::vector<uint8_t> data;
-    
     // Try loading from MPQ first if enabled
     if (pImpl->use_mpq) {
-        // Convert forward slashes to backslashes for MPQ compatibility
-        std::string mpq_path = relative_path;
-        std::replace(mpq_path.begin(), mpq_path.end(), '/', '\\');
-        
-        // Try each MPQ loader
-        for (const auto& loader : pImpl->mpq_loaders) {
-            if (loader->extractFile(mpq_path, data)) {
-                // Cache the data
-                CacheEntry entry;
-                entry.raw_data = data;
-                entry.memory_size = data.size();
-                entry.last_accessed = std::chrono::steady_clock::now();
-                entry.status = AssetStatus::LOADED;
-                pImpl->cache[relative_path] = entry;
-                pImpl->enforceCacheLimit();
-                
-                return data;
-            }
+        if (pImpl->extractFromArchives(relative_path, data)) {
+            pImpl->cacheRawData(relative_path, data);
+            return true;
         }
         
         // Try fallback path if not found in MPQs
@@ -404,36 +744,28 @@ std::vector<uint8_t> AssetManager::loadFileData(const std::string& relative_path
                     file.read(reinterpret_cast<char*>(data.data()), size);
                     
                     if (file.good()) {
-                        // Cache the data
-                        CacheEntry entry;
-                        entry.raw_data = data;
-                        entry.memory_size = data.size();
-                        entry.last_accessed = std::chrono::steady_clock::now();
-                        entry.status = AssetStatus::LOADED;
-                        pImpl->cache[relative_path] = entry;
-                        pImpl->enforceCacheLimit();
-                        
-                        return data;
+                        pImpl->cacheRawData(relative_path, data);
+                        return true;
                     }
                 }
             }
         }
         
-        pImpl->last_error = "File not found in MPQs or fallback: " + relative_path;
-        return {};
+        pImpl->setLastError("File not found in MPQs or fallback: " + relative_path);
+        return false;
     }
     
     // Original filesystem loading
     std::string full_path = pImpl->resolveFilePath(relative_path);
     if (!std::filesystem::exists(full_path)) {
-        pImpl->last_error = "File not found: " + relative_path;
-        return {};
+        pImpl->setLastError("File not found: " + relative_path);
+        return false;
     }
     
     std::ifstream file(full_path, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
-        pImpl->last_error = "Failed to open file: " + relative_path;
-        return {};
+        pImpl->setLastError("Failed to open file: " + relative_path);
+        return false;
     }
     
     auto size = file.tellg();
@@ -443,20 +775,17 @@ std::vector<uint8_t> AssetManager::loadFileData(const std::string& relative_path
     file.read(reinterpret_cast<char*>(data.data()), size);
     
     if (!file.good()) {
-        pImpl->last_error = "Failed to read file: " + relative_path;
-        return {};
+        pImpl->setLastError("Failed to read file: " + relative_path);
+        return false;
     }
     
-    // Cache the data
-    CacheEntry entry;
-    entry.raw_data = data;
-    entry.memory_size = data.size();
-    entry.last_accessed = std::chrono::steady_clock::now();
-    entry.status = AssetStatus::LOADED;
-    pImpl->cache[relative_path] = entry;
-    pImpl->enforceCacheLimit();
-    
-    return data;
+    pImpl->cacheRawData(relative_path, data);
+    return true;
+}
+
+size_t AssetManager::getFileSize(const std::string& relative_path) const {
+    auto it = pImpl->file_index.find(Impl::normalizeArchivePath(relative_path));
+    return it != pImpl->file_index.end() ? it->second.size : 0;
 }
 
 AssetInfo AssetManager::getAssetInfo(const std::string& relative_path) const {
@@ -466,10 +795,11 @@ AssetInfo AssetManager::getAssetInfo(const std::string& relative_path) const {
     info.memory_size = 0;
     info.last_accessed = std::chrono::steady_clock::now();
     
-    std::lock_guard<std::mutex> lock(pImpl->cache_mutex);
+    CacheShard& shard = pImpl->shardFor(relative_path);
+    auto lock = pImpl->lockShard(shard);
     
-    auto cache_it = pImpl->cache.find(relative_path);
-    if (cache_it != pImpl->cache.end()) {
+    auto cache_it = shard.entries.find(relative_path);
+    if (cache_it != shard.entries.end()) {
         info.status = cache_it->second.status;
         info.memory_size = cache_it->second.memory_size;
         info.last_accessed = cache_it->second.last_accessed;
@@ -479,46 +809,59 @@ AssetInfo AssetManager::getAssetInfo(const std::string& relative_path) const {
 }
 
 size_t AssetManager::getCachedAssetCount() const {
-    std::lock_guard<std::mutex> lock(pImpl->cache_mutex);
-    return pImpl->cache.size();
+    size_t count = 0;
+    for (auto& shard : pImpl->cache_shards) {
+        auto lock = pImpl->lockShard(shard);
+        count += shard.entries.size();
+    }
+    return count;
 }
 
 size_t AssetManager::getCacheMemoryUsage() const {
-    std::lock_guard<std::mutex> lock(pImpl->cache_mutex);
-    
-    size_t total = 0;
-    for (const auto& pair : pImpl->cache) {
-        total += pair.second.memory_size;
-    }
-    return total;
+    return pImpl->current_cache_size.load();
+}
+
+uint64_t AssetManager::getCacheLockContentionCount() const {
+    return pImpl->lock_contentions.load(std::memory_order_relaxed);
 }
 
 void AssetManager::clearCache() {
-    std::lock_guard<std::mutex> lock(pImpl->cache_mutex);
-    
-    // Report all deallocations to memory monitor if set
-    if (pImpl->memory_monitor) {
-        for (const auto& entry : pImpl->cache) {
-            if (entry.second.sprite) {
-                pImpl->memory_monitor->recordDeallocation("sprite:" + entry.first, entry.second.memory_size);
-            }
+    for (auto& shard : pImpl->cache_shards) {
+        auto lock = pImpl->lockShard(shard);
+        while (!shard.lru_list.empty()) {
+            pImpl->eraseEntry(shard, shard.entries.find(shard.lru_list.back()->first));
         }
     }
-    
-    pImpl->cache.clear();
 }
 
 void AssetManager::setMaxCacheSize(size_t max_bytes) {
-    std::lock_guard<std::mutex> lock(pImpl->cache_mutex);
     pImpl->max_cache_size = max_bytes;
     pImpl->enforceCacheLimit();
 }
 
+void AssetManager::setSpriteResidencyBudget(size_t max_bytes) {
+    pImpl->residency->setBudget(max_bytes);
+}
+
+size_t AssetManager::getSpriteResidencyBudget() const {
+    return pImpl->residency->getBudget();
+}
+
+size_t AssetManager::getSpriteResidentBytes() const {
+    return pImpl->residency->getResidentBytes();
+}
+
+size_t AssetManager::getSpriteResidentDirectionCount() const {
+    return pImpl->residency->getResidentDirectionCount();
+}
+
 std::string AssetManager::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->error_mutex);
     return pImpl->last_error;
 }
 
 void AssetManager::setMemoryMonitor(d2::MemoryMonitor* monitor) {
+    std::lock_guard<std::mutex> lock(pImpl->monitor_mutex);
     pImpl->memory_monitor = monitor;
 }
 
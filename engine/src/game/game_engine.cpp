@@ -395,9 +395,9 @@ bool GameEngine::initializeRenderingComponents() {
 
     // Create sprite renderer
     spriteRenderer_ = std::make_unique<d2::rendering::SpriteRenderer>();
-    // Initialize sprite renderer (simplified for now)
-    d2::rendering::TextureManager textureManager;
-    spriteRenderer_->initialize(*renderer_, textureManager);
+    // The sprite renderer reads texture trims from the manager, so it must outlive the renderer
+    textureManager_ = std::make_unique<d2::rendering::TextureManager>();
+    spriteRenderer_->initialize(*renderer_, *textureManager_);
     
     // Create optimized world renderer
     worldRenderer_ = std::make_unique<d2::rendering::OptimizedWorldRenderer>();
@@ -5,6 +5,22 @@
 
 namespace d2::game {
 
+namespace {
+
+// Extracted tables sit in data/excel next to their precompiled copies;
+// data/ holds tables laid out flat
+std::string findTable(const d2portable::core::AssetManager& assetManager, const std::string& fileName) {
+    for (const char* directory : {"data/excel/", "data/"}) {
+        std::string path = directory + fileName;
+        if (assetManager.hasFile(path)) {
+            return path;
+        }
+    }
+    return std::string();
+}
+
+} // namespace
+
 bool ItemDatabase::loadFromAssetManager(std::shared_ptr<d2portable::core::AssetManager> assetManager,
                                        d2::utils::DataTableParser* parser) {
     if (!assetManager || !parser) {
@@ -14,17 +30,17 @@ bool ItemDatabase::loadFromAssetManager(std::shared_ptr<d2portable::core::AssetM
     bool success = true;
     
     // Load armor data
-    if (assetManager->hasFile("data/armor.txt")) {
+    if (!findTable(*assetManager, "armor.txt").empty()) {
         success &= loadArmorData(assetManager, parser);
     }
     
     // Load weapon data
-    if (assetManager->hasFile("data/weapons.txt")) {
+    if (!findTable(*assetManager, "weapons.txt").empty()) {
         success &= loadWeaponData(assetManager, parser);
     }
     
     // Load misc item data
-    if (assetManager->hasFile("data/misc.txt")) {
+    if (!findTable(*assetManager, "misc.txt").empty()) {
         success &= loadMiscData(assetManager, parser);
     }
     
@@ -43,51 +59,88 @@ const Item& ItemDatabase::getItem(const std::string& itemName) const {
     return defaultItem_;
 }
 
+bool ItemDatabase::loadTable(std::shared_ptr<d2portable::core::AssetManager> assetManager,
+                             d2::utils::DataTableParser* parser,
+                             const std::string& fileName,
+                             d2::utils::DataTable& table) {
+    std::string path = findTable(*assetManager, fileName);
+    if (path.empty()) {
+        return false;
+    }
+    auto fileData = assetManager->loadFileData(path);
+    if (fileData.empty()) {
+        return false;
+    }
+    
+    // Use the precompiled table when it was built from this text
+    const char* text = reinterpret_cast<const char*>(fileData.data());
+    std::string binaryPath = d2::utils::DataTableParser::getBinaryPath(path);
+    if (assetManager->hasFile(binaryPath)) {
+        auto binaryData = assetManager->loadFileData(binaryPath);
+        uint64_t sourceHash = d2::utils::DataTableParser::hashSource(text, fileData.size());
+        if (parser->loadBinary(binaryData.data(), binaryData.size(), table, sourceHash)) {
+            return true;
+        }
+    }
+    
+    table = parser->parseExcel(text, fileData.size());
+    return true;
+}
+
 bool ItemDatabase::loadArmorData(std::shared_ptr<d2portable::core::AssetManager> assetManager,
                                 d2::utils::DataTableParser* parser) {
-    auto fileData = assetManager->loadFileData("data/armor.txt");
-    if (fileData.empty()) {
+    d2::utils::DataTable table;
+    if (!loadTable(assetManager, parser, "armor.txt", table)) {
         return false;
     }
     
-    std::string dataStr(fileData.begin(), fileData.end());
-    auto table = parser->parseExcel(dataStr);
+    // Resolve the columns once for every row
+    auto name = table.getColumn("name");
+    auto type = table.getColumn("type");
+    auto ac = table.getColumn("ac");
+    auto reqstr = table.getColumn("reqstr");
+    auto level = table.getColumn("level");
+    auto invwidth = table.getColumn("invwidth");
+    auto invheight = table.getColumn("invheight");
+    if (!name.isValid()) {
+        return true;
+    }
     
-    for (const auto& row : table.getAllRows()) {
-        auto nameIt = row.find("name");
-        if (nameIt == row.end()) continue;
+    for (size_t row = 0; row < table.getRowCount(); row++) {
+        // Rows without a name are skipped; the table does not tell an
+        // empty name cell from a row that ends before the name column
+        std::string itemName(table.getString(row, name));
+        if (itemName.empty()) continue;
         
-        Item armor(nameIt->second, ItemType::ARMOR);
+        Item armor(itemName, ItemType::ARMOR);
         
         // Set armor properties
-        armor.setDefense(table.getIntValue(row, "ac"));
-        armor.setRequiredStrength(table.getIntValue(row, "reqstr"));
-        armor.setRequiredLevel(table.getIntValue(row, "level"));
+        armor.setDefense(table.getInt(row, ac));
+        armor.setRequiredStrength(table.getInt(row, reqstr));
+        armor.setRequiredLevel(table.getInt(row, level));
         
         // Set inventory size
-        int width = table.getIntValue(row, "invwidth");
-        int height = table.getIntValue(row, "invheight");
+        int width = table.getInt(row, invwidth);
+        int height = table.getInt(row, invheight);
         if (width > 0 && height > 0) {
             armor.setSize(width, height);
         }
         
         // Determine equipment slot based on type
-        auto typeIt = row.find("type");
-        if (typeIt != row.end()) {
-            if (typeIt->second == "body") {
-                armor.setEquipmentSlot(EquipmentSlot::TORSO);
-            } else if (typeIt->second == "helm") {
-                armor.setEquipmentSlot(EquipmentSlot::HEAD);
-            } else if (typeIt->second == "glov") {
-                armor.setEquipmentSlot(EquipmentSlot::HANDS);
-            } else if (typeIt->second == "boot") {
-                armor.setEquipmentSlot(EquipmentSlot::FEET);
-            } else if (typeIt->second == "belt") {
-                armor.setEquipmentSlot(EquipmentSlot::BELT);
-            }
+        std::string_view armorType = table.getString(row, type);
+        if (armorType == "body") {
+            armor.setEquipmentSlot(EquipmentSlot::TORSO);
+        } else if (armorType == "helm") {
+            armor.setEquipmentSlot(EquipmentSlot::HEAD);
+        } else if (armorType == "glov") {
+            armor.setEquipmentSlot(EquipmentSlot::HANDS);
+        } else if (armorType == "boot") {
+            armor.setEquipmentSlot(EquipmentSlot::FEET);
+        } else if (armorType == "belt") {
+            armor.setEquipmentSlot(EquipmentSlot::BELT);
         }
         
-        items_.insert({nameIt->second, armor});
+        items_.insert({itemName, armor});
     }
     
     return true;
@@ -95,43 +148,50 @@ bool ItemDatabase::loadArmorData(std::shared_ptr<d2portable::core::AssetManager>
 
 bool ItemDatabase::loadWeaponData(std::shared_ptr<d2portable::core::AssetManager> assetManager,
                                  d2::utils::DataTableParser* parser) {
-    auto fileData = assetManager->loadFileData("data/weapons.txt");
-    if (fileData.empty()) {
+    d2::utils::DataTable table;
+    if (!loadTable(assetManager, parser, "weapons.txt", table)) {
         return false;
     }
     
-    std::string dataStr(fileData.begin(), fileData.end());
-    auto table = parser->parseExcel(dataStr);
+    // Resolve the columns once for every row
+    auto name = table.getColumn("name");
+    auto type = table.getColumn("type");
+    auto mindamage = table.getColumn("mindamage");
+    auto maxdamage = table.getColumn("maxdamage");
+    auto reqstr = table.getColumn("reqstr");
+    auto level = table.getColumn("level");
+    auto invwidth = table.getColumn("invwidth");
+    auto invheight = table.getColumn("invheight");
+    if (!name.isValid()) {
+        return true;
+    }
     
-    for (const auto& row : table.getAllRows()) {
-        auto nameIt = row.find("name");
-        if (nameIt == row.end()) continue;
+    for (size_t row = 0; row < table.getRowCount(); row++) {
+        std::string itemName(table.getString(row, name));
+        if (itemName.empty()) continue;
         
-        Item weapon(nameIt->second, ItemType::WEAPON);
+        Item weapon(itemName, ItemType::WEAPON);
         
         // Set weapon properties
-        weapon.setDamage(table.getIntValue(row, "mindamage"), 
-                        table.getIntValue(row, "maxdamage"));
-        weapon.setRequiredStrength(table.getIntValue(row, "reqstr"));
-        weapon.setRequiredLevel(table.getIntValue(row, "level"));
+        weapon.setDamage(table.getInt(row, mindamage), 
+                        table.getInt(row, maxdamage));
+        weapon.setRequiredStrength(table.getInt(row, reqstr));
+        weapon.setRequiredLevel(table.getInt(row, level));
         
         // Set inventory size
-        int width = table.getIntValue(row, "invwidth");
-        int height = table.getIntValue(row, "invheight");
+        int width = table.getInt(row, invwidth);
+        int height = table.getInt(row, invheight);
         if (width > 0 && height > 0) {
             weapon.setSize(width, height);
         }
         
         // Check if two-handed
-        auto typeIt = row.find("type");
-        if (typeIt != row.end()) {
-            if (typeIt->second.find("2h") != std::string::npos) {
-                weapon.setTwoHanded(true);
-            }
+        if (table.getString(row, type).find("2h") != std::string_view::npos) {
+            weapon.setTwoHanded(true);
         }
         
         weapon.setEquipmentSlot(EquipmentSlot::MAIN_HAND);
-        items_.insert({nameIt->second, weapon});
+        items_.insert({itemName, weapon});
     }
     
     return true;
@@ -139,46 +199,52 @@ bool ItemDatabase::loadWeaponData(std::shared_ptr<d2portable::core::AssetManager
 
 bool ItemDatabase::loadMiscData(std::shared_ptr<d2portable::core::AssetManager> assetManager,
                                d2::utils::DataTableParser* parser) {
-    auto fileData = assetManager->loadFileData("data/misc.txt");
-    if (fileData.empty()) {
+    d2::utils::DataTable table;
+    if (!loadTable(assetManager, parser, "misc.txt", table)) {
         return false;
     }
     
-    std::string dataStr(fileData.begin(), fileData.end());
-    auto table = parser->parseExcel(dataStr);
+    // Resolve the columns once for every row
+    auto name = table.getColumn("name");
+    auto type = table.getColumn("type");
+    auto level = table.getColumn("level");
+    auto stackable = table.getColumn("stackable");
+    auto maxstack = table.getColumn("maxstack");
+    auto cost = table.getColumn("cost");
+    if (!name.isValid()) {
+        return true;
+    }
     
-    for (const auto& row : table.getAllRows()) {
-        auto nameIt = row.find("name");
-        if (nameIt == row.end()) continue;
+    for (size_t row = 0; row < table.getRowCount(); row++) {
+        std::string itemName(table.getString(row, name));
+        if (itemName.empty()) continue;
         
         // Determine item type from data
         ItemType itemType = ItemType::CONSUMABLE;
-        auto typeIt = row.find("type");
-        if (typeIt != row.end()) {
-            if (typeIt->second == "gold") {
-                itemType = ItemType::GOLD;
-            } else if (typeIt->second == "quest") {
-                itemType = ItemType::QUEST;
-            }
+        std::string_view miscType = table.getString(row, type);
+        if (miscType == "gold") {
+            itemType = ItemType::GOLD;
+        } else if (miscType == "quest") {
+            itemType = ItemType::QUEST;
         }
         
-        Item misc(nameIt->second, itemType);
+        Item misc(itemName, itemType);
         
         // Set misc properties
-        misc.setRequiredLevel(table.getIntValue(row, "level"));
+        misc.setRequiredLevel(table.getInt(row, level));
         
         // Check if stackable
-        if (table.getIntValue(row, "stackable") > 0) {
+        if (table.getInt(row, stackable) > 0) {
             misc.setStackable(true);
-            misc.setMaxStackSize(table.getIntValue(row, "maxstack"));
+            misc.setMaxStackSize(table.getInt(row, maxstack));
         }
         
         // For gold items, set the amount
         if (itemType == ItemType::GOLD) {
-            misc.setGoldAmount(table.getIntValue(row, "cost"));
+            misc.setGoldAmount(table.getInt(row, cost));
         }
         
-        items_.insert({nameIt->second, misc});
+        items_.insert({itemName, misc});
     }
     
     return true;
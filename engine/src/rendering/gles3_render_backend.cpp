@@ -24,6 +24,8 @@ void GLES3RenderBackend::texImage2D(GLenum target, GLint level, GLint internalfo
 }
 void GLES3RenderBackend::texParameteri(GLenum target, GLenum pname, GLint param) { ::glTexParameteri(target, pname, param); }
 void GLES3RenderBackend::deleteTextures(GLsizei n, const GLuint* textures) { ::glDeleteTextures(n, textures); }
+void GLES3RenderBackend::activeTexture(GLenum texture) { ::glActiveTexture(texture); }
+void GLES3RenderBackend::pixelStorei(GLenum pname, GLint param) { ::glPixelStorei(pname, param); }
 
 GLuint GLES3RenderBackend::createShader(GLenum shaderType) { return ::glCreateShader(shaderType); }
 void GLES3RenderBackend::shaderSource(GLuint shader, GLsizei count, const char* const* string, const GLint* length) { ::glShaderSource(shader, count, string, length); }
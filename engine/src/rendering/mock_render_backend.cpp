@@ -29,7 +29,11 @@ void MockRenderBackend::bufferData(GLenum /*target*/, GLsizeiptr size, const voi
     }
 }
 
-void MockRenderBackend::bufferSubData(GLenum /*target*/, GLintptr offset, GLsizeiptr size, const void* /*data*/) {
+void MockRenderBackend::bufferSubData(GLenum /*target*/, GLintptr offset, GLsizeiptr size, const void* data) {
+    if (data && size > 0) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        lastBufferSubData_.assign(bytes, bytes + size);
+    }
     if (currentlyBoundBuffer_ != 0) {
         auto it = vboSizes_.find(currentlyBoundBuffer_);
         if (it != vboSizes_.end()) {
@@ -83,13 +87,14 @@ void MockRenderBackend::genTextures(GLsizei n, GLuint* textures) {
     }
 }
 
-void MockRenderBackend::bindTexture(GLenum target, GLuint /*texture*/) {
+void MockRenderBackend::bindTexture(GLenum target, GLuint texture) {
     if (currentError_ == GL_NO_ERROR_VALUE) {
         if (target != GL_TEXTURE_2D_VALUE) {
             currentError_ = GL_INVALID_ENUM_VALUE;
             return;
         }
     }
+    boundTextures_[activeTextureUnit_] = texture;
 }
 
 void MockRenderBackend::texImage2D(GLenum target, GLint level, GLint internalformat,
@@ -106,7 +111,11 @@ void MockRenderBackend::texImage2D(GLenum target, GLint level, GLint internalfor
             currentError_ = GL_INVALID_VALUE_VALUE;
             return;
         }
-        if (internalformat != static_cast<GLint>(format)) {
+        // Unsized formats must match; sized ones must match their base format
+        bool matches = internalformat == static_cast<GLint>(format) ||
+                       (internalformat == static_cast<GLint>(GL_RGBA8_VALUE) && format == GL_RGBA_VALUE) ||
+                       (internalformat == static_cast<GLint>(GL_R8_VALUE) && format == GL_RED_VALUE);
+        if (!matches) {
             currentError_ = GL_INVALID_OPERATION_VALUE;
             return;
         }
@@ -115,6 +124,11 @@ void MockRenderBackend::texImage2D(GLenum target, GLint level, GLint internalfor
             return;
         }
     }
+
+    size_t bytes_per_pixel = (format == GL_RED_VALUE) ? 1 : 4;
+    size_t bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * bytes_per_pixel;
+    texImage2DCalls_.push_back({boundTextures_[activeTextureUnit_], internalformat, width, height, format, bytes});
+    textureBytesUploaded_ += bytes;
 }
 
 void MockRenderBackend::texParameteri(GLenum target, GLenum pname, GLint param) {
@@ -150,6 +164,27 @@ void MockRenderBackend::deleteTextures(GLsizei n, const GLuint* textures) {
     }
 }
 
+void MockRenderBackend::activeTexture(GLenum texture) {
+    const GLenum MAX_TEXTURE_UNITS = 16;
+    if (texture < GL_TEXTURE0_VALUE || texture >= GL_TEXTURE0_VALUE + MAX_TEXTURE_UNITS) {
+        currentError_ = GL_INVALID_ENUM_VALUE;
+        return;
+    }
+    activeTextureUnit_ = texture;
+}
+
+void MockRenderBackend::pixelStorei(GLenum pname, GLint param) {
+    if (pname != GL_UNPACK_ALIGNMENT_VALUE) {
+        currentError_ = GL_INVALID_ENUM_VALUE;
+        return;
+    }
+    if (param != 1 && param != 2 && param != 4 && param != 8) {
+        currentError_ = GL_INVALID_VALUE_VALUE;
+        return;
+    }
+    unpackAlignment_ = param;
+}
+
 // --- Shader operations ---
 
 GLuint MockRenderBackend::createShader(GLenum /*shaderType*/) {
@@ -294,4 +329,30 @@ const std::vector<DrawElementsCall>& MockRenderBackend::getDrawElementsCalls() c
     return drawElementsCalls_;
 }
 
+void MockRenderBackend::resetTextureUploadTracking() {
+    texImage2DCalls_.clear();
+    textureBytesUploaded_ = 0;
+}
+
+const std::vector<TexImage2DCall>& MockRenderBackend::getTexImage2DCalls() const {
+    return texImage2DCalls_;
+}
+
+size_t MockRenderBackend::getTextureBytesUploaded() const {
+    return textureBytesUploaded_;
+}
+
+const std::vector<uint8_t>& MockRenderBackend::getLastBufferSubData() const {
+    return lastBufferSubData_;
+}
+
+GLuint MockRenderBackend::getBoundTexture(GLenum unit) const {
+    auto it = boundTextures_.find(unit);
+    return (it != boundTextures_.end()) ? it->second : 0;
+}
+
+GLint MockRenderBackend::getUnpackAlignment() const {
+    return unpackAlignment_;
+}
+
 } // namespace d2::rendering
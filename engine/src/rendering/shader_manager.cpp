@@ -65,6 +65,8 @@ uint32_t ShaderManager::createProgram(uint32_t vertex_shader, uint32_t fragment_
     info.uniform_locations["u_color"] = 1;
     info.uniform_locations["u_texture"] = 2;
     info.uniform_locations["u_mvp"] = 3;
+    info.uniform_locations["u_palette"] = 4;
+    info.uniform_locations["u_tint"] = 5;
 
     return program_id;
 }
@@ -111,4 +113,88 @@ bool ShaderManager::setUniform4f(uint32_t program_id, const std::string& name, f
     return true;
 }
 
+bool ShaderManager::setUniform1i(uint32_t program_id, const std::string& name, int value) {
+    int location = getUniformLocation(program_id, name);
+    if (location < 0) {
+        return false;
+    }
+
+    (void)value;
+    return true;
+}
+
+std::string ShaderManager::getSpriteVertexShaderSource() {
+    return R"(
+        #version 300 es
+        layout(location = 0) in vec2 a_position;
+        layout(location = 1) in vec2 a_texcoord;
+        uniform mat4 u_projection;
+        out vec2 v_texcoord;
+        void main() {
+            gl_Position = u_projection * vec4(a_position, 0.0, 1.0);
+            v_texcoord = a_texcoord;
+        }
+    )";
+}
+
+std::string ShaderManager::getSpriteFragmentShaderSource(SpriteShaderVariant variant) {
+    if (variant == SpriteShaderVariant::PALETTED) {
+        // The index texture must be sampled with nearest filtering; the
+        // palette is fetched by texel so neighbouring entries never blend
+        return R"(
+        #version 300 es
+        precision mediump float;
+        in vec2 v_texcoord;
+        uniform sampler2D u_texture;
+        uniform sampler2D u_palette;
+        uniform vec4 u_tint;
+        out vec4 fragColor;
+        void main() {
+            int index = int(texture(u_texture, v_texcoord).r * 255.0 + 0.5);
+            fragColor = texelFetch(u_palette, ivec2(index, 0), 0) * u_tint;
+        }
+        )";
+    }
+
+    return R"(
+        #version 300 es
+        precision mediump float;
+        in vec2 v_texcoord;
+        uniform sampler2D u_texture;
+        out vec4 fragColor;
+        void main() {
+            fragColor = texture(u_texture, v_texcoord);
+        }
+    )";
+}
+
+uint32_t ShaderManager::getSpriteProgram(SpriteShaderVariant variant) {
+    auto it = sprite_programs_.find(static_cast<int>(variant));
+    if (it != sprite_programs_.end()) {
+        return it->second;
+    }
+
+    uint32_t vertex_shader = compileShader(ShaderType::VERTEX, getSpriteVertexShaderSource());
+    uint32_t fragment_shader = compileShader(ShaderType::FRAGMENT, getSpriteFragmentShaderSource(variant));
+    uint32_t program = createProgram(vertex_shader, fragment_shader);
+    if (vertex_shader != 0) {
+        deleteShader(vertex_shader);
+    }
+    if (fragment_shader != 0) {
+        deleteShader(fragment_shader);
+    }
+    if (program == 0) {
+        return 0;
+    }
+
+    setUniform1i(program, "u_texture", static_cast<int>(SPRITE_TEXTURE_UNIT));
+    if (variant == SpriteShaderVariant::PALETTED) {
+        setUniform1i(program, "u_palette", static_cast<int>(PALETTE_TEXTURE_UNIT));
+        setUniform4f(program, "u_tint", 1.0f, 1.0f, 1.0f, 1.0f);
+    }
+
+    sprite_programs_[static_cast<int>(variant)] = program;
+    return program;
+}
+
 } // namespace d2::rendering
@@ -19,49 +19,17 @@ SpriteRenderer::~SpriteRenderer() = default;
 
 bool SpriteRenderer::initialize(const Renderer& renderer, const TextureManager& texture_manager) {
     (void)renderer;
-    (void)texture_manager;
+    texture_manager_ = &texture_manager;
 
     // Create shader manager and compile sprite shaders
     shader_manager_ = std::make_unique<ShaderManager>();
 
-    const std::string vertex_shader_source = R"(
-        #version 300 es
-        layout(location = 0) in vec2 a_position;
-        layout(location = 1) in vec2 a_texcoord;
-        uniform mat4 u_projection;
-        out vec2 v_texcoord;
-        void main() {
-            gl_Position = u_projection * vec4(a_position, 0.0, 1.0);
-            v_texcoord = a_texcoord;
-        }
-    )";
-
-    const std::string fragment_shader_source = R"(
-        #version 300 es
-        precision mediump float;
-        in vec2 v_texcoord;
-        uniform sampler2D u_texture;
-        out vec4 fragColor;
-        void main() {
-            fragColor = texture(u_texture, v_texcoord);
-        }
-    )";
-
-    uint32_t vertex_shader = shader_manager_->compileShader(ShaderType::VERTEX, vertex_shader_source);
-    uint32_t fragment_shader = shader_manager_->compileShader(ShaderType::FRAGMENT, fragment_shader_source);
-
-    if (vertex_shader == 0 || fragment_shader == 0) {
-        return false;
-    }
-
-    shader_program_ = shader_manager_->createProgram(vertex_shader, fragment_shader);
-    if (shader_program_ == 0) {
+    shader_program_ = shader_manager_->getSpriteProgram(SpriteShaderVariant::RGBA);
+    paletted_shader_program_ = shader_manager_->getSpriteProgram(SpriteShaderVariant::PALETTED);
+    if (shader_program_ == 0 || paletted_shader_program_ == 0) {
         return false;
     }
 
-    shader_manager_->deleteShader(vertex_shader);
-    shader_manager_->deleteShader(fragment_shader);
-
     // Create VAO for sprite rendering
     vao_ = std::make_unique<VertexArrayObject>();
     if (!vao_->create()) {
@@ -88,6 +56,7 @@ void SpriteRenderer::beginFrame() {
     sprite_count_ = 0;
     textures_used_.clear();
     sprite_batches_.clear();
+    paletted_batches_.clear();
 
     auto* backend = RenderContext::getBackend();
 
@@ -101,10 +70,36 @@ void SpriteRenderer::beginFrame() {
     }
 }
 
-void SpriteRenderer::drawSprite(uint32_t texture_id, const glm::vec2& position, const glm::vec2& size) {
+void SpriteRenderer::trimQuad(uint32_t texture_id, glm::vec2& position, glm::vec2& size) const {
+    if (!texture_manager_) {
+        return;
+    }
+
+    TextureTrim trim = texture_manager_->getTextureTrim(texture_id);
+    uint32_t width = texture_manager_->getTextureWidth(texture_id);
+    uint32_t height = texture_manager_->getTextureHeight(texture_id);
+    if (trim.source_width == 0 || trim.source_height == 0 ||
+        (width == trim.source_width && height == trim.source_height)) {
+        return;
+    }
+
+    // Map the visible bounds from frame pixels into the requested size
+    float scale_x = size.x / static_cast<float>(trim.source_width);
+    float scale_y = size.y / static_cast<float>(trim.source_height);
+    position.x += static_cast<float>(trim.x) * scale_x;
+    position.y += static_cast<float>(trim.y) * scale_y;
+    size.x = static_cast<float>(width) * scale_x;
+    size.y = static_cast<float>(height) * scale_y;
+}
+
+void SpriteRenderer::drawSprite(uint32_t texture_id, const glm::vec2& frame_position, const glm::vec2& frame_size) {
     sprite_count_++;
     textures_used_.insert(texture_id);
 
+    glm::vec2 position = frame_position;
+    glm::vec2 size = frame_size;
+    trimQuad(texture_id, position, size);
+
     SpriteVertex v0{{position.x, position.y}, {0.0f, 0.0f}};
     SpriteVertex v1{{position.x + size.x, position.y}, {1.0f, 0.0f}};
     SpriteVertex v2{{position.x, position.y + size.y}, {0.0f, 1.0f}};
@@ -122,6 +117,42 @@ void SpriteRenderer::drawSprite(uint32_t texture_id, const glm::vec2& position,
     batch.vertices.push_back(v2);
 }
 
+void SpriteRenderer::drawPalettedSprite(uint32_t texture_id, uint32_t palette_texture_id,
+                                        const glm::vec2& frame_position, const glm::vec2& frame_size) {
+    sprite_count_++;
+    textures_used_.insert(texture_id);
+
+    glm::vec2 position = frame_position;
+    glm::vec2 size = frame_size;
+    trimQuad(texture_id, position, size);
+
+    SpriteVertex v0{{position.x, position.y}, {0.0f, 0.0f}};
+    SpriteVertex v1{{position.x + size.x, position.y}, {1.0f, 0.0f}};
+    SpriteVertex v2{{position.x, position.y + size.y}, {0.0f, 1.0f}};
+    SpriteVertex v3{{position.x + size.x, position.y + size.y}, {1.0f, 1.0f}};
+
+    // Sprites sharing both the index and the palette texture share a batch
+    uint64_t key = (static_cast<uint64_t>(palette_texture_id) << 32) | texture_id;
+    auto& batch = paletted_batches_[key];
+    batch.texture_id = texture_id;
+    batch.palette_texture_id = palette_texture_id;
+
+    batch.vertices.push_back(v0);
+    batch.vertices.push_back(v1);
+    batch.vertices.push_back(v2);
+
+    batch.vertices.push_back(v1);
+    batch.vertices.push_back(v3);
+    batch.vertices.push_back(v2);
+}
+
+void SpriteRenderer::setPaletteTint(float r, float g, float b, float a) {
+    palette_tint_[0] = r;
+    palette_tint_[1] = g;
+    palette_tint_[2] = b;
+    palette_tint_[3] = a;
+}
+
 void SpriteRenderer::endFrame() {
     auto* backend = RenderContext::getBackend();
 
@@ -149,6 +180,30 @@ void SpriteRenderer::endFrame() {
         }
     }
 
+    // Paletted sprites switch to the palette lookup shader; changing the
+    // tint or the palette texture never touches the index textures
+    if (!paletted_batches_.empty() && vertex_buffer_ && backend) {
+        backend->useProgram(paletted_shader_program_);
+        shader_manager_->setUniform4f(paletted_shader_program_, "u_tint", palette_tint_[0], palette_tint_[1],
+                                      palette_tint_[2], palette_tint_[3]);
+
+        for (const auto& [key, batch] : paletted_batches_) {
+            if (batch.vertices.empty()) {
+                continue;
+            }
+            vertex_buffer_->update(batch.vertices);
+            vertex_buffer_->bind();
+
+            backend->activeTexture(GL_TEXTURE0_VALUE + ShaderManager::PALETTE_TEXTURE_UNIT);
+            backend->bindTexture(GL_TEXTURE_2D_VALUE, batch.palette_texture_id);
+            backend->activeTexture(GL_TEXTURE0_VALUE + ShaderManager::SPRITE_TEXTURE_UNIT);
+            backend->bindTexture(GL_TEXTURE_2D_VALUE, batch.texture_id);
+
+            backend->drawArrays(GL_TRIANGLES_VALUE, 0, static_cast<GLsizei>(batch.vertices.size()));
+            draw_call_count_++;
+        }
+    }
+
     shader_program_active_ = false;
     if (shader_program_ != 0 && backend) {
         backend->useProgram(0);
@@ -171,6 +226,10 @@ uint32_t SpriteRenderer::getShaderProgram() const {
     return shader_program_;
 }
 
+uint32_t SpriteRenderer::getPalettedShaderProgram() const {
+    return paletted_shader_program_;
+}
+
 bool SpriteRenderer::isShaderProgramActive() const {
     return shader_program_active_;
 }
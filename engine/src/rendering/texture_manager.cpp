@@ -2,6 +2,8 @@
 #include "rendering/render_context.h"
 #include "rendering/render_backend.h"
 #include "sprites/dc6_parser.h"
+#include "sprites/frame_trim.h"
+#include <vector>
 
 namespace d2::rendering {
 
@@ -20,7 +22,7 @@ uint32_t TextureManager::uploadSprite(std::shared_ptr<sprites::DC6Sprite> sprite
         return 0;
     }
 
-    sprites::DC6Frame frame_info = sprite->getFrame(direction, frame);
+    sprites::DC6FrameView frame_info = sprite->getFrameView(direction, frame);
 
     std::vector<uint8_t> rgba_data = sprite->getFrameImage(direction, frame);
     if (rgba_data.empty()) {
@@ -41,7 +43,7 @@ uint32_t TextureManager::uploadSprite(std::shared_ptr<sprites::DC6Sprite> sprite
         return createTexture(rgba_data.data(), dimension, dimension);
     }
 
-    return createTexture(rgba_data.data(), frame_info.width, frame_info.height);
+    return uploadFrame(frame_info, rgba_data.data(), TextureFormat::RGBA);
 }
 
 bool TextureManager::isTextureValid(uint32_t texture_id) const {
@@ -49,7 +51,12 @@ bool TextureManager::isTextureValid(uint32_t texture_id) const {
 }
 
 uint32_t TextureManager::createTexture(const uint8_t* rgba_data, uint32_t width, uint32_t height) {
-    if (!rgba_data || width == 0 || height == 0) {
+    return uploadTexture(rgba_data, width, height, TextureFormat::RGBA);
+}
+
+uint32_t TextureManager::uploadTexture(const uint8_t* pixels, uint32_t width, uint32_t height,
+                                       TextureFormat format) {
+    if (!pixels || width == 0 || height == 0) {
         return 0;
     }
 
@@ -72,12 +79,21 @@ uint32_t TextureManager::createTexture(const uint8_t* rgba_data, uint32_t width,
 
     // Bind and upload texture data
     backend->bindTexture(GL_TEXTURE_2D_VALUE, gl_texture_id);
-    backend->texImage2D(GL_TEXTURE_2D_VALUE, 0, GL_RGBA_VALUE, width, height, 0,
-                        GL_RGBA_VALUE, GL_UNSIGNED_BYTE_VALUE, rgba_data);
+    if (format == TextureFormat::INDEXED) {
+        // Index rows are tightly packed, so their width need not be a multiple of 4
+        backend->pixelStorei(GL_UNPACK_ALIGNMENT_VALUE, 1);
+        backend->texImage2D(GL_TEXTURE_2D_VALUE, 0, GL_R8_VALUE, width, height, 0,
+                            GL_RED_VALUE, GL_UNSIGNED_BYTE_VALUE, pixels);
+        backend->pixelStorei(GL_UNPACK_ALIGNMENT_VALUE, 4);
+    } else {
+        backend->texImage2D(GL_TEXTURE_2D_VALUE, 0, GL_RGBA_VALUE, width, height, 0,
+                            GL_RGBA_VALUE, GL_UNSIGNED_BYTE_VALUE, pixels);
+    }
 
-    // Set texture parameters
-    backend->texParameteri(GL_TEXTURE_2D_VALUE, GL_TEXTURE_MIN_FILTER_VALUE, GL_LINEAR_VALUE);
-    backend->texParameteri(GL_TEXTURE_2D_VALUE, GL_TEXTURE_MAG_FILTER_VALUE, GL_LINEAR_VALUE);
+    // Set texture parameters; indices and palette entries must never be blended
+    GLint filter = (format == TextureFormat::RGBA) ? GL_LINEAR_VALUE : GL_NEAREST_VALUE;
+    backend->texParameteri(GL_TEXTURE_2D_VALUE, GL_TEXTURE_MIN_FILTER_VALUE, filter);
+    backend->texParameteri(GL_TEXTURE_2D_VALUE, GL_TEXTURE_MAG_FILTER_VALUE, filter);
 
     // Check for OpenGL errors
     GLenum error = backend->getError();
@@ -88,11 +104,62 @@ uint32_t TextureManager::createTexture(const uint8_t* rgba_data, uint32_t width,
 
     // Store texture info
     uint32_t texture_id = next_texture_id_++;
-    textures_[texture_id] = {width, height, gl_texture_id};
+    textures_[texture_id] = {width, height, gl_texture_id, format};
+
+    return texture_id;
+}
+
+uint32_t TextureManager::uploadFrame(const sprites::DC6FrameView& frame, const uint8_t* pixels,
+                                     TextureFormat format) {
+    // Trimming needs the frame's indices; frames without them are uploaded whole
+    size_t pixel_count = static_cast<size_t>(frame.width) * frame.height;
+    if (!trim_borders_ || !frame.pixels || frame.pixelCount != pixel_count) {
+        return uploadTexture(pixels, frame.width, frame.height, format);
+    }
+
+    d2portable::sprites::FrameRect bounds =
+        d2portable::sprites::findOpaqueBounds(frame.pixels, frame.width, frame.height);
+    if (bounds.empty()) {
+        // A blank frame still gets a texture, a single transparent pixel
+        bounds = {0, 0, 1, 1};
+    }
+
+    uint32_t texture_id;
+    if (bounds.width == frame.width && bounds.height == frame.height) {
+        texture_id = uploadTexture(pixels, frame.width, frame.height, format);
+    } else {
+        size_t bytes_per_pixel = (format == TextureFormat::INDEXED) ? 1 : 4;
+        std::vector<uint8_t> trimmed(static_cast<size_t>(bounds.width) * bounds.height * bytes_per_pixel);
+        d2portable::sprites::copyFrameRect(pixels, frame.width, bytes_per_pixel, bounds, trimmed.data());
+        texture_id = uploadTexture(trimmed.data(), bounds.width, bounds.height, format);
+    }
 
+    if (texture_id != 0) {
+        textures_[texture_id].trim = {bounds.x, bounds.y, frame.width, frame.height};
+    }
     return texture_id;
 }
 
+void TextureManager::setBorderTrimming(bool enabled) {
+    trim_borders_ = enabled;
+}
+
+bool TextureManager::isBorderTrimmingEnabled() const {
+    return trim_borders_;
+}
+
+TextureTrim TextureManager::getTextureTrim(uint32_t texture_id) const {
+    auto it = textures_.find(texture_id);
+    if (it == textures_.end()) {
+        return {};
+    }
+    if (it->second.trim.source_width == 0) {
+        // Untrimmed textures cover their whole source
+        return {0, 0, it->second.width, it->second.height};
+    }
+    return it->second.trim;
+}
+
 uint32_t TextureManager::getTextureWidth(uint32_t texture_id) const {
     auto it = textures_.find(texture_id);
     return (it != textures_.end()) ? it->second.width : 0;
@@ -103,6 +170,11 @@ uint32_t TextureManager::getTextureHeight(uint32_t texture_id) const {
     return (it != textures_.end()) ? it->second.height : 0;
 }
 
+TextureFormat TextureManager::getTextureFormat(uint32_t texture_id) const {
+    auto it = textures_.find(texture_id);
+    return (it != textures_.end()) ? it->second.format : TextureFormat::RGBA;
+}
+
 void TextureManager::setTextureWrapMode(uint32_t texture_id, TextureWrapMode wrap_mode) {
     auto it = textures_.find(texture_id);
     if (it == textures_.end()) {
@@ -142,7 +214,7 @@ uint32_t TextureManager::uploadSpriteWithPalette(std::shared_ptr<sprites::DC6Spr
         return 0;
     }
 
-    sprites::DC6Frame frame_info = sprite->getFrame(direction, frame);
+    sprites::DC6FrameView frame_info = sprite->getFrameView(direction, frame);
 
     std::vector<uint8_t> rgba_data = sprite->getFrameImageWithPalette(direction, frame, palette);
     if (rgba_data.empty()) {
@@ -163,7 +235,88 @@ uint32_t TextureManager::uploadSpriteWithPalette(std::shared_ptr<sprites::DC6Spr
         return createTexture(rgba_data.data(), dimension, dimension);
     }
 
-    return createTexture(rgba_data.data(), frame_info.width, frame_info.height);
+    return uploadFrame(frame_info, rgba_data.data(), TextureFormat::RGBA);
+}
+
+uint32_t TextureManager::uploadSpriteIndexed(std::shared_ptr<sprites::DC6Sprite> sprite,
+                                             uint32_t direction, uint32_t frame) {
+    if (!sprite) {
+        return 0;
+    }
+
+    if (direction >= sprite->getDirectionCount() ||
+        frame >= sprite->getFramesPerDirection()) {
+        return 0;
+    }
+
+    // The frame's palette indices are uploaded as they are, without expanding them
+    sprites::DC6FrameView frame_info = sprite->getFrameView(direction, frame);
+    if (frame_info.empty() ||
+        frame_info.pixelCount != static_cast<size_t>(frame_info.width) * frame_info.height) {
+        return 0;
+    }
+
+    return uploadFrame(frame_info, frame_info.pixels, TextureFormat::INDEXED);
+}
+
+uint32_t TextureManager::createIndexedTexture(const uint8_t* indices, uint32_t width, uint32_t height) {
+    return uploadTexture(indices, width, height, TextureFormat::INDEXED);
+}
+
+uint32_t TextureManager::createPaletteTexture(const std::vector<uint32_t>& palette) {
+    if (palette.size() != 256) {
+        return 0;
+    }
+
+    auto* backend = RenderContext::getBackend();
+    if (!backend) return 0;
+
+    GLuint gl_texture_id;
+    backend->genTextures(1, &gl_texture_id);
+    if (gl_texture_id == 0) {
+        return 0;
+    }
+
+    if (!uploadPalette(gl_texture_id, palette)) {
+        backend->deleteTextures(1, &gl_texture_id);
+        return 0;
+    }
+
+    uint32_t texture_id = next_texture_id_++;
+    textures_[texture_id] = {256, 1, gl_texture_id, TextureFormat::PALETTE};
+    return texture_id;
+}
+
+bool TextureManager::updatePaletteTexture(uint32_t texture_id, const std::vector<uint32_t>& palette) {
+    auto it = textures_.find(texture_id);
+    if (it == textures_.end() || it->second.format != TextureFormat::PALETTE || palette.size() != 256) {
+        return false;
+    }
+
+    return uploadPalette(it->second.gl_texture_id, palette);
+}
+
+bool TextureManager::uploadPalette(uint32_t gl_texture_id, const std::vector<uint32_t>& palette) {
+    auto* backend = RenderContext::getBackend();
+    if (!backend) return false;
+
+    // Colors are stored as R | G << 8 | B << 16 | A << 24
+    uint8_t rgba_data[256 * 4];
+    for (size_t i = 0; i < 256; ++i) {
+        rgba_data[i * 4 + 0] = palette[i] & 0xFF;
+        rgba_data[i * 4 + 1] = (palette[i] >> 8) & 0xFF;
+        rgba_data[i * 4 + 2] = (palette[i] >> 16) & 0xFF;
+        rgba_data[i * 4 + 3] = (palette[i] >> 24) & 0xFF;
+    }
+
+    backend->getError();
+    backend->bindTexture(GL_TEXTURE_2D_VALUE, gl_texture_id);
+    backend->texImage2D(GL_TEXTURE_2D_VALUE, 0, GL_RGBA_VALUE, 256, 1, 0,
+                        GL_RGBA_VALUE, GL_UNSIGNED_BYTE_VALUE, rgba_data);
+    backend->texParameteri(GL_TEXTURE_2D_VALUE, GL_TEXTURE_MIN_FILTER_VALUE, GL_NEAREST_VALUE);
+    backend->texParameteri(GL_TEXTURE_2D_VALUE, GL_TEXTURE_MAG_FILTER_VALUE, GL_NEAREST_VALUE);
+
+    return backend->getError() == GL_NO_ERROR_VALUE;
 }
 
 } // namespace d2::rendering
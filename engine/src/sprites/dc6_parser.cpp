@@ -1,52 +1,83 @@
 #include "sprites/dc6_parser.h"
+#include "sprites/palette_expand.h"
+#include "sprites/sprite_residency.h"
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
 #include <cstring>
+#include <list>
+#include <mutex>
+#include <atomic>
 
 namespace d2portable {
 namespace sprites {
 
-// DC6 RLE decompression
-std::vector<uint8_t> decompressRLE(const std::vector<uint8_t>& compressed_data, uint32_t expected_size) {
-    std::vector<uint8_t> decompressed;
-    decompressed.reserve(expected_size);
+namespace {
+
+// Flag in the DC6 header marking frames stored in the game's row encoding
+constexpr uint32_t kRowEncodedFlag = 0x1;
+
+// Decodes the game's row encoding straight into pixels, which must hold
+// width * height zeroed (transparent) bytes. Rows are stored bottom-up
+// unless the frame is flipped. 0x80 ends a row, any other byte with the
+// high bit set skips that many transparent pixels, and a byte without it
+// is followed by that many literal pixels.
+void decompressRows(const uint8_t* data, size_t size, uint32_t width, uint32_t height,
+                    bool top_down, uint8_t* pixels) {
+    const uint8_t* pos = data;
+    const uint8_t* end = data + size;
+    uint32_t row = 0;
+    size_t x = 0;
     
+    while (pos < end && row < height) {
+        uint8_t command = *pos++;
+        if (command == 0x80) {
+            row++;
+            x = 0;
+        } else if (command & 0x80) {
+            x += command & 0x7F;
+        } else {
+            size_t count = std::min<size_t>(command, end - pos);
+            if (x < width) {
+                uint8_t* line = pixels + static_cast<size_t>(top_down ? row : height - 1 - row) * width;
+                std::memcpy(line + x, pos, std::min<size_t>(count, width - x));
+            }
+            pos += count;
+            x += count;
+        }
+    }
+}
+
+// Decodes the run encoding written by older tools straight into pixels,
+// which must hold pixel_count zeroed bytes. A byte with the high bit set
+// repeats the next byte (low bits) times, with a count of 0 ending the
+// frame; any other byte is followed by that many literal pixels.
+void decompressRLE(const uint8_t* data, size_t size, uint8_t* pixels, size_t pixel_count) {
     size_t pos = 0;
-    while (pos < compressed_data.size() && decompressed.size() < expected_size) {
-        uint8_t command = compressed_data[pos++];
-        
-        if (pos >= compressed_data.size()) break;
-        
+    size_t written = 0;
+    
+    // Every command is followed by at least one byte
+    while (pos + 1 < size && written < pixel_count) {
+        uint8_t command = data[pos++];
+        size_t count;
         if (command & 0x80) {
-            // RLE run: high bit set means repeat next byte
-            uint8_t count = command & 0x7F; // Remove high bit to get count
-            uint8_t pixel_value = compressed_data[pos++];
-            
-            // End marker check
+            uint8_t pixel_value = data[pos++];
+            count = std::min<size_t>(command & 0x7F, pixel_count - written);
             if (count == 0) {
                 break;
             }
-            
-            // Add repeated pixels
-            for (uint8_t i = 0; i < count && decompressed.size() < expected_size; i++) {
-                decompressed.push_back(pixel_value);
-            }
+            std::memset(pixels + written, pixel_value, count);
         } else {
-            // Raw data: copy next 'command' bytes directly
-            for (uint8_t i = 0; i < command && pos < compressed_data.size() && decompressed.size() < expected_size; i++) {
-                decompressed.push_back(compressed_data[pos++]);
-            }
+            count = std::min({static_cast<size_t>(command), size - pos, pixel_count - written});
+            std::memcpy(pixels + written, data + pos, count);
+            pos += count;
         }
+        written += count;
     }
-    
-    // Pad with transparent pixels if needed
-    while (decompressed.size() < expected_size) {
-        decompressed.push_back(0);
-    }
-    
-    return decompressed;
 }
 
+} // namespace
+
 // DC6 file header structure
 struct DC6Header {
     uint32_t version;
@@ -69,14 +100,58 @@ struct DC6FrameHeader {
     uint32_t length;
 };
 
+DC6FrameView DC6Sprite::getFrameView(uint32_t direction, uint32_t frame) const {
+    auto copy = std::make_shared<DC6Frame>(getFrame(direction, frame));
+    DC6FrameView view;
+    view.width = copy->width;
+    view.height = copy->height;
+    view.offsetX = copy->offsetX;
+    view.offsetY = copy->offsetY;
+    view.pixels = copy->pixelData.data();
+    view.pixelCount = copy->pixelData.size();
+    view.owner = std::move(copy);
+    return view;
+}
+
+size_t DC6Sprite::expandFrame(uint32_t direction, uint32_t frame, const uint32_t* palette,
+                              uint8_t* rgba, size_t capacity) const {
+    auto view = getFrameView(direction, frame);
+    if (view.empty() || capacity / 4 < view.pixelCount) {
+        return 0;
+    }
+    expandPalette(view.pixels, view.pixelCount, palette, rgba);
+    return view.pixelCount;
+}
+
+// Where a frame's encoded pixels live in the file
+struct EncodedFrame {
+    DC6FrameHeader header;
+    size_t data_offset;
+    bool valid;
+};
+
 // Implementation of DC6Sprite
-class DC6SpriteImpl : public DC6Sprite {
+//
+// Keeps the file bytes and decodes a frame the first time it is requested.
+// Decoded frames are held in an LRU cache bounded by frame_cache_budget
+// bytes; the most recently used frame is always kept. With a residency
+// the frames are charged to their direction there instead, and the
+// residency decides which directions to drop. Views own their frame, so
+// evicting it never invalidates a view already handed out.
+class DC6SpriteImpl : public DC6Sprite, public ResidentSprite {
 public:
-    DC6SpriteImpl(uint32_t dirs, uint32_t frames) 
-        : directions(dirs), frames_per_dir(frames) {
-        frames_data.resize(dirs);
-        for (auto& dir : frames_data) {
-            dir.resize(frames_per_dir);
+    DC6SpriteImpl(uint32_t dirs, uint32_t frames, bool row_encoded, std::vector<uint8_t> file_data,
+                  std::vector<EncodedFrame> encoded_frames, size_t frame_cache_budget,
+                  std::shared_ptr<SpriteResidency> residency)
+        : directions(dirs), frames_per_dir(frames), row_encoded(row_encoded),
+          file_data(std::move(file_data)), encoded_frames(std::move(encoded_frames)),
+          frame_cache_budget(frame_cache_budget), residency(std::move(residency)),
+          direction_use(new std::atomic<uint64_t>[dirs]()),
+          decoded_frames(this->encoded_frames.size()), lru_positions(this->encoded_frames.size()) {}
+    
+    ~DC6SpriteImpl() override {
+        if (residency) {
+            residency->forget(this);
         }
     }
     
@@ -92,78 +167,173 @@ public:
         if (direction >= directions || frame >= frames_per_dir) {
             return DC6Frame{};
         }
-        return frames_data[direction][frame];
+        return *decodedFrame(direction * frames_per_dir + frame);
+    }
+    
+    DC6FrameView getFrameView(uint32_t direction, uint32_t frame) const override {
+        DC6FrameView view;
+        if (direction >= directions || frame >= frames_per_dir) {
+            return view;
+        }
+        auto dc6_frame = decodedFrame(direction * frames_per_dir + frame);
+        view.width = dc6_frame->width;
+        view.height = dc6_frame->height;
+        view.offsetX = dc6_frame->offsetX;
+        view.offsetY = dc6_frame->offsetY;
+        view.pixels = dc6_frame->pixelData.data();
+        view.pixelCount = dc6_frame->pixelData.size();
+        view.owner = std::move(dc6_frame);
+        return view;
     }
     
     std::vector<uint8_t> getFrameImage(uint32_t direction, uint32_t frame) const override {
-        auto dc6_frame = getFrame(direction, frame);
-        std::vector<uint8_t> rgba_data;
-        
-        if (dc6_frame.pixelData.empty()) {
-            return rgba_data;
+        // For now, just use grayscale (no palette)
+        return expandToRGBA(direction, frame, getGrayscalePalette());
+    }
+    
+    std::vector<uint8_t> getFrameImageWithPalette(uint32_t direction, uint32_t frame, 
+                                                  const std::vector<uint32_t>& palette) const override {
+        // Check if palette is valid (must have 256 colors)
+        if (palette.size() != 256) {
+            // Fall back to grayscale conversion
+            return getFrameImage(direction, frame);
         }
         
-        // Convert palette indexed data to RGBA
-        rgba_data.reserve(dc6_frame.width * dc6_frame.height * 4);
-        
-        for (uint8_t pixel : dc6_frame.pixelData) {
-            // For now, just use grayscale (no palette)
-            rgba_data.push_back(pixel);  // R
-            rgba_data.push_back(pixel);  // G
-            rgba_data.push_back(pixel);  // B
-            rgba_data.push_back(255);     // A
+        return expandToRGBA(direction, frame, palette.data());
+    }
+    
+    size_t getEncodedSize() const override {
+        return file_data.size();
+    }
+    
+    uint64_t getDirectionLastUse(uint32_t direction) const override {
+        return direction < directions ? direction_use[direction].load(std::memory_order_relaxed) : 0;
+    }
+    
+    size_t evictDirection(uint32_t direction) const override {
+        if (direction >= directions) {
+            return 0;
         }
-        
-        return rgba_data;
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        size_t released = 0;
+        size_t first = static_cast<size_t>(direction) * frames_per_dir;
+        for (size_t index = first; index < first + frames_per_dir; index++) {
+            if (decoded_frames[index]) {
+                released += decoded_frames[index]->pixelData.size();
+                lru.erase(lru_positions[index]);
+                decoded_frames[index].reset();
+            }
+        }
+        decoded_bytes -= released;
+        return released;
     }
     
-    std::vector<uint8_t> getFrameImageWithPalette(uint32_t direction, uint32_t frame, 
-                                                  const std::vector<uint32_t>& palette) const override {
-        auto dc6_frame = getFrame(direction, frame);
+private:
+    std::vector<uint8_t> expandToRGBA(uint32_t direction, uint32_t frame, const uint32_t* palette) const {
+        auto dc6_frame = getFrameView(direction, frame);
         std::vector<uint8_t> rgba_data;
         
-        if (dc6_frame.pixelData.empty()) {
+        if (dc6_frame.empty()) {
             return rgba_data;
         }
         
-        // Check if palette is valid (must have 256 colors)
-        if (palette.size() != 256) {
-            // Fall back to grayscale conversion
-            return getFrameImage(direction, frame);
+        rgba_data.resize(dc6_frame.pixelCount * 4);
+        expandPalette(dc6_frame.pixels, dc6_frame.pixelCount, palette, rgba_data.data());
+        return rgba_data;
+    }
+    
+    std::shared_ptr<const DC6Frame> decodedFrame(size_t index) const {
+        uint32_t direction = static_cast<uint32_t>(index / frames_per_dir);
+        if (residency) {
+            direction_use[direction].store(residency->touch(), std::memory_order_relaxed);
         }
         
-        // Convert palette indexed data to RGBA using the provided palette
-        rgba_data.reserve(dc6_frame.width * dc6_frame.height * 4);
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (decoded_frames[index]) {
+                lru.splice(lru.begin(), lru, lru_positions[index]);
+                return decoded_frames[index];
+            }
+        }
         
-        for (uint8_t pixel_index : dc6_frame.pixelData) {
-            // Get color from palette
-            uint32_t color = palette[pixel_index];
-            
-            // Extract RGBA components
-            uint8_t r = color & 0xFF;
-            uint8_t g = (color >> 8) & 0xFF;
-            uint8_t b = (color >> 16) & 0xFF;
-            uint8_t a = (color >> 24) & 0xFF;
+        // Decode outside the lock; if another thread wins the race its
+        // frame is kept and this one is dropped
+        auto dc6_frame = decode(encoded_frames[index]);
+        
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (decoded_frames[index]) {
+                lru.splice(lru.begin(), lru, lru_positions[index]);
+                return decoded_frames[index];
+            }
+            decoded_frames[index] = dc6_frame;
+            lru.push_front(index);
+            lru_positions[index] = lru.begin();
+            decoded_bytes += dc6_frame->pixelData.size();
             
-            rgba_data.push_back(r);
-            rgba_data.push_back(g);
-            rgba_data.push_back(b);
-            rgba_data.push_back(a);
+            while (!residency && decoded_bytes > frame_cache_budget && lru.size() > 1) {
+                size_t evicted = lru.back();
+                lru.pop_back();
+                decoded_bytes -= decoded_frames[evicted]->pixelData.size();
+                decoded_frames[evicted].reset();
+            }
         }
         
-        return rgba_data;
+        // The residency may evict from this sprite, so charge it unlocked
+        if (residency) {
+            residency->charge(this, direction, dc6_frame->pixelData.size());
+        }
+        return dc6_frame;
     }
     
-    void setFrame(uint32_t direction, uint32_t frame, const DC6Frame& frame_data) {
-        if (direction < directions && frame < frames_per_dir) {
-            frames_data[direction][frame] = frame_data;
+    std::shared_ptr<const DC6Frame> decode(const EncodedFrame& encoded) const {
+        auto dc6_frame = std::make_shared<DC6Frame>();
+        if (!encoded.valid) {
+            // Frames whose data lies outside the file stay empty
+            return dc6_frame;
         }
+        
+        const DC6FrameHeader& frame_header = encoded.header;
+        dc6_frame->width = frame_header.width;
+        dc6_frame->height = frame_header.height;
+        dc6_frame->offsetX = frame_header.offset_x;
+        dc6_frame->offsetY = frame_header.offset_y;
+        
+        const uint8_t* raw_data = file_data.data() + encoded.data_offset;
+        
+        // Check if data needs RLE decompression
+        size_t expected_size = static_cast<size_t>(frame_header.width) * frame_header.height;
+        if (frame_header.length == expected_size) {
+            // Data is already uncompressed
+            dc6_frame->pixelData.assign(raw_data, raw_data + frame_header.length);
+            return dc6_frame;
+        }
+        
+        // Decode into the zeroed frame; pixels the encoding skips stay transparent
+        dc6_frame->pixelData.resize(expected_size);
+        if (row_encoded) {
+            decompressRows(raw_data, frame_header.length, frame_header.width, frame_header.height,
+                           frame_header.flip != 0, dc6_frame->pixelData.data());
+        } else {
+            decompressRLE(raw_data, frame_header.length, dc6_frame->pixelData.data(), expected_size);
+        }
+        return dc6_frame;
     }
     
-private:
     uint32_t directions;
     uint32_t frames_per_dir;
-    std::vector<std::vector<DC6Frame>> frames_data;
+    bool row_encoded;
+    std::vector<uint8_t> file_data;
+    std::vector<EncodedFrame> encoded_frames;
+    size_t frame_cache_budget;
+    std::shared_ptr<SpriteResidency> residency;
+    std::unique_ptr<std::atomic<uint64_t>[]> direction_use;
+    
+    mutable std::mutex cache_mutex;
+    mutable std::vector<std::shared_ptr<const DC6Frame>> decoded_frames;
+    mutable std::list<size_t> lru;
+    mutable std::vector<std::list<size_t>::iterator> lru_positions;
+    mutable size_t decoded_bytes = 0;
 };
 
 // DC6Parser implementation
@@ -172,67 +342,27 @@ std::unique_ptr<DC6Sprite> DC6Parser::parseFile(const std::string& filepath) {
         return nullptr;
     }
     
-    std::ifstream file(filepath, std::ios::binary);
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         return nullptr;
     }
     
-    // Read header
-    DC6Header header;
-    file.read(reinterpret_cast<char*>(&header), sizeof(DC6Header));
-    
-    if (!file.good() || header.version != 6) {
+    // Frames are decoded from the file bytes on demand, so read them all
+    std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!file.good()) {
         return nullptr;
     }
     
-    // Read frame pointers
-    std::vector<uint32_t> frame_pointers(header.directions * header.frames_per_dir);
-    file.read(reinterpret_cast<char*>(frame_pointers.data()), 
-              frame_pointers.size() * sizeof(uint32_t));
-    
-    // Create sprite
-    auto sprite = std::make_unique<DC6SpriteImpl>(header.directions, header.frames_per_dir);
-    
-    // Read each frame
-    for (uint32_t dir = 0; dir < header.directions; dir++) {
-        for (uint32_t frame = 0; frame < header.frames_per_dir; frame++) {
-            uint32_t idx = dir * header.frames_per_dir + frame;
-            file.seekg(frame_pointers[idx]);
-            
-            // Read frame header
-            DC6FrameHeader frame_header;
-            file.read(reinterpret_cast<char*>(&frame_header), sizeof(DC6FrameHeader));
-            
-            // Read pixel data
-            DC6Frame dc6_frame;
-            dc6_frame.width = frame_header.width;
-            dc6_frame.height = frame_header.height;
-            dc6_frame.offsetX = frame_header.offset_x;
-            dc6_frame.offsetY = frame_header.offset_y;
-            
-            // Read pixel data
-            std::vector<uint8_t> raw_data(frame_header.length);
-            file.read(reinterpret_cast<char*>(raw_data.data()), 
-                      frame_header.length);
-            
-            // Check if data needs RLE decompression
-            uint32_t expected_size = frame_header.width * frame_header.height;
-            if (frame_header.length == expected_size) {
-                // Data is already uncompressed
-                dc6_frame.pixelData = raw_data;
-            } else {
-                // Data is RLE compressed
-                dc6_frame.pixelData = decompressRLE(raw_data, expected_size);
-            }
-            
-            sprite->setFrame(dir, frame, dc6_frame);
-        }
-    }
-    
-    return sprite;
+    return parseData(std::move(data));
 }
 
 std::unique_ptr<DC6Sprite> DC6Parser::parseData(const std::vector<uint8_t>& data) {
+    return parseData(std::vector<uint8_t>(data));
+}
+
+std::unique_ptr<DC6Sprite> DC6Parser::parseData(std::vector<uint8_t>&& data) {
     if (data.size() < sizeof(DC6Header)) {
         return nullptr;
     }
@@ -246,67 +376,56 @@ std::unique_ptr<DC6Sprite> DC6Parser::parseData(const std::vector<uint8_t>& data
     }
     
     // Calculate required size
-    size_t required_size = sizeof(DC6Header) + 
-                          (header.directions * header.frames_per_dir * sizeof(uint32_t));
+    size_t frame_count = static_cast<size_t>(header.directions) * header.frames_per_dir;
+    size_t required_size = sizeof(DC6Header) + frame_count * sizeof(uint32_t);
     if (data.size() < required_size) {
         return nullptr;
     }
     
     // Read frame pointers
-    std::vector<uint32_t> frame_pointers(header.directions * header.frames_per_dir);
+    std::vector<uint32_t> frame_pointers(frame_count);
     std::memcpy(frame_pointers.data(), 
                 data.data() + sizeof(DC6Header), 
                 frame_pointers.size() * sizeof(uint32_t));
     
-    // Create sprite
-    auto sprite = std::make_unique<DC6SpriteImpl>(header.directions, header.frames_per_dir);
-    
-    // Read each frame
-    for (uint32_t dir = 0; dir < header.directions; dir++) {
-        for (uint32_t frame = 0; frame < header.frames_per_dir; frame++) {
-            uint32_t idx = dir * header.frames_per_dir + frame;
-            uint32_t offset = frame_pointers[idx];
-            
-            if (offset + sizeof(DC6FrameHeader) > data.size()) {
-                continue; // Skip invalid frame
-            }
-            
-            // Read frame header
-            DC6FrameHeader frame_header;
-            std::memcpy(&frame_header, data.data() + offset, sizeof(DC6FrameHeader));
-            
-            // Create frame
-            DC6Frame dc6_frame;
-            dc6_frame.width = frame_header.width;
-            dc6_frame.height = frame_header.height;
-            dc6_frame.offsetX = frame_header.offset_x;
-            dc6_frame.offsetY = frame_header.offset_y;
-            
-            // Check if we have enough data for the pixels
-            uint32_t pixel_offset = offset + sizeof(DC6FrameHeader);
-            if (pixel_offset + frame_header.length > data.size()) {
-                continue; // Skip frame with invalid data
-            }
-            
-            // Extract pixel data
-            std::vector<uint8_t> raw_data(data.begin() + pixel_offset,
-                                         data.begin() + pixel_offset + frame_header.length);
-            
-            // Check if data needs RLE decompression
-            uint32_t expected_size = frame_header.width * frame_header.height;
-            if (frame_header.length == expected_size) {
-                // Data is already uncompressed
-                dc6_frame.pixelData = raw_data;
-            } else {
-                // Data is RLE compressed
-                dc6_frame.pixelData = decompressRLE(raw_data, expected_size);
-            }
-            
-            sprite->setFrame(dir, frame, dc6_frame);
+    // Locate each frame; pixels are decoded when the frame is first used
+    std::vector<EncodedFrame> encoded_frames(frame_count);
+    for (size_t idx = 0; idx < frame_count; idx++) {
+        EncodedFrame& encoded = encoded_frames[idx];
+        encoded.valid = false;
+        
+        size_t offset = frame_pointers[idx];
+        if (offset + sizeof(DC6FrameHeader) > data.size()) {
+            continue; // Skip invalid frame
+        }
+        
+        // Read frame header
+        std::memcpy(&encoded.header, data.data() + offset, sizeof(DC6FrameHeader));
+        
+        // Check if we have enough data for the pixels
+        encoded.data_offset = offset + sizeof(DC6FrameHeader);
+        if (encoded.data_offset + encoded.header.length > data.size()) {
+            continue; // Skip frame with invalid data
         }
+        encoded.valid = true;
     }
     
-    return sprite;
+    bool row_encoded = (header.flags & kRowEncodedFlag) != 0;
+    return std::make_unique<DC6SpriteImpl>(header.directions, header.frames_per_dir, row_encoded,
+                                           std::move(data), std::move(encoded_frames),
+                                           frame_cache_budget, residency);
+}
+
+void DC6Parser::setFrameCacheBudget(size_t bytes) {
+    frame_cache_budget = bytes;
+}
+
+size_t DC6Parser::getFrameCacheBudget() const {
+    return frame_cache_budget;
+}
+
+void DC6Parser::setResidency(std::shared_ptr<SpriteResidency> residency) {
+    this->residency = std::move(residency);
 }
 
 std::vector<uint32_t> DC6Parser::getDefaultPalette() const {
@@ -0,0 +1,717 @@
+#include "sprites/dcc_parser.h"
+#include "sprites/palette_expand.h"
+#include "sprites/sprite_residency.h"
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <atomic>
+
+namespace d2portable {
+namespace sprites {
+
+namespace {
+
+constexpr uint8_t kDCCSignature = 0x74;
+constexpr uint8_t kDCCVersion = 6;
+
+// Signature, version, direction count, frames per direction, tag, total size
+constexpr size_t kFileHeaderSize = 15;
+
+// Largest direction canvas accepted
+constexpr int64_t kMaxDirectionSide = 8192;
+constexpr int64_t kMaxDirectionPixels = 16 * 1024 * 1024;
+
+// Field widths selected by the 4-bit codes in a direction header
+constexpr uint8_t kFieldBits[16] = {0, 1, 2, 4, 6, 8, 10, 12, 14, 16, 20, 24, 26, 28, 30, 32};
+
+// Number of pixel values a 4-bit cell mask selects
+constexpr uint8_t kMaskPixels[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+// Reads bit fields least significant bit first. Reading past the end
+// yields zero bits and marks the reader as overrun.
+class BitReader {
+public:
+    BitReader() = default;
+    BitReader(const uint8_t* data, size_t size, size_t bit_position)
+        : data(data), size(size), position(std::min(bit_position, size * 8)) {}
+
+    uint32_t read(uint32_t bits) {
+        if (bits == 0) {
+            return 0;
+        }
+        if (bits > size * 8 - position) {
+            position = size * 8;
+            overrun = true;
+            return 0;
+        }
+
+        // One unaligned little-endian load covers any field of up to 32 bits
+        size_t byte = position >> 3;
+        uint64_t word = 0;
+        if (size - byte >= sizeof(word)) {
+            std::memcpy(&word, data + byte, sizeof(word));
+        } else {
+            for (size_t i = 0; byte + i < size; i++) {
+                word |= static_cast<uint64_t>(data[byte + i]) << (i * 8);
+            }
+        }
+        word >>= position & 7;
+        position += bits;
+        return static_cast<uint32_t>(word & ((uint64_t(1) << bits) - 1));
+    }
+
+    int32_t readSigned(uint32_t bits) {
+        uint32_t value = read(bits);
+        if (bits > 0 && bits < 32 && (value & (1u << (bits - 1)))) {
+            value |= ~0u << bits;
+        }
+        return static_cast<int32_t>(value);
+    }
+
+    void skip(size_t bits) {
+        if (bits > size * 8 - position) {
+            position = size * 8;
+            overrun = true;
+            return;
+        }
+        position += bits;
+    }
+
+    void alignToByte() {
+        skip((8 - (position & 7)) & 7);
+    }
+
+    bool overran() const { return overrun; }
+
+    size_t remaining() const { return size * 8 - position; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+    bool overrun = false;
+};
+
+struct FrameBox {
+    uint32_t width;
+    uint32_t height;
+    int32_t x_offset;
+    int32_t y_offset;
+    int64_t left;
+    int64_t top;
+};
+
+// Rectangle of a frame in direction canvas coordinates
+struct Cell {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+};
+
+// The four pixel values of a cell and the frame cell that produced them
+struct PixelBufferEntry {
+    uint8_t values[4];
+    uint32_t frame;
+    uint32_t frame_cell;
+};
+
+// One 4x4 cell of the direction grid
+struct BufferCell {
+    int64_t entry;
+    int32_t last_x;
+    int32_t last_y;
+    int32_t last_width;
+    int32_t last_height;
+};
+
+// Every frame of a direction, decoded
+struct DecodedDirection {
+    std::vector<DC6Frame> frames;
+    size_t bytes = 0;
+};
+
+// Working memory for decoding a direction. A sprite keeps one and reuses
+// its buffers, so decoding further directions does not allocate them again.
+struct DCCScratchArena {
+    std::vector<FrameBox> frames;
+    std::vector<Cell> cells;
+    std::vector<size_t> first_cell;
+    std::vector<PixelBufferEntry> pixel_buffer;
+    std::vector<BufferCell> buffer_cells;
+    std::vector<uint8_t> canvas;
+};
+
+// Splits a frame into cells aligned to the direction's 4x4 grid; the first
+// and last cell in each row and column take up the misalignment
+void appendFrameCells(const FrameBox& frame, int64_t direction_left, int64_t direction_top,
+                      std::vector<Cell>& cells) {
+    auto split = [](int64_t origin, int64_t length, std::vector<int32_t>& sizes) {
+        int64_t first = 4 - (origin % 4);
+        sizes.clear();
+        if (length - first <= 1) {
+            sizes.push_back(static_cast<int32_t>(length));
+            return;
+        }
+        int64_t rest = length - first - 1;
+        int64_t count = 2 + rest / 4 - (rest % 4 == 0 ? 1 : 0);
+        sizes.push_back(static_cast<int32_t>(first));
+        for (int64_t i = 1; i < count - 1; i++) {
+            sizes.push_back(4);
+        }
+        sizes.push_back(static_cast<int32_t>(length - first - 4 * (count - 2)));
+    };
+
+    int64_t origin_x = frame.left - direction_left;
+    int64_t origin_y = frame.top - direction_top;
+    std::vector<int32_t> widths;
+    std::vector<int32_t> heights;
+    split(origin_x, frame.width, widths);
+    split(origin_y, frame.height, heights);
+
+    int32_t y = static_cast<int32_t>(origin_y);
+    for (int32_t height : heights) {
+        int32_t x = static_cast<int32_t>(origin_x);
+        for (int32_t width : widths) {
+            cells.push_back(Cell{x, y, width, height});
+            x += width;
+        }
+        y += height;
+    }
+}
+
+// Decodes every frame of the direction starting at byte offset. Returns
+// false if the direction is truncated or its geometry is unusable.
+bool decodeDirection(const uint8_t* data, size_t size, size_t offset, uint32_t frame_count,
+                     DCCScratchArena& arena, DecodedDirection& decoded) {
+    BitReader bits(data, size, offset * 8);
+    bits.read(32);  // Decoded size
+    uint32_t compression = bits.read(2);
+    uint32_t variable0_bits = kFieldBits[bits.read(4)];
+    uint32_t width_bits = kFieldBits[bits.read(4)];
+    uint32_t height_bits = kFieldBits[bits.read(4)];
+    uint32_t x_offset_bits = kFieldBits[bits.read(4)];
+    uint32_t y_offset_bits = kFieldBits[bits.read(4)];
+    uint32_t optional_bits = kFieldBits[bits.read(4)];
+    uint32_t coded_bytes_bits = kFieldBits[bits.read(4)];
+
+    // Every frame header has the same size, so the frame count must fit in
+    // what is left of the file before anything is allocated for it
+    size_t frame_header_bits = variable0_bits + width_bits + height_bits + x_offset_bits + y_offset_bits +
+                               optional_bits + coded_bytes_bits + 1;
+    if (bits.overran() || frame_count > bits.remaining() / frame_header_bits) {
+        return false;
+    }
+
+    // Frame headers and the bounding box of the frames that have pixels
+    arena.frames.resize(frame_count);
+    int64_t min_x = std::numeric_limits<int64_t>::max();
+    int64_t min_y = std::numeric_limits<int64_t>::max();
+    int64_t max_x = std::numeric_limits<int64_t>::min();
+    int64_t max_y = std::numeric_limits<int64_t>::min();
+    size_t optional_bytes = 0;
+    for (FrameBox& frame : arena.frames) {
+        bits.read(variable0_bits);
+        frame.width = bits.read(width_bits);
+        frame.height = bits.read(height_bits);
+        frame.x_offset = bits.readSigned(x_offset_bits);
+        frame.y_offset = bits.readSigned(y_offset_bits);
+        optional_bytes += bits.read(optional_bits);
+        bits.read(coded_bytes_bits);
+        if (bits.read(1) != 0) {
+            return false;  // Bottom-up frames are not used by the game's files
+        }
+        if (frame.width > kMaxDirectionSide || frame.height > kMaxDirectionSide) {
+            return false;
+        }
+
+        // Rows are stored top-down and y_offset is the bottom row
+        frame.left = frame.x_offset;
+        frame.top = static_cast<int64_t>(frame.y_offset) - frame.height + 1;
+        if (frame.width == 0 || frame.height == 0) {
+            continue;
+        }
+        min_x = std::min(min_x, frame.left);
+        min_y = std::min(min_y, frame.top);
+        max_x = std::max(max_x, frame.left + frame.width);
+        max_y = std::max(max_y, frame.top + frame.height);
+    }
+    if (optional_bytes > 0) {
+        bits.alignToByte();
+        bits.skip(optional_bytes * 8);
+    }
+
+    uint32_t equal_cells_size = (compression & 0x2) ? bits.read(20) : 0;
+    uint32_t pixel_mask_size = bits.read(20);
+    uint32_t encoding_type_size = 0;
+    uint32_t raw_codes_size = 0;
+    if (compression & 0x1) {
+        encoding_type_size = bits.read(20);
+        raw_codes_size = bits.read(20);
+    }
+
+    // Palette indices used by the direction, in ascending order
+    uint8_t pixel_values[256] = {};
+    size_t pixel_value_count = 0;
+    for (uint32_t i = 0; i < 256; i++) {
+        if (bits.read(1)) {
+            pixel_values[pixel_value_count++] = static_cast<uint8_t>(i);
+        }
+    }
+    if (bits.overran()) {
+        return false;
+    }
+
+    // The streams follow each other without byte alignment
+    BitReader equal_cells = bits;
+    bits.skip(equal_cells_size);
+    BitReader pixel_mask = bits;
+    bits.skip(pixel_mask_size);
+    BitReader encoding_type = bits;
+    bits.skip(encoding_type_size);
+    BitReader raw_codes = bits;
+    bits.skip(raw_codes_size);
+    BitReader pixel_codes = bits;
+    if (bits.overran()) {
+        return false;
+    }
+
+    decoded.frames.assign(frame_count, DC6Frame{});
+    decoded.bytes = 0;
+    for (uint32_t f = 0; f < frame_count; f++) {
+        const FrameBox& frame = arena.frames[f];
+        decoded.frames[f].width = frame.width;
+        decoded.frames[f].height = frame.height;
+        decoded.frames[f].offsetX = frame.x_offset;
+        decoded.frames[f].offsetY = frame.y_offset;
+    }
+
+    if (min_x > max_x) {
+        return true;  // Nothing to draw
+    }
+    int64_t direction_width = max_x - min_x;
+    int64_t direction_height = max_y - min_y;
+    if (direction_width > kMaxDirectionSide || direction_height > kMaxDirectionSide ||
+        direction_width * direction_height > kMaxDirectionPixels) {
+        return false;
+    }
+
+    const int32_t canvas_width = static_cast<int32_t>(direction_width);
+    const int32_t grid_width = 1 + (canvas_width - 1) / 4;
+    const int32_t grid_height = 1 + (static_cast<int32_t>(direction_height) - 1) / 4;
+
+    // Frames without pixels have no cells
+    arena.cells.clear();
+    arena.first_cell.resize(frame_count + 1);
+    for (uint32_t f = 0; f < frame_count; f++) {
+        arena.first_cell[f] = arena.cells.size();
+        if (arena.frames[f].width > 0 && arena.frames[f].height > 0) {
+            appendFrameCells(arena.frames[f], min_x, min_y, arena.cells);
+        }
+    }
+    arena.first_cell[frame_count] = arena.cells.size();
+    for (const Cell& cell : arena.cells) {
+        if (cell.x < 0 || cell.y < 0 || cell.width <= 0 || cell.height <= 0 ||
+            cell.x + cell.width > canvas_width || cell.y + cell.height > direction_height ||
+            cell.x / 4 >= grid_width || cell.y / 4 >= grid_height) {
+            return false;
+        }
+    }
+
+    // Stage 1: the pixel values of every cell, coded against the values
+    // the same grid cell had in an earlier frame
+    arena.pixel_buffer.resize(arena.cells.size());
+    arena.buffer_cells.assign(static_cast<size_t>(grid_width) * grid_height, BufferCell{-1, 0, 0, -1, -1});
+    size_t entry_count = 0;
+    for (uint32_t f = 0; f < frame_count; f++) {
+        for (size_t c = arena.first_cell[f]; c < arena.first_cell[f + 1]; c++) {
+            const Cell& cell = arena.cells[c];
+            BufferCell& buffer_cell = arena.buffer_cells[(cell.x / 4) + static_cast<size_t>(cell.y / 4) * grid_width];
+
+            uint32_t mask = 0x0F;
+            if (buffer_cell.entry >= 0) {
+                if (equal_cells_size > 0 && equal_cells.read(1)) {
+                    continue;  // Same as before
+                }
+                mask = pixel_mask.read(4);
+            }
+
+            // Values are sent in ascending order; repeating one ends the list
+            uint32_t stack[4] = {};
+            uint32_t last = 0;
+            int decoded_values = 0;
+            uint32_t value_count = kMaskPixels[mask];
+            bool raw = value_count > 0 && encoding_type_size > 0 && encoding_type.read(1);
+            for (uint32_t i = 0; i < value_count; i++) {
+                uint32_t value;
+                if (raw) {
+                    value = raw_codes.read(8);
+                } else {
+                    value = last;
+                    uint32_t displacement;
+                    do {
+                        displacement = pixel_codes.read(4);
+                        value += displacement;
+                    } while (displacement == 15);
+                }
+                if (value == last) {
+                    break;
+                }
+                stack[decoded_values++] = last = value;
+            }
+
+            PixelBufferEntry& entry = arena.pixel_buffer[entry_count];
+            int index = decoded_values - 1;
+            for (int i = 0; i < 4; i++) {
+                if (mask & (1u << i)) {
+                    entry.values[i] = index >= 0 ? static_cast<uint8_t>(stack[index--]) : 0;
+                } else {
+                    entry.values[i] = arena.pixel_buffer[buffer_cell.entry].values[i];
+                }
+            }
+            entry.frame = f;
+            entry.frame_cell = static_cast<uint32_t>(c - arena.first_cell[f]);
+            buffer_cell.entry = static_cast<int64_t>(entry_count++);
+        }
+    }
+    for (size_t i = 0; i < entry_count; i++) {
+        for (uint8_t& value : arena.pixel_buffer[i].values) {
+            value = pixel_values[value];
+        }
+    }
+
+    // Stage 2: paint the cells onto the direction canvas, copying or
+    // clearing the cells stage 1 skipped, and crop each frame out of it
+    arena.canvas.assign(static_cast<size_t>(direction_width * direction_height), 0);
+    uint8_t* canvas = arena.canvas.data();
+    size_t entry_index = 0;
+    for (uint32_t f = 0; f < frame_count; f++) {
+        for (size_t c = arena.first_cell[f]; c < arena.first_cell[f + 1]; c++) {
+            const Cell& cell = arena.cells[c];
+            BufferCell& buffer_cell = arena.buffer_cells[(cell.x / 4) + static_cast<size_t>(cell.y / 4) * grid_width];
+            uint8_t* target = canvas + static_cast<size_t>(cell.y) * canvas_width + cell.x;
+
+            const PixelBufferEntry* entry = nullptr;
+            if (entry_index < entry_count && arena.pixel_buffer[entry_index].frame == f &&
+                arena.pixel_buffer[entry_index].frame_cell == c - arena.first_cell[f]) {
+                entry = &arena.pixel_buffer[entry_index++];
+            }
+
+            if (!entry) {
+                if (cell.width != buffer_cell.last_width || cell.height != buffer_cell.last_height) {
+                    for (int32_t y = 0; y < cell.height; y++) {
+                        std::memset(target + static_cast<size_t>(y) * canvas_width, 0, cell.width);
+                    }
+                } else if (cell.x != buffer_cell.last_x || cell.y != buffer_cell.last_y) {
+                    const uint8_t* source = canvas + static_cast<size_t>(buffer_cell.last_y) * canvas_width +
+                                            buffer_cell.last_x;
+                    for (int32_t y = 0; y < cell.height; y++) {
+                        std::memmove(target + static_cast<size_t>(y) * canvas_width,
+                                     source + static_cast<size_t>(y) * canvas_width, cell.width);
+                    }
+                }
+            } else if (entry->values[0] == entry->values[1]) {
+                for (int32_t y = 0; y < cell.height; y++) {
+                    std::memset(target + static_cast<size_t>(y) * canvas_width, entry->values[0], cell.width);
+                }
+            } else {
+                // Each pixel picks one of the cell's values; a cell row is
+                // at most 5 pixels, so one read covers it
+                uint32_t index_bits = (entry->values[1] == entry->values[2]) ? 1 : 2;
+                uint32_t index_mask = (1u << index_bits) - 1;
+                for (int32_t y = 0; y < cell.height; y++) {
+                    uint32_t row = pixel_codes.read(index_bits * cell.width);
+                    uint8_t* line = target + static_cast<size_t>(y) * canvas_width;
+                    for (int32_t x = 0; x < cell.width; x++) {
+                        line[x] = entry->values[row & index_mask];
+                        row >>= index_bits;
+                    }
+                }
+            }
+
+            buffer_cell.last_x = cell.x;
+            buffer_cell.last_y = cell.y;
+            buffer_cell.last_width = cell.width;
+            buffer_cell.last_height = cell.height;
+        }
+
+        const FrameBox& frame = arena.frames[f];
+        if (frame.width == 0 || frame.height == 0) {
+            continue;
+        }
+        DC6Frame& output = decoded.frames[f];
+        output.pixelData.resize(static_cast<size_t>(frame.width) * frame.height);
+        const uint8_t* source = canvas + static_cast<size_t>(frame.top - min_y) * canvas_width + (frame.left - min_x);
+        for (uint32_t y = 0; y < frame.height; y++) {
+            std::memcpy(output.pixelData.data() + static_cast<size_t>(y) * frame.width,
+                        source + static_cast<size_t>(y) * canvas_width, frame.width);
+        }
+        decoded.bytes += output.pixelData.size();
+    }
+    return true;
+}
+
+// Implementation of a DCC sprite
+//
+// Keeps the file bytes and decodes a whole direction the first time one of
+// its frames is requested. Decoded directions are held in an LRU cache
+// bounded by direction_cache_budget bytes; the most recently used direction
+// is always kept. With a residency the directions are charged there
+// instead, and the residency decides which ones to drop. Views own their
+// direction, so evicting it never invalidates a view already handed out.
+class DCCSpriteImpl : public DC6Sprite, public ResidentSprite {
+public:
+    DCCSpriteImpl(uint32_t dirs, uint32_t frames, std::vector<uint8_t> file_data,
+                  std::vector<uint32_t> direction_offsets, size_t direction_cache_budget,
+                  std::shared_ptr<SpriteResidency> residency)
+        : directions(dirs), frames_per_dir(frames), file_data(std::move(file_data)),
+          direction_offsets(std::move(direction_offsets)), direction_cache_budget(direction_cache_budget),
+          residency(std::move(residency)), direction_use(new std::atomic<uint64_t>[dirs]()),
+          decoded_directions(dirs), lru_positions(dirs) {}
+
+    ~DCCSpriteImpl() override {
+        if (residency) {
+            residency->forget(this);
+        }
+    }
+
+    uint32_t getDirectionCount() const override {
+        return directions;
+    }
+
+    uint32_t getFramesPerDirection() const override {
+        return frames_per_dir;
+    }
+
+    DC6Frame getFrame(uint32_t direction, uint32_t frame) const override {
+        if (direction >= directions || frame >= frames_per_dir) {
+            return DC6Frame{};
+        }
+        auto decoded = decodedDirection(direction);
+        return frame < decoded->frames.size() ? decoded->frames[frame] : DC6Frame{};
+    }
+
+    DC6FrameView getFrameView(uint32_t direction, uint32_t frame) const override {
+        DC6FrameView view;
+        if (direction >= directions || frame >= frames_per_dir) {
+            return view;
+        }
+        auto decoded = decodedDirection(direction);
+        if (frame >= decoded->frames.size()) {
+            return view;
+        }
+        const DC6Frame& dcc_frame = decoded->frames[frame];
+        view.width = dcc_frame.width;
+        view.height = dcc_frame.height;
+        view.offsetX = dcc_frame.offsetX;
+        view.offsetY = dcc_frame.offsetY;
+        view.pixels = dcc_frame.pixelData.data();
+        view.pixelCount = dcc_frame.pixelData.size();
+        view.owner = std::move(decoded);
+        return view;
+    }
+
+    std::vector<uint8_t> getFrameImage(uint32_t direction, uint32_t frame) const override {
+        return expandToRGBA(direction, frame, getGrayscalePalette());
+    }
+
+    std::vector<uint8_t> getFrameImageWithPalette(uint32_t direction, uint32_t frame,
+                                                  const std::vector<uint32_t>& palette) const override {
+        if (palette.size() != 256) {
+            return getFrameImage(direction, frame);
+        }
+        return expandToRGBA(direction, frame, palette.data());
+    }
+
+    size_t getEncodedSize() const override {
+        return file_data.size();
+    }
+
+    uint64_t getDirectionLastUse(uint32_t direction) const override {
+        return direction < directions ? direction_use[direction].load(std::memory_order_relaxed) : 0;
+    }
+
+    size_t evictDirection(uint32_t direction) const override {
+        if (direction >= directions) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (!decoded_directions[direction]) {
+            return 0;
+        }
+        size_t released = decoded_directions[direction]->bytes;
+        lru.erase(lru_positions[direction]);
+        decoded_directions[direction].reset();
+        decoded_bytes -= released;
+        return released;
+    }
+
+private:
+    std::vector<uint8_t> expandToRGBA(uint32_t direction, uint32_t frame, const uint32_t* palette) const {
+        auto view = getFrameView(direction, frame);
+        std::vector<uint8_t> rgba_data;
+        if (view.empty()) {
+            return rgba_data;
+        }
+        rgba_data.resize(view.pixelCount * 4);
+        expandPalette(view.pixels, view.pixelCount, palette, rgba_data.data());
+        return rgba_data;
+    }
+
+    std::shared_ptr<const DecodedDirection> decodedDirection(uint32_t direction) const {
+        if (residency) {
+            direction_use[direction].store(residency->touch(), std::memory_order_relaxed);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (decoded_directions[direction]) {
+                lru.splice(lru.begin(), lru, lru_positions[direction]);
+                return decoded_directions[direction];
+            }
+        }
+
+        // Decoding shares the scratch arena, so only one direction is
+        // decoded at a time; cache hits do not wait for it
+        auto decoded = std::make_shared<DecodedDirection>();
+        {
+            std::lock_guard<std::mutex> lock(scratch_mutex);
+            if (!decodeDirection(file_data.data(), file_data.size(), direction_offsets[direction],
+                                 frames_per_dir, scratch, *decoded)) {
+                // Directions that cannot be decoded have no frames
+                decoded->frames.clear();
+                decoded->frames.shrink_to_fit();
+                decoded->bytes = 0;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (decoded_directions[direction]) {
+                lru.splice(lru.begin(), lru, lru_positions[direction]);
+                return decoded_directions[direction];
+            }
+            decoded_directions[direction] = decoded;
+            lru.push_front(direction);
+            lru_positions[direction] = lru.begin();
+            decoded_bytes += decoded->bytes;
+
+            while (!residency && decoded_bytes > direction_cache_budget && lru.size() > 1) {
+                uint32_t evicted = lru.back();
+                lru.pop_back();
+                decoded_bytes -= decoded_directions[evicted]->bytes;
+                decoded_directions[evicted].reset();
+            }
+        }
+
+        // The residency may evict from this sprite, so charge it unlocked
+        if (residency) {
+            residency->charge(this, direction, decoded->bytes);
+        }
+        return decoded;
+    }
+
+    uint32_t directions;
+    uint32_t frames_per_dir;
+    std::vector<uint8_t> file_data;
+    std::vector<uint32_t> direction_offsets;
+    size_t direction_cache_budget;
+    std::shared_ptr<SpriteResidency> residency;
+    std::unique_ptr<std::atomic<uint64_t>[]> direction_use;
+
+    mutable std::mutex scratch_mutex;
+    mutable DCCScratchArena scratch;
+
+    mutable std::mutex cache_mutex;
+    mutable std::vector<std::shared_ptr<const DecodedDirection>> decoded_directions;
+    mutable std::list<uint32_t> lru;
+    mutable std::vector<std::list<uint32_t>::iterator> lru_positions;
+    mutable size_t decoded_bytes = 0;
+};
+
+} // namespace
+
+// DCCParser implementation
+std::unique_ptr<DC6Sprite> DCCParser::parseFile(const std::string& filepath) {
+    if (!std::filesystem::exists(filepath)) {
+        return nullptr;
+    }
+
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return nullptr;
+    }
+
+    // Directions are decoded from the file bytes on demand, so read them all
+    std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!file.good()) {
+        return nullptr;
+    }
+
+    return parseData(std::move(data));
+}
+
+std::unique_ptr<DC6Sprite> DCCParser::parseData(const std::vector<uint8_t>& data) {
+    return parseData(std::vector<uint8_t>(data));
+}
+
+std::unique_ptr<DC6Sprite> DCCParser::parseData(std::vector<uint8_t>&& data) {
+    if (data.size() < kFileHeaderSize) {
+        return nullptr;
+    }
+
+    auto read32 = [&](size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, data.data() + offset, sizeof(value));
+        return value;
+    };
+
+    if (data[0] != kDCCSignature || data[1] != kDCCVersion) {
+        return nullptr;
+    }
+    uint32_t directions = data[2];
+    uint32_t frames_per_dir = read32(3);
+    if (read32(7) != 1) {
+        return nullptr;
+    }
+
+    // Every frame header takes at least one bit, which bounds the frame count
+    if (directions == 0 || frames_per_dir == 0 || frames_per_dir > data.size() * 8) {
+        return nullptr;
+    }
+    if (data.size() < kFileHeaderSize + directions * sizeof(uint32_t)) {
+        return nullptr;
+    }
+
+    std::vector<uint32_t> direction_offsets(directions);
+    for (uint32_t i = 0; i < directions; i++) {
+        direction_offsets[i] = read32(kFileHeaderSize + i * sizeof(uint32_t));
+        if (direction_offsets[i] >= data.size()) {
+            return nullptr;
+        }
+    }
+
+    return std::make_unique<DCCSpriteImpl>(directions, frames_per_dir, std::move(data),
+                                           std::move(direction_offsets), direction_cache_budget, residency);
+}
+
+void DCCParser::setDirectionCacheBudget(size_t bytes) {
+    direction_cache_budget = bytes;
+}
+
+size_t DCCParser::getDirectionCacheBudget() const {
+    return direction_cache_budget;
+}
+
+void DCCParser::setResidency(std::shared_ptr<SpriteResidency> residency) {
+    this->residency = std::move(residency);
+}
+
+} // namespace sprites
+} // namespace d2portable
@@ -0,0 +1,91 @@
+#include "sprites/frame_trim.h"
+#include <cstring>
+
+namespace d2portable {
+namespace sprites {
+
+namespace {
+
+// Index of the first visible pixel in [begin, end), or end if there is none
+uint32_t firstVisible(const uint8_t* row, uint32_t begin, uint32_t end) {
+    uint32_t x = begin;
+    // Skip transparent runs eight pixels at a time
+    while (x + 8 <= end) {
+        uint64_t chunk;
+        std::memcpy(&chunk, row + x, sizeof(chunk));
+        if (chunk != 0) {
+            break;
+        }
+        x += 8;
+    }
+    while (x < end && row[x] == 0) {
+        x++;
+    }
+    return x;
+}
+
+// One past the last visible pixel in [begin, end), or begin if there is none
+uint32_t lastVisible(const uint8_t* row, uint32_t begin, uint32_t end) {
+    uint32_t x = end;
+    while (x >= begin + 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, row + x - 8, sizeof(chunk));
+        if (chunk != 0) {
+            break;
+        }
+        x -= 8;
+    }
+    while (x > begin && row[x - 1] == 0) {
+        x--;
+    }
+    return x;
+}
+
+} // namespace
+
+FrameRect findOpaqueBounds(const uint8_t* indices, uint32_t width, uint32_t height) {
+    FrameRect bounds;
+    if (!indices || width == 0 || height == 0) {
+        return bounds;
+    }
+
+    // Transparent rows above and below the sprite
+    uint32_t top = 0;
+    while (top < height && firstVisible(indices + static_cast<size_t>(top) * width, 0, width) == width) {
+        top++;
+    }
+    if (top == height) {
+        return bounds;
+    }
+    uint32_t bottom = height;
+    while (lastVisible(indices + static_cast<size_t>(bottom - 1) * width, 0, width) == 0) {
+        bottom--;
+    }
+
+    // Each row only needs scanning outside the columns already known visible
+    uint32_t left = width;
+    uint32_t right = 0;
+    for (uint32_t y = top; y < bottom; y++) {
+        const uint8_t* row = indices + static_cast<size_t>(y) * width;
+        left = firstVisible(row, 0, left);
+        right = lastVisible(row, right, width);
+    }
+
+    bounds.x = left;
+    bounds.y = top;
+    bounds.width = right - left;
+    bounds.height = bottom - top;
+    return bounds;
+}
+
+void copyFrameRect(const uint8_t* pixels, uint32_t width, size_t bytes_per_pixel,
+                   const FrameRect& rect, uint8_t* out) {
+    size_t row_bytes = rect.width * bytes_per_pixel;
+    for (uint32_t y = 0; y < rect.height; y++) {
+        const uint8_t* src = pixels + ((static_cast<size_t>(rect.y) + y) * width + rect.x) * bytes_per_pixel;
+        std::memcpy(out + y * row_bytes, src, row_bytes);
+    }
+}
+
+} // namespace sprites
+} // namespace d2portable
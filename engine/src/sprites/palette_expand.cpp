@@ -0,0 +1,189 @@
+#include "sprites/palette_expand.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define D2_PALETTE_X86 1
+#include <immintrin.h>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define D2_PALETTE_SSE2 1
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define D2_PALETTE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// AVX2 is compiled with a per-function target on GCC and Clang so the
+// default build still runs on older CPUs; MSVC needs /arch:AVX2
+#if defined(D2_PALETTE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define D2_PALETTE_AVX2 1
+#define D2_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(D2_PALETTE_X86) && defined(__AVX2__)
+#define D2_PALETTE_AVX2 1
+#define D2_TARGET_AVX2
+#endif
+
+namespace d2portable {
+namespace sprites {
+
+void expandPaletteScalar(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgba) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t color = palette[indices[i]];
+        rgba[i * 4 + 0] = color & 0xFF;
+        rgba[i * 4 + 1] = (color >> 8) & 0xFF;
+        rgba[i * 4 + 2] = (color >> 16) & 0xFF;
+        rgba[i * 4 + 3] = (color >> 24) & 0xFF;
+    }
+}
+
+namespace {
+
+using ExpandKernel = void (*)(const uint8_t*, size_t, const uint32_t*, uint8_t*);
+
+#ifdef D2_PALETTE_SSE2
+// SSE has no gather; assemble four lookups and store them as one vector.
+// x86 is little endian, so a stored color is already R, G, B, A.
+void expandSSE2(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgba) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_setr_epi32(static_cast<int>(palette[indices[i + 0]]),
+                                        static_cast<int>(palette[indices[i + 1]]),
+                                        static_cast<int>(palette[indices[i + 2]]),
+                                        static_cast<int>(palette[indices[i + 3]]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), pixels);
+    }
+    expandPaletteScalar(indices + i, count - i, palette, rgba + i * 4);
+}
+#endif
+
+#ifdef D2_PALETTE_AVX2
+// Widens eight indices at a time to 32 bits and gathers their colors
+D2_TARGET_AVX2
+void expandAVX2(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgba) {
+    const int* table = reinterpret_cast<const int*>(palette);
+    __m256i* out = reinterpret_cast<__m256i*>(rgba);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i + 16));
+        __m256i p0 = _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(low), 4);
+        __m256i p1 = _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)), 4);
+        __m256i p2 = _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(high), 4);
+        __m256i p3 = _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)), 4);
+        _mm256_storeu_si256(out + i / 8 + 0, p0);
+        _mm256_storeu_si256(out + i / 8 + 1, p1);
+        _mm256_storeu_si256(out + i / 8 + 2, p2);
+        _mm256_storeu_si256(out + i / 8 + 3, p3);
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m128i group = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i));
+        _mm256_storeu_si256(out + i / 8, _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(group), 4));
+    }
+    expandPaletteScalar(indices + i, count - i, palette, rgba + i * 4);
+}
+#endif
+
+#ifdef D2_PALETTE_NEON
+// Looks each channel up in four 64-byte tables (TBL returns 0 for an
+// out-of-range index, so the four partial lookups can simply be ORed)
+// and interleaves the channels with one structured store
+void expandNEON(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgba) {
+    uint8_t planes[4][256];
+    for (int index = 0; index < 256; index++) {
+        for (int channel = 0; channel < 4; channel++) {
+            planes[channel][index] = static_cast<uint8_t>(palette[index] >> (channel * 8));
+        }
+    }
+
+    uint8x16x4_t tables[4][4];
+    for (int channel = 0; channel < 4; channel++) {
+        for (int quarter = 0; quarter < 4; quarter++) {
+            const uint8_t* base = planes[channel] + quarter * 64;
+            tables[channel][quarter].val[0] = vld1q_u8(base);
+            tables[channel][quarter].val[1] = vld1q_u8(base + 16);
+            tables[channel][quarter].val[2] = vld1q_u8(base + 32);
+            tables[channel][quarter].val[3] = vld1q_u8(base + 48);
+        }
+    }
+
+    const uint8x16_t quarter_step = vdupq_n_u8(64);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t index0 = vld1q_u8(indices + i);
+        uint8x16_t index1 = vsubq_u8(index0, quarter_step);
+        uint8x16_t index2 = vsubq_u8(index1, quarter_step);
+        uint8x16_t index3 = vsubq_u8(index2, quarter_step);
+
+        uint8x16x4_t pixels;
+        for (int channel = 0; channel < 4; channel++) {
+            uint8x16_t value = vqtbl4q_u8(tables[channel][0], index0);
+            value = vorrq_u8(value, vqtbl4q_u8(tables[channel][1], index1));
+            value = vorrq_u8(value, vqtbl4q_u8(tables[channel][2], index2));
+            value = vorrq_u8(value, vqtbl4q_u8(tables[channel][3], index3));
+            pixels.val[channel] = value;
+        }
+        vst4q_u8(rgba + i * 4, pixels);
+    }
+    expandPaletteScalar(indices + i, count - i, palette, rgba + i * 4);
+}
+#endif
+
+struct SelectedKernel {
+    ExpandKernel kernel;
+    const char* name;
+};
+
+#ifdef D2_PALETTE_AVX2
+bool cpuHasAVX2() {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return true;  // Only compiled in when the build targets AVX2
+#endif
+}
+#endif
+
+SelectedKernel selectKernel() {
+#ifdef D2_PALETTE_AVX2
+    if (cpuHasAVX2()) {
+        return {expandAVX2, "avx2"};
+    }
+#endif
+#if defined(D2_PALETTE_SSE2)
+    return {expandSSE2, "sse2"};
+#elif defined(D2_PALETTE_NEON)
+    return {expandNEON, "neon"};
+#else
+    return {expandPaletteScalar, "scalar"};
+#endif
+}
+
+const SelectedKernel& selectedKernel() {
+    static const SelectedKernel selected = selectKernel();
+    return selected;
+}
+
+} // namespace
+
+void expandPalette(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgba) {
+    selectedKernel().kernel(indices, count, palette, rgba);
+}
+
+const char* getPaletteExpandKernel() {
+    return selectedKernel().name;
+}
+
+const uint32_t* getGrayscalePalette() {
+    static const struct GrayscalePalette {
+        uint32_t colors[256];
+        GrayscalePalette() {
+            for (uint32_t i = 0; i < 256; i++) {
+                colors[i] = 0xFF000000u | (i << 16) | (i << 8) | i;
+            }
+        }
+    } palette;
+    return palette.colors;
+}
+
+} // namespace sprites
+} // namespace d2portable
@@ -0,0 +1,181 @@
+#include "sprites/sprite_residency.h"
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <limits>
+
+namespace d2portable {
+namespace sprites {
+
+namespace {
+
+struct DirectionKey {
+    const ResidentSprite* sprite;
+    uint32_t direction;
+
+    bool operator==(const DirectionKey& other) const {
+        return sprite == other.sprite && direction == other.direction;
+    }
+};
+
+struct DirectionKeyHash {
+    size_t operator()(const DirectionKey& key) const {
+        return std::hash<const void*>{}(key.sprite) ^ (static_cast<size_t>(key.direction) * 0x9E3779B97F4A7C15ull);
+    }
+};
+
+} // namespace
+
+class SpriteResidency::Impl {
+public:
+    explicit Impl(size_t budget_bytes) : budget(budget_bytes) {}
+
+    std::atomic<size_t> budget;
+    std::atomic<uint64_t> use_clock{0};
+    std::atomic<uint64_t> evictions{0};
+
+    mutable std::mutex mutex;
+    // Charged bytes per direction. A sprite reports its changes after
+    // releasing its own lock, so an entry can briefly go negative when an
+    // eviction overtakes the charge it raced with.
+    std::unordered_map<DirectionKey, int64_t, DirectionKeyHash> charged;
+    int64_t resident_bytes = 0;
+    std::function<void(int64_t)> usage_callback;
+
+    // Held while calling into a sprite to evict, and by forget(), so a
+    // sprite is never evicted while it is being destroyed
+    std::mutex evict_mutex;
+
+    // The caller must hold mutex
+    void adjust(const DirectionKey& key, int64_t delta) {
+        if (delta == 0) {
+            return;
+        }
+        auto it = charged.emplace(key, 0).first;
+        it->second += delta;
+        if (it->second == 0) {
+            charged.erase(it);
+        }
+        resident_bytes += delta;
+        if (usage_callback) {
+            usage_callback(delta);
+        }
+    }
+
+    // Must be called without mutex held
+    void enforceBudget() {
+        std::lock_guard<std::mutex> evict_lock(evict_mutex);
+        while (true) {
+            DirectionKey victim{nullptr, 0};
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                size_t limit = budget.load();
+                if (limit == 0 || resident_bytes <= static_cast<int64_t>(limit) || charged.size() <= 1) {
+                    return;
+                }
+
+                // Least recently used direction across every sprite
+                uint64_t oldest_use = std::numeric_limits<uint64_t>::max();
+                for (const auto& entry : charged) {
+                    if (entry.second <= 0) {
+                        continue;
+                    }
+                    uint64_t last_use = entry.first.sprite->getDirectionLastUse(entry.first.direction);
+                    if (last_use < oldest_use) {
+                        oldest_use = last_use;
+                        victim = entry.first;
+                    }
+                }
+                if (!victim.sprite) {
+                    return;
+                }
+            }
+
+            // Sprites take their own lock to evict, so call them unlocked
+            size_t released = victim.sprite->evictDirection(victim.direction);
+            if (released == 0) {
+                // The direction was dropped by a call that has not been
+                // reported yet; try again on the next charge
+                return;
+            }
+            evictions.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            adjust(victim, -static_cast<int64_t>(released));
+        }
+    }
+};
+
+SpriteResidency::SpriteResidency(size_t budget_bytes) : pImpl(std::make_unique<Impl>(budget_bytes)) {}
+
+SpriteResidency::~SpriteResidency() = default;
+
+void SpriteResidency::setBudget(size_t budget_bytes) {
+    pImpl->budget = budget_bytes;
+    pImpl->enforceBudget();
+}
+
+size_t SpriteResidency::getBudget() const {
+    return pImpl->budget.load();
+}
+
+size_t SpriteResidency::getResidentBytes() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->resident_bytes > 0 ? static_cast<size_t>(pImpl->resident_bytes) : 0;
+}
+
+size_t SpriteResidency::getResidentDirectionCount() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    size_t count = 0;
+    for (const auto& entry : pImpl->charged) {
+        if (entry.second > 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint64_t SpriteResidency::getEvictionCount() const {
+    return pImpl->evictions.load(std::memory_order_relaxed);
+}
+
+void SpriteResidency::setUsageCallback(std::function<void(int64_t)> callback) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->usage_callback = std::move(callback);
+}
+
+uint64_t SpriteResidency::touch() {
+    return pImpl->use_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+void SpriteResidency::charge(const ResidentSprite* sprite, uint32_t direction, size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        pImpl->adjust(DirectionKey{sprite, direction}, static_cast<int64_t>(bytes));
+    }
+    pImpl->enforceBudget();
+}
+
+void SpriteResidency::release(const ResidentSprite* sprite, uint32_t direction, size_t bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->adjust(DirectionKey{sprite, direction}, -static_cast<int64_t>(bytes));
+}
+
+void SpriteResidency::forget(const ResidentSprite* sprite) {
+    std::lock_guard<std::mutex> evict_lock(pImpl->evict_mutex);
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+
+    std::vector<std::pair<DirectionKey, int64_t>> owned;
+    for (const auto& entry : pImpl->charged) {
+        if (entry.first.sprite == sprite) {
+            owned.push_back(entry);
+        }
+    }
+    for (const auto& entry : owned) {
+        pImpl->adjust(entry.first, -entry.second);
+    }
+}
+
+} // namespace sprites
+} // namespace d2portable
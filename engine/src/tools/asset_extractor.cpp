@@ -1,17 +1,72 @@
 #include "tools/asset_extractor.h"
 #include "tools/extraction_monitor.h"
+#include "tools/texture_atlas_generator.h"
 #include "utils/stormlib_mpq_loader.h"
 #include "utils/file_utils.h"
+#include "utils/data_table_parser.h"
 #include <filesystem>
 #include <iostream>
 #include <vector>
 #include <algorithm>
 #include <fstream>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <cerrno>
 
 namespace fs = std::filesystem;
 
 namespace d2 {
 
+namespace {
+
+// Which extraction counter a file adds to
+enum class AssetKind {
+    SPRITE,
+    AUDIO,
+    DATA
+};
+
+// A file listed for extraction. The sequence orders files the way the
+// sequential pass visited them: by archive, then by listing position.
+struct ExtractionJob {
+    size_t archive = 0;
+    uint64_t sequence = 0;
+    std::string filename;
+    fs::path outputPath;
+    AssetKind kind = AssetKind::DATA;
+};
+
+struct ExtractedFile {
+    ExtractionJob job;
+    std::vector<uint8_t> data;
+    bool extracted = false;
+};
+
+// Decompressed files waiting for the writer, at most this many per worker
+constexpr size_t kWriteQueuePerWorker = 4;
+
+// Error for a file or directory the filesystem refused
+ExtractionError writeFailure(const fs::path& path, const std::error_code& ec) {
+    ExtractionError error;
+    if (ec == std::errc::no_space_on_device) {
+        error.type = ErrorType::INSUFFICIENT_SPACE;
+    } else if (ec == std::errc::permission_denied || ec == std::errc::operation_not_permitted) {
+        error.type = ErrorType::PERMISSION_DENIED;
+    } else {
+        error.type = ErrorType::IO_ERROR;
+    }
+    error.filename = path.string();
+    error.message = "Failed to write extracted file: " + ec.message();
+    error.isRecoverable = true;
+    return error;
+}
+
+} // namespace
+
 bool AssetExtractor::extractFromD2(const std::string& d2Path, const std::string& outputPath) {
     fs::path d2Dir(d2Path);
     fs::path outDir(outputPath);
@@ -86,13 +141,23 @@ bool AssetExtractor::extractMPQFiles(const fs::path& d2Path, const fs::path& out
         return false;
     }
     
+    reportProgress(0.9f, "Compiling data tables...");
+    if (!compileDataTables(outputPath.string())) {
+        return false;
+    }
+    
+    if (atlasBaking) {
+        reportProgress(0.95f, "Baking sprite atlases...");
+        if (!bakeSpriteAtlases(outputPath.string())) {
+            return false;
+        }
+    }
+    
     reportProgress(1.0f, "Extraction complete");
     return true;
 }
 
 bool AssetExtractor::extractAllAssetsOptimized(const fs::path& d2Path, const fs::path& outputPath) {
-    d2portable::utils::StormLibMPQLoader mpqLoader;
-    
     // Find all MPQ files - single directory scan
     std::vector<fs::path> mpqFiles;
     try {
@@ -111,87 +176,261 @@ bool AssetExtractor::extractAllAssetsOptimized(const fs::path& d2Path, const fs:
     
     reportProgress(0.1f, "Processing all assets...");
     
-    // Process each MPQ file once
-    for (const auto& mpqFile : mpqFiles) {
-        if (!mpqLoader.open(mpqFile.string())) {
-            std::cerr << "Failed to open MPQ: " << mpqFile << std::endl;
+    // Pipeline: one listing thread per archive feeds a job queue, workers
+    // decompress with their own archive handles, and this thread writes
+    // files from a bounded queue. Only this thread touches the monitor,
+    // the counters and the output tree.
+    size_t workerCount = threadCount > 0 ? static_cast<size_t>(threadCount)
+                                         : std::max<size_t>(1, std::thread::hardware_concurrency());
+    
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable writeReady;
+    std::condition_variable writeSpace;
+    std::deque<ExtractionJob> jobs;
+    std::deque<ExtractedFile> written;
+    std::vector<ExtractionError> errors;
+    size_t listingsLeft = mpqFiles.size();
+    size_t workersLeft = workerCount;
+    size_t totalJobs = 0;
+    bool stopping = false;
+    const size_t writeCapacity = workerCount * kWriteQueuePerWorker;
+    
+    auto listArchive = [&](size_t archive) {
+        d2portable::utils::StormLibMPQLoader mpqLoader;
+        std::vector<ExtractionJob> listed;
+        bool opened = false;
+        bool listFailed = false;
+        try {
+            opened = mpqLoader.open(mpqFiles[archive].string());
+            if (opened) {
+                auto fileList = mpqLoader.listFiles();
+                for (size_t index = 0; index < fileList.size(); index++) {
+                    const std::string& filename = fileList[index].filename;
+                    size_t len = filename.length();
+                    if (len < 4) {
+                        continue;
+                    }
+                    std::string extension = filename.substr(len - 4);
+                    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+                    
+                    // Only process files that match the extensions we want
+                    ExtractionJob job;
+                    if (extension == ".dc6") {
+                        job.kind = AssetKind::SPRITE;
+                        job.outputPath = outputPath / "sprites" / determineSpriteCategory(filename);
+                    } else if (extension == ".wav") {
+                        job.kind = AssetKind::AUDIO;
+                        job.outputPath = outputPath / "sounds" / determineAudioCategory(filename);
+                    } else if (extension == ".txt" || extension == ".dat" || extension == ".bin") {
+                        job.kind = AssetKind::DATA;
+                        job.outputPath = outputPath / "data" / determineDataCategory(filename);
+                    } else {
+                        continue;
+                    }
+                    job.archive = archive;
+                    job.sequence = (static_cast<uint64_t>(archive) << 32) | index;
+                    job.filename = filename;
+                    listed.push_back(std::move(job));
+                }
+            }
+        } catch (const std::exception&) {
+            // An archive that cannot be listed adds no jobs
+            listed.clear();
+            listFailed = true;
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!opened || listFailed) {
+            ExtractionError error;
+            error.type = ErrorType::CORRUPTED_MPQ;
+            error.filename = mpqFiles[archive].string();
+            error.message = opened ? "Failed to list MPQ file" : "Failed to open MPQ file - file may be corrupted";
+            error.isRecoverable = false;
+            errors.push_back(error);
+        }
+        totalJobs += listed.size();
+        for (auto& job : listed) {
+            jobs.push_back(std::move(job));
+        }
+        listingsLeft--;
+        jobReady.notify_all();
+        writeReady.notify_one();
+    };
+    
+    auto decompress = [&]() {
+        // Handles are opened on first use; StormLib handles are not shared
+        std::vector<std::unique_ptr<d2portable::utils::StormLibMPQLoader>> handles(mpqFiles.size());
+        while (true) {
+            ExtractedFile file;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobReady.wait(lock, [&]() { return !jobs.empty() || listingsLeft == 0 || stopping; });
+                if (jobs.empty() || stopping) {
+                    break;
+                }
+                file.job = std::move(jobs.front());
+                jobs.pop_front();
+            }
             
-            // Report error to monitor
-            if (extractionMonitor) {
+            // A file that cannot be read, even for lack of memory, is
+            // reported and skipped; the thread keeps going
+            try {
+                auto& handle = handles[file.job.archive];
+                if (!handle) {
+                    handle = std::make_unique<d2portable::utils::StormLibMPQLoader>();
+                    handle->open(mpqFiles[file.job.archive].string());
+                }
+                file.extracted = handle->isOpen() && handle->extractFile(file.job.filename, file.data);
+                
+                std::unique_lock<std::mutex> lock(mutex);
+                writeSpace.wait(lock, [&]() { return written.size() < writeCapacity || stopping; });
+                if (stopping) {
+                    break;
+                }
+                written.push_back(std::move(file));
+                writeReady.notify_one();
+            } catch (const std::exception& e) {
                 ExtractionError error;
                 error.type = ErrorType::CORRUPTED_MPQ;
-                error.filename = mpqFile.string();
-                error.message = "Failed to open MPQ file - file may be corrupted";
-                error.isRecoverable = false;
-                extractionMonitor->reportError(error);
+                error.filename = file.job.filename;
+                error.message = std::string("Failed to extract file: ") + e.what();
+                error.isRecoverable = true;
+                
+                std::lock_guard<std::mutex> lock(mutex);
+                errors.push_back(error);
+                writeReady.notify_one();
             }
-            
-            continue;
         }
         
-        // Get list of files in the MPQ once
-        auto fileList = mpqLoader.listFiles();
+        std::lock_guard<std::mutex> lock(mutex);
+        workersLeft--;
+        writeReady.notify_one();
+    };
+    
+    // Every thread started is joined on the way out. If this thread fails,
+    // the others are told to stop first so none waits for it forever.
+    std::vector<std::thread> threads;
+    bool completed = false;
+    try {
+        for (size_t archive = 0; archive < mpqFiles.size(); archive++) {
+            threads.emplace_back(listArchive, archive);
+        }
+        for (size_t worker = 0; worker < workerCount; worker++) {
+            threads.emplace_back(decompress);
+        }
         
-        // Process all file types in single pass
-        for (const auto& fileInfo : fileList) {
-            const std::string& filename = fileInfo.filename;
-            size_t len = filename.length();
+        // Writer stage. Archives extracted later overwrite files of earlier
+        // ones, so a file is only written if no later copy already was; the
+        // output matches the sequential pass whatever order workers finish in.
+        std::unordered_map<std::string, uint64_t> writtenSequence;
+        size_t processed = 0;
+        float progress = 0.1f;
+        while (true) {
+            ExtractedFile file;
+            std::vector<ExtractionError> pendingErrors;
+            size_t knownJobs = 0;
+            bool done = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                writeReady.wait(lock, [&]() { return !written.empty() || !errors.empty() || workersLeft == 0; });
+                pendingErrors.swap(errors);
+                if (!written.empty()) {
+                    file = std::move(written.front());
+                    written.pop_front();
+                    writeSpace.notify_one();
+                } else {
+                    done = workersLeft == 0;
+                }
+                knownJobs = totalJobs;
+            }
             
-            if (len >= 4) {
-                std::string extension = filename.substr(len - 4);
-                std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+            for (const auto& error : pendingErrors) {
+                std::cerr << error.message << ": " << error.filename << std::endl;
                 
-                // Only process files that match the extensions we want
-                if (extension == ".dc6") {
-                    std::vector<uint8_t> fileData;
-                    if (mpqLoader.extractFile(filename, fileData)) {
-                        // Process sprite file
-                        fs::path categoryPath = determineSpriteCategory(filename);
-                        fs::path fullOutputPath = outputPath / "sprites" / categoryPath;
-                        fs::create_directories(fullOutputPath.parent_path());
-                        
-                        std::ofstream outFile(fullOutputPath, std::ios::binary);
-                        if (outFile) {
-                            outFile.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
-                            extractedCount++;
+                // Report error to monitor
+                if (extractionMonitor) {
+                    extractionMonitor->reportError(error);
+                }
+            }
+            if (done) {
+                break;
+            }
+            if (file.job.filename.empty()) {
+                continue;
+            }
+            
+            if (file.extracted) {
+                std::string key = file.job.outputPath.string();
+                auto latest = writtenSequence.find(key);
+                bool superseded = latest != writtenSequence.end() && latest->second > file.job.sequence;
+                bool stored = superseded;
+                if (!superseded) {
+                    std::error_code ec;
+                    fs::create_directories(file.job.outputPath.parent_path(), ec);
+                    if (!ec) {
+                        errno = 0;
+                        std::ofstream outFile(file.job.outputPath, std::ios::binary);
+                        bool opened = static_cast<bool>(outFile);
+                        if (opened) {
+                            outFile.write(reinterpret_cast<const char*>(file.data.data()), file.data.size());
+                            outFile.close();
                         }
-                    }
-                } else if (extension == ".wav") {
-                    std::vector<uint8_t> fileData;
-                    if (mpqLoader.extractFile(filename, fileData)) {
-                        // Process audio file
-                        fs::path categoryPath = determineAudioCategory(filename);
-                        fs::path fullOutputPath = outputPath / "sounds" / categoryPath;
-                        fs::create_directories(fullOutputPath.parent_path());
-                        
-                        std::ofstream outFile(fullOutputPath, std::ios::binary);
-                        if (outFile) {
-                            outFile.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
-                            extractedAudioCount++;
+                        if (!opened || outFile.fail()) {
+                            ec.assign(errno ? errno : EIO, std::generic_category());
+                            
+                            // A partly written file must not pass for an extracted one
+                            if (opened) {
+                                std::error_code removeError;
+                                fs::remove(file.job.outputPath, removeError);
+                            }
                         }
                     }
-                } else if (extension == ".txt" || extension == ".dat" || extension == ".bin") {
-                    std::vector<uint8_t> fileData;
-                    if (mpqLoader.extractFile(filename, fileData)) {
-                        // Process data file
-                        fs::path categoryPath = determineDataCategory(filename);
-                        fs::path fullOutputPath = outputPath / "data" / categoryPath;
-                        fs::create_directories(fullOutputPath.parent_path());
-                        
-                        std::ofstream outFile(fullOutputPath, std::ios::binary);
-                        if (outFile) {
-                            outFile.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
-                            extractedDataCount++;
+                    if (!ec) {
+                        writtenSequence[key] = file.job.sequence;
+                        stored = true;
+                    } else {
+                        ExtractionError error = writeFailure(file.job.outputPath, ec);
+                        std::cerr << error.message << ": " << error.filename << std::endl;
+                        if (extractionMonitor) {
+                            extractionMonitor->reportError(error);
                         }
                     }
                 }
+                
+                // A copy overwritten later still counts, as it did when written in order
+                if (stored) {
+                    switch (file.job.kind) {
+                        case AssetKind::SPRITE: extractedCount++; break;
+                        case AssetKind::AUDIO: extractedAudioCount++; break;
+                        case AssetKind::DATA: extractedDataCount++; break;
+                    }
+                }
+            }
+            
+            // The total grows while archives are still being listed; never
+            // let progress step backwards
+            processed++;
+            if (processed % 32 == 0 || processed == knownJobs) {
+                float fraction = knownJobs > 0 ? static_cast<float>(processed) / knownJobs : 1.0f;
+                progress = std::max(progress, std::min(0.1f + 0.8f * fraction, 0.9f));
+                reportProgress(progress, file.job.filename);
             }
         }
-        
-        mpqLoader.close();
+        completed = true;
+    } catch (const std::exception& e) {
+        std::cerr << "Extraction stopped: " << e.what() << std::endl;
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobReady.notify_all();
+        writeSpace.notify_all();
     }
     
-    return true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    return completed;
 }
 
 bool AssetExtractor::extractSprites(const fs::path& d2Path, const fs::path& outputPath) {
@@ -265,6 +504,135 @@ bool AssetExtractor::extractSprites(const fs::path& d2Path, const fs::path& outp
     return true;
 }
 
+namespace {
+
+// Sprite categories drawn on the same screens, baked into one atlas each.
+// Character and monster animations are too large to share pages.
+const std::vector<std::string> kAtlasSets = {"ui", "items"};
+
+// pal.dat stores 256 colors as B, G, R; index 0 is transparent
+bool loadPaletteFile(const fs::path& path, std::vector<uint32_t>& palette) {
+    std::ifstream file(path, std::ios::binary);
+    uint8_t bgr[256 * 3];
+    if (!file || !file.read(reinterpret_cast<char*>(bgr), sizeof(bgr))) {
+        return false;
+    }
+    
+    palette.assign(256, 0);
+    for (size_t i = 1; i < 256; i++) {
+        palette[i] = static_cast<uint32_t>(bgr[i * 3 + 2]) |
+                     static_cast<uint32_t>(bgr[i * 3 + 1]) << 8 |
+                     static_cast<uint32_t>(bgr[i * 3]) << 16 |
+                     0xFF000000u;
+    }
+    return true;
+}
+
+} // namespace
+
+bool AssetExtractor::bakeSpriteAtlases(const std::string& outputPath) {
+    bakedAtlasCount = 0;
+    fs::path outDir(outputPath);
+    
+    // Inventory and panel art is drawn with the Act 1 palette
+    TextureAtlasGenerator generator;
+    std::vector<uint32_t> palette;
+    if (loadPaletteFile(outDir / "data" / "palette" / "act1" / "pal.dat", palette)) {
+        generator.setPalette(palette);
+    }
+    
+    for (const auto& set : kAtlasSets) {
+        fs::path spriteDir = outDir / "sprites" / set;
+        std::vector<std::string> sprites;
+        std::error_code ec;
+        for (fs::directory_iterator it(spriteDir, ec), end; !ec && it != end; it.increment(ec)) {
+            std::string extension = it->path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+            if (it->is_regular_file() && extension == ".dc6") {
+                sprites.push_back(it->path().string());
+            }
+        }
+        if (sprites.empty()) {
+            continue;
+        }
+        
+        // Directory order varies between file systems; keep the pages stable
+        std::sort(sprites.begin(), sprites.end());
+        
+        // Pages are drawn and written one at a time, so a large set never
+        // has all of its frames decoded at once
+        fs::path atlasDir = outDir / "atlases";
+        TextureAtlas atlas;
+        if (!generator.bakeAtlas(sprites, atlasPageSize, atlasPageSize, (atlasDir / set).string(), atlas)) {
+            std::cerr << "Failed to save sprite atlas: " << set << std::endl;
+            
+            if (extractionMonitor) {
+                ExtractionError error;
+                error.type = ErrorType::INSUFFICIENT_SPACE;
+                error.filename = (atlasDir / set).string();
+                error.message = "Failed to write atlas pages";
+                error.isRecoverable = false;
+                extractionMonitor->reportError(error);
+            }
+            return false;
+        }
+        if (!atlas.isValid()) {
+            // Sets whose files hold no decodable frames are left as loose sprites
+            continue;
+        }
+        bakedAtlasCount++;
+    }
+    
+    return true;
+}
+
+bool AssetExtractor::compileDataTables(const std::string& outputPath) {
+    compiledTableCount = 0;
+    fs::path excelDir = fs::path(outputPath) / "data" / "excel";
+    
+    d2::utils::DataTableParser parser;
+    std::error_code ec;
+    for (fs::directory_iterator it(excelDir, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (!it->is_regular_file() || extension != ".txt") {
+            continue;
+        }
+        
+        std::ifstream file(it->path(), std::ios::binary);
+        if (!file) {
+            continue;
+        }
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        
+        // Tables already compiled from this text are kept
+        uint64_t sourceHash = d2::utils::DataTableParser::hashSource(text.data(), text.size());
+        std::string binaryPath = d2::utils::DataTableParser::getBinaryPath(it->path().string());
+        d2::utils::DataTable existing;
+        if (parser.loadBinaryFile(binaryPath, existing, sourceHash)) {
+            continue;
+        }
+        
+        auto table = parser.parseExcel(text.data(), text.size());
+        if (!parser.writeBinary(table, sourceHash, binaryPath)) {
+            std::cerr << "Failed to write data table: " << binaryPath << std::endl;
+            
+            if (extractionMonitor) {
+                ExtractionError error;
+                error.type = ErrorType::INSUFFICIENT_SPACE;
+                error.filename = binaryPath;
+                error.message = "Failed to write precompiled data table";
+                error.isRecoverable = false;
+                extractionMonitor->reportError(error);
+            }
+            return false;
+        }
+        compiledTableCount++;
+    }
+    
+    return true;
+}
+
 fs::path AssetExtractor::determineSpriteCategory(const std::string& filePath) const {
     std::string lowerPath = filePath;
     std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(), ::tolower);
@@ -452,7 +820,8 @@ bool AssetExtractor::extractDataTables(const fs::path& d2Path, const fs::path& o
         }
     }
     
-    return true;
+    // Precompile the Excel tables so the game does not parse their text
+    return compileDataTables(outputPath.string());
 }
 
 fs::path AssetExtractor::determineAudioCategory(const std::string& filePath) const {
@@ -477,6 +846,28 @@ fs::path AssetExtractor::determineDataCategory(const std::string& filePath) cons
     std::string lowerPath = filePath;
     std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(), ::tolower);
     
+    // Every act has its own pal.dat; keep the act directory so one act's
+    // palette does not overwrite another's
+    size_t palette = lowerPath.find("palette\\");
+    if (palette == std::string::npos) {
+        palette = lowerPath.find("palette/");
+    }
+    if (palette != std::string::npos) {
+        fs::path category("palette");
+        size_t start = palette + 8;
+        while (start < lowerPath.size()) {
+            size_t end = lowerPath.find_first_of("/\\", start);
+            if (end == std::string::npos) {
+                end = lowerPath.size();
+            }
+            if (end > start) {
+                category /= lowerPath.substr(start, end - start);
+            }
+            start = end + 1;
+        }
+        return category;
+    }
+    
     // Categorize based on file extension
     size_t len = lowerPath.length();
     if (len >= 4) {
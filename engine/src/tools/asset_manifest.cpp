@@ -6,13 +6,15 @@ namespace fs = std::filesystem;
 
 namespace d2 {
 
-void AssetManifest::addAsset(const std::string& path, size_t size, const std::string& checksum) {
+void AssetManifest::addAsset(const std::string& path, size_t size, const std::string& checksum,
+                             int64_t modifiedTime) {
     AssetInfo info;
     info.path = path;
     info.size = size;
     info.checksum = checksum;
     info.type = detectAssetType(path);
     info.version = 1;
+    info.modifiedTime = modifiedTime;
     
     assets[path] = info;
 }
@@ -37,7 +39,8 @@ bool AssetManifest::save(const std::string& path) const {
         file << "      \"size\": " << info.size << ",\n";
         file << "      \"checksum\": \"" << info.checksum << "\",\n";
         file << "      \"type\": \"" << info.type << "\",\n";
-        file << "      \"version\": " << info.version << "\n";
+        file << "      \"version\": " << info.version << ",\n";
+        file << "      \"modified\": " << info.modifiedTime << "\n";
         file << "    }";
         first = false;
     }
@@ -120,6 +123,16 @@ bool AssetManifest::load(const std::string& path) {
                             std::string versionStr = afterColon.substr(digitStart, digitEnd - digitStart);
                             info.version = std::stoi(versionStr);
                         }
+                        
+                        // Manifests written before modification times were
+                        // recorded end the asset here
+                        std::streampos versionEnd = file.tellg();
+                        if (std::getline(file, line) && line.find("\"modified\":") != std::string::npos) {
+                            info.modifiedTime = std::stoll(line.substr(line.find(":") + 1));
+                        } else {
+                            file.clear();
+                            file.seekg(versionEnd);
+                        }
                     }
                 } else {
                     // This line is not part of the current asset, seek back
@@ -139,6 +152,15 @@ const AssetManifest::AssetInfo* AssetManifest::getAssetInfo(const std::string& p
     return (it != assets.end()) ? &it->second : nullptr;
 }
 
+std::vector<std::string> AssetManifest::getAssetPaths() const {
+    std::vector<std::string> result;
+    result.reserve(assets.size());
+    for (const auto& [path, info] : assets) {
+        result.push_back(path);
+    }
+    return result;
+}
+
 std::vector<std::string> AssetManifest::getAssetsByType(const std::string& type) const {
     std::vector<std::string> result;
     for (const auto& [path, info] : assets) {
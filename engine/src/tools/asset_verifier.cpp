@@ -1,10 +1,9 @@
 #include "tools/asset_verifier.h"
+#include "utils/content_hash.h"
 #include <filesystem>
 #include <vector>
 #include <string>
-#include <fstream>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
@@ -48,23 +47,20 @@ VerificationResult AssetVerifier::fullVerification(const std::string& assetPath)
     return result;
 }
 
-// Simple checksum calculation (for testing)
-static std::string calculateChecksum(const std::string& filePath) {
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file) {
-        return "";
+// Checksum of a manifest's entries, independent of map order
+static std::string calculateManifestChecksum(const std::unordered_map<std::string, std::string>& fileChecksums) {
+    std::vector<std::string> lines;
+    lines.reserve(fileChecksums.size());
+    for (const auto& [path, checksum] : fileChecksums) {
+        lines.push_back(path + ":" + checksum + "\n");
     }
+    std::sort(lines.begin(), lines.end());
     
-    // Simple sum of bytes for now
-    unsigned long checksum = 0;
-    char byte;
-    while (file.get(byte)) {
-        checksum += static_cast<unsigned char>(byte);
+    std::string data;
+    for (const auto& line : lines) {
+        data += line;
     }
-    
-    std::stringstream ss;
-    ss << std::hex << checksum;
-    return ss.str();
+    return utils::ContentHash::toHex(utils::ContentHash::hash(data.data(), data.size()));
 }
 
 ChecksumManifest AssetVerifier::generateChecksumManifest(const std::string& assetPath) {
@@ -74,35 +70,25 @@ ChecksumManifest AssetVerifier::generateChecksumManifest(const std::string& asse
         return manifest;
     }
     
-    // Generate checksums for all files
+    // Collect every file, then hash them in parallel
+    std::vector<std::string> relativePaths;
+    std::vector<std::string> paths;
     for (const auto& entry : fs::recursive_directory_iterator(assetPath)) {
         if (entry.is_regular_file()) {
-            std::string relativePath = fs::relative(entry.path(), assetPath).string();
-            std::string checksum = calculateChecksum(entry.path().string());
-            
-            if (!checksum.empty()) {
-                manifest.fileChecksums[relativePath] = checksum;
-                manifest.fileCount++;
-            }
+            relativePaths.push_back(fs::relative(entry.path(), assetPath).string());
+            paths.push_back(entry.path().string());
         }
     }
     
-    // Generate manifest checksum (simple concatenation of all checksums)
-    std::stringstream manifestData;
-    for (const auto& [path, checksum] : manifest.fileChecksums) {
-        manifestData << path << ":" << checksum << "\n";
-    }
-    
-    // Calculate checksum of the manifest data itself
-    unsigned long manifestChecksum = 0;
-    std::string data = manifestData.str();
-    for (char c : data) {
-        manifestChecksum += static_cast<unsigned char>(c);
+    auto checksums = utils::ContentHash::hashFiles(paths);
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!checksums[i].empty()) {
+            manifest.fileChecksums[relativePaths[i]] = checksums[i];
+            manifest.fileCount++;
+        }
     }
     
-    std::stringstream ss;
-    ss << std::hex << manifestChecksum;
-    manifest.manifestChecksum = ss.str();
+    manifest.manifestChecksum = calculateManifestChecksum(manifest.fileChecksums);
     
     return manifest;
 }
@@ -114,24 +100,7 @@ bool AssetVerifier::validateManifest(const ChecksumManifest& manifest) {
     }
     
     // Recalculate manifest checksum to verify integrity
-    std::stringstream manifestData;
-    for (const auto& [path, checksum] : manifest.fileChecksums) {
-        manifestData << path << ":" << checksum << "\n";
-    }
-    
-    // Calculate checksum of the manifest data
-    unsigned long calculatedChecksum = 0;
-    std::string data = manifestData.str();
-    for (char c : data) {
-        calculatedChecksum += static_cast<unsigned char>(c);
-    }
-    
-    std::stringstream ss;
-    ss << std::hex << calculatedChecksum;
-    std::string expectedChecksum = ss.str();
-    
-    // Compare with stored checksum
-    return manifest.manifestChecksum == expectedChecksum;
+    return manifest.manifestChecksum == calculateManifestChecksum(manifest.fileChecksums);
 }
 
 } // namespace d2
\ No newline at end of file
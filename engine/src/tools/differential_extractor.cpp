@@ -1,59 +1,69 @@
 #include "tools/differential_extractor.h"
 #include "tools/asset_manifest.h"
 #include "tools/asset_extractor.h"
+#include "utils/content_hash.h"
 #include <filesystem>
-#include <fstream>
 #include <chrono>
-#include <sstream>
-#include <iomanip>
-#include <set>
+#include <unordered_set>
 #include <algorithm>
 
 namespace fs = std::filesystem;
 
 namespace d2 {
 
-// Helper function to calculate a simple checksum for a file
-static std::string calculateFileChecksum(const fs::path& filePath) {
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file) {
-        return "";
+// Files written this close to a scan may still change within the same
+// timestamp tick, so their modification time is not trusted later
+constexpr auto kTimestampSettleTime = std::chrono::seconds(2);
+
+struct ScannedFile {
+    std::string name;   // Manifest path
+    std::string path;   // Path on disk
+    uintmax_t size;
+    int64_t modifiedTime;
+};
+
+static int64_t modificationTime(const fs::directory_entry& entry) {
+    return static_cast<int64_t>(entry.last_write_time().time_since_epoch().count());
+}
+
+// Sort scanned files into added and modified ones. A file whose size and
+// modification time match its manifest entry is unchanged without being
+// read; the remaining candidates are hashed in parallel.
+static void compareWithManifest(const std::vector<ScannedFile>& files,
+                                const AssetManifest& manifest,
+                                FileChanges& changes) {
+    enum class State { UNCHANGED, ADDED, MODIFIED, HASH };
+    std::vector<State> states(files.size(), State::UNCHANGED);
+    std::vector<std::string> toHash;
+    std::vector<size_t> hashedIndices;
+
+    for (size_t i = 0; i < files.size(); i++) {
+        const auto* info = manifest.getAssetInfo(files[i].name);
+        if (!info || info->path.empty()) {
+            states[i] = State::ADDED;
+        } else if (files[i].size != info->size) {
+            states[i] = State::MODIFIED;
+        } else if (info->modifiedTime == 0 || files[i].modifiedTime != info->modifiedTime) {
+            states[i] = State::HASH;
+            toHash.push_back(files[i].path);
+            hashedIndices.push_back(i);
+        }
     }
-    
-    // Simple checksum: combine file size with first and last 1KB of content
-    file.seekg(0, std::ios::end);
-    size_t fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    std::stringstream checksum;
-    checksum << std::hex << fileSize << "_";
-    
-    // Read first 1KB
-    char buffer[1024] = {0};
-    file.read(buffer, sizeof(buffer));
-    size_t bytesRead = file.gcount();
-    
-    // Simple hash of first bytes
-    size_t hash1 = 0;
-    for (size_t i = 0; i < bytesRead; ++i) {
-        hash1 = (hash1 * 31) + static_cast<unsigned char>(buffer[i]);
+
+    auto hashes = utils::ContentHash::hashFiles(toHash);
+    for (size_t h = 0; h < hashes.size(); h++) {
+        size_t i = hashedIndices[h];
+        const auto* info = manifest.getAssetInfo(files[i].name);
+        states[i] = (hashes[h].empty() || hashes[h] != info->checksum) ? State::MODIFIED : State::UNCHANGED;
     }
-    checksum << std::hex << hash1 << "_";
-    
-    // Read last 1KB if file is large enough
-    if (fileSize > 1024) {
-        file.seekg(-1024, std::ios::end);
-        file.read(buffer, sizeof(buffer));
-        bytesRead = file.gcount();
-        
-        size_t hash2 = 0;
-        for (size_t i = 0; i < bytesRead; ++i) {
-            hash2 = (hash2 * 31) + static_cast<unsigned char>(buffer[i]);
+
+    for (size_t i = 0; i < files.size(); i++) {
+        if (states[i] == State::ADDED) {
+            changes.addedFiles.push_back(files[i].name);
+        } else if (states[i] == State::MODIFIED) {
+            changes.modifiedFiles.push_back(files[i].name);
         }
-        checksum << std::hex << hash2;
     }
-    
-    return checksum.str();
 }
 
 bool DifferentialExtractor::fullExtraction(const std::string& d2Path, const std::string& outputPath) {
@@ -76,23 +86,30 @@ bool DifferentialExtractor::fullExtraction(const std::string& d2Path, const std:
 std::unique_ptr<AssetManifest> DifferentialExtractor::generateManifest(const std::string& extractedPath) {
     auto manifest = std::make_unique<AssetManifest>();
     
-    // Scan extracted files and add to manifest
+    // Scan extracted files, then hash them all in parallel
+    std::vector<ScannedFile> files;
     if (fs::exists(extractedPath)) {
+        auto settled = fs::file_time_type::clock::now() - kTimestampSettleTime;
         for (const auto& entry : fs::recursive_directory_iterator(extractedPath)) {
             if (entry.is_regular_file()) {
                 fs::path relativePath = fs::relative(entry.path(), extractedPath);
-                
-                // Calculate file size
-                auto fileSize = entry.file_size();
-                
-                // Calculate proper checksum
-                std::string checksum = calculateFileChecksum(entry.path());
-                
-                manifest->addAsset(relativePath.string(), fileSize, checksum);
+                int64_t modifiedTime = entry.last_write_time() < settled ? modificationTime(entry) : 0;
+                files.push_back({relativePath.string(), entry.path().string(), entry.file_size(), modifiedTime});
             }
         }
     }
     
+    std::vector<std::string> paths;
+    paths.reserve(files.size());
+    for (const auto& file : files) {
+        paths.push_back(file.path);
+    }
+    auto checksums = utils::ContentHash::hashFiles(paths);
+    
+    for (size_t i = 0; i < files.size(); i++) {
+        manifest->addAsset(files[i].name, files[i].size, checksums[i], files[i].modifiedTime);
+    }
+    
     return manifest;
 }
 
@@ -101,30 +118,16 @@ FileChanges DifferentialExtractor::detectChanges(const std::string& d2Path,
     FileChanges changes;
     
     // Check MPQ files in the D2 path
+    std::vector<ScannedFile> files;
     if (fs::exists(d2Path)) {
         for (const auto& entry : fs::directory_iterator(d2Path)) {
             if (entry.is_regular_file() && entry.path().extension() == ".mpq") {
-                std::string filename = entry.path().filename().string();
-                
-                // Calculate current file checksum
-                auto fileSize = entry.file_size();
-                auto modTime = fs::last_write_time(entry.path()).time_since_epoch().count();
-                std::string currentChecksum = std::to_string(fileSize) + "_" + 
-                                            std::to_string(static_cast<long long>(modTime));
-                
-                // Check if file exists in manifest
-                auto assetInfo = baseManifest.getAssetInfo(filename);
-                if (assetInfo->path.empty()) {
-                    // File is new
-                    changes.addedFiles.push_back(filename);
-                } else if (assetInfo->checksum != currentChecksum) {
-                    // File has been modified
-                    changes.modifiedFiles.push_back(filename);
-                }
-                // Note: We don't check for unchanged files in this simple implementation
+                files.push_back({entry.path().filename().string(), entry.path().string(),
+                                 entry.file_size(), modificationTime(entry)});
             }
         }
     }
+    compareWithManifest(files, baseManifest, changes);
     
     // Check for deleted files would require iterating the manifest
     // and checking if files still exist - skipping for now
@@ -135,9 +138,10 @@ FileChanges DifferentialExtractor::detectChanges(const std::string& d2Path,
 FileChanges DifferentialExtractor::detectChangesInExtractedAssets(const std::string& extractedPath,
                                                                 const AssetManifest& baseManifest) {
     FileChanges changes;
-    std::set<std::string> processedFiles;
+    std::unordered_set<std::string> processedFiles;
     
     // Check existing files for modifications and additions
+    std::vector<ScannedFile> files;
     if (fs::exists(extractedPath)) {
         for (const auto& entry : fs::recursive_directory_iterator(extractedPath)) {
             if (entry.is_regular_file()) {
@@ -148,42 +152,19 @@ FileChanges DifferentialExtractor::detectChangesInExtractedAssets(const std::str
                 std::replace(relativePathStr.begin(), relativePathStr.end(), '\\', '/');
                 
                 processedFiles.insert(relativePathStr);
-                
-                // Calculate current file checksum
-                std::string currentChecksum = calculateFileChecksum(entry.path());
-                
-                // Check if file exists in manifest
-                auto assetInfo = baseManifest.getAssetInfo(relativePathStr);
-                if (!assetInfo || assetInfo->path.empty()) {
-                    // File is new
-                    changes.addedFiles.push_back(relativePathStr);
-                } else if (assetInfo->checksum != currentChecksum) {
-                    // File has been modified
-                    changes.modifiedFiles.push_back(relativePathStr);
-                }
+                files.push_back({relativePathStr, entry.path().string(), entry.file_size(), modificationTime(entry)});
             }
         }
     }
+    compareWithManifest(files, baseManifest, changes);
     
-    // Check for deleted files - iterate through manifest and see what's missing
-    // We need a way to get all assets from the manifest
-    // For now, we'll check specific known paths from the test
-    std::vector<std::string> knownAssets = {
-        "sprites/characters/barbarian.dc6",
-        "sprites/monsters/skeleton.dc6",
-        "sounds/effects/sword_hit.wav"
-    };
-    
-    for (const auto& assetPath : knownAssets) {
+    // Files in the manifest that are no longer on disk were deleted
+    for (const auto& assetPath : baseManifest.getAssetPaths()) {
         if (processedFiles.find(assetPath) == processedFiles.end()) {
-            // Check if this asset was in the original manifest
-            auto assetInfo = baseManifest.getAssetInfo(assetPath);
-            if (assetInfo && !assetInfo->path.empty()) {
-                // File was in manifest but is now missing
-                changes.deletedFiles.push_back(assetPath);
-            }
+            changes.deletedFiles.push_back(assetPath);
         }
     }
+    std::sort(changes.deletedFiles.begin(), changes.deletedFiles.end());
     
     return changes;
 }
@@ -238,6 +219,9 @@ IncrementalUpdateResult DifferentialExtractor::incrementalUpdate(const std::stri
         }
     }
     
+    std::unordered_set<std::string> changedFiles(changes.modifiedFiles.begin(), changes.modifiedFiles.end());
+    changedFiles.insert(changes.addedFiles.begin(), changes.addedFiles.end());
+    
     // Copy unchanged files from source (in a real implementation, these would come from a base extraction)
     // For now, we'll copy all files that aren't in the changed lists
     if (fs::exists(sourcePath)) {
@@ -248,21 +232,7 @@ IncrementalUpdateResult DifferentialExtractor::incrementalUpdate(const std::stri
                 std::replace(relativePathStr.begin(), relativePathStr.end(), '\\', '/');
                 
                 // Check if this file was already processed
-                bool isChanged = false;
-                for (const auto& file : changes.modifiedFiles) {
-                    if (file == relativePathStr) {
-                        isChanged = true;
-                        break;
-                    }
-                }
-                if (!isChanged) {
-                    for (const auto& file : changes.addedFiles) {
-                        if (file == relativePathStr) {
-                            isChanged = true;
-                            break;
-                        }
-                    }
-                }
+                bool isChanged = changedFiles.count(relativePathStr) > 0;
                 
                 if (!isChanged) {
                     // Copy unchanged file
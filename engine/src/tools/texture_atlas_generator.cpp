@@ -1,120 +1,1009 @@
 #include "tools/texture_atlas_generator.h"
+#include "sprites/dc6_parser.h"
+#include "sprites/frame_trim.h"
+#include "sprites/palette_expand.h"
+#include <zlib.h>
 #include <filesystem>
+#include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <thread>
 
 namespace fs = std::filesystem;
 
 namespace d2 {
 
+namespace {
+
+constexpr char kAtlasMagic[4] = {'D', '2', 'A', 'M'};
+constexpr uint32_t kAtlasVersion = 1;
+
+// On-disk map. Sprite names are stored in a pool after the sprite table.
+struct AtlasHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t page_count;
+    uint32_t sprite_count;
+    uint32_t name_pool_size;
+    uint32_t reserved;
+};
+static_assert(sizeof(AtlasHeader) == 24, "AtlasHeader layout changed");
+
+struct AtlasPageRecord {
+    uint32_t width;
+    uint32_t height;
+};
+static_assert(sizeof(AtlasPageRecord) == 8, "AtlasPageRecord layout changed");
+
+struct AtlasSpriteRecord {
+    uint32_t name_offset;   // Relative to the name pool
+    uint32_t name_length;
+    int32_t page;
+    int32_t x, y;
+    int32_t width, height;
+    int32_t source_width, source_height;
+    int32_t trim_x, trim_y;
+    int32_t offset_x, offset_y;
+};
+static_assert(sizeof(AtlasSpriteRecord) == 52, "AtlasSpriteRecord layout changed");
+
+// Larger images cannot be packed onto any page, so they are never decoded
+constexpr uint32_t kMaxPNGSide = 16384;
+
+constexpr uint8_t kPNGSignature[8] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+
+uint32_t readBE32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void appendBE32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    if (size < 0) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), size));
+}
+
+bool isPNG(const std::vector<uint8_t>& file) {
+    return file.size() >= sizeof(kPNGSignature) &&
+           std::memcmp(file.data(), kPNGSignature, sizeof(kPNGSignature)) == 0;
+}
+
+// The IHDR chunk always comes first, right after the signature
+bool readPNGSize(const std::vector<uint8_t>& file, uint32_t& width, uint32_t& height) {
+    if (!isPNG(file) || file.size() < 33 || readBE32(file.data() + 8) != 13 ||
+        std::memcmp(file.data() + 12, "IHDR", 4) != 0) {
+        return false;
+    }
+    width = readBE32(file.data() + 16);
+    height = readBE32(file.data() + 20);
+    return width > 0 && height > 0;
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Decodes 8-bit, non-interlaced gray, RGB, gray-alpha and RGBA images
+bool decodePNG(const std::vector<uint8_t>& file, uint32_t width, uint32_t height, std::vector<uint8_t>& rgba) {
+    uint8_t bit_depth = file[24];
+    uint8_t color_type = file[25];
+    uint8_t interlace = file[28];
+    size_t channels;
+    switch (color_type) {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 4: channels = 2; break;
+        case 6: channels = 4; break;
+        default: return false;
+    }
+    if (bit_depth != 8 || interlace != 0 || width > kMaxPNGSide || height > kMaxPNGSide) {
+        return false;
+    }
+
+    std::vector<uint8_t> compressed;
+    size_t position = 8;
+    while (position + 12 <= file.size()) {
+        uint32_t length = readBE32(file.data() + position);
+        const uint8_t* type = file.data() + position + 4;
+        if (length > file.size() - position - 12) {
+            return false;
+        }
+        if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), type + 4, type + 4 + length);
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        position += 12 + static_cast<size_t>(length);
+    }
+
+    size_t stride = width * channels;
+    std::vector<uint8_t> raw((stride + 1) * height);
+    uLongf raw_size = static_cast<uLongf>(raw.size());
+    if (compressed.empty() ||
+        uncompress(raw.data(), &raw_size, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK ||
+        raw_size != raw.size()) {
+        return false;
+    }
+
+    // Undo the per-row filters in place
+    std::vector<uint8_t> zero_row(stride, 0);
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t* row = raw.data() + y * (stride + 1) + 1;
+        const uint8_t* previous = y > 0 ? row - (stride + 1) : zero_row.data();
+        uint8_t filter = row[-1];
+        for (size_t i = 0; i < stride; i++) {
+            uint8_t left = i >= channels ? row[i - channels] : 0;
+            uint8_t up_left = i >= channels ? previous[i - channels] : 0;
+            switch (filter) {
+                case 0: break;
+                case 1: row[i] = static_cast<uint8_t>(row[i] + left); break;
+                case 2: row[i] = static_cast<uint8_t>(row[i] + previous[i]); break;
+                case 3: row[i] = static_cast<uint8_t>(row[i] + ((left + previous[i]) >> 1)); break;
+                case 4: row[i] = static_cast<uint8_t>(row[i] + paeth(left, previous[i], up_left)); break;
+                default: return false;
+            }
+        }
+    }
+
+    rgba.resize(static_cast<size_t>(width) * height * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* row = raw.data() + y * (stride + 1) + 1;
+        uint8_t* out = rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (uint32_t x = 0; x < width; x++) {
+            const uint8_t* pixel = row + x * channels;
+            bool gray = channels <= 2;
+            out[x * 4 + 0] = pixel[0];
+            out[x * 4 + 1] = gray ? pixel[0] : pixel[1];
+            out[x * 4 + 2] = gray ? pixel[0] : pixel[2];
+            out[x * 4 + 3] = (channels == 2) ? pixel[1] : (channels == 4 ? pixel[3] : 255);
+        }
+    }
+    return true;
+}
+
+void appendPNGChunk(std::vector<uint8_t>& png, const char* type, const uint8_t* data, size_t size) {
+    appendBE32(png, static_cast<uint32_t>(size));
+    size_t type_offset = png.size();
+    png.insert(png.end(), type, type + 4);
+    if (size > 0) {
+        png.insert(png.end(), data, data + size);
+    }
+    uLong crc = crc32(0L, png.data() + type_offset, static_cast<uInt>(4 + size));
+    appendBE32(png, static_cast<uint32_t>(crc));
+}
+
+bool writePNG(const std::string& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgba) {
+    // Every row uses filter 0
+    size_t stride = static_cast<size_t>(width) * 4;
+    std::vector<uint8_t> raw((stride + 1) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        raw[y * (stride + 1)] = 0;
+        std::memcpy(raw.data() + y * (stride + 1) + 1, rgba.data() + y * stride, stride);
+    }
+    uLongf compressed_size = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> compressed(compressed_size);
+    if (compress2(compressed.data(), &compressed_size, raw.data(), static_cast<uLong>(raw.size()),
+                  Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return false;
+    }
+
+    std::vector<uint8_t> png(kPNGSignature, kPNGSignature + sizeof(kPNGSignature));
+    std::vector<uint8_t> ihdr;
+    appendBE32(ihdr, width);
+    appendBE32(ihdr, height);
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});  // 8-bit RGBA, deflate, no filter, no interlace
+    appendPNGChunk(png, "IHDR", ihdr.data(), ihdr.size());
+    appendPNGChunk(png, "IDAT", compressed.data(), compressed_size);
+    appendPNGChunk(png, "IEND", nullptr, 0);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
+
+// Runs fn(0) .. fn(count - 1) on up to thread_count threads
+void parallelFor(size_t count, size_t thread_count, const std::function<void(size_t)>& fn) {
+    thread_count = std::min(thread_count, count);
+    if (thread_count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                fn(i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+struct Rect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+enum class PackHeuristic {
+    BEST_SHORT_SIDE_FIT,
+    BEST_LONG_SIDE_FIT,
+    BEST_AREA_FIT,
+    BOTTOM_LEFT,
+    SKYLINE_BOTTOM_LEFT
+};
+
+enum class SortOrder {
+    AREA,
+    MAX_SIDE,
+    HEIGHT,
+    WIDTH
+};
+
+// MaxRects bin: keeps every maximal free rectangle and places each sprite
+// in the free rectangle the heuristic scores lowest
+class MaxRectsBin {
+public:
+    MaxRectsBin(int width, int height, PackHeuristic heuristic) : heuristic_(heuristic) {
+        free_.push_back({0, 0, width, height});
+    }
+
+    bool insert(int width, int height, Rect& placed) {
+        long long best_primary = std::numeric_limits<long long>::max();
+        long long best_secondary = std::numeric_limits<long long>::max();
+        bool found = false;
+        for (const Rect& free : free_) {
+            if (free.width < width || free.height < height) {
+                continue;
+            }
+            long long leftover_x = free.width - width;
+            long long leftover_y = free.height - height;
+            long long primary, secondary;
+            switch (heuristic_) {
+                case PackHeuristic::BEST_LONG_SIDE_FIT:
+                    primary = std::max(leftover_x, leftover_y);
+                    secondary = std::min(leftover_x, leftover_y);
+                    break;
+                case PackHeuristic::BEST_AREA_FIT:
+                    primary = static_cast<long long>(free.width) * free.height - static_cast<long long>(width) * height;
+                    secondary = std::min(leftover_x, leftover_y);
+                    break;
+                case PackHeuristic::BOTTOM_LEFT:
+                    primary = free.y + height;
+                    secondary = free.x;
+                    break;
+                default:
+                    primary = std::min(leftover_x, leftover_y);
+                    secondary = std::max(leftover_x, leftover_y);
+                    break;
+            }
+            if (primary < best_primary || (primary == best_primary && secondary < best_secondary)) {
+                best_primary = primary;
+                best_secondary = secondary;
+                placed = {free.x, free.y, width, height};
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+
+        // Split every free rectangle the new one overlaps
+        std::vector<Rect> next;
+        next.reserve(free_.size() + 4);
+        for (const Rect& free : free_) {
+            if (!intersects(free, placed)) {
+                next.push_back(free);
+                continue;
+            }
+            if (placed.x > free.x) {
+                next.push_back({free.x, free.y, placed.x - free.x, free.height});
+            }
+            if (placed.x + placed.width < free.x + free.width) {
+                next.push_back({placed.x + placed.width, free.y,
+                                free.x + free.width - placed.x - placed.width, free.height});
+            }
+            if (placed.y > free.y) {
+                next.push_back({free.x, free.y, free.width, placed.y - free.y});
+            }
+            if (placed.y + placed.height < free.y + free.height) {
+                next.push_back({free.x, placed.y + placed.height,
+                                free.width, free.y + free.height - placed.y - placed.height});
+            }
+        }
+        free_.swap(next);
+        prune();
+        return true;
+    }
+
+private:
+    static bool intersects(const Rect& a, const Rect& b) {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    static bool contains(const Rect& outer, const Rect& inner) {
+        return inner.x >= outer.x && inner.y >= outer.y &&
+               inner.x + inner.width <= outer.x + outer.width &&
+               inner.y + inner.height <= outer.y + outer.height;
+    }
+
+    // Drop free rectangles that lie inside another one
+    void prune() {
+        std::vector<bool> redundant(free_.size(), false);
+        for (size_t i = 0; i < free_.size(); i++) {
+            for (size_t j = 0; j < free_.size() && !redundant[i]; j++) {
+                if (i == j || redundant[j]) {
+                    continue;
+                }
+                // Of two identical rectangles, keep the first
+                if (contains(free_[j], free_[i]) &&
+                    (!contains(free_[i], free_[j]) || j < i)) {
+                    redundant[i] = true;
+                }
+            }
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < free_.size(); i++) {
+            if (!redundant[i]) {
+                free_[kept++] = free_[i];
+            }
+        }
+        free_.resize(kept);
+    }
+
+    PackHeuristic heuristic_;
+    std::vector<Rect> free_;
+};
+
+// Skyline bin: tracks the top edge of the packed area and places each
+// sprite where its top ends lowest
+class SkylineBin {
+public:
+    SkylineBin(int width, int height) : width_(width), height_(height) {
+        skyline_.push_back({0, 0, width});
+    }
+
+    bool insert(int width, int height, Rect& placed) {
+        int best_top = std::numeric_limits<int>::max();
+        int best_width = std::numeric_limits<int>::max();
+        size_t best_index = skyline_.size();
+        for (size_t i = 0; i < skyline_.size(); i++) {
+            int y;
+            if (!fits(i, width, height, y)) {
+                continue;
+            }
+            if (y + height < best_top || (y + height == best_top && skyline_[i].width < best_width)) {
+                best_top = y + height;
+                best_width = skyline_[i].width;
+                best_index = i;
+                placed = {skyline_[i].x, y, width, height};
+            }
+        }
+        if (best_index == skyline_.size()) {
+            return false;
+        }
+        addLevel(best_index, placed);
+        return true;
+    }
+
+private:
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    bool fits(size_t index, int width, int height, int& y) const {
+        if (skyline_[index].x + width > width_) {
+            return false;
+        }
+        y = skyline_[index].y;
+        int remaining = width;
+        for (size_t i = index; remaining > 0; i++) {
+            if (i == skyline_.size()) {
+                return false;
+            }
+            y = std::max(y, skyline_[i].y);
+            if (y + height > height_) {
+                return false;
+            }
+            remaining -= skyline_[i].width;
+        }
+        return true;
+    }
+
+    void addLevel(size_t index, const Rect& placed) {
+        skyline_.insert(skyline_.begin() + static_cast<std::ptrdiff_t>(index),
+                        {placed.x, placed.y + placed.height, placed.width});
+        int right = placed.x + placed.width;
+        for (size_t i = index + 1; i < skyline_.size();) {
+            if (skyline_[i].x >= right) {
+                break;
+            }
+            int shrink = right - skyline_[i].x;
+            if (skyline_[i].width <= shrink) {
+                skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+            skyline_[i].x += shrink;
+            skyline_[i].width -= shrink;
+            break;
+        }
+        for (size_t i = 0; i + 1 < skyline_.size();) {
+            if (skyline_[i].y == skyline_[i + 1].y) {
+                skyline_[i].width += skyline_[i + 1].width;
+                skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(i + 1));
+            } else {
+                i++;
+            }
+        }
+    }
+
+    int width_;
+    int height_;
+    std::vector<Segment> skyline_;
+};
+
+int roundUpToPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
 struct TextureAtlasGenerator::Impl {
     struct Sprite {
         std::string name;
         int width;
         int height;
         std::string path;
+        int sourceWidth = 0;
+        int sourceHeight = 0;
+        int trimX = 0;
+        int trimY = 0;
+        int offsetX = 0;
+        int offsetY = 0;
+        std::vector<uint8_t> rgba;  // Only filled while the sprite's page is composed
+    };
+
+    struct Placement {
+        int page = -1;
+        Rect rect;
     };
-    
+
+    struct PackResult {
+        std::vector<Placement> placements;
+        std::vector<std::pair<int, int>> page_sizes;
+        uint64_t page_area = 0;
+    };
+
+    // Measured sprites, file by file; the sprites of spritePaths[i] start
+    // at file_first[i]
     std::vector<Sprite> sprites;
+    std::vector<size_t> file_first;
+    std::vector<std::string> paths;
+    PackResult packed;
+    std::vector<uint32_t> palette;
+
+    using ExpandFn = std::function<bool(size_t)>;
+    using VisitFn = std::function<void(size_t, Sprite&)>;
+
+    static void loadSprites(const std::string& path, const std::vector<uint32_t>& palette,
+                            const ExpandFn& expand, const VisitFn& visit);
+    PackResult pack(PackHeuristic heuristic, SortOrder order, int maxWidth, int maxHeight,
+                    int padding, bool powerOfTwo) const;
+    void layout(const std::vector<std::string>& spritePaths, int maxWidth, int maxHeight,
+                int padding, bool powerOfTwo, size_t threads, TextureAtlas& atlas);
+    std::shared_ptr<std::vector<uint8_t>> composePage(size_t page, size_t threads) const;
 };
 
-TextureAtlasGenerator::TextureAtlasGenerator() : pImpl(std::make_unique<Impl>()) {
+// Reads the sprites of one file in order and hands each to visit with its
+// position in the file. Pixels are decoded to RGBA only for the sprites
+// expand selects, so measuring a file keeps none of them.
+void TextureAtlasGenerator::Impl::loadSprites(const std::string& path, const std::vector<uint32_t>& palette,
+                                              const ExpandFn& expand, const VisitFn& visit) {
+    std::vector<uint8_t> data;
+    if (!readFile(path, data)) {
+        return;
+    }
+    std::string file_name = fs::path(path).filename().string();
+
+    uint32_t width = 0, height = 0;
+    if (readPNGSize(data, width, height)) {
+        Sprite sprite;
+        sprite.name = file_name;
+        sprite.path = path;
+        sprite.width = sprite.sourceWidth = static_cast<int>(width);
+        sprite.height = sprite.sourceHeight = static_cast<int>(height);
+        if (expand && expand(0) && !decodePNG(data, width, height, sprite.rgba)) {
+            sprite.rgba.clear();
+        }
+        visit(0, sprite);
+        return;
+    }
+
+    // Anything else has to be a DC6; each frame is packed on its own
+    d2portable::sprites::DC6Parser parser;
+    auto dc6 = parser.parseData(std::move(data));
+    if (!dc6) {
+        return;
+    }
+    size_t slot = 0;
+    for (uint32_t d = 0; d < dc6->getDirectionCount(); d++) {
+        for (uint32_t f = 0; f < dc6->getFramesPerDirection(); f++, slot++) {
+            auto frame = dc6->getFrameView(d, f);
+            Sprite sprite;
+            sprite.name = TextureAtlas::frameName(file_name, static_cast<int>(d), static_cast<int>(f));
+            sprite.path = path;
+            sprite.sourceWidth = static_cast<int>(frame.width);
+            sprite.sourceHeight = static_cast<int>(frame.height);
+            sprite.offsetX = frame.offsetX;
+            sprite.offsetY = frame.offsetY;
+
+            // Transparent borders are not packed; a blank frame packs nothing
+            d2portable::sprites::FrameRect bounds;
+            if (!frame.empty() && frame.pixelCount == static_cast<size_t>(frame.width) * frame.height) {
+                bounds = d2portable::sprites::findOpaqueBounds(frame.pixels, frame.width, frame.height);
+            }
+            sprite.trimX = static_cast<int>(bounds.x);
+            sprite.trimY = static_cast<int>(bounds.y);
+            sprite.width = static_cast<int>(bounds.width);
+            sprite.height = static_cast<int>(bounds.height);
+            if (!bounds.empty() && expand && expand(slot)) {
+                std::vector<uint8_t> indices(static_cast<size_t>(bounds.width) * bounds.height);
+                d2portable::sprites::copyFrameRect(frame.pixels, frame.width, 1, bounds, indices.data());
+                sprite.rgba.resize(indices.size() * 4);
+                d2portable::sprites::expandPalette(indices.data(), indices.size(), palette.data(), sprite.rgba.data());
+            }
+            visit(slot, sprite);
+        }
+    }
 }
 
-TextureAtlasGenerator::~TextureAtlasGenerator() = default;
+TextureAtlasGenerator::Impl::PackResult
+TextureAtlasGenerator::Impl::pack(PackHeuristic heuristic, SortOrder order, int maxWidth, int maxHeight,
+                                  int padding, bool powerOfTwo) const {
+    PackResult result;
+    result.placements.resize(sprites.size());
 
-TextureAtlas TextureAtlasGenerator::generateAtlas(const std::vector<std::string>& spritePaths, 
-                                                  int maxWidth, int maxHeight) {
-    TextureAtlas atlas;
-    
-    // Load sprite information
-    pImpl->sprites.clear();
-    for (const auto& path : spritePaths) {
-        if (!fs::exists(path)) {
-            continue;
+    // Padding is added to the right and bottom of every sprite, and the bin
+    // grows by the same amount so a sprite can still touch the page edge
+    std::vector<size_t> remaining;
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const Sprite& sprite = sprites[i];
+        if (sprite.width > 0 && sprite.height > 0 && sprite.width <= maxWidth && sprite.height <= maxHeight) {
+            remaining.push_back(i);
         }
-        
-        Impl::Sprite sprite;
-        sprite.path = path;
-        sprite.name = fs::path(path).filename().string();
-        
-        // For now, assume some fixed sizes for testing
-        // In real implementation, we'd read the actual image dimensions
-        if (sprite.name == "sprite1.png") {
-            sprite.width = 128;
-            sprite.height = 128;
-        } else if (sprite.name == "sprite2.png") {
-            sprite.width = 64;
-            sprite.height = 64;
-        } else if (sprite.name == "sprite3.png") {
-            sprite.width = 256;
-            sprite.height = 256;
-        } else if (sprite.name.find("small_sprite_") == 0) {
-            // Handle the small sprites for the efficient packing test
-            sprite.width = 64;
-            sprite.height = 64;
-        } else if (sprite.name.find("medium_sprite_") == 0) {
-            // Handle the medium sprites for power-of-two test
-            sprite.width = 200;
-            sprite.height = 200;
-        } else {
-            // Default size
-            sprite.width = 64;
-            sprite.height = 64;
-        }
-        
-        pImpl->sprites.push_back(sprite);
-    }
-    
-    // Simple packing algorithm - just place sprites in order
-    // Real implementation would use a better bin packing algorithm
-    int currentX = 0;
-    int currentY = 0;
-    int rowHeight = 0;
-    int currentPage = 0;
-    
-    for (const auto& sprite : pImpl->sprites) {
-        // Check if sprite fits in current row
-        if (currentX + sprite.width + padding > maxWidth) {
-            // Move to next row
-            currentX = 0;
-            currentY += rowHeight + padding;
-            rowHeight = 0;
-        }
-        
-        // Check if sprite fits on current page
-        if (currentY + sprite.height + padding > maxHeight) {
-            // Move to next page
-            currentPage++;
-            currentX = 0;
-            currentY = 0;
-            rowHeight = 0;
-        }
-        
-        // Place sprite
+    }
+    auto key = [&](size_t index) -> long long {
+        const Sprite& sprite = sprites[index];
+        switch (order) {
+            case SortOrder::MAX_SIDE: return std::max(sprite.width, sprite.height);
+            case SortOrder::HEIGHT: return sprite.height;
+            case SortOrder::WIDTH: return sprite.width;
+            default: return static_cast<long long>(sprite.width) * sprite.height;
+        }
+    };
+    std::stable_sort(remaining.begin(), remaining.end(),
+                     [&](size_t a, size_t b) { return key(a) > key(b); });
+
+    while (!remaining.empty()) {
+        int page = static_cast<int>(result.page_sizes.size());
+        MaxRectsBin max_rects(maxWidth + padding, maxHeight + padding, heuristic);
+        SkylineBin skyline(maxWidth + padding, maxHeight + padding);
+        std::vector<size_t> leftover;
+        int used_width = 0;
+        int used_height = 0;
+        for (size_t index : remaining) {
+            const Sprite& sprite = sprites[index];
+            Rect placed;
+            bool fits = (heuristic == PackHeuristic::SKYLINE_BOTTOM_LEFT)
+                ? skyline.insert(sprite.width + padding, sprite.height + padding, placed)
+                : max_rects.insert(sprite.width + padding, sprite.height + padding, placed);
+            if (!fits) {
+                leftover.push_back(index);
+                continue;
+            }
+            placed.width = sprite.width;
+            placed.height = sprite.height;
+            result.placements[index] = {page, placed};
+            used_width = std::max(used_width, placed.x + placed.width);
+            used_height = std::max(used_height, placed.y + placed.height);
+        }
+        if (leftover.size() == remaining.size()) {
+            break;
+        }
+
+        if (powerOfTwo) {
+            used_width = std::min(roundUpToPowerOfTwo(used_width), std::max(maxWidth, used_width));
+            used_height = std::min(roundUpToPowerOfTwo(used_height), std::max(maxHeight, used_height));
+        }
+        result.page_sizes.emplace_back(used_width, used_height);
+        result.page_area += static_cast<uint64_t>(used_width) * used_height;
+        remaining.swap(leftover);
+    }
+    return result;
+}
+
+// Measures every sprite, packs them and fills the atlas map and page sizes;
+// no pixels are kept
+void TextureAtlasGenerator::Impl::layout(const std::vector<std::string>& spritePaths, int maxWidth, int maxHeight,
+                                         int padding, bool powerOfTwo, size_t threads, TextureAtlas& atlas) {
+    sprites.clear();
+    file_first.clear();
+    paths = spritePaths;
+    packed = PackResult();
+
+    // Read sprite dimensions from the files themselves
+    std::vector<std::vector<Sprite>> loaded(spritePaths.size());
+    parallelFor(spritePaths.size(), threads, [&](size_t i) {
+        loadSprites(spritePaths[i], palette, nullptr, [&](size_t, Sprite& sprite) {
+            loaded[i].push_back(std::move(sprite));
+        });
+    });
+    for (auto& file_sprites : loaded) {
+        file_first.push_back(sprites.size());
+        for (auto& sprite : file_sprites) {
+            sprites.push_back(std::move(sprite));
+        }
+        std::vector<Sprite>().swap(file_sprites);
+    }
+    file_first.push_back(sprites.size());
+    if (sprites.empty()) {
+        return;
+    }
+
+    // Every heuristic and sort order is a separate trial
+    const PackHeuristic heuristics[] = {
+        PackHeuristic::BEST_SHORT_SIDE_FIT, PackHeuristic::BEST_LONG_SIDE_FIT,
+        PackHeuristic::BEST_AREA_FIT, PackHeuristic::BOTTOM_LEFT, PackHeuristic::SKYLINE_BOTTOM_LEFT
+    };
+    const SortOrder orders[] = {SortOrder::AREA, SortOrder::MAX_SIDE, SortOrder::HEIGHT, SortOrder::WIDTH};
+    std::vector<std::pair<PackHeuristic, SortOrder>> trials;
+    for (PackHeuristic heuristic : heuristics) {
+        for (SortOrder order : orders) {
+            trials.emplace_back(heuristic, order);
+        }
+    }
+    std::vector<PackResult> results(trials.size());
+    parallelFor(trials.size(), threads, [&](size_t i) {
+        results[i] = pack(trials[i].first, trials[i].second, maxWidth, maxHeight, padding, powerOfTwo);
+    });
+
+    // Fewest pages first, then least page area; ties keep the earlier trial
+    size_t best = 0;
+    for (size_t i = 1; i < results.size(); i++) {
+        const auto& candidate = results[i];
+        const auto& current = results[best];
+        if (candidate.page_sizes.size() < current.page_sizes.size() ||
+            (candidate.page_sizes.size() == current.page_sizes.size() && candidate.page_area < current.page_area)) {
+            best = i;
+        }
+    }
+    packed = std::move(results[best]);
+
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const Sprite& sprite = sprites[i];
+        const Placement& placement = packed.placements[i];
+        bool blank = sprite.width == 0 || sprite.height == 0;
+        if (placement.page < 0 && !blank) {
+            continue;  // Larger than a page
+        }
+
         TextureAtlas::SpriteInfo info;
-        info.page = currentPage;
-        info.x = currentX;
-        info.y = currentY;
+        info.page = std::max(placement.page, 0);
+        info.x = placement.rect.x;
+        info.y = placement.rect.y;
         info.width = sprite.width;
         info.height = sprite.height;
-        
+        info.sourceWidth = sprite.sourceWidth;
+        info.sourceHeight = sprite.sourceHeight;
+        info.trimX = sprite.trimX;
+        info.trimY = sprite.trimY;
+        info.offsetX = sprite.offsetX;
+        info.offsetY = sprite.offsetY;
         atlas.spriteMap[sprite.name] = info;
-        
-        // Update position
-        currentX += sprite.width + padding;
-        rowHeight = std::max(rowHeight, sprite.height);
-    }
-    
-    atlas.pageCount = currentPage + 1;
-    atlas.valid = true;
-    
+    }
+
+    // Blank frames point at page 0, so when nothing else was packed they
+    // get an empty 1x1 page to point at
+    if (!atlas.spriteMap.empty() && packed.page_sizes.empty()) {
+        packed.page_sizes.emplace_back(1, 1);
+        packed.page_area = 1;
+    }
+
+    atlas.pages.resize(packed.page_sizes.size());
+    for (size_t page = 0; page < atlas.pages.size(); page++) {
+        atlas.pages[page].width = packed.page_sizes[page].first;
+        atlas.pages[page].height = packed.page_sizes[page].second;
+    }
+    atlas.pageCount = static_cast<int>(atlas.pages.size());
+    atlas.valid = !atlas.spriteMap.empty();
+}
+
+// Draws one page. Only the files with a sprite on the page are read again,
+// and each frame is decoded just before it is copied in.
+std::shared_ptr<std::vector<uint8_t>> TextureAtlasGenerator::Impl::composePage(size_t page, size_t threads) const {
+    auto [width, height] = packed.page_sizes[page];
+    auto pixels = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(width) * height * 4, 0);
+
+    std::vector<size_t> files;
+    for (size_t file = 0; file < paths.size(); file++) {
+        for (size_t i = file_first[file]; i < file_first[file + 1]; i++) {
+            if (packed.placements[i].page == static_cast<int>(page)) {
+                files.push_back(file);
+                break;
+            }
+        }
+    }
+
+    // Sprites never overlap, so files can be drawn from several threads
+    parallelFor(files.size(), threads, [&](size_t k) {
+        size_t file = files[k];
+        size_t first = file_first[file];
+        size_t count = file_first[file + 1] - first;
+        auto on_page = [&](size_t slot) {
+            return slot < count && packed.placements[first + slot].page == static_cast<int>(page);
+        };
+        loadSprites(paths[file], palette, on_page, [&](size_t slot, Sprite& sprite) {
+            if (!on_page(slot) || sprite.rgba.empty()) {
+                return;
+            }
+
+            // A file that changed since it was measured is left out
+            const Sprite& measured = sprites[first + slot];
+            if (sprite.width != measured.width || sprite.height != measured.height) {
+                return;
+            }
+            const Rect& rect = packed.placements[first + slot].rect;
+            size_t row_bytes = static_cast<size_t>(sprite.width) * 4;
+            for (int y = 0; y < sprite.height; y++) {
+                std::memcpy(pixels->data() + ((static_cast<size_t>(rect.y) + y) * width + rect.x) * 4,
+                            sprite.rgba.data() + y * row_bytes, row_bytes);
+            }
+        });
+    });
+    return pixels;
+}
+
+TextureAtlasGenerator::TextureAtlasGenerator() : pImpl(std::make_unique<Impl>()) {
+    d2portable::sprites::DC6Parser parser;
+    pImpl->palette = parser.getDefaultPalette();
+}
+
+TextureAtlasGenerator::~TextureAtlasGenerator() = default;
+
+void TextureAtlasGenerator::setPalette(const std::vector<uint32_t>& palette) {
+    if (palette.size() == 256) {
+        pImpl->palette = palette;
+    }
+}
+
+TextureAtlas TextureAtlasGenerator::generateAtlas(const std::vector<std::string>& spritePaths,
+                                                  int maxWidth, int maxHeight) {
+    TextureAtlas atlas;
+    if (maxWidth <= 0 || maxHeight <= 0) {
+        return atlas;
+    }
+
+    size_t threads = threadCount > 0 ? static_cast<size_t>(threadCount)
+                                     : std::max<size_t>(1, std::thread::hardware_concurrency());
+    pImpl->layout(spritePaths, maxWidth, maxHeight, padding, powerOfTwo, threads, atlas);
+    for (size_t page = 0; page < atlas.pages.size(); page++) {
+        atlas.pages[page].pixels = pImpl->composePage(page, threads);
+    }
     return atlas;
 }
 
+bool TextureAtlasGenerator::bakeAtlas(const std::vector<std::string>& spritePaths, int maxWidth, int maxHeight,
+                                      const std::string& outputPath, TextureAtlas& atlas) {
+    atlas = TextureAtlas();
+    if (maxWidth <= 0 || maxHeight <= 0) {
+        return true;
+    }
+
+    size_t threads = threadCount > 0 ? static_cast<size_t>(threadCount)
+                                     : std::max<size_t>(1, std::thread::hardware_concurrency());
+    pImpl->layout(spritePaths, maxWidth, maxHeight, padding, powerOfTwo, threads, atlas);
+    if (!atlas.isValid()) {
+        return true;
+    }
+
+    fs::path base(outputPath);
+    if (base.has_parent_path()) {
+        std::error_code ec;
+        fs::create_directories(base.parent_path(), ec);
+    }
+
+    // Each page is written and released before the next is drawn
+    for (size_t page = 0; page < atlas.pages.size(); page++) {
+        auto pixels = pImpl->composePage(page, threads);
+        std::string page_path = outputPath + "_" + std::to_string(page) + ".png";
+        if (!writePNG(page_path, static_cast<uint32_t>(atlas.pages[page].width),
+                      static_cast<uint32_t>(atlas.pages[page].height), *pixels)) {
+            return false;
+        }
+    }
+
+    // The pages hold no pixels, so this writes only the map
+    return saveAtlas(atlas, outputPath);
+}
+
 bool TextureAtlasGenerator::saveAtlas(const TextureAtlas& atlas, const std::string& outputPath) {
-    // Implementation would save the atlas pages as image files
-    // For now, just return true
-    return true;
+    if (!atlas.isValid()) {
+        return false;
+    }
+
+    fs::path base(outputPath);
+    if (base.has_parent_path()) {
+        std::error_code ec;
+        fs::create_directories(base.parent_path(), ec);
+    }
+
+    for (size_t page = 0; page < atlas.pages.size(); page++) {
+        const auto& info = atlas.pages[page];
+        if (!info.pixels) {
+            continue;
+        }
+        std::string page_path = outputPath + "_" + std::to_string(page) + ".png";
+        if (!writePNG(page_path, static_cast<uint32_t>(info.width), static_cast<uint32_t>(info.height), *info.pixels)) {
+            return false;
+        }
+    }
+
+    // Sorted by name so the same atlas always writes the same map
+    std::vector<const std::pair<const std::string, TextureAtlas::SpriteInfo>*> entries;
+    for (const auto& entry : atlas.spriteMap) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    std::vector<AtlasPageRecord> page_records;
+    for (const auto& page : atlas.pages) {
+        page_records.push_back({static_cast<uint32_t>(page.width), static_cast<uint32_t>(page.height)});
+    }
+    std::vector<AtlasSpriteRecord> sprite_records;
+    std::string name_pool;
+    for (const auto* entry : entries) {
+        const TextureAtlas::SpriteInfo& info = entry->second;
+        AtlasSpriteRecord record;
+        record.name_offset = static_cast<uint32_t>(name_pool.size());
+        record.name_length = static_cast<uint32_t>(entry->first.size());
+        record.page = info.page;
+        record.x = info.x;
+        record.y = info.y;
+        record.width = info.width;
+        record.height = info.height;
+        record.source_width = info.sourceWidth;
+        record.source_height = info.sourceHeight;
+        record.trim_x = info.trimX;
+        record.trim_y = info.trimY;
+        record.offset_x = info.offsetX;
+        record.offset_y = info.offsetY;
+        sprite_records.push_back(record);
+        name_pool += entry->first;
+    }
+
+    AtlasHeader header;
+    std::memcpy(header.magic, kAtlasMagic, sizeof(kAtlasMagic));
+    header.version = kAtlasVersion;
+    header.page_count = static_cast<uint32_t>(page_records.size());
+    header.sprite_count = static_cast<uint32_t>(sprite_records.size());
+    header.name_pool_size = static_cast<uint32_t>(name_pool.size());
+    header.reserved = 0;
+
+    std::ofstream out(outputPath + ".atlas", std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(page_records.data()),
+              static_cast<std::streamsize>(page_records.size() * sizeof(AtlasPageRecord)));
+    out.write(reinterpret_cast<const char*>(sprite_records.data()),
+              static_cast<std::streamsize>(sprite_records.size() * sizeof(AtlasSpriteRecord)));
+    out.write(name_pool.data(), static_cast<std::streamsize>(name_pool.size()));
+    return static_cast<bool>(out);
+}
+
+bool TextureAtlas::loadFromFile(const std::string& mapPath) {
+    std::vector<uint8_t> data;
+    if (!readFile(mapPath, data) || data.size() < sizeof(AtlasHeader)) {
+        return false;
+    }
+
+    AtlasHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, kAtlasMagic, sizeof(kAtlasMagic)) != 0 || header.version != kAtlasVersion) {
+        return false;
+    }
+    uint64_t expected = sizeof(AtlasHeader) +
+                        static_cast<uint64_t>(header.page_count) * sizeof(AtlasPageRecord) +
+                        static_cast<uint64_t>(header.sprite_count) * sizeof(AtlasSpriteRecord) +
+                        header.name_pool_size;
+    if (expected != data.size()) {
+        return false;
+    }
+
+    const uint8_t* cursor = data.data() + sizeof(AtlasHeader);
+    std::vector<Page> loaded_pages(header.page_count);
+    for (auto& page : loaded_pages) {
+        AtlasPageRecord record;
+        std::memcpy(&record, cursor, sizeof(record));
+        cursor += sizeof(record);
+        page.width = static_cast<int>(record.width);
+        page.height = static_cast<int>(record.height);
+    }
+
+    const char* name_pool = reinterpret_cast<const char*>(cursor + header.sprite_count * sizeof(AtlasSpriteRecord));
+    std::unordered_map<std::string, SpriteInfo> loaded_sprites;
+    for (uint32_t i = 0; i < header.sprite_count; i++) {
+        AtlasSpriteRecord record;
+        std::memcpy(&record, cursor, sizeof(record));
+        cursor += sizeof(record);
+        if (static_cast<uint64_t>(record.name_offset) + record.name_length > header.name_pool_size ||
+            record.page < 0 || record.page >= static_cast<int32_t>(header.page_count)) {
+            return false;
+        }
+        SpriteInfo info;
+        info.page = record.page;
+        info.x = record.x;
+        info.y = record.y;
+        info.width = record.width;
+        info.height = record.height;
+        info.sourceWidth = record.source_width;
+        info.sourceHeight = record.source_height;
+        info.trimX = record.trim_x;
+        info.trimY = record.trim_y;
+        info.offsetX = record.offset_x;
+        info.offsetY = record.offset_y;
+        loaded_sprites[std::string(name_pool + record.name_offset, record.name_length)] = info;
+    }
+
+    pages = std::move(loaded_pages);
+    spriteMap = std::move(loaded_sprites);
+    pageCount = static_cast<int>(pages.size());
+    valid = !spriteMap.empty();
+    return valid;
+}
+
+std::string TextureAtlas::frameName(const std::string& spriteName, int direction, int frame) {
+    if (direction == 0 && frame == 0) {
+        return spriteName;
+    }
+    return spriteName + ":" + std::to_string(direction) + ":" + std::to_string(frame);
 }
 
-} // namespace d2
\ No newline at end of file
+} // namespace d2
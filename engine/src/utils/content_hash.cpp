@@ -0,0 +1,163 @@
+#include "utils/content_hash.h"
+#include "utils/memory_mapped_file.h"
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace d2::utils {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Little-endian loads; compilers turn these into single moves
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+inline uint32_t read32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t lane(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t mergeLane(uint64_t acc, uint64_t value) {
+    acc ^= lane(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+} // namespace
+
+uint64_t ContentHash::hash(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        // Four independent lanes over 32-byte stripes
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = lane(v1, read64(p));
+            v2 = lane(v2, read64(p + 8));
+            v3 = lane(v3, read64(p + 16));
+            v4 = lane(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeLane(h, v1);
+        h = mergeLane(h, v2);
+        h = mergeLane(h, v3);
+        h = mergeLane(h, v4);
+    } else {
+        h = seed + kPrime5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    while (end - p >= 8) {
+        h ^= lane(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (end - p >= 4) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+        p++;
+    }
+
+    // Final avalanche
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool ContentHash::hashFile(const std::string& path, uint64_t& result) {
+    d2portable::utils::MemoryMappedFile file;
+    if (file.open(path)) {
+        result = hash(file.data(), file.size());
+        return true;
+    }
+
+    // Empty files cannot be mapped
+    std::error_code ec;
+    if (fs::is_regular_file(path, ec) && fs::file_size(path, ec) == 0 && !ec) {
+        result = hash(nullptr, 0);
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::string> ContentHash::hashFiles(const std::vector<std::string>& paths, int threads) {
+    std::vector<std::string> results(paths.size());
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            uint64_t value;
+            if (hashFile(paths[i], value)) {
+                results[i] = toHex(value);
+            }
+        }
+    };
+
+    size_t workers = threads > 0 ? static_cast<size_t>(threads) : std::thread::hardware_concurrency();
+    workers = std::min(std::max<size_t>(workers, 1), paths.size());
+    if (workers <= 1) {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> pool;
+    for (size_t i = 0; i < workers; i++) {
+        pool.emplace_back(worker);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return results;
+}
+
+std::string ContentHash::toHex(uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; i--) {
+        text[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return text;
+}
+
+} // namespace d2::utils
@@ -1,97 +1,857 @@
 #include "utils/data_table_parser.h"
-#include <sstream>
+#include "utils/memory_mapped_file.h"
+#include "utils/content_hash.h"
 #include <fstream>
 #include <algorithm>
+#include <charconv>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <cctype>
+#include <mutex>
 
 namespace d2::utils {
 
+namespace {
+
+// Remove quotes if present
+std::string_view unquote(std::string_view cell) {
+    if (cell.size() >= 2 && cell.front() == '"' && cell.back() == '"') {
+        return cell.substr(1, cell.size() - 2);
+    }
+    return cell;
+}
+
+// Whole-cell integer, as stored in INT columns
+bool parseInt(std::string_view text, int32_t& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Whole-cell number, as stored in FLOAT columns
+bool parseFloat(std::string_view text, float& value) {
+    char buffer[64];
+    if (text.empty() || text.size() >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtof(buffer, &end);
+    return errno == 0 && end == buffer + text.size() && std::isdigit(static_cast<unsigned char>(text.back()));
+}
+
+// Whether a cell's text is exactly how its integer value prints
+bool isCanonicalInt(std::string_view text, int32_t value) {
+    char buffer[16];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string_view(buffer, result.ptr - buffer) == text;
+}
+
+// Whether a cell's text is exactly how its float value prints
+bool isCanonicalFloat(std::string_view text, float value) {
+    char buffer[64];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+    return result.ec == std::errc() && std::string_view(buffer, result.ptr - buffer) == text;
+}
+
+// Leading number of a text cell, read the way std::stoi does; 0 if there is none
+int leadingInt(std::string_view text) {
+    if (text.empty()) {
+        return 0;
+    }
+    char buffer[64];
+    size_t length = std::min(text.size(), sizeof(buffer) - 1);
+    std::memcpy(buffer, text.data(), length);
+    buffer[length] = '\0';
+
+    char* end = nullptr;
+    errno = 0;
+    long value = std::strtol(buffer, &end, 10);
+    if (end == buffer || errno != 0 || value < INT_MIN || value > INT_MAX) {
+        return 0;
+    }
+    return static_cast<int>(value);
+}
+
+// Leading number of a text cell, read the way std::stof does; 0 if there is none
+float leadingFloat(std::string_view text) {
+    if (text.empty()) {
+        return 0.0f;
+    }
+    char buffer[64];
+    size_t length = std::min(text.size(), sizeof(buffer) - 1);
+    std::memcpy(buffer, text.data(), length);
+    buffer[length] = '\0';
+
+    char* end = nullptr;
+    errno = 0;
+    float value = std::strtof(buffer, &end);
+    if (end == buffer || errno != 0) {
+        return 0.0f;
+    }
+    return value;
+}
+
+// Splits the next line off a buffer, without its line break
+bool nextLine(const char*& cursor, const char* end, std::string_view& line) {
+    if (cursor >= end) {
+        return false;
+    }
+    const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+    const char* line_end = newline ? newline : end;
+    line = std::string_view(cursor, line_end - cursor);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    cursor = newline ? newline + 1 : end;
+    return true;
+}
+
+// Calls visit(index, cell) for each tab-separated cell of a line
+template <typename Visit>
+void forEachCell(std::string_view line, Visit visit) {
+    size_t index = 0;
+    size_t start = 0;
+    while (true) {
+        size_t tab = line.find('\t', start);
+        if (tab == std::string_view::npos) {
+            visit(index, unquote(line.substr(start)));
+            return;
+        }
+        if (!visit(index, unquote(line.substr(start, tab - start)))) {
+            return;
+        }
+        index++;
+        start = tab + 1;
+    }
+}
+
+// Column state while a table is parsed: a column stays numeric until a
+// cell fails to parse, so its type is known after one pass
+struct ColumnBuilder {
+    bool maybe_int = true;
+    bool maybe_float = true;
+};
+
+constexpr char kTableMagic[4] = {'D', '2', 'T', 'B'};
+constexpr uint64_t kSectionAlignment = 16;
+
+// On-disk structures of the precompiled form. Offsets are absolute file offsets.
+struct TableHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t column_count;
+    uint32_t row_count;
+    uint64_t source_hash;
+    uint64_t column_table_offset;
+    uint64_t pool_offsets_offset;   // pool_string_count + 1 entries
+    uint32_t pool_string_count;
+    uint32_t int_text_count;
+    uint64_t pool_offset;
+    uint64_t pool_size;
+    uint64_t number_text_offset;    // int_text_count then float_text_count NumberText
+    uint32_t float_text_count;
+    uint32_t reserved;
+    uint64_t file_size;
+};
+static_assert(sizeof(TableHeader) == 88, "TableHeader layout changed");
+
+struct ColumnRecord {
+    uint64_t name_offset;
+    uint32_t name_length;
+    uint32_t type;              // DataTable::ColumnType
+    uint64_t strings_offset;    // Pool id per row, 0 if the column keeps none
+    uint64_t values_offset;     // int32 or float per row, 0 for STRING columns
+    uint64_t blanks_offset;     // One bit per row, 0 if the column has none
+};
+static_assert(sizeof(ColumnRecord) == 40, "ColumnRecord layout changed");
+
+// Pool id of the text of a numeric value (an int, or a float's bits)
+struct NumberText {
+    uint32_t value;
+    uint32_t id;
+};
+static_assert(sizeof(NumberText) == 8, "NumberText layout changed");
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+// Whether [offset, offset + count * element) lies inside a buffer of size bytes
+bool inBounds(uint64_t offset, uint64_t count, uint64_t element, uint64_t size) {
+    return offset <= size && count <= (size - offset) / element;
+}
+
+// Copies count elements of a section into a vector
+template <typename T>
+void readArray(std::vector<T>& out, const uint8_t* source, size_t count) {
+    out.resize(count);
+    if (count > 0) {
+        std::memcpy(out.data(), source, count * sizeof(T));
+    }
+}
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+} // namespace
+
+// Open-addressing hash index of one column. Keys are not stored: a slot
+// holds a group of rows sharing a text, compared through the group's first
+// row, so the index does not point into the table's storage.
+struct DataTable::ColumnIndex {
+    std::vector<uint32_t> slots;        // Group + 1, or 0 for an empty slot
+    std::vector<uint32_t> slotHashes;   // Hash of each slot's text
+    std::vector<uint32_t> groupStarts;  // Group g spans rows[groupStarts[g]..groupStarts[g + 1])
+    std::vector<uint32_t> rows;         // Row indices grouped by text, ascending in a group
+    bool unique = true;
+
+    size_t memoryUsage() const {
+        return (slots.capacity() + slotHashes.capacity() + groupStarts.capacity() + rows.capacity()) *
+               sizeof(uint32_t);
+    }
+};
+
+struct DataTable::IndexCache {
+    explicit IndexCache(size_t columns)
+        : once(std::make_unique<std::once_flag[]>(columns)), indexes(columns) {}
+
+    std::unique_ptr<std::once_flag[]> once;
+    std::mutex mutex;  // Guards indexes while one is stored or measured
+    std::vector<std::unique_ptr<ColumnIndex>> indexes;
+};
+
 DataTable DataTableParser::parseExcel(const std::string& data) {
+    return parseExcel(data.data(), data.size());
+}
+
+DataTable DataTableParser::parseExcel(const char* data, size_t size) {
     DataTable table;
     
-    if (data.empty()) {
+    if (!data || size == 0) {
         return table;
     }
     
-    std::istringstream stream(data);
-    std::string line;
+    const char* cursor = data;
+    const char* end = data + size;
+    std::string_view line;
     
     // Parse header line to get column names
-    if (std::getline(stream, line)) {
-        std::istringstream headerStream(line);
-        std::string column;
-        
-        while (std::getline(headerStream, column, '\t')) {
-            // Remove quotes if present
-            if (column.size() >= 2 && column.front() == '"' && column.back() == '"') {
-                column = column.substr(1, column.size() - 2);
-            }
-            table.columns_.push_back(column);
-        }
+    if (nextLine(cursor, end, line) && !line.empty()) {
+        forEachCell(line, [&](size_t, std::string_view name) {
+            table.columns_.emplace_back();
+            table.columns_.back().name = std::string(name);
+            return true;
+        });
+    }
+    if (table.columns_.empty()) {
+        return table;
     }
     
+    // Cells are interned by their text in the source buffer; id 0 is ""
+    std::unordered_map<std::string_view, uint32_t> string_ids;
+    table.poolOffsets_ = {0, 0};
+    string_ids.emplace(std::string_view(), 0);
+    auto intern = [&](std::string_view text) {
+        auto inserted = string_ids.try_emplace(text, static_cast<uint32_t>(string_ids.size()));
+        if (inserted.second) {
+            table.pool_.append(text.data(), text.size());
+            table.poolOffsets_.push_back(static_cast<uint32_t>(table.pool_.size()));
+        }
+        return inserted.first->second;
+    };
+
+    size_t expected_rows = static_cast<size_t>(std::count(cursor, end, '\n')) + 1;
+    std::vector<ColumnBuilder> builders(table.columns_.size());
+    for (auto& column : table.columns_) {
+        column.strings.reserve(expected_rows);
+        column.ints.reserve(expected_rows);
+        column.floats.reserve(expected_rows);
+    }
+
+    auto addCell = [&](size_t index, std::string_view text) {
+        DataTable::ColumnData& column = table.columns_[index];
+        ColumnBuilder& builder = builders[index];
+        column.strings.push_back(intern(text));
+        if (!builder.maybe_float) {
+            return;
+        }
+
+        int32_t int_value = 0;
+        float float_value = 0.0f;
+        if (text.empty()) {
+            // Blank cells read as zero in any column
+        } else if (builder.maybe_int && parseInt(text, int_value)) {
+            float_value = static_cast<float>(int_value);
+        } else if (parseFloat(text, float_value)) {
+            if (builder.maybe_int) {
+                builder.maybe_int = false;
+                std::vector<int32_t>().swap(column.ints);
+            }
+        } else {
+            builder.maybe_int = false;
+            builder.maybe_float = false;
+            std::vector<int32_t>().swap(column.ints);
+            std::vector<float>().swap(column.floats);
+            return;
+        }
+        if (builder.maybe_int) {
+            column.ints.push_back(int_value);
+        }
+        column.floats.push_back(float_value);
+    };
+
     // Parse data rows
-    while (std::getline(stream, line)) {
+    while (nextLine(cursor, end, line)) {
         if (line.empty()) continue;
         
-        DataTable::Row row;
-        std::istringstream lineStream(line);
-        std::string value;
-        size_t columnIndex = 0;
-        
-        while (std::getline(lineStream, value, '\t') && columnIndex < table.columns_.size()) {
-            // Remove quotes if present
-            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
-                value = value.substr(1, value.size() - 2);
+        size_t filled = 0;
+        forEachCell(line, [&](size_t index, std::string_view text) {
+            if (index >= table.columns_.size()) {
+                return false;
             }
+            addCell(index, text);
+            filled = index + 1;
+            return true;
+        });
+        
+        // Short rows leave their remaining cells blank
+        for (size_t index = filled; index < table.columns_.size(); index++) {
+            addCell(index, std::string_view());
+        }
+        table.rowCount_++;
+    }
             
-            row[table.columns_[columnIndex]] = value;
-            columnIndex++;
+    // Whether each pooled text prints back exactly from its value, checked
+    // once per distinct text: 0 = unknown, 1 = yes, 2 = no
+    std::vector<uint8_t> int_canonical(string_ids.size(), 0);
+    std::vector<uint8_t> float_canonical(string_ids.size(), 0);
+
+    for (size_t index = 0; index < table.columns_.size(); index++) {
+        DataTable::ColumnData& column = table.columns_[index];
+        if (builders[index].maybe_int) {
+            column.type = DataTable::ColumnType::INT;
+            std::vector<float>().swap(column.floats);
+        } else if (builders[index].maybe_float) {
+            column.type = DataTable::ColumnType::FLOAT;
+        } else {
+            column.type = DataTable::ColumnType::STRING;
+        }
+        if (column.type == DataTable::ColumnType::STRING || table.rowCount_ == 0) {
+            column.strings.shrink_to_fit();
+            continue;
         }
         
-        // Only add rows that have data
-        if (!row.empty()) {
-            table.rows_.push_back(row);
+        // A numeric column whose text all follows from its values keeps one
+        // pool id per distinct value and a bit per blank, not an id per cell
+        bool is_int = column.type == DataTable::ColumnType::INT;
+        std::vector<uint8_t>& canonical = is_int ? int_canonical : float_canonical;
+        bool has_blank = false;
+        bool drop_strings = true;
+        for (size_t row = 0; row < table.rowCount_ && drop_strings; row++) {
+            uint32_t id = column.strings[row];
+            if (id == 0) {
+                has_blank = true;
+                continue;
+            }
+            if (canonical[id] == 0) {
+                std::string_view text = table.pooledString(id);
+                bool exact = is_int ? isCanonicalInt(text, column.ints[row])
+                                    : isCanonicalFloat(text, column.floats[row]);
+                canonical[id] = exact ? 1 : 2;
+            }
+            drop_strings = canonical[id] == 1;
+        }
+        if (drop_strings) {
+            if (has_blank) {
+                column.blanks.resize(table.rowCount_);
+            }
+            for (size_t row = 0; row < table.rowCount_; row++) {
+                uint32_t id = column.strings[row];
+                if (id == 0) {
+                    column.blanks[row] = true;
+                } else if (is_int) {
+                    table.intText_.try_emplace(column.ints[row], id);
+                } else {
+                    table.floatText_.try_emplace(floatBits(column.floats[row]), id);
+                }
+            }
+            std::vector<uint32_t>().swap(column.strings);
         }
+        column.strings.shrink_to_fit();
+        column.ints.shrink_to_fit();
+        column.floats.shrink_to_fit();
     }
+    table.pool_.shrink_to_fit();
+    table.poolOffsets_.shrink_to_fit();
+    table.indexes_ = std::make_shared<DataTable::IndexCache>(table.columns_.size());
     
     return table;
 }
 
 DataTable DataTableParser::parseExcelFile(const std::string& filename) {
-    std::ifstream file(filename);
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         return DataTable();
     }
     
-    std::string content((std::istreambuf_iterator<char>(file)),
-                       std::istreambuf_iterator<char>());
+    std::vector<char> content(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(content.data(), content.size())) {
+        return DataTable();
+    }
     
-    return parseExcel(content);
+    // Prefer a precompiled copy built from this exact text
+    DataTable table;
+    if (loadBinaryFile(getBinaryPath(filename), table, hashSource(content.data(), content.size()))) {
+        return table;
+    }
+    return parseExcel(content.data(), content.size());
+}
+
+bool DataTableParser::writeBinary(const DataTable& table, uint64_t sourceHash, const std::string& filename) {
+    std::vector<uint8_t> buffer(sizeof(TableHeader), 0);
+    auto append = [&](const void* data, size_t size) -> uint64_t {
+        buffer.resize(alignUp(buffer.size()), 0);
+        uint64_t offset = buffer.size();
+        if (size > 0) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+        return offset;
+    };
+
+    TableHeader header{};
+    std::memcpy(header.magic, kTableMagic, sizeof(kTableMagic));
+    header.version = kDataTableBinaryVersion;
+    header.column_count = static_cast<uint32_t>(table.columns_.size());
+    header.row_count = static_cast<uint32_t>(table.rowCount_);
+    header.source_hash = sourceHash;
+
+    // Schema first, patched once the blobs are placed
+    std::vector<ColumnRecord> records(table.columns_.size());
+    header.column_table_offset = append(records.data(), records.size() * sizeof(ColumnRecord));
+
+    std::string names;
+    for (const auto& column : table.columns_) {
+        names += column.name;
+    }
+    uint64_t names_offset = append(names.data(), names.size());
+
+    // A table without rows has an empty pool
+    std::vector<uint32_t> pool_offsets = table.poolOffsets_.empty() ? std::vector<uint32_t>{0} : table.poolOffsets_;
+    header.pool_string_count = static_cast<uint32_t>(pool_offsets.size() - 1);
+    header.pool_offsets_offset = append(pool_offsets.data(), pool_offsets.size() * sizeof(uint32_t));
+    header.pool_size = table.pool_.size();
+    header.pool_offset = append(table.pool_.data(), table.pool_.size());
+
+    std::vector<NumberText> number_text;
+    for (const auto& entry : table.intText_) {
+        number_text.push_back({static_cast<uint32_t>(entry.first), entry.second});
+    }
+    for (const auto& entry : table.floatText_) {
+        number_text.push_back({entry.first, entry.second});
+    }
+    header.int_text_count = static_cast<uint32_t>(table.intText_.size());
+    header.float_text_count = static_cast<uint32_t>(table.floatText_.size());
+    header.number_text_offset = append(number_text.data(), number_text.size() * sizeof(NumberText));
+
+    for (size_t index = 0; index < table.columns_.size(); index++) {
+        const DataTable::ColumnData& column = table.columns_[index];
+        ColumnRecord& record = records[index];
+        record.name_offset = names_offset;
+        record.name_length = static_cast<uint32_t>(column.name.size());
+        names_offset += column.name.size();
+        record.type = static_cast<uint32_t>(column.type);
+
+        if (!column.strings.empty()) {
+            record.strings_offset = append(column.strings.data(), column.strings.size() * sizeof(uint32_t));
+        }
+        if (column.type == DataTable::ColumnType::INT) {
+            record.values_offset = append(column.ints.data(), column.ints.size() * sizeof(int32_t));
+        } else if (column.type == DataTable::ColumnType::FLOAT) {
+            record.values_offset = append(column.floats.data(), column.floats.size() * sizeof(float));
+        }
+        if (!column.blanks.empty()) {
+            std::vector<uint8_t> bits((table.rowCount_ + 7) / 8, 0);
+            for (size_t row = 0; row < table.rowCount_; row++) {
+                if (column.blanks[row]) {
+                    bits[row / 8] |= static_cast<uint8_t>(1u << (row % 8));
+                }
+            }
+            record.blanks_offset = append(bits.data(), bits.size());
+        }
+    }
+
+    buffer.resize(alignUp(buffer.size()), 0);
+    header.file_size = buffer.size();
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    if (!records.empty()) {
+        std::memcpy(buffer.data() + header.column_table_offset, records.data(), records.size() * sizeof(ColumnRecord));
+    }
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    return out.good();
+}
+
+bool DataTableParser::loadBinary(const uint8_t* data, size_t size, DataTable& table, uint64_t sourceHash) {
+    if (!data || size < sizeof(TableHeader)) {
+        return false;
+    }
+
+    TableHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kTableMagic, sizeof(kTableMagic)) != 0 ||
+        header.version != kDataTableBinaryVersion || header.file_size != size) {
+        return false;
+    }
+    if (sourceHash != 0 && header.source_hash != sourceHash) {
+        return false;
+    }
+
+    // Every section must lie inside the buffer before it is read
+    uint64_t number_count = static_cast<uint64_t>(header.int_text_count) + header.float_text_count;
+    if (!inBounds(header.column_table_offset, header.column_count, sizeof(ColumnRecord), size) ||
+        !inBounds(header.pool_offsets_offset, header.pool_string_count + 1ull, sizeof(uint32_t), size) ||
+        !inBounds(header.pool_offset, header.pool_size, 1, size) ||
+        !inBounds(header.number_text_offset, number_count, sizeof(NumberText), size)) {
+        return false;
+    }
+
+    DataTable loaded;
+    loaded.rowCount_ = header.row_count;
+    readArray(loaded.poolOffsets_, data + header.pool_offsets_offset, header.pool_string_count + 1ull);
+    if (loaded.poolOffsets_[0] != 0) {
+        return false;
+    }
+    for (size_t i = 1; i < loaded.poolOffsets_.size(); i++) {
+        if (loaded.poolOffsets_[i] < loaded.poolOffsets_[i - 1] || loaded.poolOffsets_[i] > header.pool_size) {
+            return false;
+        }
+    }
+    loaded.pool_.assign(reinterpret_cast<const char*>(data + header.pool_offset), header.pool_size);
+    uint32_t pool_strings = header.pool_string_count;
+
+    std::vector<NumberText> number_text;
+    readArray(number_text, data + header.number_text_offset, number_count);
+    for (size_t i = 0; i < number_text.size(); i++) {
+        if (number_text[i].id >= pool_strings) {
+            return false;
+        }
+        if (i < header.int_text_count) {
+            loaded.intText_.emplace(static_cast<int32_t>(number_text[i].value), number_text[i].id);
+        } else {
+            loaded.floatText_.emplace(number_text[i].value, number_text[i].id);
+        }
+    }
+
+    std::vector<ColumnRecord> records;
+    readArray(records, data + header.column_table_offset, header.column_count);
+    loaded.columns_.resize(records.size());
+    for (size_t index = 0; index < records.size(); index++) {
+        const ColumnRecord& record = records[index];
+        DataTable::ColumnData& column = loaded.columns_[index];
+        if (!inBounds(record.name_offset, record.name_length, 1, size) ||
+            record.type > static_cast<uint32_t>(DataTable::ColumnType::STRING)) {
+            return false;
+        }
+        column.name.assign(reinterpret_cast<const char*>(data + record.name_offset), record.name_length);
+        column.type = static_cast<DataTable::ColumnType>(record.type);
+
+        // String columns always keep their ids; numeric ones may not
+        if (record.strings_offset != 0 || column.type == DataTable::ColumnType::STRING) {
+            if (!inBounds(record.strings_offset, header.row_count, sizeof(uint32_t), size)) {
+                return false;
+            }
+            readArray(column.strings, data + record.strings_offset, header.row_count);
+            if (!column.strings.empty() && *std::max_element(column.strings.begin(), column.strings.end()) >= pool_strings) {
+                return false;
+            }
+        }
+        if (column.type == DataTable::ColumnType::INT) {
+            if (!inBounds(record.values_offset, header.row_count, sizeof(int32_t), size)) {
+                return false;
+            }
+            readArray(column.ints, data + record.values_offset, header.row_count);
+        } else if (column.type == DataTable::ColumnType::FLOAT) {
+            if (!inBounds(record.values_offset, header.row_count, sizeof(float), size)) {
+                return false;
+            }
+            readArray(column.floats, data + record.values_offset, header.row_count);
+        }
+        if (record.blanks_offset != 0) {
+            uint64_t bytes = (static_cast<uint64_t>(header.row_count) + 7) / 8;
+            if (!inBounds(record.blanks_offset, bytes, 1, size)) {
+                return false;
+            }
+            const uint8_t* bits = data + record.blanks_offset;
+            column.blanks.resize(header.row_count);
+            for (size_t row = 0; row < header.row_count; row++) {
+                column.blanks[row] = (bits[row / 8] >> (row % 8)) & 1;
+            }
+        }
+    }
+
+    loaded.indexes_ = std::make_shared<DataTable::IndexCache>(loaded.columns_.size());
+    table = std::move(loaded);
+    return true;
+}
+
+bool DataTableParser::loadBinaryFile(const std::string& filename, DataTable& table, uint64_t sourceHash) {
+    d2portable::utils::MemoryMappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+    return loadBinary(file.data(), file.size(), table, sourceHash);
+}
+
+uint64_t DataTableParser::hashSource(const char* data, size_t size) {
+    return ContentHash::hash(data, size);
+}
+
+std::string DataTableParser::getBinaryPath(const std::string& textPath) {
+    size_t dot = textPath.find_last_of('.');
+    size_t separator = textPath.find_last_of("/\\");
+    if (dot == std::string::npos || (separator != std::string::npos && dot < separator)) {
+        return textPath + ".d2tbl";
+    }
+    return textPath.substr(0, dot) + ".d2tbl";
 }
 
 bool DataTable::hasColumn(const std::string& columnName) const {
-    return std::find(columns_.begin(), columns_.end(), columnName) != columns_.end();
+    return getColumn(columnName).isValid();
 }
 
-DataTable::Row DataTable::findRow(const std::string& columnName, const std::string& value) const {
-    for (const auto& row : rows_) {
-        auto it = row.find(columnName);
-        if (it != row.end() && it->second == value) {
-            return row;
+DataTable::Column DataTable::getColumn(const std::string& columnName) const {
+    Column column;
+    for (size_t index = 0; index < columns_.size(); index++) {
+        if (columns_[index].name == columnName) {
+            column.index = index;
+            break;
+        }
+    }
+    return column;
+}
+
+int DataTable::getInt(size_t row, Column column) const {
+    if (!column.isValid() || row >= rowCount_) {
+        return 0;
+    }
+    const ColumnData& data = columns_[column.index];
+    if (data.type == ColumnType::INT) {
+        return data.ints[row];
+    }
+    // Fractions and text read their leading integer, as std::stoi would
+    return leadingInt(cellString(data, row));
+}
+
+float DataTable::getFloat(size_t row, Column column) const {
+    if (!column.isValid() || row >= rowCount_) {
+        return 0.0f;
+    }
+    const ColumnData& data = columns_[column.index];
+    switch (data.type) {
+        case ColumnType::INT:
+            return static_cast<float>(data.ints[row]);
+        case ColumnType::FLOAT:
+            return data.floats[row];
+        case ColumnType::STRING:
+        default:
+            return leadingFloat(pooledString(data.strings[row]));
+    }
+}
+
+std::string_view DataTable::getString(size_t row, Column column) const {
+    if (!column.isValid() || row >= rowCount_) {
+        return std::string_view();
+    }
+    return cellString(columns_[column.index], row);
+}
+
+std::string_view DataTable::cellString(const ColumnData& data, size_t row) const {
+    if (!data.strings.empty()) {
+        return pooledString(data.strings[row]);
+    }
+
+    // Numeric column without per-cell ids: look up the text of the value
+    if (!data.blanks.empty() && data.blanks[row]) {
+        return std::string_view();
+    }
+    if (data.type == ColumnType::INT) {
+        auto it = intText_.find(data.ints[row]);
+        return it != intText_.end() ? pooledString(it->second) : std::string_view();
+    }
+    auto it = floatText_.find(floatBits(data.floats[row]));
+    return it != floatText_.end() ? pooledString(it->second) : std::string_view();
+}
+
+const DataTable::ColumnIndex* DataTable::columnIndex(Column column) const {
+    if (!column.isValid() || !indexes_) {
+        return nullptr;
+    }
+
+    std::call_once(indexes_->once[column.index], [&]() {
+        const ColumnData& data = columns_[column.index];
+        auto index = std::make_unique<ColumnIndex>();
+
+        size_t capacity = 16;
+        while (capacity < rowCount_ * 2) {
+            capacity *= 2;
+        }
+        index->slots.assign(capacity, 0);
+        index->slotHashes.assign(capacity, 0);
+
+        // Assign every row to the group of its text
+        std::vector<uint32_t> row_groups(rowCount_);
+        std::vector<uint32_t> group_sizes;
+        std::vector<uint32_t> group_first_rows;
+        for (size_t row = 0; row < rowCount_; row++) {
+            std::string_view text = cellString(data, row);
+            uint32_t hash = static_cast<uint32_t>(std::hash<std::string_view>{}(text));
+            size_t slot = hash & (capacity - 1);
+            while (true) {
+                uint32_t group = index->slots[slot];
+                if (group == 0) {
+                    index->slots[slot] = static_cast<uint32_t>(group_sizes.size() + 1);
+                    index->slotHashes[slot] = hash;
+                    row_groups[row] = static_cast<uint32_t>(group_sizes.size());
+                    group_sizes.push_back(1);
+                    group_first_rows.push_back(static_cast<uint32_t>(row));
+                    break;
+                }
+                if (index->slotHashes[slot] == hash && cellString(data, group_first_rows[group - 1]) == text) {
+                    row_groups[row] = group - 1;
+                    group_sizes[group - 1]++;
+                    index->unique = false;
+                    break;
+                }
+                slot = (slot + 1) & (capacity - 1);
+            }
+        }
+
+        index->groupStarts.resize(group_sizes.size() + 1, 0);
+        for (size_t group = 0; group < group_sizes.size(); group++) {
+            index->groupStarts[group + 1] = index->groupStarts[group] + group_sizes[group];
+        }
+        std::vector<uint32_t> fill(index->groupStarts.begin(), index->groupStarts.end() - 1);
+        index->rows.resize(rowCount_);
+        for (size_t row = 0; row < rowCount_; row++) {
+            index->rows[fill[row_groups[row]]++] = static_cast<uint32_t>(row);
+        }
+
+        std::lock_guard<std::mutex> lock(indexes_->mutex);
+        indexes_->indexes[column.index] = std::move(index);
+    });
+    // call_once orders the store before this read
+    return indexes_->indexes[column.index].get();
+}
+
+DataTable::RowRange DataTable::findRows(Column column, std::string_view value) const {
+    RowRange range;
+    const ColumnIndex* index = columnIndex(column);
+    if (!index) {
+        return range;
+    }
+
+    const ColumnData& data = columns_[column.index];
+    uint32_t hash = static_cast<uint32_t>(std::hash<std::string_view>{}(value));
+    size_t mask = index->slots.size() - 1;
+    for (size_t slot = hash & mask; index->slots[slot] != 0; slot = (slot + 1) & mask) {
+        if (index->slotHashes[slot] != hash) {
+            continue;
+        }
+        uint32_t group = index->slots[slot] - 1;
+        const uint32_t* first = index->rows.data() + index->groupStarts[group];
+        if (cellString(data, *first) == value) {
+            range.first = first;
+            range.last = index->rows.data() + index->groupStarts[group + 1];
+            break;
+        }
+    }
+    return range;
+}
+
+size_t DataTable::findRowIndex(Column column, std::string_view value) const {
+    RowRange rows = findRows(column, value);
+    return rows.empty() ? kNoRow : rows[0];
+}
+
+bool DataTable::isUniqueColumn(Column column) const {
+    const ColumnIndex* index = columnIndex(column);
+    return index && index->unique;
+}
+
+void DataTable::buildIndex(Column column) const {
+    columnIndex(column);
+}
+
+size_t DataTable::getMemoryUsage() const {
+    // Hash nodes are counted as a key, a value and a next pointer
+    const size_t node_bytes = 2 * sizeof(uint32_t) + sizeof(void*);
+    size_t bytes = pool_.capacity() + poolOffsets_.capacity() * sizeof(uint32_t);
+    bytes += (intText_.size() + floatText_.size()) * node_bytes;
+    bytes += (intText_.bucket_count() + floatText_.bucket_count()) * sizeof(void*);
+    for (const auto& column : columns_) {
+        bytes += sizeof(ColumnData) + column.name.capacity();
+        bytes += column.strings.capacity() * sizeof(uint32_t);
+        bytes += column.ints.capacity() * sizeof(int32_t);
+        bytes += column.floats.capacity() * sizeof(float);
+        bytes += column.blanks.capacity() / 8;
+    }
+    if (indexes_) {
+        std::lock_guard<std::mutex> lock(indexes_->mutex);
+        for (const auto& index : indexes_->indexes) {
+            if (index) {
+                bytes += index->memoryUsage();
+            }
         }
     }
-    return Row(); // Return empty row if not found
+    return bytes;
+}
+
+DataTable::Row DataTable::findRow(const std::string& columnName, const std::string& value) const {
+    size_t row = findRowIndex(getColumn(columnName), value);
+    if (row == kNoRow) {
+        return Row(); // Return empty row if not found
+    }
+    return getRow(row);
+}
+
+std::vector<DataTable::Row> DataTable::getAllRows() const {
+    std::vector<Row> rows;
+    rows.reserve(rowCount_);
+    for (size_t row = 0; row < rowCount_; row++) {
+        rows.push_back(getRow(row));
+    }
+    return rows;
+}
+
+DataTable::Row DataTable::getRow(size_t index) const {
+    Row row;
+    if (index >= rowCount_) {
+        return row;
+    }
+    for (const auto& column : columns_) {
+        row[column.name] = std::string(cellString(column, index));
+    }
+    return row;
 }
 
 int DataTable::getIntValue(const Row& row, const std::string& columnName) const {
     auto it = row.find(columnName);
     if (it != row.end()) {
-        try {
-            return std::stoi(it->second);
-        } catch (...) {
-            return 0;
-        }
+        return leadingInt(it->second);
     }
     return 0;
 }
@@ -99,13 +859,9 @@ int DataTable::getIntValue(const Row& row, const std::string& columnName) const
 float DataTable::getFloatValue(const Row& row, const std::string& columnName) const {
     auto it = row.find(columnName);
     if (it != row.end()) {
-        try {
-            return std::stof(it->second);
-        } catch (...) {
-            return 0.0f;
-        }
+        return leadingFloat(it->second);
     }
     return 0.0f;
 }
 
-} // namespace d2::utils
\ No newline at end of file
+} // namespace d2::utils
@@ -5,6 +5,8 @@
 /* Based on StormLib implementation                                          */
 /*****************************************************************************/
 
+#include "utils/huffman_decompress.h"
+#include <algorithm>
 #include <cstring>
 #include <vector>
 #include <cstdint>
@@ -12,132 +14,139 @@
 namespace d2portable {
 namespace utils {
 
-// Huffman tree node
-struct HuffmanNode {
-    HuffmanNode* child0;    // Child for bit 0
-    HuffmanNode* child1;    // Child for bit 1
-    uint32_t value;         // Value if this is a leaf node
-    bool is_leaf;           // True if this is a leaf node
-    
-    HuffmanNode() : child0(nullptr), child1(nullptr), value(0), is_leaf(false) {}
+namespace {
+
+// Longest code the single-level lookup table resolves. The table is
+// indexed by the next kMaxCodeBits input bits, so every code is decoded
+// with one lookup.
+constexpr uint32_t kMaxCodeBits = 12;
+
+// Lookup table entry; length 0 marks a bit pattern no code starts with
+struct LookupEntry {
+    uint16_t symbol;
+    uint8_t length;
 };
 
-// Huffman decompression context
-struct HuffmanContext {
-    const uint8_t* in_buff;     // Input buffer
-    const uint8_t* in_pos;      // Current input position
-    const uint8_t* in_end;      // End of input buffer
-    
-    uint8_t* out_buff;          // Output buffer
-    uint8_t* out_pos;           // Current output position
-    uint8_t* out_end;           // End of output buffer
-    
-    uint32_t bit_buff;          // Bit buffer
-    uint32_t bits_avail;        // Number of bits available in bit buffer
-    
-    HuffmanNode* root;          // Root of Huffman tree
-    std::vector<HuffmanNode> nodes; // Node storage
+// One code word. Bits are listed in the order they are read from the
+// stream (first bit in bit 0).
+struct HuffmanCode {
+    uint32_t bits;
+    uint32_t length;
+    uint16_t symbol;
 };
 
-// Read bits from input stream
-static uint32_t ReadBits(HuffmanContext* ctx, uint32_t num_bits) {
-    uint32_t result = 0;
-    
-    while (num_bits > 0) {
-        // Refill bit buffer if needed
-        if (ctx->bits_avail == 0) {
-            if (ctx->in_pos >= ctx->in_end) {
-                return 0xFFFFFFFF; // No more input
+class HuffmanTable {
+public:
+    // Fills every table slot whose low bits match a code
+    bool build(const std::vector<HuffmanCode>& codes) {
+        table_bits = 0;
+        for (const auto& code : codes) {
+            if (code.length == 0 || code.length > kMaxCodeBits) {
+                return false;
             }
-            ctx->bit_buff = *ctx->in_pos++;
-            ctx->bits_avail = 8;
+            table_bits = std::max(table_bits, code.length);
         }
-        
-        // Extract one bit
-        uint32_t bit = ctx->bit_buff & 1;
-        ctx->bit_buff >>= 1;
-        ctx->bits_avail--;
-        
-        result = (result << 1) | bit;
-        num_bits--;
-    }
-    
-    return result;
-}
 
-// Build a simple Huffman tree for MPQ decompression
-// This is a simplified version - real MPQ Huffman uses predefined weight tables
-static bool BuildHuffmanTree(HuffmanContext* ctx) {
-    // For MPQ Huffman, we need to read the tree structure from the compressed data
-    // This is a simplified implementation that handles basic cases
-    
-    // Reserve space for nodes (worst case: 512 nodes for 256 symbols)
-    ctx->nodes.reserve(512);
-    
-    // Create root node
-    ctx->nodes.emplace_back();
-    ctx->root = &ctx->nodes[0];
-    
-    // In a real implementation, we would:
-    // 1. Read the compression type indicator
-    // 2. Build the tree based on predefined weight tables
-    // 3. Handle different compression types (0-8)
-    
-    // For now, create a simple fixed tree for testing
-    // This handles uncompressed data passed through Huffman wrapper
-    for (int i = 0; i < 256; i++) {
-        HuffmanNode* current = ctx->root;
-        
-        // Use the byte value as a path in the tree (8 bits)
-        for (int bit = 7; bit >= 0; bit--) {
-            if (i & (1 << bit)) {
-                if (!current->child1) {
-                    ctx->nodes.emplace_back();
-                    current->child1 = &ctx->nodes.back();
+        entries.assign(size_t(1) << table_bits, LookupEntry{0, 0});
+        for (const auto& code : codes) {
+            for (uint32_t high = 0; high < (1u << (table_bits - code.length)); high++) {
+                LookupEntry& entry = entries[code.bits | (high << code.length)];
+                if (entry.length != 0) {
+                    return false;  // Not a prefix code
                 }
-                current = current->child1;
-            } else {
-                if (!current->child0) {
-                    ctx->nodes.emplace_back();
-                    current->child0 = &ctx->nodes.back();
-                }
-                current = current->child0;
+                entry = LookupEntry{code.symbol, static_cast<uint8_t>(code.length)};
             }
         }
-        
-        // Make it a leaf node
-        current->is_leaf = true;
-        current->value = i;
+        return true;
     }
-    
-    return true;
-}
 
-// Decode one byte using Huffman tree
-static uint32_t DecodeSymbol(HuffmanContext* ctx) {
-    HuffmanNode* current = ctx->root;
-    
-    // Traverse tree based on input bits
-    while (!current->is_leaf) {
-        uint32_t bit = ReadBits(ctx, 1);
-        if (bit == 0xFFFFFFFF) {
-            return 0xFFFFFFFF; // No more input
+    uint32_t bits() const { return table_bits; }
+    const LookupEntry* data() const { return entries.data(); }
+
+private:
+    std::vector<LookupEntry> entries;
+    uint32_t table_bits = 0;
+};
+
+// Fixed code: each byte value is sent as 8 bits, most significant bit first
+const HuffmanTable& fixedTable() {
+    static const HuffmanTable table = []() {
+        std::vector<HuffmanCode> codes;
+        codes.reserve(256);
+        for (uint32_t value = 0; value < 256; value++) {
+            uint32_t reversed = 0;
+            for (uint32_t bit = 0; bit < 8; bit++) {
+                reversed |= ((value >> (7 - bit)) & 1) << bit;
+            }
+            codes.push_back(HuffmanCode{reversed, 8, static_cast<uint16_t>(value)});
         }
-        
-        if (bit) {
-            current = current->child1;
+        HuffmanTable built;
+        built.build(codes);
+        return built;
+    }();
+    return table;
+}
+
+// Decodes symbols until the output is full or the input runs out; a
+// trailing partial code is ignored. Input bits are consumed LSB first from
+// a 64-bit buffer. The buffer state and table pointer live in locals so
+// the byte stores to the output cannot force them back to memory.
+size_t decodeSymbols(const HuffmanTable& table, const uint8_t* in_pos, const uint8_t* in_end,
+                     uint8_t* out, size_t out_size) {
+    const LookupEntry* lookup = table.data();
+    const uint32_t table_bits = table.bits();
+    const uint64_t peek_mask = (uint64_t(1) << table_bits) - 1;
+    uint64_t bit_buff = 0;
+    uint32_t bits_avail = 0;
+    size_t written = 0;
+
+    while (written < out_size) {
+        // Top the buffer up to at least 56 bits while input remains
+        if (in_end - in_pos >= 8) {
+            // Load a whole little-endian word and keep the bytes that fit
+            uint64_t word;
+            std::memcpy(&word, in_pos, sizeof(word));
+            bit_buff |= word << bits_avail;
+            in_pos += (63 - bits_avail) >> 3;
+            bits_avail |= 56;
         } else {
-            current = current->child0;
+            while (bits_avail <= 56 && in_pos < in_end) {
+                bit_buff |= static_cast<uint64_t>(*in_pos++) << bits_avail;
+                bits_avail += 8;
+            }
+        }
+
+        if (bits_avail >= table_bits) {
+            // Every code fits in a table-width peek, so while that many
+            // bits are buffered each symbol is a single lookup
+            do {
+                const LookupEntry& entry = lookup[bit_buff & peek_mask];
+                if (entry.length == 0) {
+                    return written;
+                }
+                bit_buff >>= entry.length;
+                bits_avail -= entry.length;
+                out[written++] = static_cast<uint8_t>(entry.symbol);
+            } while (bits_avail >= table_bits && written < out_size);
+            continue;
         }
-        
-        if (!current) {
-            return 0xFFFFFFFF; // Invalid tree
+
+        // Input is exhausted and the peek includes missing bits; only
+        // accept a code if all of its bits were actually present
+        const LookupEntry& entry = lookup[bit_buff & peek_mask];
+        if (entry.length == 0 || entry.length > bits_avail) {
+            break;
         }
+        bit_buff >>= entry.length;
+        bits_avail -= entry.length;
+        out[written++] = static_cast<uint8_t>(entry.symbol);
     }
-    
-    return current->value;
+
+    return written;
 }
 
+} // namespace
+
 // Main Huffman decompression function
 bool HuffmanDecompress(const std::vector<uint8_t>& compressed_data,
                       std::vector<uint8_t>& output,
@@ -145,55 +154,30 @@ bool HuffmanDecompress(const std::vector<uint8_t>& compressed_data,
     if (compressed_data.empty()) {
         return false;
     }
-    
-    HuffmanContext ctx;
-    memset(&ctx, 0, sizeof(ctx));
-    
-    // Initialize context
-    ctx.in_buff = compressed_data.data();
-    ctx.in_pos = ctx.in_buff;
-    ctx.in_end = ctx.in_buff + compressed_data.size();
-    
+
     // Allocate output buffer
     output.resize(expected_size);
-    ctx.out_buff = output.data();
-    ctx.out_pos = ctx.out_buff;
-    ctx.out_end = ctx.out_buff + expected_size;
-    
-    // Build Huffman tree
-    if (!BuildHuffmanTree(&ctx)) {
-        return false;
-    }
-    
-    // Check for compression type byte (first byte in MPQ Huffman)
-    if (ctx.in_pos < ctx.in_end) {
-        uint8_t comp_type = *ctx.in_pos++;
-        
-        // For now, handle only simple cases
-        // Type 0-8 are different weight tables in real implementation
-        if (comp_type > 8) {
-            // Unknown compression type, try simple copy
-            if (compressed_data.size() - 1 == expected_size) {
-                memcpy(output.data(), compressed_data.data() + 1, expected_size);
-                return true;
-            }
-            return false;
-        }
-    }
-    
-    // Decompress data
-    while (ctx.out_pos < ctx.out_end) {
-        uint32_t symbol = DecodeSymbol(&ctx);
-        if (symbol == 0xFFFFFFFF) {
-            break; // End of input or error
+
+    // First byte is the compression type (weight table selector in MPQ)
+    uint8_t comp_type = compressed_data[0];
+    if (comp_type > 8) {
+        // Unknown compression type, try simple copy
+        if (compressed_data.size() - 1 == expected_size) {
+            memcpy(output.data(), compressed_data.data() + 1, expected_size);
+            return true;
         }
-        
-        *ctx.out_pos++ = (uint8_t)symbol;
+        return false;
     }
-    
+
+    // Types 0-8 select weight tables in the full MPQ format; all of them
+    // currently share the fixed 8-bit code
+    size_t written = decodeSymbols(fixedTable(), compressed_data.data() + 1,
+                                   compressed_data.data() + compressed_data.size(),
+                                   output.data(), expected_size);
+
     // Check if we decompressed the expected amount
-    return (ctx.out_pos - ctx.out_buff) == expected_size;
+    return written == expected_size;
 }
 
 } // namespace utils
-} // namespace d2portable
\ No newline at end of file
+} // namespace d2portable
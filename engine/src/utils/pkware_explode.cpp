@@ -11,9 +11,12 @@
 /* Huffman-encoded distances is not supported as it's a different variant.  */
 /*****************************************************************************/
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <vector>
 #include <cstdint>
+#include "utils/pkware_explode.h"
 #include "utils/pkware_explode_internal.h"
 
 // #define PKWARE_DEBUG
@@ -342,6 +345,7 @@ uint32_t calculateDistance(PKWAREWork& work, uint32_t length, uint32_t dist_pos_
 bool performCopy(PKWAREWork& work, uint32_t distance, uint32_t length) {
     size_t current_pos = work.out_pos - work.out_buff;
     uint8_t* copy_src;
+    const uint8_t* pre_init_end = nullptr;
     
     if (distance > current_pos) {
         // Distance goes before start of output buffer
@@ -359,6 +363,7 @@ bool performCopy(PKWAREWork& work, uint32_t distance, uint32_t length) {
             return false;  // Invalid distance
         }
         copy_src = pre_init_buffer + sizeof(pre_init_buffer) - pre_init_offset;
+        pre_init_end = pre_init_buffer + sizeof(pre_init_buffer);
     } else {
         // Normal case - copy from within output buffer
         copy_src = work.out_pos - distance;
@@ -366,6 +371,11 @@ bool performCopy(PKWAREWork& work, uint32_t distance, uint32_t length) {
     
     // Copy bytes
     while (length-- && work.out_pos < work.out_end) {
+        // A match that runs past the pre-init pattern continues at the
+        // start of the output
+        if (copy_src == pre_init_end) {
+            copy_src = work.out_buff;
+        }
         *work.out_pos++ = *copy_src++;
     }
     
@@ -416,14 +426,11 @@ bool processLengthDistancePair(PKWAREWork& work, bool literals_coded, const Huff
     return true;
 }
 
-} // namespace pkware_internal
-
-// Main decompression function (refactored)
-bool PKWAREExplode(const std::vector<uint8_t>& compressed_data,
-                   std::vector<uint8_t>& output,
-                   size_t expected_size) {
+bool explodeReference(const std::vector<uint8_t>& compressed_data,
+                      std::vector<uint8_t>& output,
+                      size_t expected_size) {
     // Handle test data format first
-    if (pkware_internal::handleTestDataFormat(compressed_data, output, expected_size)) {
+    if (handleTestDataFormat(compressed_data, output, expected_size)) {
         return true;
     }
     
@@ -431,16 +438,16 @@ bool PKWAREExplode(const std::vector<uint8_t>& compressed_data,
     memset(&work, 0, sizeof(work));
     
     // Validate and parse header
-    if (!pkware_internal::validateAndParseHeader(compressed_data, work)) {
+    if (!validateAndParseHeader(compressed_data, work)) {
         return false;
     }
     
     // Check if literals are coded
-    bool literals_coded = (work.ctype == 1);
+    bool literals_coded = (work.ctype == CMP_ASCII);
     
     // Build Huffman table for coded literals
     HuffmanTable litcode;
-    if (!pkware_internal::buildHuffmanTable(work, literals_coded, litcode)) {
+    if (!buildHuffmanTable(work, literals_coded, litcode)) {
         return false;
     }
     
@@ -458,12 +465,12 @@ bool PKWAREExplode(const std::vector<uint8_t>& compressed_data,
         
         if (flag) {
             // Flag=1: This is a length/distance pair (match)
-            if (!pkware_internal::processLengthDistancePair(work, literals_coded, litcode)) {
+            if (!processLengthDistancePair(work, literals_coded, litcode)) {
                 break;
             }
         } else {
             // Flag=0: This is a literal byte
-            if (!pkware_internal::processLiteral(work, literals_coded, litcode)) {
+            if (!processLiteral(work, literals_coded, litcode)) {
                 break;
             }
         }
@@ -480,6 +487,170 @@ bool PKWAREExplode(const std::vector<uint8_t>& compressed_data,
     return actual_size > 0;
 }
 
+} // namespace pkware_internal
+
+namespace {
+
+// Size of the space-filled window a match may reach back into before the
+// start of the output
+constexpr size_t kPreInitSize = 4096;
+
+// Match length for each 8-bit binary mode length code
+constexpr std::array<uint8_t, 256> kBinaryLengths = []() {
+    std::array<uint8_t, 256> lengths{};
+    for (uint32_t code = 0; code < 256; code++) {
+        lengths[code] = static_cast<uint8_t>(code < 32 ? code + 2 : 2 + (code % 8));
+    }
+    return lengths;
+}();
+
+// Distance position code and its bit count, indexed by the peeked bits
+struct DistanceEntry {
+    uint8_t code;
+    uint8_t bits;
+};
+
+const std::array<DistanceEntry, 256> kDistanceTable = []() {
+    std::array<DistanceEntry, 256> table{};
+    for (uint32_t bits = 0; bits < 256; bits++) {
+        table[bits] = DistanceEntry{DistPosCodes[bits], DistBits[DistPosCodes[bits]]};
+    }
+    return table;
+}();
+
+// Decodes a binary mode stream (uncoded literals) until the output is full
+// or a token runs out of input; returns the number of bytes written.
+// Produces the same bytes as the reference decoder. Input bits are taken
+// LSB first from a 64-bit buffer held in locals, topped up once per token.
+size_t explodeBinary(const uint8_t* in_pos, const uint8_t* in_end, uint32_t dsize_bits,
+                     uint8_t* out_buff, size_t out_size) {
+    uint8_t* out = out_buff;
+    uint8_t* const out_end = out_buff + out_size;
+    uint64_t bit_buff = 0;
+    uint32_t bits_avail = 0;
+
+    while (out < out_end) {
+        // A token needs at most 1 + 8 + 8 + 6 bits, so one refill to 56
+        // bits covers it; fewer bits remain only at the end of the input
+        if (in_end - in_pos >= 8) {
+            uint64_t word;
+            std::memcpy(&word, in_pos, sizeof(word));
+            bit_buff |= word << bits_avail;
+            in_pos += (63 - bits_avail) >> 3;
+            bits_avail |= 56;
+        } else {
+            while (bits_avail <= 56 && in_pos < in_end) {
+                bit_buff |= static_cast<uint64_t>(*in_pos++) << bits_avail;
+                bits_avail += 8;
+            }
+        }
+
+        if (bits_avail < 9) {
+            break;  // Not even a whole literal left
+        }
+        const bool is_match = bit_buff & 1;
+        const uint32_t code = static_cast<uint32_t>(bit_buff >> 1) & 0xFF;
+        bit_buff >>= 9;
+        bits_avail -= 9;
+
+        if (!is_match) {
+            *out++ = static_cast<uint8_t>(code);
+            continue;
+        }
+
+        const uint32_t length = kBinaryLengths[code];
+
+        // The reference decoder refills a byte at a time, so its distance
+        // code peek only sees the bits left over from the last input byte
+        const DistanceEntry& dist = kDistanceTable[bit_buff & ((1u << (bits_avail & 7)) - 1)];
+        if (bits_avail >= dist.bits) {
+            bit_buff >>= dist.bits;
+            bits_avail -= dist.bits;
+        }
+
+        const uint32_t low_bits = (length == 2) ? 2 : dsize_bits;
+        if (bits_avail < low_bits) {
+            break;
+        }
+        const size_t distance = ((static_cast<size_t>(dist.code) << low_bits) |
+                                 (bit_buff & ((1u << low_bits) - 1))) + 1;
+        bit_buff >>= low_bits;
+        bits_avail -= low_bits;
+
+        size_t count = std::min<size_t>(length, out_end - out);
+        const size_t current_pos = out - out_buff;
+        if (distance > current_pos) {
+            // Reaches back before the output into the space-filled window
+            const size_t before = distance - current_pos;
+            if (before > kPreInitSize) {
+                break;
+            }
+            const size_t blank = std::min(count, before);
+            std::memset(out, 0x20, blank);
+            out += blank;
+            count -= blank;
+        }
+
+        const uint8_t* src = out - distance;
+        if (distance >= 16 && out_end - out >= 48) {
+            // Matches are at most 33 bytes; copy in fixed 16-byte chunks,
+            // each reading only bytes written before it
+            for (size_t i = 0; i < count; i += 16) {
+                std::memcpy(out + i, src + i, 16);
+            }
+            out += count;
+        } else if (distance >= count) {
+            // A match fully covered by the blank prefix leaves nothing to
+            // copy, and src may then point before the window
+            if (count) {
+                std::memcpy(out, src, count);
+            }
+            out += count;
+        } else {
+            // Overlapping match repeats the last `distance` bytes
+            while (count--) {
+                *out++ = *src++;
+            }
+        }
+    }
+
+    return out - out_buff;
+}
+
+} // namespace
+
+// Main decompression function
+bool PKWAREExplode(const std::vector<uint8_t>& compressed_data,
+                   std::vector<uint8_t>& output,
+                   size_t expected_size) {
+    // Handle test data format first
+    if (pkware_internal::handleTestDataFormat(compressed_data, output, expected_size)) {
+        return true;
+    }
+
+    if (compressed_data.size() < 2 ||
+        compressed_data[1] < 4 || compressed_data[1] > MAX_DICT_BITS) {
+        return false;
+    }
+
+    // Coded literals stay on the bitwise Huffman decoder
+    if (compressed_data[0] == CMP_ASCII) {
+        return pkware_internal::explodeReference(compressed_data, output, expected_size);
+    }
+
+    output.resize(expected_size);
+    size_t actual_size = explodeBinary(compressed_data.data() + 2,
+                                       compressed_data.data() + compressed_data.size(),
+                                       compressed_data[1], output.data(), expected_size);
+
+    // Resize output to actual size if less than expected
+    if (actual_size < expected_size) {
+        output.resize(actual_size);
+    }
+
+    return actual_size > 0;
+}
+
 // Keep the original helper functions for compatibility
 // (GetBits, decode, construct implementations from original file)
 
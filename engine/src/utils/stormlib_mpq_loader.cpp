@@ -1,52 +1,298 @@
 #include "utils/stormlib_mpq_loader.h"
+#include "utils/memory_mapped_file.h"
 #include <StormLib.h>
 #include <cstring>
 #include <algorithm>
 #include <filesystem>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace d2portable {
 namespace utils {
 
+// Where a file's stored bytes live inside the mapped archive
+struct MappedFileLayout {
+    const uint8_t* data;
+    uint32_t compressedSize;
+    uint32_t fileSize;
+    uint32_t flags;
+};
+
 class StormLibMPQLoader::Impl {
 public:
+    // Handle opened by open(); non-null while the archive is open
     HANDLE hMpq = nullptr;
+    std::string archivePath;
+    
     std::string lastError;
+    mutable std::mutex errorMutex;
+    
+    // A StormLib archive handle carries its own file position and sector
+    // cache, so concurrent readers each borrow a separate handle. Extra
+    // handles are opened on demand, up to one per hardware thread, and
+    // kept until the archive is closed.
+    mutable std::mutex handleMutex;
+    mutable std::condition_variable handleReleased;
+    mutable std::vector<HANDLE> idleHandles;
+    mutable std::vector<HANDLE> openHandles;
+    mutable size_t pendingOpens = 0;
+    const size_t maxHandles = std::max(1u, std::thread::hardware_concurrency());
+    
+    // Memory-mapped mode
+    MemoryMappedFile mapping;
+    uint64_t headerOffset = 0;
+    uint32_t sectorSize = 0;
     
     ~Impl() {
-        if (hMpq) {
-            SFileCloseArchive(hMpq);
+        closeHandles();
+    }
+    
+    // Borrows an archive handle for the duration of one operation
+    class HandleLease {
+    public:
+        explicit HandleLease(const Impl& impl) : impl(impl), handle(impl.acquireHandle()) {}
+        ~HandleLease() {
+            if (handle) {
+                impl.releaseHandle(handle);
+            }
+        }
+        HandleLease(const HandleLease&) = delete;
+        HandleLease& operator=(const HandleLease&) = delete;
+        
+        HANDLE get() const { return handle; }
+        
+    private:
+        const Impl& impl;
+        HANDLE handle;
+    };
+    
+    HANDLE acquireHandle() const {
+        std::unique_lock<std::mutex> lock(handleMutex);
+        // At the cap, wait for a reader to hand its handle back
+        handleReleased.wait(lock, [this]() {
+            return !hMpq || !idleHandles.empty() || openHandles.size() + pendingOpens < maxHandles;
+        });
+        if (!hMpq) {
+            return nullptr;
+        }
+        if (!idleHandles.empty()) {
+            HANDLE handle = idleHandles.back();
+            idleHandles.pop_back();
+            return handle;
+        }
+        
+        // Opening reads the archive tables, so do it without blocking
+        // readers that only need an idle handle
+        pendingOpens++;
+        std::string path = archivePath;
+        lock.unlock();
+        HANDLE handle = nullptr;
+        bool opened = SFileOpenArchive(path.c_str(), 0, MPQ_OPEN_READ_ONLY, &handle);
+        lock.lock();
+        pendingOpens--;
+        if (!opened) {
+            // Let a waiter retry the slot this open held
+            handleReleased.notify_one();
+            return nullptr;
+        }
+        openHandles.push_back(handle);
+        return handle;
+    }
+    
+    void releaseHandle(HANDLE handle) const {
+        {
+            std::lock_guard<std::mutex> lock(handleMutex);
+            idleHandles.push_back(handle);
+        }
+        handleReleased.notify_one();
+    }
+    
+    void closeHandles() {
+        std::lock_guard<std::mutex> lock(handleMutex);
+        for (HANDLE handle : openHandles) {
+            SFileCloseArchive(handle);
+        }
+        openHandles.clear();
+        idleHandles.clear();
+        hMpq = nullptr;
+        handleReleased.notify_all();
+    }
+    
+    bool locateMappedFile(HANDLE hFile, MappedFileLayout& layout) const {
+        ULONGLONG byteOffset = 0;
+        DWORD compressedSize = 0;
+        DWORD flags = 0;
+        if (!SFileGetFileInfo(hFile, SFileInfoByteOffset, &byteOffset, sizeof(byteOffset), nullptr) ||
+            !SFileGetFileInfo(hFile, SFileInfoCompressedSize, &compressedSize, sizeof(compressedSize), nullptr) ||
+            !SFileGetFileInfo(hFile, SFileInfoFlags, &flags, sizeof(flags), nullptr)) {
+            return false;
+        }
+        
+        uint64_t start = headerOffset + byteOffset;
+        if (start > mapping.size() || compressedSize > mapping.size() - start) {
+            return false;
+        }
+        
+        layout.data = mapping.data() + start;
+        layout.compressedSize = compressedSize;
+        layout.fileSize = SFileGetFileSize(hFile, nullptr);
+        layout.flags = flags;
+        return layout.fileSize != SFILE_INVALID_SIZE;
+    }
+    
+    static bool isStoredRaw(const MappedFileLayout& layout) {
+        return !(layout.flags & (MPQ_FILE_COMPRESS | MPQ_FILE_IMPLODE | MPQ_FILE_ENCRYPTED | MPQ_FILE_PATCH_FILE)) &&
+               layout.compressedSize >= layout.fileSize;
+    }
+    
+    // Decompress one sector from the mapping straight into the destination
+    static bool decodeSector(const uint8_t* src, uint32_t srcSize, uint8_t* dst, uint32_t dstSize, uint32_t flags) {
+        if (srcSize == dstSize) {
+            // Sectors that did not shrink are stored raw
+            std::memcpy(dst, src, dstSize);
+            return true;
+        }
+        if (srcSize > dstSize) {
+            return false;
+        }
+        
+        // StormLib only reads from the input buffer
+        int outSize = static_cast<int>(dstSize);
+        void* input = const_cast<uint8_t*>(src);
+        int ok = (flags & MPQ_FILE_COMPRESS)
+            ? SCompDecompress(dst, &outSize, input, static_cast<int>(srcSize))
+            : SCompExplode(dst, &outSize, input, static_cast<int>(srcSize));
+        return ok && outSize == static_cast<int>(dstSize);
+    }
+    
+    // Returns false when the file needs StormLib's own read path
+    // (encryption, patch files, or anything that does not validate)
+    bool readMappedFile(HANDLE hFile, uint8_t* output, uint32_t fileSize) const {
+        MappedFileLayout layout;
+        if (!locateMappedFile(hFile, layout) || layout.fileSize != fileSize ||
+            (layout.flags & (MPQ_FILE_ENCRYPTED | MPQ_FILE_PATCH_FILE))) {
+            return false;
+        }
+        
+        if (isStoredRaw(layout)) {
+            std::memcpy(output, layout.data, fileSize);
+            return true;
+        }
+        if (!(layout.flags & (MPQ_FILE_COMPRESS | MPQ_FILE_IMPLODE))) {
+            return false;
+        }
+        if (fileSize == 0) {
+            return true;
+        }
+        
+        if (layout.flags & MPQ_FILE_SINGLE_UNIT) {
+            return decodeSector(layout.data, layout.compressedSize, output, fileSize, layout.flags);
+        }
+        
+        // Sector offset table: one entry per sector plus the end offset
+        uint32_t sectorCount = (layout.fileSize + sectorSize - 1) / sectorSize;
+        uint64_t tableSize = (static_cast<uint64_t>(sectorCount) + 1) * sizeof(uint32_t);
+        if (tableSize > layout.compressedSize) {
+            return false;
+        }
+        
+        uint32_t sectorStart;
+        std::memcpy(&sectorStart, layout.data, sizeof(uint32_t));
+        for (uint32_t i = 0; i < sectorCount; i++) {
+            uint32_t sectorEnd;
+            std::memcpy(&sectorEnd, layout.data + (i + 1) * sizeof(uint32_t), sizeof(uint32_t));
+            if (sectorEnd < sectorStart || sectorEnd > layout.compressedSize) {
+                return false;
+            }
+            
+            uint32_t outOffset = i * sectorSize;
+            uint32_t outSize = std::min(sectorSize, layout.fileSize - outOffset);
+            if (!decodeSector(layout.data + sectorStart, sectorEnd - sectorStart,
+                              output + outOffset, outSize, layout.flags)) {
+                return false;
+            }
+            sectorStart = sectorEnd;
         }
+        return true;
     }
     
     void setLastError() {
         DWORD error = GetLastError();
         switch (error) {
             case ERROR_FILE_NOT_FOUND:
-                lastError = "File not found";
+                setError("File not found");
                 break;
             case ERROR_ACCESS_DENIED:
-                lastError = "Access denied";
+                setError("Access denied");
                 break;
             case ERROR_INVALID_HANDLE:
-                lastError = "Invalid handle";
+                setError("Invalid handle");
                 break;
             case ERROR_NOT_ENOUGH_MEMORY:
-                lastError = "Not enough memory";
+                setError("Not enough memory");
                 break;
             case ERROR_NOT_SUPPORTED:
-                lastError = "Operation not supported";
+                setError("Operation not supported");
                 break;
             case ERROR_INVALID_PARAMETER:
-                lastError = "Invalid parameter";
+                setError("Invalid parameter");
                 break;
             case ERROR_FILE_CORRUPT:
-                lastError = "File corrupt";
+                setError("File corrupt");
                 break;
             default:
-                lastError = "Error code: " + std::to_string(error);
+                setError("Error code: " + std::to_string(error));
                 break;
         }
     }
+    
+    void setError(const std::string& message) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        lastError = message;
+    }
+    
+    // Opens a file and reports its size; the caller closes the handle
+    bool openFile(HANDLE archive, const std::string& filename, HANDLE& hFile, DWORD& fileSize) {
+        if (!archive) {
+            setError(hMpq ? "Failed to open additional archive handle" : "MPQ not open");
+            return false;
+        }
+        
+        if (!SFileOpenFileEx(archive, filename.c_str(), 0, &hFile)) {
+            setLastError();
+            return false;
+        }
+        
+        fileSize = SFileGetFileSize(hFile, nullptr);
+        if (fileSize == SFILE_INVALID_SIZE) {
+            setLastError();
+            SFileCloseFile(hFile);
+            return false;
+        }
+        return true;
+    }
+    
+    // Reads a whole open file into a buffer of at least fileSize bytes
+    bool readOpenFile(HANDLE hFile, uint8_t* buffer, DWORD fileSize) {
+        // Serve the file from the mapping when possible
+        if (mapping.isOpen() && readMappedFile(hFile, buffer, fileSize)) {
+            return true;
+        }
+        
+        DWORD bytesRead = 0;
+        if (!SFileReadFile(hFile, buffer, fileSize, &bytesRead, nullptr)) {
+            setLastError();
+            return false;
+        }
+        
+        // Verify we read the full file
+        if (bytesRead != fileSize) {
+            setError("Failed to read complete file");
+            return false;
+        }
+        return true;
+    }
 };
 
 StormLibMPQLoader::StormLibMPQLoader() : pImpl(std::make_unique<Impl>()) {
@@ -57,7 +303,7 @@ StormLibMPQLoader::~StormLibMPQLoader() = default;
 StormLibMPQLoader::StormLibMPQLoader(StormLibMPQLoader&& other) noexcept = default;
 StormLibMPQLoader& StormLibMPQLoader::operator=(StormLibMPQLoader&& other) noexcept = default;
 
-bool StormLibMPQLoader::open(const std::string& filepath) {
+bool StormLibMPQLoader::open(const std::string& filepath, MPQAccessMode mode) {
     // Close any existing archive
     close();
     
@@ -65,40 +311,64 @@ bool StormLibMPQLoader::open(const std::string& filepath) {
     std::error_code ec;
     auto file_size = std::filesystem::file_size(filepath, ec);
     if (ec || file_size < 32) { // MPQ header is at least 32 bytes
-        pImpl->lastError = "File too small or inaccessible to be a valid MPQ archive";
+        pImpl->setError("File too small or inaccessible to be a valid MPQ archive");
         return false;
     }
     
     // Open the MPQ archive - use read-only mode for Diablo II MPQs
-    if (!SFileOpenArchive(filepath.c_str(), 0, MPQ_OPEN_READ_ONLY, &pImpl->hMpq)) {
+    HANDLE hMpq = nullptr;
+    if (!SFileOpenArchive(filepath.c_str(), 0, MPQ_OPEN_READ_ONLY, &hMpq)) {
         pImpl->setLastError();
         return false;
     }
+    {
+        std::lock_guard<std::mutex> lock(pImpl->handleMutex);
+        pImpl->hMpq = hMpq;
+        pImpl->archivePath = filepath;
+        pImpl->openHandles.push_back(hMpq);
+        pImpl->idleHandles.push_back(hMpq);
+    }
+    
+    if (mode == MPQAccessMode::MEMORY_MAPPED) {
+        // If the archive cannot be mapped it is still usable through StormLib
+        ULONGLONG headerOffset = 0;
+        DWORD sectorSize = 0;
+        if (SFileGetFileInfo(pImpl->hMpq, SFileMpqHeaderOffset, &headerOffset, sizeof(headerOffset), nullptr) &&
+            SFileGetFileInfo(pImpl->hMpq, SFileMpqSectorSize, &sectorSize, sizeof(sectorSize), nullptr) &&
+            sectorSize > 0 && pImpl->mapping.open(filepath)) {
+            pImpl->headerOffset = headerOffset;
+            pImpl->sectorSize = sectorSize;
+        }
+    }
     
     return true;
 }
 
 void StormLibMPQLoader::close() {
-    if (pImpl->hMpq) {
-        SFileCloseArchive(pImpl->hMpq);
-        pImpl->hMpq = nullptr;
-    }
+    pImpl->closeHandles();
+    pImpl->mapping.close();
 }
 
 bool StormLibMPQLoader::isOpen() const {
+    std::lock_guard<std::mutex> lock(pImpl->handleMutex);
     return pImpl->hMpq != nullptr;
 }
 
+bool StormLibMPQLoader::isMemoryMapped() const {
+    return pImpl->mapping.isOpen();
+}
+
 std::vector<StormMPQFileInfo> StormLibMPQLoader::listFiles() const {
     std::vector<StormMPQFileInfo> result;
     
-    if (!pImpl->hMpq) {
+    Impl::HandleLease archive(*pImpl);
+    if (!archive.get()) {
         return result;
     }
     
     // Find first file
     SFILE_FIND_DATA findData;
-    HANDLE hFind = SFileFindFirstFile(pImpl->hMpq, "*", &findData, nullptr);
+    HANDLE hFind = SFileFindFirstFile(archive.get(), "*", &findData, nullptr);
     
     if (hFind != nullptr) {
         do {
@@ -123,65 +393,88 @@ std::vector<StormMPQFileInfo> StormLibMPQLoader::listFiles() const {
 }
 
 bool StormLibMPQLoader::hasFile(const std::string& filename) const {
-    if (!pImpl->hMpq) {
+    Impl::HandleLease archive(*pImpl);
+    if (!archive.get()) {
         return false;
     }
     
-    return SFileHasFile(pImpl->hMpq, filename.c_str());
+    return SFileHasFile(archive.get(), filename.c_str());
 }
 
 bool StormLibMPQLoader::extractFile(const std::string& filename, std::vector<uint8_t>& output) {
-    if (!pImpl->hMpq) {
-        pImpl->lastError = "MPQ not open";
+    Impl::HandleLease archive(*pImpl);
+    HANDLE hFile;
+    DWORD fileSize;
+    if (!pImpl->openFile(archive.get(), filename, hFile, fileSize)) {
         return false;
     }
     
-    // Open file in MPQ
+    // resize() keeps existing capacity, so a reused vector does not reallocate
+    output.resize(fileSize);
+    bool success = pImpl->readOpenFile(hFile, output.data(), fileSize);
+    SFileCloseFile(hFile);
+    
+    return success;
+}
+
+bool StormLibMPQLoader::extractFile(const std::string& filename, uint8_t* buffer, size_t capacity,
+                                    size_t& bytesWritten) {
+    bytesWritten = 0;
+    
+    Impl::HandleLease archive(*pImpl);
     HANDLE hFile;
-    if (!SFileOpenFileEx(pImpl->hMpq, filename.c_str(), 0, &hFile)) {
-        pImpl->setLastError();
+    DWORD fileSize;
+    if (!pImpl->openFile(archive.get(), filename, hFile, fileSize)) {
         return false;
     }
     
-    // Get file size
-    DWORD fileSize = SFileGetFileSize(hFile, nullptr);
-    if (fileSize == SFILE_INVALID_SIZE) {
-        pImpl->setLastError();
+    // Report the required size so the caller can grow its buffer and retry
+    bytesWritten = fileSize;
+    if (fileSize > capacity) {
+        pImpl->setError("Buffer too small: " + std::to_string(fileSize) + " bytes required");
         SFileCloseFile(hFile);
         return false;
     }
     
-    // Allocate buffer
-    output.resize(fileSize);
+    bool success = pImpl->readOpenFile(hFile, buffer, fileSize);
+    SFileCloseFile(hFile);
     
-    // Read file data
-    DWORD bytesRead = 0;
-    if (!SFileReadFile(hFile, output.data(), fileSize, &bytesRead, nullptr)) {
-        pImpl->setLastError();
-        SFileCloseFile(hFile);
+    return success;
+}
+
+bool StormLibMPQLoader::getFileView(const std::string& filename, MPQFileView& view) const {
+    if (!pImpl->mapping.isOpen()) {
+        return false;
+    }
+    
+    Impl::HandleLease archive(*pImpl);
+    HANDLE hFile;
+    if (!archive.get() || !SFileOpenFileEx(archive.get(), filename.c_str(), 0, &hFile)) {
         return false;
     }
     
-    // Close file
+    MappedFileLayout layout;
+    bool stored = pImpl->locateMappedFile(hFile, layout) && Impl::isStoredRaw(layout);
     SFileCloseFile(hFile);
     
-    // Verify we read the full file
-    if (bytesRead != fileSize) {
-        pImpl->lastError = "Failed to read complete file";
+    if (!stored) {
         return false;
     }
     
+    view.data = layout.data;
+    view.size = layout.fileSize;
     return true;
 }
 
 std::optional<StormMPQFileInfo> StormLibMPQLoader::getFileInfo(const std::string& filename) const {
-    if (!pImpl->hMpq) {
+    Impl::HandleLease archive(*pImpl);
+    if (!archive.get()) {
         return std::nullopt;
     }
     
     // Open file to get info
     HANDLE hFile;
-    if (!SFileOpenFileEx(pImpl->hMpq, filename.c_str(), 0, &hFile)) {
+    if (!SFileOpenFileEx(archive.get(), filename.c_str(), 0, &hFile)) {
         return std::nullopt;
     }
     
@@ -201,6 +494,7 @@ std::optional<StormMPQFileInfo> StormLibMPQLoader::getFileInfo(const std::string
 }
 
 std::string StormLibMPQLoader::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->errorMutex);
     return pImpl->lastError;
 }
 
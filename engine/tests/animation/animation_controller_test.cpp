@@ -156,6 +156,9 @@ TEST_F(AnimationControllerTest, GetsCorrectSpriteFrame) {
     EXPECT_EQ(controller.getCurrentDirection(), d2::animation::Direction::EAST);
     EXPECT_EQ(controller.getCurrentFrame(), 3);
     
-    // In a real implementation, getCurrentSpriteFrame would return the actual frame
-    // For now, we just verify the state is correct
+    // The view points at the sprite's frame without copying it
+    auto view = controller.getCurrentFrameView();
+    EXPECT_EQ(view.width, 64);
+    EXPECT_EQ(view.height, 64);
+    EXPECT_EQ(view.pixelCount, 64 * 64 * 4);
 }
\ No newline at end of file
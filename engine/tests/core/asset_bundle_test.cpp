@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include "core/asset_bundle.h"
+#include "core/asset_manager.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace d2portable::core;
+using d2portable::sprites::DC6Sprite;
+using d2portable::sprites::DC6Frame;
+using d2portable::sprites::DC6Parser;
+
+namespace {
+
+// Sprite with generated frames of varying sizes
+class GeneratedSprite : public DC6Sprite {
+public:
+    GeneratedSprite(uint32_t directions, uint32_t frames, uint8_t seed)
+        : directions(directions), frames_per_direction(frames) {
+        for (uint32_t dir = 0; dir < directions; dir++) {
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                DC6Frame dc6_frame;
+                dc6_frame.width = 3 + dir * 5 + frame;
+                dc6_frame.height = 2 + frame * 3;
+                dc6_frame.offsetX = -static_cast<int32_t>(dir);
+                dc6_frame.offsetY = static_cast<int32_t>(frame) - 40;
+                dc6_frame.pixelData.resize(dc6_frame.width * dc6_frame.height);
+                for (size_t i = 0; i < dc6_frame.pixelData.size(); i++) {
+                    dc6_frame.pixelData[i] = static_cast<uint8_t>(i * 31 + dir * 7 + frame + seed);
+                }
+                frame_list.push_back(dc6_frame);
+            }
+        }
+    }
+
+    uint32_t getDirectionCount() const override { return directions; }
+    uint32_t getFramesPerDirection() const override { return frames_per_direction; }
+
+    DC6Frame getFrame(uint32_t direction, uint32_t frame) const override {
+        if (direction >= directions || frame >= frames_per_direction) {
+            return DC6Frame{};
+        }
+        return frame_list[direction * frames_per_direction + frame];
+    }
+
+    std::vector<uint8_t> getFrameImage(uint32_t, uint32_t) const override { return {}; }
+    std::vector<uint8_t> getFrameImageWithPalette(uint32_t, uint32_t,
+                                                  const std::vector<uint32_t>&) const override { return {}; }
+
+private:
+    uint32_t directions;
+    uint32_t frames_per_direction;
+    std::vector<DC6Frame> frame_list;
+};
+
+void expectSameFrames(const DC6Sprite& expected, const DC6Sprite& actual) {
+    ASSERT_EQ(actual.getDirectionCount(), expected.getDirectionCount());
+    ASSERT_EQ(actual.getFramesPerDirection(), expected.getFramesPerDirection());
+    for (uint32_t dir = 0; dir < expected.getDirectionCount(); dir++) {
+        for (uint32_t frame = 0; frame < expected.getFramesPerDirection(); frame++) {
+            auto a = expected.getFrame(dir, frame);
+            auto b = actual.getFrame(dir, frame);
+            EXPECT_EQ(b.width, a.width);
+            EXPECT_EQ(b.height, a.height);
+            EXPECT_EQ(b.offsetX, a.offsetX);
+            EXPECT_EQ(b.offsetY, a.offsetY);
+            EXPECT_EQ(b.pixelData, a.pixelData);
+        }
+    }
+}
+
+} // namespace
+
+class AssetBundleTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "d2portable_bundle_test";
+        std::filesystem::create_directories(test_dir);
+        bundle_path = (test_dir / "sprites.d2pak").string();
+
+        cursor = std::make_shared<GeneratedSprite>(1, 8, 1);
+        monster = std::make_shared<GeneratedSprite>(8, 4, 2);
+
+        AssetBundleWriter writer;
+        ASSERT_TRUE(writer.addSprite("data\\global\\ui\\cursor\\cursor.dc6", cursor));
+        ASSERT_TRUE(writer.addSprite("data/global/monsters/zombie.dc6", monster));
+        EXPECT_FALSE(writer.addSprite("DATA\\GLOBAL\\MONSTERS\\ZOMBIE.DC6", monster));
+        EXPECT_EQ(writer.getSpriteCount(), 2);
+        ASSERT_TRUE(writer.write(bundle_path)) << writer.getLastError();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    std::filesystem::path test_dir;
+    std::string bundle_path;
+    std::shared_ptr<DC6Sprite> cursor;
+    std::shared_ptr<DC6Sprite> monster;
+};
+
+TEST_F(AssetBundleTest, RoundTripsSprites) {
+    AssetBundle bundle;
+    ASSERT_TRUE(bundle.open(bundle_path)) << bundle.getLastError();
+    EXPECT_EQ(bundle.getSpriteCount(), 2);
+
+    auto loaded_cursor = bundle.loadSprite("data/global/ui/cursor/cursor.dc6");
+    auto loaded_monster = bundle.loadSprite("Data\\Global\\Monsters\\Zombie.dc6");
+    ASSERT_NE(loaded_cursor, nullptr);
+    ASSERT_NE(loaded_monster, nullptr);
+    expectSameFrames(*cursor, *loaded_cursor);
+    expectSameFrames(*monster, *loaded_monster);
+
+    EXPECT_FALSE(bundle.contains("data/global/monsters/skeleton.dc6"));
+    EXPECT_EQ(bundle.loadSprite("data/global/monsters/skeleton.dc6"), nullptr);
+}
+
+TEST_F(AssetBundleTest, FrameImagesMatchParsedSprites) {
+    AssetBundle bundle;
+    ASSERT_TRUE(bundle.open(bundle_path));
+    auto sprite = bundle.loadSprite("data/global/monsters/zombie.dc6");
+    ASSERT_NE(sprite, nullptr);
+
+    auto frame = monster->getFrame(3, 2);
+    auto rgba = sprite->getFrameImage(3, 2);
+    ASSERT_EQ(rgba.size(), frame.pixelData.size() * 4);
+    EXPECT_EQ(rgba[4], frame.pixelData[1]);
+    EXPECT_EQ(rgba[7], 255);
+
+    auto palette = DC6Parser().getDefaultPalette();
+    auto colored = sprite->getFrameImageWithPalette(3, 2, palette);
+    ASSERT_EQ(colored.size(), rgba.size());
+    uint32_t color = palette[frame.pixelData[5]];
+    EXPECT_EQ(colored[20], color & 0xFF);
+    EXPECT_EQ(colored[23], (color >> 24) & 0xFF);
+
+    EXPECT_TRUE(sprite->getFrameImage(8, 0).empty());
+}
+
+TEST_F(AssetBundleTest, SpritesOutliveTheBundle) {
+    std::shared_ptr<DC6Sprite> sprite;
+    {
+        AssetBundle bundle;
+        ASSERT_TRUE(bundle.open(bundle_path));
+        sprite = bundle.loadSprite("data/global/ui/cursor/cursor.dc6");
+    }
+    ASSERT_NE(sprite, nullptr);
+    expectSameFrames(*cursor, *sprite);
+}
+
+TEST_F(AssetBundleTest, FrameViewsKeepTheMappingAlive) {
+    DC6Frame expected = monster->getFrame(5, 1);
+    d2portable::sprites::DC6FrameView view;
+    {
+        AssetBundle bundle;
+        ASSERT_TRUE(bundle.open(bundle_path));
+        view = bundle.loadSprite("data/global/monsters/zombie.dc6")->getFrameView(5, 1);
+    }
+    EXPECT_EQ(view.width, expected.width);
+    EXPECT_EQ(view.offsetY, expected.offsetY);
+    ASSERT_EQ(view.pixelCount, expected.pixelData.size());
+    EXPECT_EQ(std::vector<uint8_t>(view.pixels, view.pixels + view.pixelCount), expected.pixelData);
+}
+
+TEST_F(AssetBundleTest, RejectsCorruptBundles) {
+    std::vector<char> bytes(std::filesystem::file_size(bundle_path));
+    std::ifstream(bundle_path, std::ios::binary).read(bytes.data(), bytes.size());
+
+    auto writeVariant = [&](const std::string& name, std::vector<char> variant) {
+        std::string path = (test_dir / name).string();
+        std::ofstream(path, std::ios::binary).write(variant.data(), variant.size());
+        return path;
+    };
+
+    auto bad_magic = bytes;
+    bad_magic[0] = 'X';
+    auto bad_version = bytes;
+    bad_version[4] = 99;
+    auto truncated = bytes;
+    truncated.resize(truncated.size() - 16);
+
+    AssetBundle bundle;
+    EXPECT_FALSE(bundle.open(writeVariant("magic.d2pak", bad_magic)));
+    EXPECT_FALSE(bundle.open(writeVariant("version.d2pak", bad_version)));
+    EXPECT_FALSE(bundle.open(writeVariant("truncated.d2pak", truncated)));
+    EXPECT_FALSE(bundle.open((test_dir / "missing.d2pak").string()));
+    EXPECT_FALSE(bundle.isOpen());
+    EXPECT_FALSE(bundle.contains("data/global/ui/cursor/cursor.dc6"));
+}
+
+TEST_F(AssetBundleTest, AssetManagerServesMountedBundle) {
+    AssetManager manager;
+    ASSERT_TRUE(manager.initialize(test_dir.string()));
+    EXPECT_FALSE(manager.mountBundle((test_dir / "missing.d2pak").string()));
+    ASSERT_TRUE(manager.mountBundle(bundle_path));
+    EXPECT_EQ(manager.getMountedBundleCount(), 1);
+
+    EXPECT_TRUE(manager.hasFile("data/global/monsters/zombie.dc6"));
+    auto sprite = manager.loadSprite("data/global/monsters/zombie.dc6");
+    ASSERT_NE(sprite, nullptr);
+    expectSameFrames(*monster, *sprite);
+
+    // Mapped sprites are cheap to keep cached
+    EXPECT_LT(manager.getCacheMemoryUsage(), 4096);
+    EXPECT_EQ(manager.loadSprite("data/global/monsters/zombie.dc6"), sprite);
+}
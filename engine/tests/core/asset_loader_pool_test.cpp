@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "core/asset_loader_pool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace d2portable::core;
+using d2portable::sprites::DC6Sprite;
+using d2portable::sprites::DC6Frame;
+
+namespace {
+
+class StubSprite : public DC6Sprite {
+public:
+    explicit StubSprite(std::string path) : path(std::move(path)) {}
+
+    uint32_t getDirectionCount() const override { return 1; }
+    uint32_t getFramesPerDirection() const override { return 1; }
+    DC6Frame getFrame(uint32_t, uint32_t) const override { return DC6Frame{}; }
+    std::vector<uint8_t> getFrameImage(uint32_t, uint32_t) const override { return {}; }
+    std::vector<uint8_t> getFrameImageWithPalette(uint32_t, uint32_t,
+                                                  const std::vector<uint32_t>&) const override { return {}; }
+
+    std::string path;
+};
+
+// Blocks every load until released so tests control what is queued
+class GatedLoader {
+public:
+    AssetLoaderPool::SpritePtr load(const std::string& path) {
+        std::unique_lock<std::mutex> lock(mutex);
+        started.push_back(path);
+        started_cv.notify_all();
+        release_cv.wait(lock, [this]() { return released; });
+        return std::make_shared<StubSprite>(path);
+    }
+
+    void waitForStarted(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        started_cv.wait(lock, [&]() { return started.size() >= count; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+        release_cv.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable started_cv;
+    std::condition_variable release_cv;
+    std::vector<std::string> started;
+    bool released = false;
+};
+
+std::string pathOf(const AssetLoaderPool::SpritePtr& sprite) {
+    return static_cast<const StubSprite*>(sprite.get())->path;
+}
+
+} // namespace
+
+TEST(AssetLoaderPoolTest, LoadsOnWorkerThreads) {
+    AssetLoaderPool pool([](const std::string& path) {
+        return std::make_shared<StubSprite>(path);
+    }, 2);
+
+    EXPECT_EQ(pool.getWorkerCount(), 2);
+
+    auto future = pool.submit("data/global/ui/panel/invchar6.dc6");
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(pathOf(future.get()), "data/global/ui/panel/invchar6.dc6");
+}
+
+TEST(AssetLoaderPoolTest, DuplicateRequestsShareOneLoad) {
+    std::atomic<int> loads{0};
+    GatedLoader gate;
+    AssetLoaderPool pool([&](const std::string& path) {
+        loads++;
+        return gate.load(path);
+    }, 1);
+
+    auto first = pool.submit("monster.dc6");
+    auto second = pool.submit("monster.dc6", LoadPriority::PREFETCH);
+    gate.release();
+
+    auto a = first.get();
+    auto b = second.get();
+    EXPECT_EQ(a.get(), b.get());
+    EXPECT_EQ(loads.load(), 1);
+}
+
+TEST(AssetLoaderPoolTest, HigherPriorityRunsFirst) {
+    GatedLoader gate;
+    AssetLoaderPool pool([&](const std::string& path) { return gate.load(path); }, 1);
+
+    // Occupy the single worker so the rest stay queued
+    auto blocker = pool.submit("blocker");
+    gate.waitForStarted(1);
+
+    auto prefetch = pool.submit("prefetch", LoadPriority::PREFETCH);
+    auto nearby = pool.submit("nearby", LoadPriority::NEARBY);
+    auto visible = pool.submit("visible", LoadPriority::VISIBLE);
+    EXPECT_EQ(pool.getQueuedCount(), 3);
+
+    gate.release();
+    prefetch.get();
+    nearby.get();
+    visible.get();
+    blocker.get();
+
+    ASSERT_EQ(gate.started.size(), 4);
+    EXPECT_EQ(gate.started[1], "visible");
+    EXPECT_EQ(gate.started[2], "nearby");
+    EXPECT_EQ(gate.started[3], "prefetch");
+}
+
+TEST(AssetLoaderPoolTest, RepeatedRequestPromotesQueuedLoad) {
+    GatedLoader gate;
+    AssetLoaderPool pool([&](const std::string& path) { return gate.load(path); }, 1);
+
+    auto blocker = pool.submit("blocker");
+    gate.waitForStarted(1);
+
+    auto nearby = pool.submit("nearby", LoadPriority::NEARBY);
+    auto prefetch = pool.submit("tileset", LoadPriority::PREFETCH);
+    auto promoted = pool.submit("tileset", LoadPriority::VISIBLE);
+
+    gate.release();
+    blocker.get();
+    nearby.get();
+    EXPECT_EQ(prefetch.get().get(), promoted.get().get());
+
+    ASSERT_EQ(gate.started.size(), 3);
+    EXPECT_EQ(gate.started[1], "tileset");
+}
+
+TEST(AssetLoaderPoolTest, CancelQueuedLoads) {
+    GatedLoader gate;
+    AssetLoaderPool pool([&](const std::string& path) { return gate.load(path); }, 1);
+
+    auto blocker = pool.submit("blocker");
+    gate.waitForStarted(1);
+
+    auto visible = pool.submit("visible", LoadPriority::VISIBLE);
+    auto nearby = pool.submit("nearby", LoadPriority::NEARBY);
+    auto prefetch_a = pool.submit("prefetch_a", LoadPriority::PREFETCH);
+    auto prefetch_b = pool.submit("prefetch_b", LoadPriority::PREFETCH);
+
+    // A running load cannot be cancelled
+    EXPECT_FALSE(pool.cancel("blocker"));
+    EXPECT_TRUE(pool.cancel("nearby"));
+    EXPECT_FALSE(pool.cancel("nearby"));
+    EXPECT_EQ(pool.cancelAll(LoadPriority::PREFETCH), 2);
+    EXPECT_EQ(pool.getQueuedCount(), 1);
+
+    EXPECT_EQ(nearby.get(), nullptr);
+    EXPECT_EQ(prefetch_a.get(), nullptr);
+    EXPECT_EQ(prefetch_b.get(), nullptr);
+
+    gate.release();
+    EXPECT_NE(visible.get(), nullptr);
+    EXPECT_NE(blocker.get(), nullptr);
+}
+
+TEST(AssetLoaderPoolTest, ShutdownResolvesQueuedLoads) {
+    GatedLoader gate;
+    std::future<AssetLoaderPool::SpritePtr> queued;
+    std::future<AssetLoaderPool::SpritePtr> running;
+    {
+        AssetLoaderPool pool([&](const std::string& path) { return gate.load(path); }, 1);
+        running = pool.submit("running");
+        gate.waitForStarted(1);
+        queued = pool.submit("queued");
+        gate.release();
+    }
+
+    EXPECT_NE(running.get(), nullptr);
+    EXPECT_EQ(queued.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+}
@@ -1,12 +1,15 @@
 #include <gtest/gtest.h>
 #include "core/asset_manager.h"
 #include "performance/memory_monitor.h"
+#include "dc6_test_data.h"
 #include <memory>
 #include <fstream>
 #include <filesystem>
+#include <vector>
 
 using namespace d2portable::core;
 using namespace d2;
+using namespace d2::test;
 
 class AssetManagerMemoryTest : public ::testing::Test {
 protected:
@@ -43,4 +46,46 @@ TEST_F(AssetManagerMemoryTest, TrackClearCacheMemoryUsage) {
     
     // Memory usage should still be zero
     EXPECT_EQ(memoryMonitor->getCurrentMemoryUsage(), 0);
-}
\ No newline at end of file
+}
+
+TEST_F(AssetManagerMemoryTest, ReportsDecodedSpriteDirections) {
+    // 4 directions of two raw 32x32 frames each
+    const uint32_t directions = 4, frames = 2, size = 32;
+    std::vector<DC6TestFrame> dc6Frames;
+    for (uint32_t i = 0; i < directions * frames; i++) {
+        dc6Frames.push_back(rawDC6Frame(size, size, [i](uint32_t, uint32_t) { return i + 1; }));
+    }
+
+    auto test_dir = std::filesystem::temp_directory_path() / "asset_manager_residency_test";
+    std::filesystem::create_directories(test_dir);
+    writeDC6(test_dir / "hero.dc6", buildDC6(directions, dc6Frames));
+
+    ASSERT_TRUE(assetManager->initialize(test_dir.string()));
+    assetManager->setMemoryMonitor(memoryMonitor.get());
+    auto sprite = assetManager->loadSprite("hero.dc6");
+    ASSERT_NE(sprite, nullptr);
+
+    // Loading charges the file bytes; frames cost nothing until decoded
+    size_t loaded = memoryMonitor->getCurrentMemoryUsage();
+    EXPECT_EQ(loaded, assetManager->getCacheMemoryUsage());
+    EXPECT_EQ(assetManager->getSpriteResidentBytes(), 0u);
+
+    for (uint32_t d = 0; d < directions; d++) {
+        sprite->getFrameView(d, 0);
+        sprite->getFrameView(d, 1);
+    }
+    EXPECT_EQ(assetManager->getSpriteResidentBytes(), directions * frames * size * size);
+    EXPECT_EQ(memoryMonitor->getCurrentMemoryUsage(), loaded + directions * frames * size * size);
+
+    // A two-direction budget keeps the direction still on screen
+    sprite->getFrameView(1, 0);
+    sprite->getFrameView(1, 1);
+    assetManager->setSpriteResidencyBudget(2 * frames * size * size);
+    EXPECT_EQ(assetManager->getSpriteResidentDirectionCount(), 2u);
+    EXPECT_EQ(memoryMonitor->getCurrentMemoryUsage(), loaded + 2 * frames * size * size);
+
+    sprite.reset();
+    assetManager->clearCache();
+    EXPECT_EQ(memoryMonitor->getCurrentMemoryUsage(), 0u);
+    std::filesystem::remove_all(test_dir);
+}
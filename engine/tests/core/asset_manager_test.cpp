@@ -5,6 +5,8 @@
 #include <filesystem>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <vector>
 
 using namespace d2portable::core;
 using namespace testing;
@@ -243,4 +245,153 @@ TEST_F(AssetManagerTest, LoadNonExistentSprite) {
     
     EXPECT_TRUE(sprite == nullptr);
     EXPECT_FALSE(manager.getLastError().empty());
-}
\ No newline at end of file
+}
+
+// Test: Eviction removes the least recently used entry first
+TEST_F(AssetManagerTest, EvictsLeastRecentlyUsedEntry) {
+    for (const char* name : {"a.bin", "b.bin", "c.bin"}) {
+        std::ofstream file(excel_dir / name, std::ios::binary);
+        file << std::string(100, 'x');
+    }
+    
+    AssetManager manager;
+    ASSERT_TRUE(manager.initialize(test_dir.string()));
+    
+    ASSERT_EQ(manager.loadFileData("data/global/excel/a.bin").size(), 100);
+    ASSERT_EQ(manager.loadFileData("data/global/excel/b.bin").size(), 100);
+    ASSERT_EQ(manager.loadFileData("data/global/excel/c.bin").size(), 100);
+    EXPECT_EQ(manager.getCacheMemoryUsage(), 300);
+    
+    // Touch "a" so "b" becomes the least recently used entry
+    manager.loadFileData("data/global/excel/a.bin");
+    manager.setMaxCacheSize(200);
+    
+    EXPECT_EQ(manager.getCachedAssetCount(), 2);
+    EXPECT_EQ(manager.getCacheMemoryUsage(), 200);
+    EXPECT_EQ(manager.getAssetInfo("data/global/excel/a.bin").status, AssetStatus::LOADED);
+    EXPECT_EQ(manager.getAssetInfo("data/global/excel/b.bin").status, AssetStatus::NOT_LOADED);
+    EXPECT_EQ(manager.getAssetInfo("data/global/excel/c.bin").status, AssetStatus::LOADED);
+}
+
+// Test: Concurrent loads of the same sprite share one cache entry
+TEST_F(AssetManagerTest, ConcurrentSpriteLoadsShareCacheEntry) {
+    AssetManager manager;
+    ASSERT_TRUE(manager.initialize(test_dir.string()));
+    
+    // A single thread never waits on a shard lock
+    for (int j = 0; j < 10; j++) {
+        ASSERT_TRUE(manager.loadSprite("data/global/ui/panel/invchar6.dc6") != nullptr);
+    }
+    EXPECT_EQ(manager.getCacheLockContentionCount(), 0u);
+    
+    constexpr int kThreads = 8;
+    std::vector<std::shared_ptr<d2portable::sprites::DC6Sprite>> results(kThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; i++) {
+        threads.emplace_back([&manager, &results, i]() {
+            for (int j = 0; j < 100; j++) {
+                results[i] = manager.loadSprite("data/global/ui/panel/invchar6.dc6");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (const auto& sprite : results) {
+        ASSERT_TRUE(sprite != nullptr);
+        EXPECT_EQ(sprite.get(), results[0].get());
+    }
+    EXPECT_EQ(manager.getCachedAssetCount(), 1);
+    
+    // Contention is only ever counted up
+    uint64_t contentions = manager.getCacheLockContentionCount();
+    manager.loadSprite("data/global/ui/panel/invchar6.dc6");
+    EXPECT_GE(manager.getCacheLockContentionCount(), contentions);
+}
+
+// Test: Concurrent loads under a small cache limit return correct data and
+// keep the cache accounting consistent while entries are evicted
+TEST_F(AssetManagerTest, ConcurrentLoadsKeepCacheAccountingConsistent) {
+    constexpr int kFiles = 32;
+    for (int i = 0; i < kFiles; i++) {
+        std::ofstream file(excel_dir / ("file" + std::to_string(i) + ".bin"), std::ios::binary);
+        file << std::string(100 + i, static_cast<char>('a' + i % 26));
+    }
+    
+    AssetManager manager;
+    ASSERT_TRUE(manager.initialize(test_dir.string()));
+    manager.setMaxCacheSize(1000);
+    
+    constexpr int kThreads = 8;
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int j = 0; j < 200; j++) {
+                int i = (j * 7 + t * 5) % kFiles;
+                auto data = manager.loadFileData("data/global/excel/file" + std::to_string(i) + ".bin");
+                if (data.size() != static_cast<size_t>(100 + i) ||
+                    data.front() != static_cast<uint8_t>('a' + i % 26)) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_GT(manager.getCachedAssetCount(), 0u);
+    EXPECT_LE(manager.getCacheMemoryUsage(), 1000u);
+    
+    // The running total matches the entries actually left in the cache
+    size_t cached_bytes = 0;
+    size_t cached_count = 0;
+    for (int i = 0; i < kFiles; i++) {
+        auto info = manager.getAssetInfo("data/global/excel/file" + std::to_string(i) + ".bin");
+        if (info.status == AssetStatus::LOADED) {
+            cached_bytes += 100 + i;
+            cached_count++;
+        }
+    }
+    EXPECT_EQ(manager.getCacheMemoryUsage(), cached_bytes);
+    EXPECT_EQ(manager.getCachedAssetCount(), cached_count);
+    
+    // Contention is only ever counted up
+    uint64_t contentions = manager.getCacheLockContentionCount();
+    manager.loadFileData("data/global/excel/file0.bin");
+    EXPECT_GE(manager.getCacheLockContentionCount(), contentions);
+}
+
+// Test: Cancelling while another thread starts the async loader is safe
+TEST_F(AssetManagerTest, CancelWhileAsyncLoaderStarts) {
+    AssetManager manager;
+    ASSERT_TRUE(manager.initialize(test_dir.string()));
+    
+    std::thread canceller([&manager]() {
+        for (int i = 0; i < 200; i++) {
+            manager.cancelAsyncLoads(LoadPriority::PREFETCH);
+            manager.cancelAsyncLoad("data/global/ui/panel/invchar6.dc6");
+        }
+    });
+    auto future = manager.loadSpriteAsync("data/global/ui/panel/invchar6.dc6");
+    canceller.join();
+    
+    // A cancelled load yields nothing; one that ran yields the whole sprite
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    auto sprite = future.get();
+    if (sprite) {
+        EXPECT_EQ(sprite->getDirectionCount(), 1);
+        EXPECT_EQ(sprite->getFramesPerDirection(), 1);
+        EXPECT_EQ(sprite->getFrame(0, 0).pixelData.size(), 16u * 16u);
+    }
+    
+    // Cancelling leaves nothing behind that breaks a later load
+    auto reloaded = manager.loadSprite("data/global/ui/panel/invchar6.dc6");
+    ASSERT_TRUE(reloaded != nullptr);
+    EXPECT_EQ(reloaded->getDirectionCount(), 1);
+    EXPECT_EQ(reloaded->getFramesPerDirection(), 1);
+    EXPECT_EQ(reloaded->getFrame(0, 0).pixelData.size(), 16u * 16u);
+}
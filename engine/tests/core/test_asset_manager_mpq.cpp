@@ -136,4 +136,34 @@ TEST_F(AssetManagerMPQTest, FallbackToFilesystem) {
     EXPECT_FALSE(data.empty());
     std::string content(data.begin(), data.end());
     EXPECT_EQ(content, "Local content");
-}
\ No newline at end of file
+}
+
+// Test 7: Indexed lookups ignore path case and separator style
+TEST_F(AssetManagerMPQTest, IndexedLookupIsCaseAndSeparatorInsensitive) {
+    ASSERT_TRUE(asset_manager.initializeWithMPQs(test_mpq_dir));
+    
+    EXPECT_TRUE(asset_manager.hasFile("data/global/excel/armor.txt"));
+    EXPECT_TRUE(asset_manager.hasFile("DATA\\GLOBAL\\EXCEL\\ARMOR.TXT"));
+    EXPECT_FALSE(asset_manager.hasFile("data/global/excel/not_a_table.txt"));
+    
+    auto data = asset_manager.loadFileData("Data/Global/Excel/Armor.txt");
+    EXPECT_FALSE(data.empty());
+}
+
+TEST_F(AssetManagerMPQTest, LoadFileDataIntoReusedBuffer) {
+    ASSERT_TRUE(asset_manager.initializeWithMPQs(test_mpq_dir));
+    
+    auto expected = asset_manager.loadFileData("data\\global\\excel\\armor.txt");
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ(asset_manager.getFileSize("data/global/excel/armor.txt"), expected.size());
+    EXPECT_EQ(asset_manager.getFileSize("data/global/excel/not_a_table.txt"), 0);
+    
+    std::vector<uint8_t> buffer;
+    buffer.reserve(expected.size());
+    const uint8_t* allocation = buffer.data();
+    ASSERT_TRUE(asset_manager.loadFileData("data\\global\\excel\\armor.txt", buffer));
+    EXPECT_EQ(buffer, expected);
+    EXPECT_EQ(buffer.data(), allocation);
+    
+    EXPECT_FALSE(asset_manager.loadFileData("data\\global\\excel\\not_a_table.txt", buffer));
+}
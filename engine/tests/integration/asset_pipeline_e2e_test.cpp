@@ -163,8 +163,15 @@ protected:
     void createOptimizedSprite(const fs::path& path, int width, int height) {
         std::ofstream file(path, std::ios::binary);
         
-        // Simple PNG header
-        std::vector<uint8_t> header = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+        // PNG signature and IHDR chunk
+        std::vector<uint8_t> header = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A,
+                                       0x00, 0x00, 0x00, 0x0D, 'I', 'H', 'D', 'R'};
+        for (int value : {width, height}) {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                header.push_back(static_cast<uint8_t>(value >> shift));
+            }
+        }
+        header.insert(header.end(), {8, 6, 0, 0, 0, 0, 0, 0, 0});
         file.write(reinterpret_cast<const char*>(header.data()), header.size());
         
         // RGBA data
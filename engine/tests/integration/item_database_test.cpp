@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include <fstream>
+#include <filesystem>
 #include "game/item_database.h"
 #include "utils/data_table_parser.h"
 #include "core/asset_manager.h"
+#include "tools/asset_extractor.h"
 
 class ItemDatabaseTest : public ::testing::Test {
 protected:
@@ -15,6 +17,10 @@ protected:
         itemDb_ = std::make_unique<d2::game::ItemDatabase>();
     }
     
+    void TearDown() override {
+        std::filesystem::remove_all("test_assets/data/excel");
+    }
+    
     std::shared_ptr<d2portable::core::AssetManager> assetManager_;
     std::unique_ptr<d2::utils::DataTableParser> parser_;
     std::unique_ptr<d2::game::ItemDatabase> itemDb_;
@@ -100,4 +106,44 @@ TEST_F(ItemDatabaseTest, CachesLoadedData) {
     // Should still have the original value (cached)
     auto item = itemDb_->getItem("Test Armor");
     EXPECT_EQ(item.getDefense(), 10);
-}
\ No newline at end of file
+}
+
+TEST_F(ItemDatabaseTest, SkipsRowsWithoutName) {
+    std::string armorData = "name\ttype\tac\nCap\thelm\t3\n\thelm\t5\nSkull Cap\thelm\t8";
+    std::ofstream file("test_assets/data/armor.txt");
+    file << armorData;
+    file.close();
+    
+    itemDb_->loadFromAssetManager(assetManager_, parser_.get());
+    
+    EXPECT_TRUE(itemDb_->hasItem("Cap"));
+    EXPECT_TRUE(itemDb_->hasItem("Skull Cap"));
+    EXPECT_FALSE(itemDb_->hasItem(""));
+    EXPECT_EQ(itemDb_->getItem("Skull Cap").getDefense(), 8);
+}
+
+TEST_F(ItemDatabaseTest, LoadsCompiledTablesFromExtractedLayout) {
+    // Tables extracted from the archives live in data/excel
+    std::string armorData = "name\ttype\tac\nBone Helm\thelm\t33\n";
+    std::filesystem::create_directories("test_assets/data/excel");
+    std::ofstream file("test_assets/data/excel/armor.txt", std::ios::binary);
+    file << armorData;
+    file.close();
+    
+    d2::AssetExtractor extractor;
+    ASSERT_TRUE(extractor.compileDataTables("test_assets"));
+    ASSERT_EQ(extractor.getCompiledDataTableCount(), 1u);
+    std::string binaryPath = d2::utils::DataTableParser::getBinaryPath("test_assets/data/excel/armor.txt");
+    ASSERT_TRUE(std::filesystem::exists(binaryPath));
+    
+    // Rewrite the compiled copy with another value under the same source
+    // hash, so the value read back shows which copy was loaded
+    auto compiled = parser_->parseExcel("name\ttype\tac\nBone Helm\thelm\t44\n");
+    uint64_t sourceHash = d2::utils::DataTableParser::hashSource(armorData.data(), armorData.size());
+    ASSERT_TRUE(parser_->writeBinary(compiled, sourceHash, binaryPath));
+    
+    itemDb_->loadFromAssetManager(assetManager_, parser_.get());
+    
+    ASSERT_TRUE(itemDb_->hasItem("Bone Helm"));
+    EXPECT_EQ(itemDb_->getItem("Bone Helm").getDefense(), 44);
+}
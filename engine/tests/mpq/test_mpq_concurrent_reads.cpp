@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "utils/stormlib_mpq_loader.h"
+#include "utils/mock_mpq_builder.h"
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace d2portable::utils;
+
+// Many threads extracting from one loader must see exactly the bytes a
+// single-threaded reader sees
+class MPQConcurrentReadTest : public ::testing::TestWithParam<MPQAccessMode> {
+protected:
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "d2portable_mpq_concurrent_test";
+        std::filesystem::create_directories(test_dir);
+        mpq_path = (test_dir / "concurrent.mpq").string();
+        
+        const MockMPQBuilder::CompressionType compressions[] = {
+            MockMPQBuilder::CompressionType::NONE,
+            MockMPQBuilder::CompressionType::ZLIB,
+            MockMPQBuilder::CompressionType::PKWARE,
+            MockMPQBuilder::CompressionType::BZIP2
+        };
+        
+        MockMPQBuilder builder;
+        for (int i = 0; i < 24; i++) {
+            // Sizes from a few bytes up to several sectors
+            std::vector<uint8_t> data(37 + i * 2909);
+            for (size_t j = 0; j < data.size(); j++) {
+                data[j] = static_cast<uint8_t>((j * (i + 3)) ^ (j >> 7) ^ i);
+            }
+            std::string name = "data\\global\\file" + std::to_string(i) + ".bin";
+            builder.addFileWithCompression(name, data, compressions[i % 4]);
+            expected[name] = std::move(data);
+        }
+        ASSERT_TRUE(builder.build(mpq_path));
+    }
+    
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+    
+    std::filesystem::path test_dir;
+    std::string mpq_path;
+    std::map<std::string, std::vector<uint8_t>> expected;
+};
+
+TEST_P(MPQConcurrentReadTest, EightThreadsExtractIdenticalBytes) {
+    StormLibMPQLoader loader;
+    ASSERT_TRUE(loader.open(mpq_path, GetParam()));
+    
+    std::vector<std::string> names;
+    for (const auto& pair : expected) {
+        names.push_back(pair.first);
+    }
+    
+    constexpr int kThreads = 8;
+    constexpr int kRounds = 20;
+    std::atomic<int> mismatches{0};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t]() {
+            std::vector<uint8_t> data;
+            for (int round = 0; round < kRounds; round++) {
+                // Each thread walks the list from a different starting point
+                for (size_t k = 0; k < names.size(); k++) {
+                    const std::string& name = names[(k + t * 3) % names.size()];
+                    if (!loader.extractFile(name, data)) {
+                        failures++;
+                    } else if (data != expected.at(name)) {
+                        mismatches++;
+                    }
+                    if (!loader.hasFile(name)) {
+                        failures++;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    EXPECT_EQ(failures.load(), 0) << loader.getLastError();
+    EXPECT_EQ(mismatches.load(), 0);
+    
+    // The loader keeps working single-threaded afterwards
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(loader.extractFile(names.front(), data));
+    EXPECT_EQ(data, expected.at(names.front()));
+}
+
+TEST_P(MPQConcurrentReadTest, CloseAndReopenAfterConcurrentReads) {
+    StormLibMPQLoader loader;
+    ASSERT_TRUE(loader.open(mpq_path, GetParam()));
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            std::vector<uint8_t> data;
+            loader.extractFile("data\\global\\file5.bin", data);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    loader.close();
+    EXPECT_FALSE(loader.isOpen());
+    std::vector<uint8_t> data;
+    EXPECT_FALSE(loader.extractFile("data\\global\\file5.bin", data));
+    
+    ASSERT_TRUE(loader.open(mpq_path, GetParam()));
+    ASSERT_TRUE(loader.extractFile("data\\global\\file5.bin", data));
+    EXPECT_EQ(data, expected.at("data\\global\\file5.bin"));
+}
+
+INSTANTIATE_TEST_SUITE_P(AccessModes, MPQConcurrentReadTest,
+                         ::testing::Values(MPQAccessMode::BUFFERED, MPQAccessMode::MEMORY_MAPPED));
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "utils/stormlib_mpq_loader.h"
+#include "utils/mock_mpq_builder.h"
+#include <filesystem>
+#include <cstring>
+#include <vector>
+
+using namespace d2portable::utils;
+
+// Memory-mapped reads must return exactly what StormLib's buffered path does
+class MPQMemoryMappedTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "d2portable_mpq_mmap_test";
+        std::filesystem::create_directories(test_dir);
+        mpq_path = (test_dir / "mapped.mpq").string();
+        
+        // Multi-sector payload (default sector size is 4 KB) that compresses well
+        large_data.resize(64 * 1024 + 123);
+        for (size_t i = 0; i < large_data.size(); i++) {
+            large_data[i] = static_cast<uint8_t>((i * 7) ^ (i >> 5));
+        }
+        small_data = {'D', '2', 'P', 'O', 'R', 'T', 'A', 'B', 'L', 'E'};
+        
+        MockMPQBuilder builder;
+        builder.addFileWithCompression("data\\stored.bin", large_data, MockMPQBuilder::CompressionType::NONE);
+        builder.addFileWithCompression("data\\zlib.bin", large_data, MockMPQBuilder::CompressionType::ZLIB);
+        builder.addFileWithCompression("data\\pkware.bin", large_data, MockMPQBuilder::CompressionType::PKWARE);
+        builder.addFileWithCompression("data\\bzip2.bin", large_data, MockMPQBuilder::CompressionType::BZIP2);
+        builder.addFileWithCompression("data\\small.txt", small_data, MockMPQBuilder::CompressionType::ZLIB);
+        ASSERT_TRUE(builder.build(mpq_path));
+    }
+    
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+    
+    std::filesystem::path test_dir;
+    std::string mpq_path;
+    std::vector<uint8_t> large_data;
+    std::vector<uint8_t> small_data;
+};
+
+TEST_F(MPQMemoryMappedTest, OpensArchiveMapped) {
+    StormLibMPQLoader loader;
+    ASSERT_TRUE(loader.open(mpq_path, MPQAccessMode::MEMORY_MAPPED));
+    EXPECT_TRUE(loader.isMemoryMapped());
+    
+    loader.close();
+    EXPECT_FALSE(loader.isMemoryMapped());
+    
+    ASSERT_TRUE(loader.open(mpq_path));
+    EXPECT_FALSE(loader.isMemoryMapped());
+}
+
+TEST_F(MPQMemoryMappedTest, MappedReadsMatchBufferedReads) {
+    StormLibMPQLoader buffered;
+    StormLibMPQLoader mapped;
+    ASSERT_TRUE(buffered.open(mpq_path));
+    ASSERT_TRUE(mapped.open(mpq_path, MPQAccessMode::MEMORY_MAPPED));
+    
+    for (const char* name : {"data\\stored.bin", "data\\zlib.bin", "data\\pkware.bin",
+                             "data\\bzip2.bin", "data\\small.txt"}) {
+        std::vector<uint8_t> expected;
+        std::vector<uint8_t> actual;
+        ASSERT_TRUE(buffered.extractFile(name, expected)) << name;
+        ASSERT_TRUE(mapped.extractFile(name, actual)) << name;
+        EXPECT_EQ(actual, expected) << name;
+    }
+    
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(mapped.extractFile("data\\zlib.bin", data));
+    EXPECT_EQ(data, large_data);
+}
+
+TEST_F(MPQMemoryMappedTest, StoredFilesAreZeroCopyViews) {
+    StormLibMPQLoader loader;
+    ASSERT_TRUE(loader.open(mpq_path, MPQAccessMode::MEMORY_MAPPED));
+    
+    MPQFileView view;
+    ASSERT_TRUE(loader.getFileView("data\\stored.bin", view));
+    ASSERT_EQ(view.size, large_data.size());
+    EXPECT_EQ(std::memcmp(view.data, large_data.data(), view.size), 0);
+    
+    // Compressed files have no raw view
+    EXPECT_FALSE(loader.getFileView("data\\zlib.bin", view));
+    EXPECT_FALSE(loader.getFileView("data\\missing.bin", view));
+}
+
+TEST_F(MPQMemoryMappedTest, BufferedArchiveHasNoViews) {
+    StormLibMPQLoader loader;
+    ASSERT_TRUE(loader.open(mpq_path));
+    
+    MPQFileView view;
+    EXPECT_FALSE(loader.getFileView("data\\stored.bin", view));
+}
+
+TEST_F(MPQMemoryMappedTest, ExtractsIntoCallerBuffer) {
+    for (MPQAccessMode mode : {MPQAccessMode::BUFFERED, MPQAccessMode::MEMORY_MAPPED}) {
+        StormLibMPQLoader loader;
+        ASSERT_TRUE(loader.open(mpq_path, mode));
+        
+        // A zero-capacity call is a size query
+        size_t required = 0;
+        EXPECT_FALSE(loader.extractFile("data\\zlib.bin", nullptr, 0, required));
+        EXPECT_EQ(required, large_data.size());
+        EXPECT_NE(loader.getLastError().find("Buffer too small"), std::string::npos);
+        
+        std::vector<uint8_t> buffer(required + 16, 0xCD);
+        for (const char* name : {"data\\stored.bin", "data\\zlib.bin", "data\\pkware.bin", "data\\bzip2.bin"}) {
+            size_t written = 0;
+            ASSERT_TRUE(loader.extractFile(name, buffer.data(), buffer.size(), written)) << name;
+            ASSERT_EQ(written, large_data.size()) << name;
+            EXPECT_EQ(std::memcmp(buffer.data(), large_data.data(), written), 0) << name;
+            // Bytes past the file are left alone
+            EXPECT_EQ(buffer[written], 0xCD) << name;
+        }
+    }
+}
+
+TEST_F(MPQMemoryMappedTest, ReusedVectorKeepsItsAllocation) {
+    StormLibMPQLoader loader;
+    ASSERT_TRUE(loader.open(mpq_path, MPQAccessMode::MEMORY_MAPPED));
+    
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(loader.extractFile("data\\zlib.bin", data));
+    const uint8_t* allocation = data.data();
+    
+    ASSERT_TRUE(loader.extractFile("data\\small.txt", data));
+    EXPECT_EQ(data, small_data);
+    ASSERT_TRUE(loader.extractFile("data\\bzip2.bin", data));
+    EXPECT_EQ(data, large_data);
+    EXPECT_EQ(data.data(), allocation);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "rendering/texture_manager.h"
+#include "rendering/shader_manager.h"
+#include "rendering/sprite_renderer.h"
+#include "rendering/renderer.h"
+#include "rendering/egl_context.h"
+#include "rendering/render_context.h"
+#include "rendering/mock_render_backend.h"
+#include "dc6_test_data.h"
+#include "sprites/dc6_parser.h"
+
+namespace d2::rendering {
+
+namespace {
+
+// Single-frame DC6 with uncompressed palette indices
+std::shared_ptr<sprites::DC6Sprite> indexedSprite(uint32_t width, uint32_t height) {
+    auto frame = d2::test::rawDC6Frame(width, height, [&](uint32_t x, uint32_t y) { return y * width + x; });
+
+    d2portable::sprites::DC6Parser parser;
+    return parser.parseData(d2::test::buildDC6(1, {frame}));
+}
+
+} // namespace
+
+class PalettedTextureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        backend = dynamic_cast<MockRenderBackend*>(RenderContext::getBackend());
+        ASSERT_NE(backend, nullptr);
+        backend->resetTextureUploadTracking();
+
+        palette.resize(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            palette[i] = 0xFF000000u | (i << 16) | (i << 8) | i;
+        }
+    }
+
+    MockRenderBackend* backend = nullptr;
+    std::vector<uint32_t> palette;
+};
+
+TEST_F(PalettedTextureTest, IndexedUploadUsesOneBytePerPixel) {
+    auto sprite = indexedSprite(61, 40);
+    ASSERT_NE(sprite, nullptr);
+    TextureManager manager;
+
+    uint32_t indexed_id = manager.uploadSpriteIndexed(sprite, 0, 0);
+    ASSERT_NE(indexed_id, 0u);
+    EXPECT_EQ(manager.getTextureFormat(indexed_id), TextureFormat::INDEXED);
+    EXPECT_EQ(manager.getTextureWidth(indexed_id), 61u);
+    ASSERT_EQ(backend->getTexImage2DCalls().size(), 1u);
+    const TexImage2DCall& call = backend->getTexImage2DCalls()[0];
+    EXPECT_EQ(call.internalformat, static_cast<int>(GL_R8_VALUE));
+    EXPECT_EQ(call.format, GL_RED_VALUE);
+    EXPECT_EQ(backend->getTextureBytesUploaded(), 61u * 40u);
+
+    // Odd-width rows are uploaded unpadded, and the default is restored afterwards
+    EXPECT_EQ(backend->getUnpackAlignment(), 4);
+
+    // The CPU-expanded path uploads four times as much
+    backend->resetTextureUploadTracking();
+    EXPECT_NE(manager.uploadSpriteWithPalette(sprite, 0, 0, palette), 0u);
+    EXPECT_EQ(backend->getTextureBytesUploaded(), 61u * 40u * 4u);
+}
+
+TEST_F(PalettedTextureTest, PaletteSwapUploadsOnlyThePalette) {
+    auto sprite = indexedSprite(32, 32);
+    ASSERT_NE(sprite, nullptr);
+    TextureManager manager;
+
+    uint32_t indexed_id = manager.uploadSpriteIndexed(sprite, 0, 0);
+    uint32_t palette_id = manager.createPaletteTexture(palette);
+    ASSERT_NE(indexed_id, 0u);
+    ASSERT_NE(palette_id, 0u);
+    EXPECT_EQ(manager.getTextureFormat(palette_id), TextureFormat::PALETTE);
+    EXPECT_EQ(manager.getTextureWidth(palette_id), 256u);
+    EXPECT_EQ(manager.getTextureHeight(palette_id), 1u);
+
+    // A palette shift re-uploads 256 colors, not the frame
+    backend->resetTextureUploadTracking();
+    std::vector<uint32_t> shifted(palette.rbegin(), palette.rend());
+    EXPECT_TRUE(manager.updatePaletteTexture(palette_id, shifted));
+    EXPECT_EQ(backend->getTextureBytesUploaded(), 256u * 4u);
+    EXPECT_TRUE(manager.isTextureValid(indexed_id));
+
+    EXPECT_EQ(manager.createPaletteTexture(std::vector<uint32_t>(16, 0)), 0u);
+    EXPECT_FALSE(manager.updatePaletteTexture(indexed_id, palette));
+}
+
+TEST_F(PalettedTextureTest, ShaderManagerBuildsPalettedVariant) {
+    ShaderManager shader_manager;
+
+    uint32_t rgba_program = shader_manager.getSpriteProgram(SpriteShaderVariant::RGBA);
+    uint32_t paletted_program = shader_manager.getSpriteProgram(SpriteShaderVariant::PALETTED);
+    ASSERT_NE(rgba_program, 0u);
+    ASSERT_NE(paletted_program, 0u);
+    EXPECT_NE(rgba_program, paletted_program);
+    EXPECT_EQ(shader_manager.getSpriteProgram(SpriteShaderVariant::PALETTED), paletted_program);
+
+    std::string source = ShaderManager::getSpriteFragmentShaderSource(SpriteShaderVariant::PALETTED);
+    EXPECT_NE(source.find("u_palette"), std::string::npos);
+    EXPECT_GE(shader_manager.getUniformLocation(paletted_program, "u_palette"), 0);
+    EXPECT_TRUE(shader_manager.setUniform4f(paletted_program, "u_tint", 1.0f, 0.5f, 0.5f, 1.0f));
+}
+
+TEST_F(PalettedTextureTest, SpriteRendererBindsPaletteAndIndices) {
+    EGLContext context;
+    context.initialize();
+    Renderer renderer;
+    renderer.initialize(context);
+    TextureManager manager;
+    SpriteRenderer sprite_renderer;
+    ASSERT_TRUE(sprite_renderer.initialize(renderer, manager));
+    EXPECT_NE(sprite_renderer.getPalettedShaderProgram(), 0u);
+
+    backend->resetDrawCommandTracking();
+    sprite_renderer.beginFrame();
+    sprite_renderer.setPaletteTint(1.0f, 0.0f, 0.0f, 1.0f);
+    sprite_renderer.drawPalettedSprite(7, 9, glm::vec2(0.0f, 0.0f), glm::vec2(32.0f, 32.0f));
+    sprite_renderer.drawPalettedSprite(7, 9, glm::vec2(40.0f, 0.0f), glm::vec2(32.0f, 32.0f));
+    sprite_renderer.endFrame();
+
+    EXPECT_EQ(sprite_renderer.getDrawCallCount(), 1u);
+    EXPECT_EQ(sprite_renderer.getSpriteCount(), 2u);
+    EXPECT_EQ(backend->getBoundTexture(GL_TEXTURE0_VALUE + ShaderManager::PALETTE_TEXTURE_UNIT), 9u);
+    EXPECT_EQ(backend->getBoundTexture(GL_TEXTURE0_VALUE + ShaderManager::SPRITE_TEXTURE_UNIT), 7u);
+}
+
+} // namespace d2::rendering
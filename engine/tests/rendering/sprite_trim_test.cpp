@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "rendering/texture_manager.h"
+#include "rendering/sprite_renderer.h"
+#include "rendering/renderer.h"
+#include "rendering/egl_context.h"
+#include "rendering/render_context.h"
+#include "rendering/mock_render_backend.h"
+#include "dc6_test_data.h"
+#include "rendering/vertex_buffer.h"
+#include "sprites/dc6_parser.h"
+#include <cstring>
+
+namespace d2::rendering {
+
+namespace {
+
+// Single-frame DC6 with uncompressed indices: a 10x6 block of color
+// inside a 64x48 frame, 20 pixels from the left and 30 from the top
+std::shared_ptr<sprites::DC6Sprite> paddedSprite() {
+    const uint32_t width = 64;
+    const uint32_t height = 48;
+    auto frame = d2::test::rawDC6Frame(width, height, [](uint32_t x, uint32_t y) {
+        bool visible = x >= 20 && x < 30 && y >= 30 && y < 36;
+        return visible ? 200 : 0;
+    });
+
+    d2portable::sprites::DC6Parser parser;
+    return parser.parseData(d2::test::buildDC6(1, {frame}));
+}
+
+} // namespace
+
+class SpriteTrimTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        backend = dynamic_cast<MockRenderBackend*>(RenderContext::getBackend());
+        ASSERT_NE(backend, nullptr);
+        backend->resetTextureUploadTracking();
+        sprite = paddedSprite();
+        ASSERT_NE(sprite, nullptr);
+    }
+
+    MockRenderBackend* backend = nullptr;
+    std::shared_ptr<sprites::DC6Sprite> sprite;
+};
+
+TEST_F(SpriteTrimTest, UploadKeepsOnlyVisibleBounds) {
+    TextureManager manager;
+    EXPECT_TRUE(manager.isBorderTrimmingEnabled());
+
+    uint32_t texture_id = manager.uploadSprite(sprite, 0, 0);
+    ASSERT_NE(texture_id, 0u);
+    EXPECT_EQ(manager.getTextureWidth(texture_id), 10u);
+    EXPECT_EQ(manager.getTextureHeight(texture_id), 6u);
+    EXPECT_EQ(backend->getTextureBytesUploaded(), 10u * 6u * 4u);
+
+    TextureTrim trim = manager.getTextureTrim(texture_id);
+    EXPECT_EQ(trim.x, 20u);
+    EXPECT_EQ(trim.y, 30u);
+    EXPECT_EQ(trim.source_width, 64u);
+    EXPECT_EQ(trim.source_height, 48u);
+
+    // Indexed uploads are trimmed the same way
+    backend->resetTextureUploadTracking();
+    uint32_t indexed_id = manager.uploadSpriteIndexed(sprite, 0, 0);
+    ASSERT_NE(indexed_id, 0u);
+    EXPECT_EQ(backend->getTextureBytesUploaded(), 10u * 6u);
+    EXPECT_EQ(manager.getTextureTrim(indexed_id).x, 20u);
+}
+
+TEST_F(SpriteTrimTest, TrimmingCanBeDisabled) {
+    TextureManager manager;
+    manager.setBorderTrimming(false);
+
+    uint32_t texture_id = manager.uploadSprite(sprite, 0, 0);
+    ASSERT_NE(texture_id, 0u);
+    EXPECT_EQ(manager.getTextureWidth(texture_id), 64u);
+    EXPECT_EQ(backend->getTextureBytesUploaded(), 64u * 48u * 4u);
+
+    // Untrimmed textures report themselves as their whole source
+    TextureTrim trim = manager.getTextureTrim(texture_id);
+    EXPECT_EQ(trim.x, 0u);
+    EXPECT_EQ(trim.source_width, 64u);
+    EXPECT_EQ(trim.source_height, 48u);
+}
+
+TEST_F(SpriteTrimTest, SpriteRendererDrawsTrimmedQuad) {
+    EGLContext context;
+    context.initialize();
+    Renderer renderer;
+    renderer.initialize(context);
+    TextureManager manager;
+    SpriteRenderer sprite_renderer;
+    ASSERT_TRUE(sprite_renderer.initialize(renderer, manager));
+
+    uint32_t texture_id = manager.uploadSprite(sprite, 0, 0);
+    ASSERT_NE(texture_id, 0u);
+
+    // The caller still positions the whole frame, here at twice its size
+    sprite_renderer.beginFrame();
+    sprite_renderer.drawSprite(texture_id, glm::vec2(100.0f, 50.0f), glm::vec2(128.0f, 96.0f));
+    sprite_renderer.endFrame();
+
+    const std::vector<uint8_t>& bytes = backend->getLastBufferSubData();
+    ASSERT_EQ(bytes.size(), 6u * sizeof(SpriteVertex));
+    std::vector<SpriteVertex> vertices(6);
+    std::memcpy(vertices.data(), bytes.data(), bytes.size());
+
+    // v0 is the top-left corner and v3 (the fifth vertex) the bottom-right
+    EXPECT_FLOAT_EQ(vertices[0].position.x, 140.0f);
+    EXPECT_FLOAT_EQ(vertices[0].position.y, 110.0f);
+    EXPECT_FLOAT_EQ(vertices[4].position.x, 160.0f);
+    EXPECT_FLOAT_EQ(vertices[4].position.y, 122.0f);
+}
+
+} // namespace d2::rendering
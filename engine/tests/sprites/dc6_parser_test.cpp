@@ -1,12 +1,103 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "sprites/dc6_parser.h"
+#include "dc6_test_data.h"
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
 
 using namespace d2portable::sprites;
+using d2::test::DC6TestFrame;
+using d2::test::rawDC6Frame;
 using namespace testing;
 
+namespace {
+
+// In-memory DC6 with uncompressed frames whose pixels encode their index
+std::vector<uint8_t> buildDC6(uint32_t directions, uint32_t frames, uint32_t width, uint32_t height) {
+    std::vector<DC6TestFrame> dc6_frames;
+    for (uint32_t i = 0; i < directions * frames; i++) {
+        dc6_frames.push_back(rawDC6Frame(width, height, [&](uint32_t x, uint32_t y) {
+            uint32_t p = y * width + x;
+            return i * 7 + p;
+        }));
+        dc6_frames.back().offsetX = static_cast<int32_t>(i);
+    }
+    return d2::test::buildDC6(directions, dc6_frames);
+}
+
+// In-memory DC6 whose frames hold already encoded pixel data
+std::vector<uint8_t> buildEncodedDC6(uint32_t flags, uint32_t directions, uint32_t width, uint32_t height,
+                                     const std::vector<std::vector<uint8_t>>& encoded_frames,
+                                     uint32_t flip = 0) {
+    std::vector<DC6TestFrame> dc6_frames;
+    for (const auto& encoded : encoded_frames) {
+        DC6TestFrame frame;
+        frame.width = width;
+        frame.height = height;
+        frame.offsetX = static_cast<int32_t>(dc6_frames.size());
+        frame.flip = flip;
+        frame.data = encoded;
+        frame.terminator = true;
+        dc6_frames.push_back(std::move(frame));
+    }
+    return d2::test::buildDC6(directions, dc6_frames, flags);
+}
+
+// Game-style row encoding of a frame, bottom row first
+std::vector<uint8_t> encodeRows(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height) {
+    std::vector<uint8_t> encoded;
+    for (uint32_t row = height; row-- > 0;) {
+        const uint8_t* line = pixels.data() + static_cast<size_t>(row) * width;
+        uint32_t end = width;
+        while (end > 0 && line[end - 1] == 0) {
+            end--;  // Trailing transparency is implied by the end of the row
+        }
+        
+        uint32_t x = 0;
+        while (x < end) {
+            bool transparent = line[x] == 0;
+            uint32_t run = 0;
+            while (x + run < end && run < 0x7F && (line[x + run] == 0) == transparent) {
+                run++;
+            }
+            if (transparent) {
+                encoded.push_back(static_cast<uint8_t>(0x80 | run));
+            } else {
+                encoded.push_back(static_cast<uint8_t>(run));
+                encoded.insert(encoded.end(), line + x, line + x + run);
+            }
+            x += run;
+        }
+        encoded.push_back(0x80);
+    }
+    return encoded;
+}
+
+// Sprite-like frame: an opaque ellipse with a few holes on a transparent background
+std::vector<uint8_t> spriteImage(uint32_t width, uint32_t height, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height, 0);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            double dx = (x + 0.5) / width - 0.5;
+            double dy = (y + 0.5) / height - 0.5;
+            if (dx * dx + dy * dy < 0.2 && rng() % 16 != 0) {
+                pixels[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>(1 + rng() % 255);
+            }
+        }
+    }
+    return pixels;
+}
+
+} // namespace
+
 class DC6ParserTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -182,6 +273,163 @@ TEST_F(DC6ParserTest, GetFrameDimensions) {
     EXPECT_EQ(frame.offsetY, -16);
 }
 
+// Test: Frame views expose the sprite's pixels without copying them
+TEST_F(DC6ParserTest, GetFrameView) {
+    DC6Parser parser;
+    auto sprite = parser.parseFile(test_dc6_path.string());
+    
+    ASSERT_TRUE(sprite != nullptr);
+    
+    auto view = sprite->getFrameView(0, 0);
+    auto frame = sprite->getFrame(0, 0);
+    EXPECT_EQ(view.width, 32);
+    EXPECT_EQ(view.height, 32);
+    EXPECT_EQ(view.offsetX, -16);
+    EXPECT_EQ(view.offsetY, -16);
+    ASSERT_EQ(view.pixelCount, frame.pixelData.size());
+    EXPECT_TRUE(std::equal(view.pixels, view.pixels + view.pixelCount, frame.pixelData.begin()));
+    
+    // Every view of a frame points at the same storage
+    EXPECT_EQ(sprite->getFrameView(0, 0).pixels, view.pixels);
+    
+    EXPECT_TRUE(sprite->getFrameView(1, 0).empty());
+    EXPECT_TRUE(sprite->getFrameView(0, 1).empty());
+}
+
+// Test: Frames decode on first use and are evicted beyond the cache budget
+TEST_F(DC6ParserTest, DecodesFramesLazily) {
+    DC6Parser parser;
+    EXPECT_EQ(parser.getFrameCacheBudget(), kDefaultFrameCacheBudget);
+    
+    // Room for two decoded 16x16 frames
+    parser.setFrameCacheBudget(2 * 16 * 16);
+    auto sprite = parser.parseData(buildDC6(16, 4, 16, 16));
+    ASSERT_TRUE(sprite != nullptr);
+    EXPECT_EQ(sprite->getDirectionCount(), 16);
+    
+    auto first = sprite->getFrameView(3, 1);
+    ASSERT_EQ(first.pixelCount, 16 * 16);
+    EXPECT_EQ(first.offsetX, 13);
+    EXPECT_EQ(first.pixels[5], static_cast<uint8_t>(13 * 7 + 5));
+    
+    // Cached while it is among the two most recently used frames
+    sprite->getFrameView(0, 0);
+    EXPECT_EQ(sprite->getFrameView(3, 1).pixels, first.pixels);
+    
+    // Evicted once two other frames were used since
+    sprite->getFrameView(0, 1);
+    sprite->getFrameView(0, 2);
+    auto again = sprite->getFrameView(3, 1);
+    EXPECT_NE(again.pixels, first.pixels);
+    
+    // The evicted frame stays valid through the view that holds it
+    EXPECT_TRUE(std::equal(first.pixels, first.pixels + first.pixelCount, again.pixels));
+    EXPECT_EQ(sprite->getFrame(15, 3).offsetX, 63);
+}
+
+// Test: Concurrent readers share one sprite while its cache evicts
+TEST_F(DC6ParserTest, ConcurrentLazyDecoding) {
+    DC6Parser parser;
+    parser.setFrameCacheBudget(3 * 8 * 8);
+    std::shared_ptr<DC6Sprite> sprite = parser.parseData(buildDC6(8, 8, 8, 8));
+    ASSERT_TRUE(sprite != nullptr);
+    
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (uint32_t round = 0; round < 50; round++) {
+                uint32_t index = (round * 5 + t * 11) % 64;
+                auto view = sprite->getFrameView(index / 8, index % 8);
+                if (view.pixelCount != 64 || view.pixels[9] != static_cast<uint8_t>(index * 7 + 9)) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+// Test: Expand a frame into a caller-provided buffer
+TEST_F(DC6ParserTest, ExpandFrameIntoBuffer) {
+    DC6Parser parser;
+    auto sprite = parser.parseData(buildDC6(1, 2, 8, 4));
+    ASSERT_TRUE(sprite != nullptr);
+    auto palette = parser.getDefaultPalette();
+    
+    std::vector<uint8_t> rgba(8 * 4 * 4);
+    EXPECT_EQ(sprite->expandFrame(0, 1, palette.data(), rgba.data(), rgba.size()), 32);
+    EXPECT_EQ(rgba, sprite->getFrameImageWithPalette(0, 1, palette));
+    
+    // Nothing is written when the frame does not fit
+    EXPECT_EQ(sprite->expandFrame(0, 1, palette.data(), rgba.data(), rgba.size() - 1), 0);
+    EXPECT_EQ(sprite->expandFrame(1, 0, palette.data(), rgba.data(), rgba.size()), 0);
+}
+
+// Test: Frames whose data lies outside the file are empty
+TEST_F(DC6ParserTest, TruncatedFramesAreEmpty) {
+    auto data = buildDC6(1, 2, 8, 8);
+    data.resize(data.size() - 10);
+    
+    DC6Parser parser;
+    auto sprite = parser.parseData(data);
+    ASSERT_TRUE(sprite != nullptr);
+    EXPECT_EQ(sprite->getFrameView(0, 0).pixelCount, 64);
+    EXPECT_TRUE(sprite->getFrameView(0, 1).empty());
+    EXPECT_TRUE(sprite->getFrameImage(0, 1).empty());
+}
+
+TEST_F(DC6ParserTest, DecodesRowEncodedFrames) {
+    // Rows are stored bottom-up: a skip and two pixels, an empty row, four pixels
+    std::vector<uint8_t> encoded = {0x81, 2, 7, 8, 0x80, 0x80, 4, 1, 2, 3, 4, 0x80};
+    std::vector<uint8_t> expected = {1, 2, 3, 4, 0, 0, 0, 0, 0, 0, 0, 7, 8, 0, 0};
+    
+    DC6Parser parser;
+    auto sprite = parser.parseData(buildEncodedDC6(1, 1, 5, 3, {encoded}));
+    ASSERT_TRUE(sprite != nullptr);
+    auto view = sprite->getFrameView(0, 0);
+    ASSERT_EQ(view.pixelCount, expected.size());
+    EXPECT_EQ(std::vector<uint8_t>(view.pixels, view.pixels + view.pixelCount), expected);
+    
+    // Flipped frames store their rows top-down
+    std::vector<uint8_t> flipped = {0, 7, 8, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 0};
+    sprite = parser.parseData(buildEncodedDC6(1, 1, 5, 3, {encoded}, 1));
+    ASSERT_TRUE(sprite != nullptr);
+    EXPECT_EQ(sprite->getFrame(0, 0).pixelData, flipped);
+}
+
+TEST_F(DC6ParserTest, ClipsMalformedRows) {
+    // A row longer than the frame and a literal run cut off by the end of the data
+    std::vector<uint8_t> encoded = {0x82, 5, 1, 2, 3, 4, 5, 0x80, 0x7F, 9, 9};
+    std::vector<uint8_t> expected = {0, 0, 0, 0, 9, 9, 0, 0, 0, 0, 1, 2};
+    
+    DC6Parser parser;
+    auto sprite = parser.parseData(buildEncodedDC6(1, 1, 4, 3, {encoded}));
+    ASSERT_TRUE(sprite != nullptr);
+    EXPECT_EQ(sprite->getFrame(0, 0).pixelData, expected);
+}
+
+TEST_F(DC6ParserTest, RowEncodingRoundTrips) {
+    const uint32_t width = 37;
+    const uint32_t height = 29;
+    std::vector<std::vector<uint8_t>> images;
+    std::vector<std::vector<uint8_t>> encoded;
+    for (uint32_t i = 0; i < 8; i++) {
+        images.push_back(spriteImage(width, height, i));
+        encoded.push_back(encodeRows(images.back(), width, height));
+    }
+    
+    DC6Parser parser;
+    auto sprite = parser.parseData(buildEncodedDC6(1, 2, width, height, encoded));
+    ASSERT_TRUE(sprite != nullptr);
+    for (uint32_t i = 0; i < 8; i++) {
+        EXPECT_EQ(sprite->getFrame(i / 4, i % 4).pixelData, images[i]) << "frame " << i;
+    }
+}
+
 // Test: Convert frame to image data
 TEST_F(DC6ParserTest, ConvertFrameToImage) {
     DC6Parser parser;
@@ -365,4 +613,59 @@ TEST_F(DC6ParserTest, HandleInvalidPaletteSize) {
             EXPECT_EQ(image_data[idx + 3], 255);      // A
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_F(DC6ParserTest, DecodeThroughputBenchmark) {
+    std::vector<std::vector<uint8_t>> files;
+    
+    // Every DC6 in the test assets, when there are any
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it("test_assets", error), end; !error && it != end;
+         it.increment(error)) {
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (it->is_regular_file() && extension == ".dc6") {
+            std::ifstream file(it->path(), std::ios::binary);
+            files.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+    }
+    size_t asset_files = files.size();
+    
+    // Plus a generated character-sized sprite: 8 directions of 16 frames
+    std::vector<std::vector<uint8_t>> encoded;
+    for (uint32_t i = 0; i < 8 * 16; i++) {
+        encoded.push_back(encodeRows(spriteImage(96, 128, i), 96, 128));
+    }
+    files.push_back(buildEncodedDC6(1, 8, 96, 128, encoded));
+    
+    // Decode every frame once per run; the sprites are parsed again before
+    // each run so no frame is already cached
+    DC6Parser parser;
+    parser.setFrameCacheBudget(0);
+    size_t decoded_bytes = 0;
+    double best = 1e9;
+    for (int run = 0; run < 5; run++) {
+        std::vector<std::unique_ptr<DC6Sprite>> sprites;
+        for (const auto& data : files) {
+            if (auto sprite = parser.parseData(data)) {
+                sprites.push_back(std::move(sprite));
+            }
+        }
+        
+        decoded_bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& sprite : sprites) {
+            for (uint32_t dir = 0; dir < sprite->getDirectionCount(); dir++) {
+                for (uint32_t frame = 0; frame < sprite->getFramesPerDirection(); frame++) {
+                    decoded_bytes += sprite->getFrameView(dir, frame).pixelCount;
+                }
+            }
+        }
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    
+    std::cout << "DC6 decode: " << asset_files << " asset files + 1 generated, "
+              << (decoded_bytes / (1024.0 * 1024.0)) / std::max(best, 1e-9) << " MB/s of pixels\n";
+    EXPECT_GE(decoded_bytes, 8u * 16 * 96 * 128);
+}
@@ -0,0 +1,575 @@
+#include <gtest/gtest.h>
+#include "sprites/dcc_parser.h"
+#include "sprites/sprite_residency.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <random>
+#include <thread>
+
+using namespace d2portable::sprites;
+
+namespace {
+
+// Appends bit fields least significant bit first, as DCC streams store them
+class BitWriter {
+public:
+    void write(uint32_t value, uint32_t bits) {
+        for (uint32_t i = 0; i < bits; i++) {
+            writeBit((value >> i) & 1);
+        }
+    }
+
+    void append(const BitWriter& other) {
+        for (size_t i = 0; i < other.bit_count; i++) {
+            writeBit((other.bytes[i / 8] >> (i % 8)) & 1);
+        }
+    }
+
+    size_t size() const { return bit_count; }
+    const std::vector<uint8_t>& data() const { return bytes; }
+
+private:
+    void writeBit(uint32_t bit) {
+        if (bit_count % 8 == 0) {
+            bytes.push_back(0);
+        }
+        bytes.back() |= static_cast<uint8_t>(bit << (bit_count % 8));
+        bit_count++;
+    }
+
+    std::vector<uint8_t> bytes;
+    size_t bit_count = 0;
+};
+
+struct TestFrame {
+    uint32_t width;
+    uint32_t height;
+    int32_t x_offset;
+    int32_t y_offset;
+    std::vector<uint8_t> pixels;  // Top row first
+};
+
+struct EncodeOptions {
+    bool equal_cells = true;
+    bool raw_codes = false;
+};
+
+struct TestCell {
+    int32_t x, y, width, height;
+};
+
+// Same grid split the decoder uses
+std::vector<int32_t> splitCells(int32_t origin, int32_t length) {
+    int32_t first = 4 - (origin % 4);
+    if (length - first <= 1) {
+        return {length};
+    }
+    int32_t rest = length - first - 1;
+    int32_t count = 2 + rest / 4 - (rest % 4 == 0 ? 1 : 0);
+    std::vector<int32_t> sizes(count, 4);
+    sizes.front() = first;
+    sizes.back() = length - first - 4 * (count - 2);
+    return sizes;
+}
+
+// Encodes one direction. A cell can only hold four pixel values, so the
+// frames are first reduced to what the format can represent; the test
+// compares the decoder against the reduced frames.
+BitWriter encodeDirection(std::vector<TestFrame>& frames, const EncodeOptions& options) {
+    // Palette indices in use; index 0 is always code 0
+    std::vector<bool> used(256, false);
+    used[0] = true;
+    for (const auto& frame : frames) {
+        for (uint8_t pixel : frame.pixels) {
+            used[pixel] = true;
+        }
+    }
+    std::vector<uint8_t> code_of(256, 0);
+    uint32_t codes = 0;
+    for (int i = 0; i < 256; i++) {
+        if (used[i]) {
+            code_of[i] = static_cast<uint8_t>(codes++);
+        }
+    }
+
+    int32_t min_x = INT32_MAX, min_y = INT32_MAX, max_x = INT32_MIN, max_y = INT32_MIN;
+    for (const auto& frame : frames) {
+        if (frame.width == 0 || frame.height == 0) {
+            continue;
+        }
+        int32_t top = frame.y_offset - static_cast<int32_t>(frame.height) + 1;
+        min_x = std::min(min_x, frame.x_offset);
+        min_y = std::min(min_y, top);
+        max_x = std::max(max_x, frame.x_offset + static_cast<int32_t>(frame.width));
+        max_y = std::max(max_y, top + static_cast<int32_t>(frame.height));
+    }
+    int32_t canvas_width = max_x - min_x;
+    int32_t grid_width = 1 + (canvas_width - 1) / 4;
+    int32_t grid_height = 1 + (max_y - min_y - 1) / 4;
+    std::vector<uint8_t> canvas(static_cast<size_t>(canvas_width) * (max_y - min_y), 0);
+
+    struct GridCell {
+        bool seen = false;
+        TestCell last{0, 0, -1, -1};
+    };
+    std::vector<GridCell> grid(static_cast<size_t>(grid_width) * grid_height);
+
+    BitWriter equal_cells, pixel_mask, encoding_type, raw_codes, displacements, indices;
+    bool any_raw = false;
+
+    for (auto& frame : frames) {
+        if (frame.width == 0 || frame.height == 0) {
+            continue;
+        }
+        int32_t left = frame.x_offset - min_x;
+        int32_t top = frame.y_offset - static_cast<int32_t>(frame.height) + 1 - min_y;
+        auto widths = splitCells(left, frame.width);
+        auto heights = splitCells(top, frame.height);
+
+        int32_t y = top;
+        for (int32_t height : heights) {
+            int32_t x = left;
+            for (int32_t width : widths) {
+                TestCell cell{x, y, width, height};
+                GridCell& grid_cell = grid[(x / 4) + (y / 4) * grid_width];
+                auto pixel = [&](int32_t px, int32_t py) -> uint8_t& {
+                    return frame.pixels[(py + y - top) * frame.width + (px + x - left)];
+                };
+                auto canvas_at = [&](int32_t cx, int32_t cy) -> uint8_t& {
+                    return canvas[static_cast<size_t>(cy) * canvas_width + cx];
+                };
+
+                // Keep the largest values when a cell has too many
+                std::vector<uint8_t> distinct;
+                for (int32_t py = 0; py < height; py++) {
+                    for (int32_t px = 0; px < width; px++) {
+                        distinct.push_back(code_of[pixel(px, py)]);
+                    }
+                }
+                std::sort(distinct.begin(), distinct.end());
+                distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+                distinct.erase(std::remove(distinct.begin(), distinct.end(), 0), distinct.end());
+                bool has_zero = false;
+                for (int32_t py = 0; py < height; py++) {
+                    for (int32_t px = 0; px < width; px++) {
+                        has_zero |= code_of[pixel(px, py)] == 0;
+                    }
+                }
+                size_t limit = has_zero ? 3 : 4;
+                if (distinct.size() > limit) {
+                    distinct.erase(distinct.begin(), distinct.end() - limit);
+                }
+                std::vector<uint8_t> palette_of(256, 0);
+                for (int i = 0; i < 256; i++) {
+                    if (used[i]) {
+                        palette_of[code_of[i]] = static_cast<uint8_t>(i);
+                    }
+                }
+                for (int32_t py = 0; py < height; py++) {
+                    for (int32_t px = 0; px < width; px++) {
+                        uint8_t code = code_of[pixel(px, py)];
+                        if (code != 0 && !std::binary_search(distinct.begin(), distinct.end(), code)) {
+                            pixel(px, py) = palette_of[distinct.back()];
+                        }
+                    }
+                }
+
+                // What the decoder would produce for an equal cell
+                bool equal = false;
+                if (grid_cell.seen && options.equal_cells) {
+                    bool same_size = grid_cell.last.width == width && grid_cell.last.height == height;
+                    equal = true;
+                    for (int32_t py = 0; py < height && equal; py++) {
+                        for (int32_t px = 0; px < width && equal; px++) {
+                            uint8_t copied = same_size ? canvas_at(grid_cell.last.x + px, grid_cell.last.y + py) : 0;
+                            equal = copied == pixel(px, py);
+                        }
+                    }
+                }
+
+                if (grid_cell.seen) {
+                    if (options.equal_cells) {
+                        equal_cells.write(equal ? 1 : 0, 1);
+                    }
+                    if (!equal) {
+                        pixel_mask.write(0x0F, 4);
+                    }
+                }
+
+                if (!equal) {
+                    // Values go out in ascending order and come back largest first
+                    bool raw = options.raw_codes && ((x + y) / 4) % 2 == 0;
+                    if (options.raw_codes) {
+                        encoding_type.write(raw ? 1 : 0, 1);
+                        any_raw = true;
+                    }
+                    uint32_t last = 0;
+                    for (uint8_t value : distinct) {
+                        if (raw) {
+                            raw_codes.write(value, 8);
+                        } else {
+                            uint32_t displacement = value - last;
+                            while (displacement >= 15) {
+                                displacements.write(15, 4);
+                                displacement -= 15;
+                            }
+                            displacements.write(displacement, 4);
+                        }
+                        last = value;
+                    }
+                    if (distinct.size() < 4) {
+                        if (raw) {
+                            raw_codes.write(last, 8);
+                        } else {
+                            displacements.write(0, 4);
+                        }
+                    }
+
+                    uint8_t values[4] = {0, 0, 0, 0};
+                    for (size_t i = 0; i < distinct.size(); i++) {
+                        values[i] = distinct[distinct.size() - 1 - i];
+                    }
+                    if (values[0] != values[1]) {
+                        uint32_t bits = (values[1] == values[2]) ? 1 : 2;
+                        for (int32_t py = 0; py < height; py++) {
+                            for (int32_t px = 0; px < width; px++) {
+                                uint8_t code = code_of[pixel(px, py)];
+                                uint32_t index = static_cast<uint32_t>(std::find(values, values + 4, code) - values);
+                                indices.write(index, bits);
+                            }
+                        }
+                    }
+                }
+
+                for (int32_t py = 0; py < height; py++) {
+                    for (int32_t px = 0; px < width; px++) {
+                        canvas_at(x + px, y + py) = pixel(px, py);
+                    }
+                }
+                grid_cell.seen = true;
+                grid_cell.last = cell;
+                x += width;
+            }
+            y += height;
+        }
+    }
+
+    // Header: 16-bit sizes and offsets, no optional data
+    BitWriter direction;
+    uint32_t compression = (options.equal_cells ? 0x2 : 0) | (any_raw ? 0x1 : 0);
+    direction.write(0, 32);
+    direction.write(compression, 2);
+    direction.write(0, 4);   // Variable0
+    direction.write(9, 4);   // Width: 16 bits
+    direction.write(9, 4);   // Height: 16 bits
+    direction.write(9, 4);   // X offset: 16 bits
+    direction.write(9, 4);   // Y offset: 16 bits
+    direction.write(0, 4);   // Optional data
+    direction.write(0, 4);   // Coded bytes
+    for (const auto& frame : frames) {
+        direction.write(frame.width, 16);
+        direction.write(frame.height, 16);
+        direction.write(static_cast<uint32_t>(frame.x_offset) & 0xFFFF, 16);
+        direction.write(static_cast<uint32_t>(frame.y_offset) & 0xFFFF, 16);
+        direction.write(0, 1);
+    }
+    if (compression & 0x2) {
+        direction.write(static_cast<uint32_t>(equal_cells.size()), 20);
+    }
+    direction.write(static_cast<uint32_t>(pixel_mask.size()), 20);
+    if (compression & 0x1) {
+        direction.write(static_cast<uint32_t>(encoding_type.size()), 20);
+        direction.write(static_cast<uint32_t>(raw_codes.size()), 20);
+    }
+    for (int i = 0; i < 256; i++) {
+        direction.write(used[i] ? 1 : 0, 1);
+    }
+    direction.append(equal_cells);
+    direction.append(pixel_mask);
+    if (compression & 0x1) {
+        direction.append(encoding_type);
+        direction.append(raw_codes);
+    }
+    direction.append(displacements);
+    direction.append(indices);
+    return direction;
+}
+
+std::vector<uint8_t> buildDCC(std::vector<std::vector<TestFrame>>& directions, const EncodeOptions& options) {
+    std::vector<uint8_t> data;
+    auto put = [&](uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            data.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    };
+
+    data.push_back(0x74);
+    data.push_back(6);
+    data.push_back(static_cast<uint8_t>(directions.size()));
+    put(static_cast<uint32_t>(directions[0].size()));
+    put(1);
+    put(0);
+    size_t offsets = data.size();
+    data.resize(data.size() + directions.size() * 4);
+    for (size_t d = 0; d < directions.size(); d++) {
+        uint32_t offset = static_cast<uint32_t>(data.size());
+        std::memcpy(data.data() + offsets + d * 4, &offset, 4);
+        BitWriter encoded = encodeDirection(directions[d], options);
+        data.insert(data.end(), encoded.data().begin(), encoded.data().end());
+    }
+    return data;
+}
+
+// A figure made of a few colored bands that drifts from frame to frame
+std::vector<TestFrame> animatedDirection(uint32_t frame_count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<TestFrame> frames;
+    for (uint32_t f = 0; f < frame_count; f++) {
+        TestFrame frame;
+        frame.width = 20 + rng() % 23;
+        frame.height = 30 + rng() % 19;
+        frame.x_offset = -static_cast<int32_t>(frame.width / 2) + static_cast<int32_t>(rng() % 5);
+        frame.y_offset = static_cast<int32_t>(rng() % 7) - 3;
+        frame.pixels.resize(frame.width * frame.height);
+        for (uint32_t y = 0; y < frame.height; y++) {
+            for (uint32_t x = 0; x < frame.width; x++) {
+                int32_t world_x = frame.x_offset + static_cast<int32_t>(x);
+                bool inside = (x > 2 && x + 2 < frame.width) && (y % 11 != 0);
+                uint8_t band = static_cast<uint8_t>(((world_x + 64) / 3 + y / 5) % 3);
+                frame.pixels[y * frame.width + x] = inside ? static_cast<uint8_t>(40 + band * 37 + (f % 2)) : 0;
+            }
+        }
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+void expectFramesMatch(const DC6Sprite& sprite, const std::vector<std::vector<TestFrame>>& directions) {
+    for (uint32_t d = 0; d < directions.size(); d++) {
+        for (uint32_t f = 0; f < directions[d].size(); f++) {
+            const TestFrame& expected = directions[d][f];
+            auto view = sprite.getFrameView(d, f);
+            ASSERT_EQ(view.width, expected.width) << "direction " << d << " frame " << f;
+            ASSERT_EQ(view.height, expected.height);
+            EXPECT_EQ(view.offsetX, expected.x_offset);
+            EXPECT_EQ(view.offsetY, expected.y_offset);
+            ASSERT_EQ(view.pixelCount, expected.pixels.size());
+            EXPECT_TRUE(std::equal(expected.pixels.begin(), expected.pixels.end(), view.pixels))
+                << "direction " << d << " frame " << f;
+        }
+    }
+}
+
+} // namespace
+
+TEST(DCCParserTest, DecodesSingleFrame) {
+    TestFrame frame{6, 5, -2, 1, {}};
+    frame.pixels = {
+        0, 0, 9, 9, 0, 0,
+        0, 9, 7, 7, 9, 0,
+        9, 7, 3, 3, 7, 9,
+        0, 9, 7, 7, 9, 0,
+        0, 0, 9, 9, 0, 0,
+    };
+    std::vector<std::vector<TestFrame>> directions = {{frame}};
+    auto expected = directions;
+
+    DCCParser parser;
+    auto sprite = parser.parseData(buildDCC(directions, EncodeOptions{}));
+    ASSERT_NE(sprite, nullptr);
+    EXPECT_EQ(sprite->getDirectionCount(), 1u);
+    EXPECT_EQ(sprite->getFramesPerDirection(), 1u);
+
+    // Few enough colors per cell that nothing was reduced
+    EXPECT_EQ(directions[0][0].pixels, expected[0][0].pixels);
+    expectFramesMatch(*sprite, expected);
+    EXPECT_EQ(sprite->getFrameImage(0, 0).size(), 6u * 5u * 4u);
+}
+
+TEST(DCCParserTest, DecodesAnimatedDirections) {
+    // Moving frames exercise cells that are copied, cleared and re-coded
+    for (bool raw_codes : {false, true}) {
+        std::vector<std::vector<TestFrame>> directions;
+        for (uint32_t d = 0; d < 3; d++) {
+            directions.push_back(animatedDirection(8, d * 31 + 7));
+        }
+
+        EncodeOptions options;
+        options.raw_codes = raw_codes;
+        auto data = buildDCC(directions, options);
+
+        DCCParser parser;
+        auto sprite = parser.parseData(data);
+        ASSERT_NE(sprite, nullptr);
+        expectFramesMatch(*sprite, directions);
+    }
+}
+
+TEST(DCCParserTest, DecodesWithoutEqualCells) {
+    std::vector<std::vector<TestFrame>> directions = {animatedDirection(5, 3)};
+    EncodeOptions options;
+    options.equal_cells = false;
+
+    DCCParser parser;
+    auto sprite = parser.parseData(buildDCC(directions, options));
+    ASSERT_NE(sprite, nullptr);
+    expectFramesMatch(*sprite, directions);
+}
+
+TEST(DCCParserTest, RejectsInvalidHeaders) {
+    std::vector<std::vector<TestFrame>> directions = {animatedDirection(2, 1)};
+    auto data = buildDCC(directions, EncodeOptions{});
+    DCCParser parser;
+    ASSERT_NE(parser.parseData(data), nullptr);
+
+    auto bad_signature = data;
+    bad_signature[0] = 0x75;
+    EXPECT_EQ(parser.parseData(bad_signature), nullptr);
+
+    auto bad_tag = data;
+    bad_tag[7] = 2;
+    EXPECT_EQ(parser.parseData(bad_tag), nullptr);
+
+    auto bad_offset = data;
+    bad_offset[15] = 0xFF;
+    bad_offset[16] = 0xFF;
+    EXPECT_EQ(parser.parseData(bad_offset), nullptr);
+
+    EXPECT_EQ(parser.parseData(std::vector<uint8_t>(data.begin(), data.begin() + 10)), nullptr);
+    EXPECT_EQ(parser.parseFile("does_not_exist.dcc"), nullptr);
+}
+
+TEST(DCCParserTest, TruncatedDirectionsAreEmpty) {
+    std::vector<std::vector<TestFrame>> directions = {animatedDirection(4, 2)};
+    auto data = buildDCC(directions, EncodeOptions{});
+
+    // Cut inside the frame headers
+    data.resize(19 + 12);
+    DCCParser parser;
+    auto sprite = parser.parseData(data);
+    ASSERT_NE(sprite, nullptr);
+    for (uint32_t f = 0; f < 4; f++) {
+        EXPECT_TRUE(sprite->getFrameView(0, f).empty());
+    }
+    EXPECT_TRUE(sprite->getFrameView(1, 0).empty());
+    EXPECT_TRUE(sprite->getFrameImage(0, 0).empty());
+}
+
+TEST(DCCParserTest, EmptyFramesDoNotWidenDirection) {
+    // A 0x0 frame far from the others has no cells and no pixels
+    TestFrame frame{8, 8, 0, 7, {}};
+    for (uint32_t i = 0; i < 64; i++) {
+        frame.pixels.push_back(static_cast<uint8_t>(i % 8 < 4 ? 12 : 0));
+    }
+    TestFrame empty{0, 0, 100, 100, {}};
+    std::vector<std::vector<TestFrame>> directions = {{frame, empty}};
+
+    DCCParser parser;
+    auto sprite = parser.parseData(buildDCC(directions, EncodeOptions{}));
+    ASSERT_NE(sprite, nullptr);
+    expectFramesMatch(*sprite, directions);
+    auto view = sprite->getFrameView(0, 1);
+    EXPECT_TRUE(view.empty());
+    EXPECT_EQ(view.offsetX, 100);
+    EXPECT_EQ(view.offsetY, 100);
+}
+
+TEST(DCCParserTest, FrameCountBeyondDirectionIsEmpty) {
+    std::vector<std::vector<TestFrame>> directions = {animatedDirection(2, 5)};
+    auto data = buildDCC(directions, EncodeOptions{});
+
+    // More frame headers than the direction's bits can hold
+    uint32_t frames = static_cast<uint32_t>(data.size() * 8);
+    std::memcpy(data.data() + 3, &frames, sizeof(frames));
+    DCCParser parser;
+    auto sprite = parser.parseData(data);
+    ASSERT_NE(sprite, nullptr);
+    EXPECT_TRUE(sprite->getFrameView(0, 0).empty());
+    EXPECT_TRUE(sprite->getFrameView(0, frames - 1).empty());
+    EXPECT_TRUE(sprite->getFrame(0, 1).pixelData.empty());
+}
+
+TEST(DCCParserTest, DirectionCacheStaysWithinBudget) {
+    std::vector<std::vector<TestFrame>> directions;
+    for (uint32_t d = 0; d < 4; d++) {
+        directions.push_back(animatedDirection(6, d + 100));
+    }
+    auto data = buildDCC(directions, EncodeOptions{});
+
+    DCCParser parser;
+    EXPECT_EQ(parser.getDirectionCacheBudget(), kDefaultDirectionCacheBudget);
+    parser.setDirectionCacheBudget(1);
+    auto sprite = parser.parseData(data);
+    ASSERT_NE(sprite, nullptr);
+
+    // Only the last direction stays decoded; views keep evicted ones alive
+    auto first = sprite->getFrameView(0, 3);
+    for (uint32_t d = 1; d < 4; d++) {
+        sprite->getFrameView(d, 0);
+    }
+    ASSERT_EQ(first.pixelCount, directions[0][3].pixels.size());
+    EXPECT_TRUE(std::equal(directions[0][3].pixels.begin(), directions[0][3].pixels.end(), first.pixels));
+    expectFramesMatch(*sprite, directions);
+}
+
+TEST(DCCParserTest, ChargesDirectionsToResidency) {
+    std::vector<std::vector<TestFrame>> directions;
+    for (uint32_t d = 0; d < 3; d++) {
+        directions.push_back(animatedDirection(4, d + 300));
+    }
+    auto residency = std::make_shared<SpriteResidency>(0);
+    DCCParser parser;
+    parser.setDirectionCacheBudget(1);
+    parser.setResidency(residency);
+    auto sprite = parser.parseData(buildDCC(directions, EncodeOptions{}));
+    ASSERT_NE(sprite, nullptr);
+
+    // The residency replaces the per-sprite budget, so both stay decoded
+    auto first = sprite->getFrameView(0, 0);
+    sprite->getFrameView(2, 1);
+    size_t expected = 0;
+    for (uint32_t d : {0u, 2u}) {
+        for (const auto& frame : directions[d]) {
+            expected += frame.pixels.size();
+        }
+    }
+    EXPECT_EQ(residency->getResidentBytes(), expected);
+    EXPECT_EQ(residency->getResidentDirectionCount(), 2u);
+    EXPECT_EQ(sprite->getFrameView(0, 3).owner, first.owner);
+
+    sprite.reset();
+    EXPECT_EQ(residency->getResidentBytes(), 0u);
+}
+
+TEST(DCCParserTest, ConcurrentDirectionDecoding) {
+    std::vector<std::vector<TestFrame>> directions;
+    for (uint32_t d = 0; d < 8; d++) {
+        directions.push_back(animatedDirection(4, d + 200));
+    }
+    DCCParser parser;
+    parser.setDirectionCacheBudget(4096);
+    std::shared_ptr<DC6Sprite> sprite = parser.parseData(buildDCC(directions, EncodeOptions{}));
+    ASSERT_NE(sprite, nullptr);
+
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 20; round++) {
+                uint32_t d = static_cast<uint32_t>(t + round) % 8;
+                uint32_t f = static_cast<uint32_t>(round) % 4;
+                auto view = sprite->getFrameView(d, f);
+                const auto& expected = directions[d][f].pixels;
+                if (view.pixelCount != expected.size() ||
+                    !std::equal(expected.begin(), expected.end(), view.pixels)) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches, std::vector<int>(4, 0));
+}
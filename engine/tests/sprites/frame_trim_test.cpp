@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "sprites/frame_trim.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace d2portable::sprites;
+
+namespace {
+
+// Reference bounds from a plain scan of every pixel
+FrameRect bruteForceBounds(const std::vector<uint8_t>& indices, uint32_t width, uint32_t height) {
+    uint32_t left = width, top = height, right = 0, bottom = 0;
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            if (indices[y * width + x] != 0) {
+                left = std::min(left, x);
+                top = std::min(top, y);
+                right = std::max(right, x + 1);
+                bottom = std::max(bottom, y + 1);
+            }
+        }
+    }
+    FrameRect bounds;
+    if (right > left) {
+        bounds = {left, top, right - left, bottom - top};
+    }
+    return bounds;
+}
+
+} // namespace
+
+TEST(FrameTrimTest, FindsVisibleBounds) {
+    // 6x5 frame with visible pixels in a 3x2 block
+    std::vector<uint8_t> indices = {
+        0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+        0, 5, 0, 7, 0, 0,
+        0, 0, 9, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+    };
+
+    FrameRect bounds = findOpaqueBounds(indices.data(), 6, 5);
+    EXPECT_EQ(bounds.x, 1u);
+    EXPECT_EQ(bounds.y, 2u);
+    EXPECT_EQ(bounds.width, 3u);
+    EXPECT_EQ(bounds.height, 2u);
+}
+
+TEST(FrameTrimTest, HandlesFullAndEmptyFrames) {
+    std::vector<uint8_t> full(12 * 4, 3);
+    FrameRect bounds = findOpaqueBounds(full.data(), 12, 4);
+    EXPECT_EQ(bounds.x, 0u);
+    EXPECT_EQ(bounds.y, 0u);
+    EXPECT_EQ(bounds.width, 12u);
+    EXPECT_EQ(bounds.height, 4u);
+
+    std::vector<uint8_t> blank(40 * 30, 0);
+    EXPECT_TRUE(findOpaqueBounds(blank.data(), 40, 30).empty());
+    EXPECT_TRUE(findOpaqueBounds(nullptr, 40, 30).empty());
+    EXPECT_TRUE(findOpaqueBounds(full.data(), 0, 4).empty());
+}
+
+TEST(FrameTrimTest, MatchesFullScanOnRandomFrames) {
+    // Widths around the eight-pixel chunk size catch edge mistakes
+    std::mt19937 rng(17);
+    for (int round = 0; round < 300; round++) {
+        uint32_t width = 1 + rng() % 40;
+        uint32_t height = 1 + rng() % 24;
+        std::vector<uint8_t> indices(width * height, 0);
+        uint32_t spots = rng() % 4;
+        for (uint32_t i = 0; i < spots; i++) {
+            indices[rng() % indices.size()] = static_cast<uint8_t>(1 + rng() % 255);
+        }
+
+        FrameRect expected = bruteForceBounds(indices, width, height);
+        FrameRect bounds = findOpaqueBounds(indices.data(), width, height);
+        ASSERT_EQ(bounds.empty(), expected.empty()) << "round " << round;
+        if (!expected.empty()) {
+            EXPECT_EQ(bounds.x, expected.x) << "round " << round;
+            EXPECT_EQ(bounds.y, expected.y) << "round " << round;
+            EXPECT_EQ(bounds.width, expected.width) << "round " << round;
+            EXPECT_EQ(bounds.height, expected.height) << "round " << round;
+        }
+    }
+}
+
+TEST(FrameTrimTest, CopiesRectangles) {
+    // 4x3 RGBA image where each pixel stores its own index
+    std::vector<uint8_t> rgba(4 * 3 * 4);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = static_cast<uint8_t>(i / 4);
+    }
+
+    FrameRect rect{1, 1, 2, 2};
+    std::vector<uint8_t> out(2 * 2 * 4);
+    copyFrameRect(rgba.data(), 4, 4, rect, out.data());
+    std::vector<uint8_t> expected = {5, 5, 5, 5, 6, 6, 6, 6, 9, 9, 9, 9, 10, 10, 10, 10};
+    EXPECT_EQ(out, expected);
+}
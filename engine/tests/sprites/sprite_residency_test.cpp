@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "sprites/sprite_residency.h"
+#include "sprites/dc6_parser.h"
+#include "dc6_test_data.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace d2portable::sprites;
+using d2::test::DC6TestFrame;
+using d2::test::rawDC6Frame;
+
+namespace {
+
+// In-memory DC6 with uncompressed width x height frames
+std::vector<uint8_t> buildDC6(uint32_t directions, uint32_t frames, uint32_t width, uint32_t height) {
+    std::vector<DC6TestFrame> dc6_frames;
+    for (uint32_t i = 0; i < directions * frames; i++) {
+        dc6_frames.push_back(rawDC6Frame(width, height, [&](uint32_t x, uint32_t y) {
+            uint32_t p = y * width + x;
+            return i * 7 + p + 1;
+        }));
+        dc6_frames.back().offsetX = static_cast<int32_t>(i);
+    }
+    return d2::test::buildDC6(directions, dc6_frames);
+}
+
+} // namespace
+
+TEST(SpriteResidencyTest, ChargesDecodedFramesToTheirDirection) {
+    auto residency = std::make_shared<SpriteResidency>(0);
+    int64_t reported = 0;
+    residency->setUsageCallback([&](int64_t delta) { reported += delta; });
+
+    DC6Parser parser;
+    parser.setResidency(residency);
+    auto sprite = parser.parseData(buildDC6(8, 4, 16, 16));
+    ASSERT_NE(sprite, nullptr);
+    EXPECT_EQ(residency->getResidentBytes(), 0u);
+
+    // Only the frames actually used are counted
+    sprite->getFrameView(0, 0);
+    sprite->getFrameView(0, 1);
+    sprite->getFrameView(5, 2);
+    sprite->getFrameView(0, 0);
+    EXPECT_EQ(residency->getResidentBytes(), 3u * 16 * 16);
+    EXPECT_EQ(residency->getResidentDirectionCount(), 2u);
+    EXPECT_EQ(reported, 3 * 16 * 16);
+
+    sprite.reset();
+    EXPECT_EQ(residency->getResidentBytes(), 0u);
+    EXPECT_EQ(residency->getResidentDirectionCount(), 0u);
+    EXPECT_EQ(reported, 0);
+}
+
+TEST(SpriteResidencyTest, EvictsColdDirectionsAndKeepsHotOnes) {
+    // Room for three full 4-frame directions of 16x16 pixels
+    const size_t direction_bytes = 4 * 16 * 16;
+    auto residency = std::make_shared<SpriteResidency>(3 * direction_bytes);
+    DC6Parser parser;
+    parser.setResidency(residency);
+    auto hero = parser.parseData(buildDC6(8, 4, 16, 16));
+    auto monster = parser.parseData(buildDC6(8, 4, 16, 16));
+    ASSERT_NE(hero, nullptr);
+    ASSERT_NE(monster, nullptr);
+
+    // The hero faces one way every frame while the monster turns around
+    for (uint32_t tick = 0; tick < 64; tick++) {
+        auto hot = hero->getFrameView(2, tick % 4);
+        ASSERT_EQ(hot.pixelCount, 16u * 16);
+        monster->getFrameView(tick / 4 % 8, tick % 4);
+        EXPECT_LE(residency->getResidentBytes(), 3 * direction_bytes);
+    }
+    EXPECT_GT(residency->getEvictionCount(), 0u);
+
+    // The hot direction was never dropped: using it decodes nothing
+    uint64_t evictions = residency->getEvictionCount();
+    size_t resident = residency->getResidentBytes();
+    for (uint32_t f = 0; f < 4; f++) {
+        hero->getFrameView(2, f);
+    }
+    EXPECT_EQ(residency->getEvictionCount(), evictions);
+    EXPECT_EQ(residency->getResidentBytes(), resident);
+
+    // Frames decode again after their direction was evicted
+    auto frame = monster->getFrameView(0, 3);
+    EXPECT_EQ(frame.offsetX, 3);
+    EXPECT_EQ(frame.pixels[0], static_cast<uint8_t>(3 * 7 + 1));
+
+    // Shrinking the budget evicts at once, down to the latest direction
+    residency->setBudget(1);
+    EXPECT_EQ(residency->getResidentDirectionCount(), 1u);
+    EXPECT_EQ(residency->getResidentBytes(), 16u * 16);
+}
+
+TEST(SpriteResidencyTest, ConcurrentSpritesStayWithinBudget) {
+    const size_t frame_bytes = 8 * 8;
+    auto residency = std::make_shared<SpriteResidency>(6 * frame_bytes);
+    DC6Parser parser;
+    parser.setResidency(residency);
+
+    std::vector<std::shared_ptr<DC6Sprite>> sprites;
+    for (int i = 0; i < 4; i++) {
+        sprites.push_back(parser.parseData(buildDC6(8, 2, 8, 8)));
+        ASSERT_NE(sprites.back(), nullptr);
+    }
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (uint32_t round = 0; round < 400; round++) {
+                const auto& sprite = sprites[(round + t) % sprites.size()];
+                uint32_t index = (round * 5 + t * 3) % 16;
+                auto view = sprite->getFrameView(index / 2, index % 2);
+                if (view.pixelCount != frame_bytes || view.pixels[0] != static_cast<uint8_t>(index * 7 + 1)) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+
+    // Racing charges may leave eviction to a later one; enforcing again
+    // once they have all landed brings the total within budget
+    residency->setBudget(6 * frame_bytes);
+    EXPECT_LE(residency->getResidentBytes(), 6 * frame_bytes);
+    EXPECT_GT(residency->getEvictionCount(), 0u);
+
+    sprites.clear();
+    EXPECT_EQ(residency->getResidentBytes(), 0u);
+}
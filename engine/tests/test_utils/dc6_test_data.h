@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace d2::test {
+
+// One frame of a DC6 file built for tests
+struct DC6TestFrame {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int32_t offsetX = 0;
+    int32_t offsetY = 0;
+    uint32_t flip = 0;
+    std::vector<uint8_t> data;  // Stored pixel bytes: raw indices, or encoded rows
+    bool terminator = false;    // Append the game's 3-byte frame terminator
+};
+
+// Raw-index frame whose pixels come from pixel(x, y)
+template <typename PixelFn>
+DC6TestFrame rawDC6Frame(uint32_t width, uint32_t height, PixelFn pixel) {
+    DC6TestFrame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.data.reserve(static_cast<size_t>(width) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            frame.data.push_back(static_cast<uint8_t>(pixel(x, y)));
+        }
+    }
+    return frame;
+}
+
+// DC6 file bytes; frames are stored direction by direction
+inline std::vector<uint8_t> buildDC6(uint32_t directions, const std::vector<DC6TestFrame>& frames,
+                                     uint32_t flags = 0) {
+    std::vector<uint8_t> data;
+    auto put = [&](uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            data.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    };
+
+    uint32_t frame_count = static_cast<uint32_t>(frames.size());
+    put(6); put(flags); put(0); put(0xEEEEEEEE); put(directions); put(directions ? frame_count / directions : 0);
+    uint32_t offset = 24 + frame_count * 4;
+    for (const auto& frame : frames) {
+        put(offset);
+        offset += 32 + static_cast<uint32_t>(frame.data.size()) + (frame.terminator ? 3 : 0);
+    }
+    for (const auto& frame : frames) {
+        put(frame.flip); put(frame.width); put(frame.height);
+        put(static_cast<uint32_t>(frame.offsetX)); put(static_cast<uint32_t>(frame.offsetY));
+        put(0); put(0); put(static_cast<uint32_t>(frame.data.size()));
+        data.insert(data.end(), frame.data.begin(), frame.data.end());
+        if (frame.terminator) {
+            data.insert(data.end(), 3, 0xEE);
+        }
+    }
+    return data;
+}
+
+inline void writeDC6(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+} // namespace d2::test
@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include "tools/asset_extractor.h"
+#include "tools/texture_atlas_generator.h"
+#include "utils/data_table_parser.h"
+#include "utils/mock_mpq_builder.h"
+#include "tools/extraction_monitor.h"
+#include "dc6_test_data.h"
+#include <map>
+#include <algorithm>
 #include <filesystem>
 #include <vector>
 #include <string>
@@ -7,6 +14,7 @@
 
 namespace fs = std::filesystem;
 using namespace d2;
+using namespace d2::test;
 
 class AssetExtractorTest : public ::testing::Test {
 protected:
@@ -193,4 +201,295 @@ TEST_F(AssetExtractorTest, ExtractDataTables) {
     }
     
     EXPECT_TRUE(foundDataFiles) << "No data files were extracted to organized directories";
-}
\ No newline at end of file
+}
+
+namespace {
+
+// Raw-index DC6 with one direction; frame i is a (4 + i)x3 block of color
+// centered in a 16x12 frame
+void writeBlockDC6(const fs::path& path, uint32_t frames) {
+    std::vector<DC6TestFrame> dc6Frames;
+    for (uint32_t f = 0; f < frames; f++) {
+        dc6Frames.push_back(rawDC6Frame(16, 12, [f](uint32_t x, uint32_t y) {
+            bool visible = x >= 6 && x < 10 + f && y >= 4 && y < 7;
+            return visible ? 40 : 0;
+        }));
+    }
+    writeDC6(path, buildDC6(1, dc6Frames));
+}
+
+} // namespace
+
+TEST_F(AssetExtractorTest, BakesCoVisibleSpriteSetsIntoAtlases) {
+    writeBlockDC6(outputPath / "sprites" / "ui" / "panel.dc6", 1);
+    writeBlockDC6(outputPath / "sprites" / "ui" / "buttons.dc6", 3);
+    writeBlockDC6(outputPath / "sprites" / "items" / "invsword.dc6", 1);
+    writeBlockDC6(outputPath / "sprites" / "characters" / "hero.dc6", 2);
+
+    AssetExtractor extractor;
+    ASSERT_TRUE(extractor.bakeSpriteAtlases(outputPath.string()));
+    EXPECT_EQ(extractor.getBakedAtlasCount(), 2u);
+
+    fs::path atlasDir = outputPath / "atlases";
+    EXPECT_TRUE(fs::exists(atlasDir / "ui_0.png"));
+    EXPECT_TRUE(fs::exists(atlasDir / "items_0.png"));
+    EXPECT_FALSE(fs::exists(atlasDir / "characters.atlas"));
+
+    // The map is the lookup table screens bind their pages with
+    TextureAtlas ui;
+    ASSERT_TRUE(ui.loadFromFile((atlasDir / "ui.atlas").string()));
+    EXPECT_EQ(ui.getPageCount(), 1);
+    EXPECT_EQ(ui.getSpriteCount(), 4u);
+    EXPECT_TRUE(ui.hasSprite("panel.dc6"));
+    EXPECT_FALSE(ui.hasSprite("invsword.dc6"));
+
+    const TextureAtlas::SpriteInfo* frame = ui.getSpriteInfo(TextureAtlas::frameName("buttons.dc6", 0, 2));
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->page, 0);
+    EXPECT_EQ(frame->width, 6);
+    EXPECT_EQ(frame->height, 3);
+    EXPECT_EQ(frame->trimX, 6);
+    EXPECT_EQ(frame->trimY, 4);
+    EXPECT_EQ(frame->sourceWidth, 16);
+
+    TextureAtlas items;
+    ASSERT_TRUE(items.loadFromFile((atlasDir / "items.atlas").string()));
+    EXPECT_TRUE(items.hasSprite("invsword.dc6"));
+}
+
+TEST_F(AssetExtractorTest, KeepsActPalettesApartAndBakesWithAct1) {
+    // Index 40 is a different color in each act's pal.dat (stored B, G, R)
+    auto paletteWith = [](uint8_t blue, uint8_t green, uint8_t red) {
+        std::vector<uint8_t> bgr(256 * 3, 0);
+        bgr[40 * 3] = blue;
+        bgr[40 * 3 + 1] = green;
+        bgr[40 * 3 + 2] = red;
+        return bgr;
+    };
+    std::vector<DC6TestFrame> frames = {rawDC6Frame(8, 8, [](uint32_t, uint32_t) { return 40; })};
+    std::string spriteName = "data\\global\\ui\\panel\\gemsocket.dc6";
+    d2portable::utils::MockMPQBuilder data;
+    data.addFile("data\\global\\palette\\ACT1\\pal.dat", paletteWith(10, 20, 30));
+    data.addFile("data\\global\\palette\\ACT2\\pal.dat", paletteWith(200, 200, 200));
+    data.addFile(spriteName, buildDC6(1, frames));
+    ASSERT_TRUE(data.build((testD2Path / "d2data.mpq").string()));
+    
+    AssetExtractor extractor;
+    ASSERT_TRUE(extractor.extractFromD2(testD2Path.string(), outputPath.string()));
+    EXPECT_TRUE(fs::exists(outputPath / "data" / "palette" / "act1" / "pal.dat"));
+    EXPECT_TRUE(fs::exists(outputPath / "data" / "palette" / "act2" / "pal.dat"));
+    ASSERT_EQ(extractor.getBakedAtlasCount(), 1u);
+    
+    TextureAtlas ui;
+    ASSERT_TRUE(ui.loadFromFile((outputPath / "atlases" / "ui.atlas").string()));
+    const TextureAtlas::SpriteInfo* sprite = ui.getSpriteInfo(fs::path(spriteName).filename().string());
+    ASSERT_NE(sprite, nullptr);
+    
+    // Decode the written page by packing it again
+    TextureAtlasGenerator generator;
+    auto repacked = generator.generateAtlas({(outputPath / "atlases" / "ui_0.png").string()}, 512, 512);
+    ASSERT_TRUE(repacked.isValid());
+    const TextureAtlas::SpriteInfo* page = repacked.getSpriteInfo("ui_0.png");
+    ASSERT_NE(page, nullptr);
+    size_t pixel = (static_cast<size_t>(page->y + sprite->y) * repacked.getPageWidth(0) + page->x + sprite->x) * 4;
+    const std::vector<uint8_t>& pixels = *repacked.getPagePixels(0);
+    EXPECT_EQ(pixels[pixel], 30);
+    EXPECT_EQ(pixels[pixel + 1], 20);
+    EXPECT_EQ(pixels[pixel + 2], 10);
+    EXPECT_EQ(pixels[pixel + 3], 255);
+}
+
+TEST_F(AssetExtractorTest, SkipsAtlasesWhenNoSpritesWereExtracted) {
+    AssetExtractor extractor;
+    EXPECT_TRUE(extractor.extractFromD2(testD2Path.string(), outputPath.string()));
+    EXPECT_EQ(extractor.getBakedAtlasCount(), 0u);
+    EXPECT_FALSE(fs::exists(outputPath / "atlases"));
+}
+
+TEST_F(AssetExtractorTest, CompilesExcelTablesOnce) {
+    fs::path excelDir = outputPath / "data" / "excel";
+    fs::create_directories(excelDir);
+    std::ofstream(excelDir / "armor.txt") << "name\tac\nQuilted Armor\t8\nLeather Armor\t14\n";
+    std::ofstream(excelDir / "MonStats.TXT") << "Id\tLevel\nzombie\t1\n";
+    std::ofstream(excelDir / "notes.dat") << "not a table";
+
+    AssetExtractor extractor;
+    ASSERT_TRUE(extractor.compileDataTables(outputPath.string()));
+    EXPECT_EQ(extractor.getCompiledDataTableCount(), 2u);
+    ASSERT_TRUE(fs::exists(excelDir / "armor.d2tbl"));
+    EXPECT_TRUE(fs::exists(excelDir / "MonStats.d2tbl"));
+    EXPECT_FALSE(fs::exists(excelDir / "notes.d2tbl"));
+
+    d2::utils::DataTableParser parser;
+    d2::utils::DataTable armor;
+    ASSERT_TRUE(parser.loadBinaryFile((excelDir / "armor.d2tbl").string(), armor));
+    EXPECT_EQ(armor.getRowCount(), 2u);
+    EXPECT_EQ(armor.getInt(armor.findRowIndex(armor.getColumn("name"), "Leather Armor"), armor.getColumn("ac")), 14);
+
+    // Unchanged tables are not rebuilt; edited ones are
+    ASSERT_TRUE(extractor.compileDataTables(outputPath.string()));
+    EXPECT_EQ(extractor.getCompiledDataTableCount(), 0u);
+    std::ofstream(excelDir / "armor.txt") << "name\tac\nQuilted Armor\t9\n";
+    ASSERT_TRUE(extractor.compileDataTables(outputPath.string()));
+    EXPECT_EQ(extractor.getCompiledDataTableCount(), 1u);
+}
+
+namespace {
+
+// Every file under a directory, by relative path
+std::map<std::string, std::string> readTree(const fs::path& root) {
+    std::map<std::string, std::string> files;
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (entry.is_regular_file()) {
+            std::ifstream file(entry.path(), std::ios::binary);
+            files[fs::relative(entry.path(), root).generic_string()] =
+                std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        }
+    }
+    return files;
+}
+
+} // namespace
+
+TEST_F(AssetExtractorTest, ParallelExtractionMatchesExpectedTree) {
+    // Two archives sharing an Excel table; d2music.mpq stays unreadable
+    d2portable::utils::MockMPQBuilder data;
+    d2portable::utils::MockMPQBuilder chars;
+    std::map<std::string, std::string> expected;
+    for (int i = 0; i < 40; i++) {
+        std::vector<uint8_t> bytes(100 + i * 37, static_cast<uint8_t>(i));
+        std::string sprite = "data\\global\\items\\inv" + std::to_string(i) + ".dc6";
+        std::string sound = "data\\global\\sfx\\hit" + std::to_string(i) + ".wav";
+        data.addFile(sprite, bytes);
+        chars.addFile(sound, bytes);
+        expected[(fs::path("sprites") / "items" / fs::path(sprite).filename()).generic_string()] = std::string(bytes.begin(), bytes.end());
+        expected[(fs::path("sounds") / "effects" / fs::path(sound).filename()).generic_string()] = std::string(bytes.begin(), bytes.end());
+    }
+    std::string table = "data\\global\\excel\\armor.txt";
+    std::string fromData = "name\tac\nQuilted Armor\t8\n";
+    std::string fromChars = "name\tac\nQuilted Armor\t9\n";
+    data.addFile(table, std::vector<uint8_t>(fromData.begin(), fromData.end()));
+    chars.addFile(table, std::vector<uint8_t>(fromChars.begin(), fromChars.end()));
+    ASSERT_TRUE(data.build((testD2Path / "d2data.mpq").string()));
+    ASSERT_TRUE(chars.build((testD2Path / "d2char.mpq").string()));
+    
+    // The archive extracted last wins, as in a single ordered pass
+    std::string armor;
+    for (const auto& entry : fs::directory_iterator(testD2Path)) {
+        std::string name = entry.path().filename().string();
+        if (name == "d2data.mpq") {
+            armor = fromData;
+        } else if (name == "d2char.mpq") {
+            armor = fromChars;
+        }
+    }
+    fs::path tablePath = fs::path("data") / "excel" / fs::path(table).filename();
+    expected[tablePath.generic_string()] = armor;
+    
+    // The compiled table is built straight from the winning text
+    d2::utils::DataTableParser parser;
+    fs::path compiled = outputPath / "expected.d2tbl";
+    fs::create_directories(outputPath);
+    ASSERT_TRUE(parser.writeBinary(parser.parseExcel(armor.data(), armor.size()),
+                                   d2::utils::DataTableParser::hashSource(armor.data(), armor.size()),
+                                   compiled.string()));
+    std::ifstream compiledFile(compiled, std::ios::binary);
+    expected[fs::path(d2::utils::DataTableParser::getBinaryPath(tablePath.string())).generic_string()] =
+        std::string((std::istreambuf_iterator<char>(compiledFile)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(expected.size(), 81u + 1u);
+    
+    ExtractionMonitor monitor;
+    float lastProgress = 0.0f;
+    bool monotonic = true;
+    size_t errors = 0;
+    monitor.setProgressCallback([&](const ProgressUpdate& update) {
+        monotonic = monotonic && update.percentage >= lastProgress;
+        lastProgress = update.percentage;
+    });
+    monitor.setErrorCallback([&](const ExtractionError&) { errors++; });
+    
+    AssetExtractor extractor;
+    extractor.setThreadCount(8);
+    extractor.setMonitor(&monitor);
+    ASSERT_TRUE(extractor.extractFromD2(testD2Path.string(), (outputPath / "parallel").string()));
+    EXPECT_TRUE(monotonic);
+    EXPECT_FLOAT_EQ(lastProgress, 1.0f);
+    EXPECT_EQ(errors, 1u);
+    EXPECT_EQ(extractor.getExtractedFileCount(), 40u);
+    EXPECT_EQ(extractor.getExtractedAudioFileCount(), 40u);
+    EXPECT_EQ(extractor.getExtractedDataFileCount(), 2u);
+    
+    auto parallel = readTree(outputPath / "parallel");
+    ASSERT_EQ(parallel.size(), expected.size());
+    for (const auto& file : expected) {
+        auto found = parallel.find(file.first);
+        ASSERT_NE(found, parallel.end()) << file.first;
+        EXPECT_TRUE(found->second == file.second) << file.first;
+    }
+}
+
+TEST_F(AssetExtractorTest, ReportsUnwritableFilesAndKeepsExtracting) {
+    d2portable::utils::MockMPQBuilder data;
+    for (int i = 0; i < 20; i++) {
+        data.addFile("data\\global\\items\\inv" + std::to_string(i) + ".dc6", std::vector<uint8_t>(64, static_cast<uint8_t>(i)));
+    }
+    ASSERT_TRUE(data.build((testD2Path / "d2data.mpq").string()));
+    
+    // A directory where one of the files goes cannot be opened for writing
+    fs::path blocked = outputPath / "sprites" / "items" / fs::path("data\\global\\items\\inv7.dc6").filename();
+    fs::create_directories(blocked);
+    
+    std::vector<ExtractionError> errors;
+    ExtractionMonitor monitor;
+    monitor.setErrorCallback([&](const ExtractionError& error) { errors.push_back(error); });
+    
+    AssetExtractor extractor;
+    extractor.setThreadCount(4);
+    extractor.setMonitor(&monitor);
+    EXPECT_TRUE(extractor.extractFromD2(testD2Path.string(), outputPath.string()));
+    EXPECT_EQ(extractor.getExtractedFileCount(), 19u);
+    
+    auto writeError = std::find_if(errors.begin(), errors.end(), [&](const ExtractionError& error) {
+        return error.filename == blocked.string();
+    });
+    ASSERT_NE(writeError, errors.end());
+    EXPECT_EQ(writeError->type, ErrorType::IO_ERROR);
+    EXPECT_TRUE(writeError->isRecoverable);
+}
+
+TEST_F(AssetExtractorTest, ReportsFailedWritesAsNotExtracted) {
+    if (!fs::exists("/dev/full")) {
+        GTEST_SKIP() << "/dev/full is not available";
+    }
+    d2portable::utils::MockMPQBuilder data;
+    for (int i = 0; i < 20; i++) {
+        data.addFile("data\\global\\items\\inv" + std::to_string(i) + ".dc6", std::vector<uint8_t>(64, static_cast<uint8_t>(i)));
+    }
+    ASSERT_TRUE(data.build((testD2Path / "d2data.mpq").string()));
+    
+    // Opening succeeds, but every write to /dev/full fails with ENOSPC
+    fs::path full = outputPath / "sprites" / "items" / fs::path("data\\global\\items\\inv3.dc6").filename();
+    fs::create_directories(full.parent_path());
+    std::error_code ec;
+    fs::create_symlink("/dev/full", full, ec);
+    if (ec) {
+        GTEST_SKIP() << "Cannot create symlinks here: " << ec.message();
+    }
+    
+    std::vector<ExtractionError> errors;
+    ExtractionMonitor monitor;
+    monitor.setErrorCallback([&](const ExtractionError& error) { errors.push_back(error); });
+    
+    AssetExtractor extractor;
+    extractor.setThreadCount(4);
+    extractor.setMonitor(&monitor);
+    EXPECT_TRUE(extractor.extractFromD2(testD2Path.string(), outputPath.string()));
+    EXPECT_EQ(extractor.getExtractedFileCount(), 19u);
+    EXPECT_FALSE(fs::exists(fs::symlink_status(full)));
+    
+    auto writeError = std::find_if(errors.begin(), errors.end(), [&](const ExtractionError& error) {
+        return error.filename == full.string();
+    });
+    ASSERT_NE(writeError, errors.end());
+    EXPECT_EQ(writeError->type, ErrorType::INSUFFICIENT_SPACE);
+}
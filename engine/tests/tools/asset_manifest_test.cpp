@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <fstream>
 #include <algorithm>
+#include <vector>
 
 namespace fs = std::filesystem;
 using namespace d2;
@@ -207,4 +208,54 @@ TEST_F(AssetManifestTest, ChecksumPreservation) {
     const auto* info3 = loaded.getAssetInfo("file3.json");
     ASSERT_NE(info3, nullptr);
     EXPECT_EQ(info3->checksum, "crc32:deadbeef");
-}
\ No newline at end of file
+}
+
+TEST_F(AssetManifestTest, ModificationTimePreservation) {
+    AssetManifest manifest;
+    manifest.addAsset("sprites/player.png", 1024, "checksum1", -5123456789012345LL);
+    manifest.addAsset("sounds/music.ogg", 2048, "checksum2");
+    
+    auto manifestPath = tempPath / "timed_manifest.json";
+    ASSERT_TRUE(manifest.save(manifestPath.string()));
+    
+    AssetManifest loaded;
+    ASSERT_TRUE(loaded.load(manifestPath.string()));
+    ASSERT_EQ(loaded.getAssetCount(), 2);
+    EXPECT_EQ(loaded.getAssetInfo("sprites/player.png")->modifiedTime, -5123456789012345LL);
+    EXPECT_EQ(loaded.getAssetInfo("sounds/music.ogg")->modifiedTime, 0);
+    EXPECT_EQ(loaded.getAssetInfo("sounds/music.ogg")->checksum, "checksum2");
+    
+    auto paths = loaded.getAssetPaths();
+    std::sort(paths.begin(), paths.end());
+    EXPECT_EQ(paths, (std::vector<std::string>{"sounds/music.ogg", "sprites/player.png"}));
+}
+
+TEST_F(AssetManifestTest, LoadsManifestsWithoutModificationTimes) {
+    auto manifestPath = tempPath / "old_manifest.json";
+    std::ofstream(manifestPath) << "{\n"
+        "  \"version\": 2,\n"
+        "  \"assets\": [\n"
+        "    {\n"
+        "      \"path\": \"a.png\",\n"
+        "      \"size\": 10,\n"
+        "      \"checksum\": \"x\",\n"
+        "      \"type\": \"sprite\",\n"
+        "      \"version\": 1\n"
+        "    },\n"
+        "    {\n"
+        "      \"path\": \"b.wav\",\n"
+        "      \"size\": 20,\n"
+        "      \"checksum\": \"y\",\n"
+        "      \"type\": \"sound\",\n"
+        "      \"version\": 1\n"
+        "    }\n"
+        "  ]\n"
+        "}\n";
+    
+    AssetManifest loaded;
+    ASSERT_TRUE(loaded.load(manifestPath.string()));
+    EXPECT_EQ(loaded.getVersion(), 2);
+    ASSERT_EQ(loaded.getAssetCount(), 2);
+    EXPECT_EQ(loaded.getAssetInfo("a.png")->modifiedTime, 0);
+    EXPECT_EQ(loaded.getAssetInfo("b.wav")->size, 20u);
+}
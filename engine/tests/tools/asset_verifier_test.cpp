@@ -93,4 +93,37 @@ TEST_F(AssetVerifierTest, GenerateChecksumManifest) {
     
     // Verify manifest integrity
     EXPECT_TRUE(verifier.validateManifest(manifest));
-}
\ No newline at end of file
+}
+
+TEST_F(AssetVerifierTest, ChecksumsSeeReorderedBytes) {
+    AssetVerifier verifier;
+    fs::path file = extractedPath / "data/global/ui/panel/invchar6.dc6";
+    auto before = verifier.generateChecksumManifest(extractedPath.string());
+    
+    // Swap two bytes: same size and same byte sum
+    {
+        std::fstream out(file, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(10);
+        out.put(static_cast<char>(11));
+        out.put(static_cast<char>(10));
+    }
+    auto after = verifier.generateChecksumManifest(extractedPath.string());
+    
+    ASSERT_EQ(before.fileCount, after.fileCount);
+    EXPECT_NE(before.fileChecksums["data/global/ui/panel/invchar6.dc6"],
+              after.fileChecksums["data/global/ui/panel/invchar6.dc6"]);
+    EXPECT_EQ(before.fileChecksums["data/global/sfx/cursor/button.wav"],
+              after.fileChecksums["data/global/sfx/cursor/button.wav"]);
+    EXPECT_NE(before.manifestChecksum, after.manifestChecksum);
+    
+    // The manifest checksum does not depend on map order
+    ChecksumManifest copy;
+    copy.fileCount = after.fileCount;
+    copy.manifestChecksum = after.manifestChecksum;
+    copy.fileChecksums.rehash(64);
+    copy.fileChecksums.insert(after.fileChecksums.begin(), after.fileChecksums.end());
+    EXPECT_TRUE(verifier.validateManifest(copy));
+    
+    copy.fileChecksums["data/global/sfx/cursor/button.wav"] = "0000000000000000";
+    EXPECT_FALSE(verifier.validateManifest(copy));
+}
@@ -4,6 +4,7 @@
 #include <filesystem>
 #include <fstream>
 #include <vector>
+#include <chrono>
 
 namespace fs = std::filesystem;
 using namespace d2;
@@ -90,4 +91,40 @@ TEST_F(DifferentialExtractorProperTest, DetectChangedExtractedAssets) {
     EXPECT_EQ(changes.deletedFiles.size(), 1);
     EXPECT_TRUE(changes.hasFile("sounds/effects/sword_hit.wav"));
     EXPECT_EQ(changes.changeType("sounds/effects/sword_hit.wav"), ChangeType::DELETED);
-}
\ No newline at end of file
+}
+
+TEST_F(DifferentialExtractorProperTest, SkipsFilesWithUnchangedSizeAndTime) {
+    DifferentialExtractor extractor;
+    
+    fs::path barbarian = extractedPath / "sprites" / "characters" / "barbarian.dc6";
+    fs::path skeleton = extractedPath / "sprites" / "monsters" / "skeleton.dc6";
+    fs::path sword = extractedPath / "sounds" / "effects" / "sword_hit.wav";
+    
+    // Files written just now are hashed again next time, however they look
+    auto fresh = extractor.generateManifest(extractedPath.string());
+    EXPECT_EQ(fresh->getAssetInfo("sprites/characters/barbarian.dc6")->modifiedTime, 0);
+    
+    // Settled files keep their modification time in the manifest
+    auto lastHour = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    for (const auto& path : {barbarian, skeleton, sword}) {
+        fs::last_write_time(path, lastHour);
+    }
+    auto manifest = extractor.generateManifest(extractedPath.string());
+    EXPECT_NE(manifest->getAssetInfo("sprites/characters/barbarian.dc6")->modifiedTime, 0);
+    EXPECT_EQ(extractor.detectChangesInExtractedAssets(extractedPath.string(), *manifest).modifiedFiles.size(), 0u);
+    
+    // Same size and time: taken as unchanged without reading the file
+    modifyTestAsset(barbarian, "barb_data_v9");
+    fs::last_write_time(barbarian, lastHour);
+    
+    // Same size, new time: hashed, and the new content is seen
+    modifyTestAsset(skeleton, "skel_data_v2");
+    
+    // Touched but identical content is still unchanged
+    modifyTestAsset(sword, "sword_sound_v1");
+    
+    auto changes = extractor.detectChangesInExtractedAssets(extractedPath.string(), *manifest);
+    EXPECT_EQ(changes.modifiedFiles, std::vector<std::string>{"sprites/monsters/skeleton.dc6"});
+    EXPECT_TRUE(changes.addedFiles.empty());
+    EXPECT_TRUE(changes.deletedFiles.empty());
+}
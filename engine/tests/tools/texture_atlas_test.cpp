@@ -1,11 +1,14 @@
 #include <gtest/gtest.h>
 #include "tools/texture_atlas_generator.h"
+#include "dc6_test_data.h"
 #include <filesystem>
 #include <fstream>
 #include <vector>
+#include <random>
 
 namespace fs = std::filesystem;
 using namespace d2;
+using namespace d2::test;
 
 class TextureAtlasTest : public ::testing::Test {
 protected:
@@ -33,10 +36,17 @@ protected:
         // For now, just create a file with expected size
         std::ofstream file(path, std::ios::binary);
         
-        // Simple PNG header (this is a simplified version for testing)
+        // PNG signature and IHDR chunk; the generator reads the size from it
         std::vector<uint8_t> header = {
-            0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A
+            0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A,
+            0x00, 0x00, 0x00, 0x0D, 'I', 'H', 'D', 'R'
         };
+        for (int value : {width, height}) {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                header.push_back(static_cast<uint8_t>(value >> shift));
+            }
+        }
+        header.insert(header.end(), {8, 6, 0, 0, 0, 0, 0, 0, 0});
         file.write(reinterpret_cast<const char*>(header.data()), header.size());
         
         // Add some dummy data proportional to dimensions
@@ -46,6 +56,42 @@ protected:
         file.close();
     }
     
+    // DC6 with uncompressed frames; every frame is a solid block of
+    // palette index 9 at (left, top) inside the frame
+    void createDC6Sprite(const fs::path& path, uint32_t directions, uint32_t frames,
+                         uint32_t width, uint32_t height, uint32_t left, uint32_t top,
+                         uint32_t blockWidth, uint32_t blockHeight) {
+        std::vector<DC6TestFrame> dc6Frames;
+        for (uint32_t i = 0; i < directions * frames; i++) {
+            dc6Frames.push_back(rawDC6Frame(width, height, [&](uint32_t x, uint32_t y) {
+                bool inside = x >= left && x < left + blockWidth && y >= top && y < top + blockHeight;
+                return inside ? 9 : 0;
+            }));
+            dc6Frames.back().offsetX = static_cast<int32_t>(i);
+        }
+        writeDC6(path, buildDC6(directions, dc6Frames));
+    }
+    
+    // Checks that no two sprites on a page overlap and all lie inside it
+    void expectValidLayout(const TextureAtlas& atlas, const std::vector<std::string>& names) {
+        for (size_t i = 0; i < names.size(); ++i) {
+            auto a = atlas.getSpriteInfo(names[i]);
+            ASSERT_NE(a, nullptr) << names[i];
+            EXPECT_LE(a->x + a->width, atlas.getPageWidth(a->page)) << names[i];
+            EXPECT_LE(a->y + a->height, atlas.getPageHeight(a->page)) << names[i];
+            for (size_t j = i + 1; j < names.size(); ++j) {
+                auto b = atlas.getSpriteInfo(names[j]);
+                ASSERT_NE(b, nullptr);
+                if (a->page != b->page) {
+                    continue;
+                }
+                bool apart = a->x + a->width <= b->x || b->x + b->width <= a->x ||
+                             a->y + a->height <= b->y || b->y + b->height <= a->y;
+                EXPECT_TRUE(apart) << names[i] << " overlaps " << names[j];
+            }
+        }
+    }
+    
     fs::path inputPath;
     fs::path outputPath;
 };
@@ -163,4 +209,254 @@ TEST_F(TextureAtlasTest, PowerOfTwoTextures) {
         std::string spriteName = "medium_sprite_" + std::to_string(i) + ".png";
         EXPECT_TRUE(atlas.hasSprite(spriteName));
     }
-}
\ No newline at end of file
+}
+
+TEST_F(TextureAtlasTest, ReadsDimensionsFromFileHeaders) {
+    TextureAtlasGenerator generator;
+    
+    // The name says nothing about the size
+    createMockSprite(inputPath / "hero.png", 100, 37);
+    auto atlas = generator.generateAtlas({(inputPath / "hero.png").string()}, 256, 256);
+    
+    auto info = atlas.getSpriteInfo("hero.png");
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->width, 100);
+    EXPECT_EQ(info->height, 37);
+    EXPECT_EQ(info->sourceWidth, 100);
+    
+    // Power-of-two pages are only as large as their contents need
+    EXPECT_EQ(atlas.getPageWidth(0), 128);
+    EXPECT_EQ(atlas.getPageHeight(0), 64);
+}
+
+TEST_F(TextureAtlasTest, PacksTrimmedDC6Frames) {
+    TextureAtlasGenerator generator;
+    std::vector<uint32_t> palette(256, 0);
+    palette[9] = 0xFF0000FF;
+    generator.setPalette(palette);
+    
+    createDC6Sprite(inputPath / "torch.dc6", 2, 3, 40, 60, 12, 20, 8, 16);
+    auto atlas = generator.generateAtlas({(inputPath / "torch.dc6").string()}, 256, 256);
+    ASSERT_TRUE(atlas.isValid());
+    EXPECT_EQ(atlas.getSpriteCount(), 6u);
+    
+    std::vector<std::string> names;
+    for (int d = 0; d < 2; ++d) {
+        for (int f = 0; f < 3; ++f) {
+            names.push_back(TextureAtlas::frameName("torch.dc6", d, f));
+        }
+    }
+    EXPECT_EQ(names[0], "torch.dc6");
+    EXPECT_EQ(names[4], "torch.dc6:1:1");
+    expectValidLayout(atlas, names);
+    
+    // Only the visible block is packed, with the offsets needed to place it
+    auto info = atlas.getSpriteInfo(names[4]);
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->width, 8);
+    EXPECT_EQ(info->height, 16);
+    EXPECT_EQ(info->trimX, 12);
+    EXPECT_EQ(info->trimY, 20);
+    EXPECT_EQ(info->sourceWidth, 40);
+    EXPECT_EQ(info->sourceHeight, 60);
+    EXPECT_EQ(info->offsetX, 4);
+    
+    const std::vector<uint8_t>* pixels = atlas.getPagePixels(info->page);
+    ASSERT_NE(pixels, nullptr);
+    size_t corner = (static_cast<size_t>(info->y) * atlas.getPageWidth(info->page) + info->x) * 4;
+    EXPECT_EQ((*pixels)[corner + 0], 0xFF);
+    EXPECT_EQ((*pixels)[corner + 3], 0xFF);
+}
+
+TEST_F(TextureAtlasTest, SpillsOntoMultiplePages) {
+    TextureAtlasGenerator generator;
+    
+    // With padding, four 200x200 sprites fit on a 512x512 page
+    std::vector<std::string> sprites;
+    std::vector<std::string> names;
+    for (int i = 0; i < 10; ++i) {
+        std::string name = "big_" + std::to_string(i) + ".png";
+        createMockSprite(inputPath / name, 200, 200);
+        sprites.push_back((inputPath / name).string());
+        names.push_back(name);
+    }
+    
+    auto atlas = generator.generateAtlas(sprites, 512, 512);
+    ASSERT_TRUE(atlas.isValid());
+    EXPECT_EQ(atlas.getPageCount(), 3);
+    expectValidLayout(atlas, names);
+    
+    // A sprite larger than a page is left out
+    createMockSprite(inputPath / "huge.png", 600, 10);
+    sprites.push_back((inputPath / "huge.png").string());
+    atlas = generator.generateAtlas(sprites, 512, 512);
+    EXPECT_FALSE(atlas.hasSprite("huge.png"));
+    EXPECT_EQ(atlas.getSpriteCount(), 10u);
+}
+
+TEST_F(TextureAtlasTest, PackingIsDenseAndDeterministic) {
+    std::mt19937 rng(5);
+    std::vector<std::string> sprites;
+    std::vector<std::string> names;
+    uint64_t spriteArea = 0;
+    for (int i = 0; i < 120; ++i) {
+        int width = 8 + static_cast<int>(rng() % 90);
+        int height = 8 + static_cast<int>(rng() % 90);
+        std::string name = "random_" + std::to_string(i) + ".png";
+        createMockSprite(inputPath / name, width, height);
+        sprites.push_back((inputPath / name).string());
+        names.push_back(name);
+        spriteArea += static_cast<uint64_t>(width + 2) * (height + 2);
+    }
+    
+    TextureAtlasGenerator serial;
+    serial.setThreadCount(1);
+    serial.setPowerOfTwo(false);
+    TextureAtlasGenerator parallel;
+    parallel.setThreadCount(8);
+    parallel.setPowerOfTwo(false);
+    
+    auto a = serial.generateAtlas(sprites, 1024, 1024);
+    auto b = parallel.generateAtlas(sprites, 1024, 1024);
+    ASSERT_TRUE(a.isValid());
+    expectValidLayout(a, names);
+    
+    // Trials run on any number of threads pick the same layout
+    for (const auto& name : names) {
+        auto x = a.getSpriteInfo(name);
+        auto y = b.getSpriteInfo(name);
+        ASSERT_NE(y, nullptr);
+        EXPECT_EQ(x->page, y->page);
+        EXPECT_EQ(x->x, y->x);
+        EXPECT_EQ(x->y, y->y);
+    }
+    
+    uint64_t pageArea = 0;
+    for (int page = 0; page < a.getPageCount(); ++page) {
+        pageArea += static_cast<uint64_t>(a.getPageWidth(page)) * a.getPageHeight(page);
+    }
+    double occupancy = static_cast<double>(spriteArea) / static_cast<double>(pageArea);
+    EXPECT_GT(occupancy, 0.85);
+}
+
+TEST_F(TextureAtlasTest, SavesPagesAndBinaryMap) {
+    TextureAtlasGenerator generator;
+    std::vector<uint32_t> palette(256, 0);
+    palette[9] = 0xFF336699;
+    generator.setPalette(palette);
+    createDC6Sprite(inputPath / "gem.dc6", 1, 2, 16, 16, 2, 3, 10, 7);
+    createMockSprite(inputPath / "sprite4.png", 30, 20);
+    
+    auto atlas = generator.generateAtlas({(inputPath / "gem.dc6").string(),
+                                          (inputPath / "sprite4.png").string()}, 128, 128);
+    ASSERT_TRUE(atlas.isValid());
+    std::string base = (outputPath / "items").string();
+    ASSERT_TRUE(generator.saveAtlas(atlas, base));
+    ASSERT_TRUE(fs::exists(base + ".atlas"));
+    ASSERT_TRUE(fs::exists(base + "_0.png"));
+    
+    TextureAtlas loaded;
+    ASSERT_TRUE(loaded.loadFromFile(base + ".atlas"));
+    EXPECT_EQ(loaded.getPageCount(), atlas.getPageCount());
+    EXPECT_EQ(loaded.getPageWidth(0), atlas.getPageWidth(0));
+    EXPECT_EQ(loaded.getSpriteCount(), atlas.getSpriteCount());
+    EXPECT_EQ(loaded.getPagePixels(0), nullptr);
+    for (const auto& name : {std::string("gem.dc6"), std::string("gem.dc6:0:1"), std::string("sprite4.png")}) {
+        auto expected = atlas.getSpriteInfo(name);
+        auto actual = loaded.getSpriteInfo(name);
+        ASSERT_NE(expected, nullptr);
+        ASSERT_NE(actual, nullptr);
+        EXPECT_EQ(actual->x, expected->x);
+        EXPECT_EQ(actual->y, expected->y);
+        EXPECT_EQ(actual->width, expected->width);
+        EXPECT_EQ(actual->trimX, expected->trimX);
+        EXPECT_EQ(actual->offsetX, expected->offsetX);
+    }
+    
+    // The page image is a real PNG: packing it again decodes the same pixels
+    auto repacked = generator.generateAtlas({base + "_0.png"}, 512, 512);
+    ASSERT_TRUE(repacked.isValid());
+    ASSERT_NE(repacked.getPagePixels(0), nullptr);
+    auto page = repacked.getSpriteInfo("items_0.png");
+    ASSERT_NE(page, nullptr);
+    EXPECT_EQ(page->width, atlas.getPageWidth(0));
+    auto gem = atlas.getSpriteInfo("gem.dc6");
+    size_t original = (static_cast<size_t>(gem->y) * atlas.getPageWidth(0) + gem->x) * 4;
+    size_t decoded = (static_cast<size_t>(page->y + gem->y) * repacked.getPageWidth(0) + page->x + gem->x) * 4;
+    for (int channel = 0; channel < 4; ++channel) {
+        EXPECT_EQ((*repacked.getPagePixels(0))[decoded + channel], (*atlas.getPagePixels(0))[original + channel]);
+    }
+    
+    std::ofstream(outputPath / "broken.atlas") << "not an atlas";
+    EXPECT_FALSE(loaded.loadFromFile((outputPath / "broken.atlas").string()));
+}
+
+TEST_F(TextureAtlasTest, BakesTheSameFilesPageByPage) {
+    TextureAtlasGenerator generator;
+    std::vector<uint32_t> palette(256, 0);
+    palette[9] = 0xFF336699;
+    generator.setPalette(palette);
+    std::vector<std::string> sprites;
+    for (int i = 0; i < 6; ++i) {
+        std::string name = "frames_" + std::to_string(i) + ".dc6";
+        createDC6Sprite(inputPath / name, 2, 3, 60 + i * 7, 50, 3, 4, 50 + i * 7, 40);
+        sprites.push_back((inputPath / name).string());
+    }
+    
+    auto atlas = generator.generateAtlas(sprites, 256, 256);
+    ASSERT_TRUE(atlas.isValid());
+    ASSERT_GT(atlas.getPageCount(), 1);
+    std::string saved = (outputPath / "saved").string();
+    ASSERT_TRUE(generator.saveAtlas(atlas, saved));
+    
+    TextureAtlas baked;
+    std::string bakedBase = (outputPath / "baked").string();
+    ASSERT_TRUE(generator.bakeAtlas(sprites, 256, 256, bakedBase, baked));
+    ASSERT_TRUE(baked.isValid());
+    EXPECT_EQ(baked.getPageCount(), atlas.getPageCount());
+    EXPECT_EQ(baked.getSpriteCount(), atlas.getSpriteCount());
+    EXPECT_EQ(baked.getPagePixels(0), nullptr);
+    
+    auto read = [](const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+    EXPECT_EQ(read(bakedBase + ".atlas"), read(saved + ".atlas"));
+    for (int page = 0; page < atlas.getPageCount(); ++page) {
+        std::string suffix = "_" + std::to_string(page) + ".png";
+        ASSERT_TRUE(fs::exists(bakedBase + suffix));
+        EXPECT_EQ(read(bakedBase + suffix), read(saved + suffix)) << "page " << page;
+    }
+    
+    // Nothing to pack writes nothing
+    TextureAtlas empty;
+    EXPECT_TRUE(generator.bakeAtlas({(inputPath / "missing.dc6").string()}, 256, 256,
+                                    (outputPath / "none").string(), empty));
+    EXPECT_FALSE(empty.isValid());
+    EXPECT_FALSE(fs::exists(outputPath / "none.atlas"));
+}
+
+TEST_F(TextureAtlasTest, BlankFramesOnlyGetOneEmptyPage) {
+    TextureAtlasGenerator generator;
+    createDC6Sprite(inputPath / "blank.dc6", 1, 3, 20, 10, 0, 0, 0, 0);
+    
+    // Every frame trims away, but the map still needs a page to point at
+    TextureAtlas baked;
+    std::string base = (outputPath / "blank").string();
+    ASSERT_TRUE(generator.bakeAtlas({(inputPath / "blank.dc6").string()}, 256, 256, base, baked));
+    ASSERT_TRUE(baked.isValid());
+    ASSERT_EQ(baked.getPageCount(), 1);
+    EXPECT_EQ(baked.getPageWidth(0), 1);
+    EXPECT_EQ(baked.getPageHeight(0), 1);
+    EXPECT_TRUE(fs::exists(base + "_0.png"));
+    
+    TextureAtlas loaded;
+    ASSERT_TRUE(loaded.loadFromFile(base + ".atlas"));
+    EXPECT_EQ(loaded.getPageCount(), 1);
+    EXPECT_EQ(loaded.getSpriteCount(), 3u);
+    auto frame = loaded.getSpriteInfo("blank.dc6:0:2");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->page, 0);
+    EXPECT_EQ(frame->width, 0);
+    EXPECT_EQ(frame->sourceWidth, 20);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include "utils/content_hash.h"
+
+namespace fs = std::filesystem;
+using d2::utils::ContentHash;
+
+class ContentHashTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        tempDir_ = fs::temp_directory_path() / "content_hash_test";
+        fs::create_directories(tempDir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(tempDir_);
+    }
+
+    std::string writeFile(const std::string& name, const std::string& content) {
+        fs::path path = tempDir_ / name;
+        std::ofstream(path, std::ios::binary) << content;
+        return path.string();
+    }
+
+    fs::path tempDir_;
+};
+
+TEST_F(ContentHashTest, MatchesReferenceVectors) {
+    // Published XXH64 values, covering the short path and the 32-byte stripes
+    EXPECT_EQ(ContentHash::hash(nullptr, 0), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(ContentHash::hash("a", 1), 0xD24EC4F1A98C6E5BULL);
+    EXPECT_EQ(ContentHash::hash("abc", 3), 0x44BC2CF5AD770999ULL);
+    std::string sentence = "Nobody inspects the spammish repetition";
+    EXPECT_EQ(ContentHash::hash(sentence.data(), sentence.size()), 0xFBCEA83C8A378BF1ULL);
+
+    EXPECT_NE(ContentHash::hash("abc", 3, 1), ContentHash::hash("abc", 3));
+    EXPECT_EQ(ContentHash::toHex(0xEF46DB3751D8E999ULL), "ef46db3751d8e999");
+    EXPECT_EQ(ContentHash::toHex(0x2A), "000000000000002a");
+}
+
+TEST_F(ContentHashTest, SeesReorderedBytes) {
+    // A byte sum cannot tell these apart
+    std::string first = "sprites/characters/barbarian.dc6";
+    std::string second = "sprites/characters/barbarain.dc6";
+    EXPECT_NE(ContentHash::hash(first.data(), first.size()), ContentHash::hash(second.data(), second.size()));
+}
+
+TEST_F(ContentHashTest, HashesFilesInParallel) {
+    std::vector<std::string> paths;
+    std::vector<std::string> contents;
+    for (int i = 0; i < 50; i++) {
+        contents.push_back(std::string(static_cast<size_t>(i) * 37, static_cast<char>('a' + i % 26)) + std::to_string(i));
+        paths.push_back(writeFile("file" + std::to_string(i) + ".bin", contents.back()));
+    }
+    contents.push_back("");
+    paths.push_back(writeFile("empty.bin", ""));
+    paths.push_back((tempDir_ / "missing.bin").string());
+
+    auto hashes = ContentHash::hashFiles(paths, 4);
+    ASSERT_EQ(hashes.size(), paths.size());
+    for (size_t i = 0; i < contents.size(); i++) {
+        EXPECT_EQ(hashes[i], ContentHash::toHex(ContentHash::hash(contents[i].data(), contents[i].size()))) << paths[i];
+    }
+    EXPECT_TRUE(hashes.back().empty());
+
+    EXPECT_EQ(ContentHash::hashFiles(paths, 1), hashes);
+
+    uint64_t value = 0;
+    EXPECT_FALSE(ContentHash::hashFile((tempDir_ / "missing.bin").string(), value));
+}
+
+TEST_F(ContentHashTest, BenchmarkHashFiles) {
+    // 32 files of 2 MB, about the size of the larger extracted sprite sheets
+    const size_t fileSize = 2 * 1024 * 1024;
+    std::vector<std::string> paths;
+    std::string content(fileSize, '\0');
+    for (int i = 0; i < 32; i++) {
+        for (size_t b = 0; b < content.size(); b++) {
+            content[b] = static_cast<char>((b * 131 + i) >> 3);
+        }
+        paths.push_back(writeFile("asset" + std::to_string(i) + ".dc6", content));
+    }
+
+    // The byte sum through an ifstream that the asset verifier used
+    auto start = std::chrono::high_resolution_clock::now();
+    unsigned long sum = 0;
+    for (const auto& path : paths) {
+        std::ifstream file(path, std::ios::binary);
+        char byte;
+        while (file.get(byte)) {
+            sum += static_cast<unsigned char>(byte);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto sum_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    auto single = ContentHash::hashFiles(paths, 1);
+    end = std::chrono::high_resolution_clock::now();
+    auto single_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    auto parallel = ContentHash::hashFiles(paths);
+    end = std::chrono::high_resolution_clock::now();
+    auto parallel_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    EXPECT_EQ(single, parallel);
+    EXPECT_NE(sum, 0u);
+
+    std::cout << "Hashing " << paths.size() * fileSize / (1024 * 1024) << " MB:" << std::endl;
+    std::cout << "  byte sum via ifstream: " << sum_ms << " ms" << std::endl;
+    std::cout << "  XXH64, one thread:     " << single_ms << " ms" << std::endl;
+    std::cout << "  XXH64, all threads:    " << parallel_ms << " ms" << std::endl;
+}
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include <string>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <filesystem>
+#include <fstream>
 #include "utils/data_table_parser.h"
 
 class DataTableParserTest : public ::testing::Test {
@@ -71,4 +77,472 @@ TEST_F(DataTableParserTest, HandlesQuotedStrings) {
     auto row1 = table.findRow("id", "1");
     EXPECT_EQ(row1["text"], "Hello, world!");
     EXPECT_EQ(row1["description"], "This is a test");
-}
\ No newline at end of file
+}
+
+TEST_F(DataTableParserTest, DetectsColumnTypes) {
+    std::string data = "name\tlevel\tspeed\tcode\tblank\n";
+    data += "Zombie\t1\t0.5\tzm1\t\n";
+    data += "Skeleton\t-3\t1.25\t12\t\n";
+    data += "Wraith\t\t2\tw1\t\n";
+    
+    auto table = parser_->parseExcel(data);
+    using ColumnType = d2::utils::DataTable::ColumnType;
+    
+    ASSERT_EQ(table.getColumnCount(), 5u);
+    EXPECT_EQ(table.getColumnType(table.getColumn("name")), ColumnType::STRING);
+    EXPECT_EQ(table.getColumnType(table.getColumn("level")), ColumnType::INT);
+    EXPECT_EQ(table.getColumnType(table.getColumn("speed")), ColumnType::FLOAT);
+    EXPECT_EQ(table.getColumnType(table.getColumn("code")), ColumnType::STRING);
+    EXPECT_EQ(table.getColumnType(table.getColumn("blank")), ColumnType::INT);
+}
+
+TEST_F(DataTableParserTest, ReadsCellsThroughColumnHandles) {
+    std::string data = "name\tlevel\tspeed\tdamage\n";
+    data += "Zombie\t1\t0.5\t2-7\n";
+    data += "Skeleton\t-3\t1.25\tx\n";
+    data += "Wraith\t\t2\t\n";
+    
+    auto table = parser_->parseExcel(data);
+    auto name = table.getColumn("name");
+    auto level = table.getColumn("level");
+    auto speed = table.getColumn("speed");
+    auto damage = table.getColumn("damage");
+    ASSERT_TRUE(name.isValid());
+    EXPECT_FALSE(table.getColumn("missing").isValid());
+    EXPECT_EQ(table.getColumnName(speed), "speed");
+    
+    EXPECT_EQ(table.getString(1, name), "Skeleton");
+    EXPECT_EQ(table.getInt(1, level), -3);
+    EXPECT_EQ(table.getInt(2, level), 0);
+    EXPECT_FLOAT_EQ(table.getFloat(1, speed), 1.25f);
+    EXPECT_EQ(table.getInt(0, speed), 0);
+    EXPECT_EQ(table.getInt(2, speed), 2);
+    EXPECT_FLOAT_EQ(table.getFloat(0, level), 1.0f);
+    
+    // Text columns read their leading number, like getIntValue
+    EXPECT_EQ(table.getInt(0, damage), 2);
+    EXPECT_EQ(table.getInt(1, damage), 0);
+    EXPECT_EQ(table.getString(0, damage), "2-7");
+    
+    // Invalid handles and rows read as empty
+    EXPECT_EQ(table.getInt(0, table.getColumn("missing")), 0);
+    EXPECT_EQ(table.getString(9, name), "");
+}
+
+TEST_F(DataTableParserTest, KeepsExactTextOfNumericCells) {
+    std::string data = "name\tlevel\tpadded\tspeed\tratio\n";
+    data += "Zombie\t1\t08\t0.5\t1.50\n";
+    data += "Skeleton\t\t9\t\t2\n";
+    data += "Wraith\t-12\t10\t1.25\t0.5\n";
+    
+    auto table = parser_->parseExcel(data);
+    auto level = table.getColumn("level");
+    auto padded = table.getColumn("padded");
+    auto speed = table.getColumn("speed");
+    auto ratio = table.getColumn("ratio");
+    
+    EXPECT_EQ(table.getString(0, level), "1");
+    EXPECT_EQ(table.getString(1, level), "");
+    EXPECT_EQ(table.getString(2, level), "-12");
+    EXPECT_EQ(table.getString(0, padded), "08");
+    EXPECT_EQ(table.getInt(0, padded), 8);
+    EXPECT_EQ(table.getString(0, speed), "0.5");
+    EXPECT_EQ(table.getString(1, speed), "");
+    EXPECT_EQ(table.getString(0, ratio), "1.50");
+    EXPECT_EQ(table.getString(1, ratio), "2");
+    EXPECT_FLOAT_EQ(table.getFloat(0, ratio), 1.5f);
+    EXPECT_EQ(table.findRowIndex(level, "-12"), 2u);
+    EXPECT_EQ(table.findRowIndex(speed, ""), 1u);
+    EXPECT_EQ(table.getRow(2)["speed"], "1.25");
+}
+
+TEST_F(DataTableParserTest, HandlesLineEndingsAndShortRows) {
+    std::string data = "name\tlevel\tcode\r\n";
+    data += "Zombie\t1\tzm1\r\n";
+    data += "\r\n";
+    data += "Skeleton\t4\r\n";
+    data += "Wraith\t7\tw1\textra";
+    
+    auto table = parser_->parseExcel(data);
+    auto name = table.getColumn("name");
+    auto level = table.getColumn("level");
+    auto code = table.getColumn("code");
+    
+    ASSERT_EQ(table.getRowCount(), 3u);
+    EXPECT_EQ(table.getString(0, code), "zm1");
+    EXPECT_EQ(table.getString(1, name), "Skeleton");
+    EXPECT_EQ(table.getString(1, code), "");
+    EXPECT_EQ(table.getInt(2, level), 7);
+    EXPECT_EQ(table.getString(2, code), "w1");
+    
+    auto skeleton = table.getRow(1);
+    EXPECT_EQ(skeleton["level"], "4");
+    EXPECT_EQ(skeleton.count("code"), 1u);
+}
+
+TEST_F(DataTableParserTest, FindsRowIndexByValue) {
+    std::string data = "name\tcode\n";
+    data += "Zombie\tzm1\n";
+    data += "Skeleton\tsk1\n";
+    data += "Zombie\tzm2\n";
+    
+    auto table = parser_->parseExcel(data);
+    auto name = table.getColumn("name");
+    
+    EXPECT_EQ(table.findRowIndex(name, "Zombie"), 0u);
+    EXPECT_EQ(table.findRowIndex(name, "Skeleton"), 1u);
+    EXPECT_EQ(table.findRowIndex(name, "Fallen"), d2::utils::DataTable::kNoRow);
+    EXPECT_EQ(table.findRowIndex(table.getColumn("missing"), "Zombie"), d2::utils::DataTable::kNoRow);
+}
+
+TEST_F(DataTableParserTest, BenchmarkWideTable) {
+    // A MonStats-sized table: 200 columns, 4000 rows, mostly small numbers
+    const int columns = 200;
+    const int rows = 4000;
+    std::string data;
+    for (int c = 0; c < columns; c++) {
+        data += (c ? "\t" : "") + std::string("column") + std::to_string(c);
+    }
+    data += "\n";
+    for (int r = 0; r < rows; r++) {
+        data += "monster" + std::to_string(r);
+        for (int c = 1; c < columns; c++) {
+            data += "\t";
+            if (c % 10 == 1) {
+                data += "code" + std::to_string(r % 50);
+            } else if (c % 10 == 2) {
+                data += std::to_string(r % 7) + ".5";
+            } else if (c % 3 != 0) {
+                data += std::to_string((r * c) % 100);
+            }
+        }
+        data += "\n";
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    auto table = parser_->parseExcel(data);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto parse_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    
+    ASSERT_EQ(table.getRowCount(), static_cast<size_t>(rows));
+    ASSERT_EQ(table.getColumnCount(), static_cast<size_t>(columns));
+    
+    // Read one integer column of every row through a handle
+    auto column = table.getColumn("column5");
+    start = std::chrono::high_resolution_clock::now();
+    long long sum = 0;
+    for (size_t row = 0; row < table.getRowCount(); row++) {
+        sum += table.getInt(row, column);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto read_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    EXPECT_GT(sum, 0);
+    
+    std::cout << "Data table benchmark (" << columns << " columns x " << rows << " rows):" << std::endl;
+    std::cout << "  Text size: " << data.size() / 1024 << " KB" << std::endl;
+    std::cout << "  Parse time: " << parse_ms << " ms" << std::endl;
+    std::cout << "  Table memory: " << table.getMemoryUsage() / 1024 << " KB" << std::endl;
+    std::cout << "  Column read: " << read_us << " us" << std::endl;
+    
+    // A map per row holds at least a name and a value string per cell;
+    // typed columns take an order of magnitude less
+    size_t row_map_bytes = static_cast<size_t>(rows) * columns * 2 * sizeof(std::string);
+    std::cout << "  Row map lower bound: " << row_map_bytes / 1024 << " KB" << std::endl;
+    EXPECT_LT(table.getMemoryUsage() * 10, row_map_bytes);
+}
+
+TEST_F(DataTableParserTest, IndexesUniqueAndRepeatedValues) {
+    std::string data = "Id\tcode\tlevel\n";
+    data += "zombie\tzm\t1\n";
+    data += "skeleton\tsk\t3\n";
+    data += "zombie2\tzm\t\n";
+    data += "wraith\twr\t3\n";
+    data += "zombie3\tzm\t1\n";
+    
+    auto table = parser_->parseExcel(data);
+    auto id = table.getColumn("Id");
+    auto code = table.getColumn("code");
+    auto level = table.getColumn("level");
+    
+    EXPECT_TRUE(table.isUniqueColumn(id));
+    EXPECT_FALSE(table.isUniqueColumn(code));
+    EXPECT_FALSE(table.isUniqueColumn(table.getColumn("missing")));
+    EXPECT_EQ(table.findRowIndex(id, "wraith"), 3u);
+    
+    auto zombies = table.findRows(code, "zm");
+    ASSERT_EQ(zombies.size(), 3u);
+    EXPECT_EQ(zombies[0], 0u);
+    EXPECT_EQ(zombies[1], 2u);
+    EXPECT_EQ(zombies[2], 4u);
+    EXPECT_TRUE(table.findRows(code, "fa").empty());
+    
+    // Numeric columns are looked up by their text, blanks included
+    std::vector<size_t> level3(table.findRows(level, "3").begin(), table.findRows(level, "3").end());
+    EXPECT_EQ(level3, (std::vector<size_t>{1, 3}));
+    EXPECT_EQ(table.findRowIndex(level, ""), 2u);
+    EXPECT_EQ(table.findRowIndex(level, "03"), d2::utils::DataTable::kNoRow);
+    
+    // Copies share the indexes already built
+    auto copy = table;
+    EXPECT_EQ(copy.findRows(code, "zm").begin(), zombies.begin());
+    EXPECT_EQ(copy.findRow("Id", "skeleton")["code"], "sk");
+}
+
+TEST_F(DataTableParserTest, LooksUpFromSeveralThreads) {
+    std::string data = "Id\tindex\n";
+    for (int row = 0; row < 500; row++) {
+        data += "monster" + std::to_string(row) + "\t" + std::to_string(row) + "\n";
+    }
+    auto table = parser_->parseExcel(data);
+    auto id = table.getColumn("Id");
+    auto index = table.getColumn("index");
+    
+    std::vector<int> mismatches(4, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 500; i++) {
+                int row = (i * 7 + t * 13) % 500;
+                size_t found = table.findRowIndex(id, "monster" + std::to_string(row));
+                if (found != static_cast<size_t>(row) || table.getInt(found, index) != row) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int count : mismatches) {
+        EXPECT_EQ(count, 0);
+    }
+}
+
+TEST_F(DataTableParserTest, BenchmarkIndexedLookups) {
+    // MonStats-sized: 250 columns, 800 rows keyed by a unique Id
+    const int columns = 250;
+    const int rows = 800;
+    std::string data = "Id\thcIdx\tBaseId";
+    for (int c = 3; c < columns; c++) {
+        data += "\tcolumn" + std::to_string(c);
+    }
+    data += "\n";
+    for (int r = 0; r < rows; r++) {
+        data += "monster" + std::to_string(r) + "\t" + std::to_string(r) + "\tbase" + std::to_string(r / 4);
+        for (int c = 3; c < columns; c++) {
+            data += "\t" + std::to_string((r + c) % 30);
+        }
+        data += "\n";
+    }
+    auto table = parser_->parseExcel(data);
+    ASSERT_EQ(table.getRowCount(), static_cast<size_t>(rows));
+    auto id = table.getColumn("Id");
+    auto base = table.getColumn("BaseId");
+    
+    const int lookups = 10000;
+    std::vector<std::string> keys;
+    std::vector<std::string> base_keys;
+    for (int i = 0; i < lookups; i++) {
+        keys.push_back("monster" + std::to_string((i * 37) % rows));
+        base_keys.push_back("base" + std::to_string(i % (rows / 4)));
+    }
+    
+    // Linear scan, as findRow used to do
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t scan_sum = 0;
+    for (const auto& key : keys) {
+        for (size_t row = 0; row < table.getRowCount(); row++) {
+            if (table.getString(row, id) == key) {
+                scan_sum += row;
+                break;
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto scan_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    
+    start = std::chrono::high_resolution_clock::now();
+    table.buildIndex(id);
+    end = std::chrono::high_resolution_clock::now();
+    auto build_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    
+    start = std::chrono::high_resolution_clock::now();
+    size_t index_sum = 0;
+    for (const auto& key : keys) {
+        index_sum += table.findRowIndex(id, key);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto index_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    
+    start = std::chrono::high_resolution_clock::now();
+    size_t multi_count = 0;
+    for (const auto& key : base_keys) {
+        multi_count += table.findRows(base, key).size();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto multi_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    
+    EXPECT_EQ(index_sum, scan_sum);
+    EXPECT_EQ(multi_count, static_cast<size_t>(lookups) * 4);
+    EXPECT_TRUE(table.isUniqueColumn(id));
+    EXPECT_FALSE(table.isUniqueColumn(base));
+    
+    std::cout << "Data table lookup benchmark (" << lookups << " lookups, " << rows << " rows):" << std::endl;
+    std::cout << "  Linear scan: " << scan_us << " us" << std::endl;
+    std::cout << "  Index build: " << build_us << " us" << std::endl;
+    std::cout << "  Unique index: " << index_us << " us" << std::endl;
+    std::cout << "  Multi-valued index: " << multi_us << " us" << std::endl;
+}
+
+namespace {
+
+// Every cell of two tables reads the same through each accessor
+void expectSameCells(const d2::utils::DataTable& a, const d2::utils::DataTable& b) {
+    ASSERT_EQ(a.getRowCount(), b.getRowCount());
+    ASSERT_EQ(a.getColumnCount(), b.getColumnCount());
+    for (size_t index = 0; index < a.getColumnCount(); index++) {
+        d2::utils::DataTable::Column column{index};
+        ASSERT_EQ(a.getColumnName(column), b.getColumnName(column));
+        ASSERT_EQ(a.getColumnType(column), b.getColumnType(column));
+        for (size_t row = 0; row < a.getRowCount(); row++) {
+            ASSERT_EQ(a.getString(row, column), b.getString(row, column)) << "row " << row << " column " << index;
+            ASSERT_EQ(a.getInt(row, column), b.getInt(row, column));
+            ASSERT_EQ(a.getFloat(row, column), b.getFloat(row, column));
+        }
+    }
+}
+
+} // namespace
+
+TEST_F(DataTableParserTest, RoundTripsThroughBinaryForm) {
+    std::string data = "name\tlevel\tpadded\tspeed\tratio\tcode\n";
+    data += "Zombie\t1\t08\t0.5\t1.50\tzm1\n";
+    data += "Skeleton\t\t9\t\t2\t\n";
+    data += "Wraith\t-12\t10\t1.25\t0.5\tw1\n";
+    auto table = parser_->parseExcel(data);
+    uint64_t hash = d2::utils::DataTableParser::hashSource(data.data(), data.size());
+    
+    auto path = (std::filesystem::temp_directory_path() / "d2_table_roundtrip.d2tbl").string();
+    ASSERT_TRUE(parser_->writeBinary(table, hash, path));
+    
+    d2::utils::DataTable loaded;
+    ASSERT_TRUE(parser_->loadBinaryFile(path, loaded, hash));
+    expectSameCells(table, loaded);
+    EXPECT_EQ(loaded.findRowIndex(loaded.getColumn("level"), "-12"), 2u);
+    EXPECT_EQ(loaded.getMemoryUsage() > 0, true);
+    
+    // A table built from other text is refused and leaves the target alone
+    d2::utils::DataTable other;
+    EXPECT_FALSE(parser_->loadBinaryFile(path, other, hash + 1));
+    EXPECT_EQ(other.getColumnCount(), 0u);
+    
+    // Empty tables round trip too
+    ASSERT_TRUE(parser_->writeBinary(parser_->parseExcel("name\tlevel\n"), 0, path));
+    ASSERT_TRUE(parser_->loadBinaryFile(path, other));
+    EXPECT_EQ(other.getColumnCount(), 2u);
+    EXPECT_EQ(other.getRowCount(), 0u);
+    std::filesystem::remove(path);
+}
+
+TEST_F(DataTableParserTest, RejectsDamagedBinaryTables) {
+    std::string data = "name\tlevel\nZombie\t1\nSkeleton\t3\n";
+    auto path = (std::filesystem::temp_directory_path() / "d2_table_damaged.d2tbl").string();
+    ASSERT_TRUE(parser_->writeBinary(parser_->parseExcel(data), 0, path));
+    
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::filesystem::remove(path);
+    
+    d2::utils::DataTable table;
+    ASSERT_TRUE(parser_->loadBinary(bytes.data(), bytes.size(), table));
+    EXPECT_FALSE(parser_->loadBinary(bytes.data(), bytes.size() - 16, table));
+    EXPECT_FALSE(parser_->loadBinary(nullptr, 0, table));
+    
+    auto bad_magic = bytes;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(parser_->loadBinary(bad_magic.data(), bad_magic.size(), table));
+    
+    auto bad_version = bytes;
+    bad_version[4] = static_cast<uint8_t>(d2::utils::kDataTableBinaryVersion + 1);
+    EXPECT_FALSE(parser_->loadBinary(bad_version.data(), bad_version.size(), table));
+    
+    // Flipping any single byte must never crash the loader
+    for (size_t i = 0; i < bytes.size(); i++) {
+        auto damaged = bytes;
+        damaged[i] ^= 0xFF;
+        d2::utils::DataTable scratch;
+        parser_->loadBinary(damaged.data(), damaged.size(), scratch);
+    }
+}
+
+TEST_F(DataTableParserTest, ParseExcelFilePrefersMatchingBinary) {
+    auto dir = std::filesystem::temp_directory_path() / "d2_table_cache_test";
+    std::filesystem::create_directories(dir);
+    auto textPath = (dir / "monstats.txt").string();
+    std::string text = "Id\tLevel\nzombie\t1\n";
+    std::ofstream(textPath, std::ios::binary) << text;
+    EXPECT_EQ(d2::utils::DataTableParser::getBinaryPath(textPath), (dir / "monstats.d2tbl").string());
+    
+    // A binary stamped with the text's hash is used instead of the text
+    uint64_t hash = d2::utils::DataTableParser::hashSource(text.data(), text.size());
+    auto marker = parser_->parseExcel("Id\tLevel\nfrom_binary\t7\n");
+    ASSERT_TRUE(parser_->writeBinary(marker, hash, d2::utils::DataTableParser::getBinaryPath(textPath)));
+    auto table = parser_->parseExcelFile(textPath);
+    EXPECT_EQ(table.getString(0, table.getColumn("Id")), "from_binary");
+    
+    // Editing the text makes the binary stale
+    std::ofstream(textPath, std::ios::binary) << "Id\tLevel\nzombie\t2\n";
+    table = parser_->parseExcelFile(textPath);
+    EXPECT_EQ(table.getString(0, table.getColumn("Id")), "zombie");
+    EXPECT_EQ(table.getInt(0, table.getColumn("Level")), 2);
+    
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(DataTableParserTest, BenchmarkBinaryLoad) {
+    // Same shape as BenchmarkWideTable
+    const int columns = 200;
+    const int rows = 4000;
+    std::string data;
+    for (int c = 0; c < columns; c++) {
+        data += (c ? "\t" : "") + std::string("column") + std::to_string(c);
+    }
+    data += "\n";
+    for (int r = 0; r < rows; r++) {
+        data += "monster" + std::to_string(r);
+        for (int c = 1; c < columns; c++) {
+            data += "\t";
+            if (c % 10 == 1) {
+                data += "code" + std::to_string(r % 50);
+            } else if (c % 10 == 2) {
+                data += std::to_string(r % 7) + ".5";
+            } else if (c % 3 != 0) {
+                data += std::to_string((r * c) % 100);
+            }
+        }
+        data += "\n";
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    auto table = parser_->parseExcel(data);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto parse_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    
+    auto path = (std::filesystem::temp_directory_path() / "d2_table_benchmark.d2tbl").string();
+    ASSERT_TRUE(parser_->writeBinary(table, 0, path));
+    
+    start = std::chrono::high_resolution_clock::now();
+    d2::utils::DataTable loaded;
+    ASSERT_TRUE(parser_->loadBinaryFile(path, loaded));
+    end = std::chrono::high_resolution_clock::now();
+    auto load_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    
+    expectSameCells(table, loaded);
+    
+    std::cout << "Data table binary benchmark (" << columns << " columns x " << rows << " rows):" << std::endl;
+    std::cout << "  Text size: " << data.size() / 1024 << " KB" << std::endl;
+    std::cout << "  Binary size: " << std::filesystem::file_size(path) / 1024 << " KB" << std::endl;
+    std::cout << "  Parse text: " << parse_us << " us" << std::endl;
+    std::cout << "  Load binary: " << load_us << " us" << std::endl;
+    std::filesystem::remove(path);
+}
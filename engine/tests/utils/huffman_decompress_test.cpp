@@ -2,9 +2,70 @@
 #include "utils/huffman_decompress.h"
 #include <vector>
 #include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <random>
 
 using namespace d2portable::utils;
 
+namespace {
+
+// The previous decoder: walks the fixed 8-bit code tree one input bit at
+// a time. Kept as the byte-exact reference for the table-driven decoder.
+bool ReferenceHuffmanDecompress(const std::vector<uint8_t>& compressed_data,
+                                std::vector<uint8_t>& output,
+                                size_t expected_size) {
+    if (compressed_data.empty()) {
+        return false;
+    }
+    output.resize(expected_size);
+    
+    if (compressed_data[0] > 8) {
+        if (compressed_data.size() - 1 == expected_size) {
+            std::copy(compressed_data.begin() + 1, compressed_data.end(), output.begin());
+            return true;
+        }
+        return false;
+    }
+    
+    size_t in_pos = 1;
+    uint32_t bit_buff = 0;
+    uint32_t bits_avail = 0;
+    size_t written = 0;
+    while (written < expected_size) {
+        uint32_t symbol = 0;
+        int depth = 0;
+        for (; depth < 8; depth++) {
+            if (bits_avail == 0) {
+                if (in_pos >= compressed_data.size()) {
+                    break;
+                }
+                bit_buff = compressed_data[in_pos++];
+                bits_avail = 8;
+            }
+            symbol = (symbol << 1) | (bit_buff & 1);
+            bit_buff >>= 1;
+            bits_avail--;
+        }
+        if (depth < 8) {
+            break;
+        }
+        output[written++] = static_cast<uint8_t>(symbol);
+    }
+    return written == expected_size;
+}
+
+std::vector<uint8_t> randomStream(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+} // namespace
+
 class HuffmanDecompressTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -170,4 +231,54 @@ TEST_F(HuffmanDecompressTest, DataIntegrityPassThrough) {
     for (size_t i = 0; i < original.size(); i++) {
         EXPECT_EQ(output[i], original[i]) << "Mismatch at index " << i;
     }
-}
\ No newline at end of file
+}
+
+// The table-driven decoder must match the tree walker for every type,
+// input length and requested size
+TEST_F(HuffmanDecompressTest, MatchesReferenceDecoder) {
+    for (uint8_t comp_type : {0, 1, 7, 8, 9, 255}) {
+        for (size_t input_size : {0, 1, 3, 7, 8, 9, 64, 1000}) {
+            auto stream = randomStream(input_size, comp_type * 131 + static_cast<uint32_t>(input_size));
+            stream.insert(stream.begin(), comp_type);
+            
+            for (size_t expected_size : {size_t(0), input_size / 2, input_size, input_size + 1}) {
+                std::vector<uint8_t> expected;
+                std::vector<uint8_t> actual;
+                bool expected_ok = ReferenceHuffmanDecompress(stream, expected, expected_size);
+                bool actual_ok = HuffmanDecompress(stream, actual, expected_size);
+                
+                EXPECT_EQ(actual_ok, expected_ok) << "type " << int(comp_type) << " input " << input_size
+                                                  << " expected " << expected_size;
+                if (expected_ok) {
+                    EXPECT_EQ(actual, expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(HuffmanDecompressTest, ThroughputBenchmark) {
+    const size_t size = 4 * 1024 * 1024;
+    auto stream = randomStream(size, 42);
+    stream.insert(stream.begin(), 0);
+    
+    // Best of several runs into a warm output buffer
+    auto measure = [&](auto decompress, std::vector<uint8_t>& output) {
+        double best = 1e9;
+        for (int run = 0; run < 5; run++) {
+            auto start = std::chrono::steady_clock::now();
+            EXPECT_TRUE(decompress(stream, output, size));
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return (size / (1024.0 * 1024.0)) / std::max(best, 1e-9);
+    };
+    
+    std::vector<uint8_t> reference_output;
+    std::vector<uint8_t> table_output;
+    double reference_mbps = measure(ReferenceHuffmanDecompress, reference_output);
+    double table_mbps = measure(HuffmanDecompress, table_output);
+    
+    std::cout << "Huffman decode: tree walk " << reference_mbps << " MB/s, lookup table "
+              << table_mbps << " MB/s\n";
+    EXPECT_EQ(table_output, reference_output);
+}
@@ -2,9 +2,31 @@
 #include <vector>
 #include <cstdint>
 #include <cstring>
+#include <chrono>
+#include <iostream>
+#include <random>
 
 // Include the header for the function we're testing
 #include "utils/pkware_explode.h"
+#include "utils/pkware_explode_internal.h"
+
+using d2portable::utils::PKWAREExplode;
+using d2portable::utils::pkware_internal::explodeReference;
+
+namespace {
+
+// Header followed by random bits, which decode to a mix of literals and
+// matches of every length and distance
+std::vector<uint8_t> randomStream(uint8_t ctype, uint8_t dict_bits, size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> stream = {ctype, dict_bits};
+    for (size_t i = 0; i < size; i++) {
+        stream.push_back(static_cast<uint8_t>(rng()));
+    }
+    return stream;
+}
+
+} // namespace
 
 class PKWareTest : public ::testing::Test {
 protected:
@@ -121,4 +143,59 @@ TEST_F(PKWareTest, NoDebugOutputToStderr) {
     
     // Should have no debug output
     EXPECT_TRUE(stderr_output.empty()) << "Unexpected stderr output: " << stderr_output;
-}
\ No newline at end of file
+}
+
+// Test 6: Table-driven decoder against the bit-at-a-time reference
+TEST_F(PKWareTest, MatchesReferenceDecoder) {
+    uint32_t seed = 1;
+    for (uint8_t ctype : {0, 1, 2}) {
+        for (uint8_t dict_bits = 4; dict_bits <= 6; dict_bits++) {
+            for (size_t size : {1, 2, 3, 7, 8, 9, 31, 257, 4096}) {
+                auto stream = randomStream(ctype, dict_bits, size, seed++);
+                
+                // Too little, about enough, and more output than the input holds
+                for (size_t expected_size : {size_t(1), size * 2, size * 16}) {
+                    std::vector<uint8_t> expected = {0xAA};
+                    std::vector<uint8_t> actual = {0xAA};
+                    bool expected_result = explodeReference(stream, expected, expected_size);
+                    bool actual_result = PKWAREExplode(stream, actual, expected_size);
+                    
+                    EXPECT_EQ(actual_result, expected_result) << "size " << size;
+                    EXPECT_EQ(actual, expected) << "ctype " << int(ctype) << " dict " << int(dict_bits)
+                                                << " size " << size;
+                }
+            }
+        }
+    }
+}
+
+// Test 7: Decode throughput
+TEST_F(PKWareTest, ThroughputBenchmark) {
+    auto stream = randomStream(0, 6, 4 * 1024 * 1024, 42);
+    
+    // Ask for exactly what the stream holds so the runs measure decoding
+    // rather than zero-filling an oversized output
+    std::vector<uint8_t> probe;
+    ASSERT_TRUE(explodeReference(stream, probe, 64 * 1024 * 1024));
+    const size_t limit = probe.size();
+    
+    // Best of several runs into a warm output buffer
+    auto measure = [&](auto explode, std::vector<uint8_t>& output) {
+        double best = 1e9;
+        for (int run = 0; run < 5; run++) {
+            auto start = std::chrono::steady_clock::now();
+            EXPECT_TRUE(explode(stream, output, limit));
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return (output.size() / (1024.0 * 1024.0)) / std::max(best, 1e-9);
+    };
+    
+    std::vector<uint8_t> reference_output;
+    std::vector<uint8_t> fast_output;
+    double reference_mbps = measure(explodeReference, reference_output);
+    double fast_mbps = measure(PKWAREExplode, fast_output);
+    
+    std::cout << "PKWARE explode (" << fast_output.size() / (1024 * 1024) << " MB out): reference "
+              << reference_mbps << " MB/s, table-driven " << fast_mbps << " MB/s\n";
+    EXPECT_EQ(fast_output, reference_output);
+}
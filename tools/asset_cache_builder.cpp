@@ -5,6 +5,7 @@
 #include <map>
 #include <set>
 #include "../engine/include/core/asset_manager.h"
+#include "../engine/include/core/asset_bundle.h"
 #include "../engine/include/sprites/dc6_parser.h"
 
 using namespace d2portable::core;
@@ -22,6 +23,8 @@ struct CacheConfig {
 
 class AssetCacheBuilder {
 public:
+    static constexpr const char* kSpriteBundleName = "sprites.d2pak";
+    
     AssetCacheBuilder(const CacheConfig& config) : config_(config) {}
     
     bool build() {
@@ -96,89 +99,32 @@ private:
             "data\\global\\items\\misc\\potion\\rps1.dc6"
         };
         
-        int processed = 0;
-        int failed = 0;
+        // Sprites are stored pre-decoded in one bundle the engine maps at startup
+        AssetBundleWriter writer;
         
         for (const auto& sprite_path : priority_sprites) {
             auto sprite = asset_manager.loadSprite(sprite_path);
             if (sprite) {
-                if (processSpriteToCache(sprite_path, sprite)) {
-                    processed++;
-                } else {
-                    failed++;
+                std::cout << "  Processing: " << sprite_path 
+                          << " (" << sprite->getDirectionCount() << " dirs, " 
+                          << sprite->getFramesPerDirection() << " frames/dir)\n";
+                if (writer.addSprite(sprite_path, sprite)) {
+                    sprite_cache_entries_[sprite_path] = kSpriteBundleName;
                 }
             } else {
                 std::cout << "  Skipping (not found): " << sprite_path << "\n";
             }
         }
         
-        std::cout << "Sprite cache complete: " << processed << " processed, " 
-                  << failed << " failed\n\n";
-    }
-    
-    bool processSpriteToCache(const std::string& sprite_path, 
-                             std::shared_ptr<DC6Sprite> sprite) {
-        // Convert path to cache filename
-        std::string cache_name = sprite_path;
-        std::replace(cache_name.begin(), cache_name.end(), '\\', '_');
-        std::replace(cache_name.begin(), cache_name.end(), '/', '_');
-        
-        fs::path cache_path = fs::path(config_.output_dir) / "sprites" / (cache_name + ".cache");
-        fs::create_directories(cache_path.parent_path());
-        
-        // Extract sprite information
-        uint32_t directions = sprite->getDirectionCount();
-        uint32_t frames_per_dir = sprite->getFramesPerDirection();
-        
-        std::cout << "  Processing: " << sprite_path 
-                  << " (" << directions << " dirs, " 
-                  << frames_per_dir << " frames/dir)\n";
-        
-        // Create cache file
-        std::ofstream cache_file(cache_path, std::ios::binary);
-        if (!cache_file) {
-            return false;
-        }
-        
-        // Write cache header
-        const char* magic = "D2SC"; // D2 Sprite Cache
-        cache_file.write(magic, 4);
-        
-        uint32_t version = 1;
-        cache_file.write(reinterpret_cast<const char*>(&version), 4);
-        cache_file.write(reinterpret_cast<const char*>(&directions), 4);
-        cache_file.write(reinterpret_cast<const char*>(&frames_per_dir), 4);
-        
-        // Process each frame
-        for (uint32_t dir = 0; dir < directions; dir++) {
-            for (uint32_t frame = 0; frame < frames_per_dir; frame++) {
-                auto frame_data = sprite->getFrame(dir, frame);
-                auto rgba_data = sprite->getFrameImage(dir, frame);
-                
-                // Write frame header
-                cache_file.write(reinterpret_cast<const char*>(&frame_data.width), 4);
-                cache_file.write(reinterpret_cast<const char*>(&frame_data.height), 4);
-                cache_file.write(reinterpret_cast<const char*>(&frame_data.offsetX), 4);
-                cache_file.write(reinterpret_cast<const char*>(&frame_data.offsetY), 4);
-                
-                uint32_t data_size = rgba_data.size();
-                cache_file.write(reinterpret_cast<const char*>(&data_size), 4);
-                
-                // Optimize if requested
-                if (config_.optimize_sprites) {
-                    // Could implement texture compression here
-                    // For now, just write raw RGBA
-                    cache_file.write(reinterpret_cast<const char*>(rgba_data.data()), 
-                                   rgba_data.size());
-                } else {
-                    cache_file.write(reinterpret_cast<const char*>(rgba_data.data()), 
-                                   rgba_data.size());
-                }
-            }
+        fs::path bundle_path = fs::path(config_.output_dir) / kSpriteBundleName;
+        if (!writer.write(bundle_path.string())) {
+            std::cerr << "Failed to write sprite bundle: " << writer.getLastError() << "\n";
+            sprite_cache_entries_.clear();
+            return;
         }
         
-        sprite_cache_entries_[sprite_path] = cache_name + ".cache";
-        return true;
+        std::cout << "Sprite bundle complete: " << writer.getSpriteCount() 
+                  << " sprites in " << bundle_path << "\n\n";
     }
     
     void buildDataCache(AssetManager& asset_manager) {
@@ -246,7 +192,8 @@ private:
         }
         
         manifest << "{\n";
-        manifest << "  \"version\": 1,\n";
+        manifest << "  \"version\": 2,\n";
+        manifest << "  \"bundle_version\": " << kAssetBundleVersion << ",\n";
         manifest << "  \"created\": \"" << getCurrentTimestamp() << "\",\n";
         manifest << "  \"config\": {\n";
         manifest << "    \"optimize_sprites\": " 
@@ -261,7 +208,7 @@ private:
         bool first = true;
         for (const auto& [orig, cached] : sprite_cache_entries_) {
             if (!first) manifest << ",\n";
-            manifest << "    \"" << orig << "\": \"sprites/" << cached << "\"";
+            manifest << "    \"" << orig << "\": \"" << cached << "\"";
             first = false;
         }
         manifest << "\n  },\n";